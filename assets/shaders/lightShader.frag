@@ -11,13 +11,28 @@ uniform int  uType;
 uniform vec2 uBlur;
 
 // The texture for sampling
-uniform sampler2D uTexture;
+uniform sampler2D uTextures[8];
 
 
-//16 is maximum possible rooms in a map
-uniform vec3 uRoomLights[16];
+// Lights are culled to the view and binned into 4x4 tiles on the CPU
+// (see LightGrid). Sizes must match the light constants in Constants.h.
 
-uniform vec4 uPlayers[3];
+// Lights in view: xy is the position, z the radius squared
+uniform vec4 uLights[32];
+// Light cones: xy is the direction, z and w the cosines of the outer and inner half angles
+uniform vec4 uLightCones[32];
+// Light indices grouped by tile, four to a vector
+uniform ivec4 uLightIndex[32];
+// The start and count of each tile in uLightIndex
+uniform ivec2 uTiles[16];
+// The corner and size of a tile, in drawing coordinates
+uniform vec2 uTileOrigin;
+uniform vec2 uTileSize;
+
+// 1 to take the light from a light map instead (see GameScene::setLightMapScale)
+uniform int uLightMode;
+// The light map, covering the screen
+uniform sampler2D uLightMask;
 
 uniform float uLightAngle;
 
@@ -30,23 +45,8 @@ out vec4 frag_color;
 in vec2 outPosition;
 in vec4 outColor;
 in vec2 outTexCoord;
-
-float rangle (vec2 v) {
-    float a = atan(v.y/v.x);
-    return v.x > 0.? a: a + 3.14159;
-}
-float dangle (float a, float b) {
-    float d = abs(a-b);
-    return d > 3.14159 ? d - 3.14159 * 2. : d;
-}
-float sq (float x) {
-    return x * x;
-}
-
-float dist (vec2 v1, vec2 v2) {
-    float d = sq(v1.x - v2.x) + sq(v1.y - v2.y);
-    return sqrt(d);
-}
+in float outTexSlot;
+in vec2 outScreen;
 
 // The stroke+gradient uniform block
 layout (std140) uniform uContext
@@ -98,6 +98,27 @@ float scissormask(vec2 pt) {
     return clamp(sc.x,0.0,1.0) * clamp(sc.y,0.0,1.0);
 }
 
+/**
+ * Returns the texture color at the given coordinate
+ *
+ * The texture is the one in the slot for this vertex. Samplers
+ * may only be indexed by constants, hence the branches.
+ *
+ * coord: The texture coordinate to sample
+ */
+vec4 slotsample(vec2 coord) {
+    int slot = int(outTexSlot+0.5);
+    if (slot < 4) {
+        if (slot < 2) {
+            return slot == 0 ? texture(uTextures[0], coord) : texture(uTextures[1], coord);
+        }
+        return slot == 2 ? texture(uTextures[2], coord) : texture(uTextures[3], coord);
+    } else if (slot < 6) {
+        return slot == 4 ? texture(uTextures[4], coord) : texture(uTextures[5], coord);
+    }
+    return slot == 6 ? texture(uTextures[6], coord) : texture(uTextures[7], coord);
+}
+
 /**
  * Returns the result of a simple kernel blur
  *
@@ -135,82 +156,53 @@ vec4 blursample(vec2 coord) {
     // Sample from the texture and average
     vec4 result = vec4(0.0);
     for(int ii = 0; ii < 9; ii++) {
-        result += texture(uTexture, coord + off[ii])*kernel[ii];
+        result += slotsample(coord + off[ii])*kernel[ii];
     }
 
     return result;
 }
 
 
-float roomshade(vec3 light, vec2 pos) {
-    float a = 0.0;
-    if (light.z == 0.0f) return a;
-    vec2 room = light.xy - pos;
-    //sharpness of outer circle edge
-    float roomRadius = 432.0;
-    float roomOuterRadius = roomRadius + 10.0;
-    float rD = dist(light.xy, pos);
-    if (rD <= roomRadius) {
-        a = 1.0;
-    } else {
-        a = 0.0;
-    }
-    return a;
-}
-
-float flashshade(vec4 pal, vec2 pos) {
-    float a = 0.0;
-    if (pal.z == 0.0f) {
-        return a;
-    }
-    vec2 coor = pal.xy - pos;
-    float mangle = rangle(coor);
-    //the flashlight angle
-    float pangle = pal.w;
-    //sharpness of outer circle edge
-    float palRadius = 200.0;
-    float palOuterRadius = 210.0;
-    float d = dist(pal.xy, pos);
-    //adjust 0.2 and 0.1 to make edge sharper
-    float inAngle = smoothstep(0.5, 0.49, sq(
-        dangle(pangle, mangle)
-    ));
-    if (d <= palRadius) {
-        a = inAngle;
-    } else {
-        a = 0.0;
+/**
+ * Returns how much the given light lights a position
+ *
+ * Round lights have cone cosines below -1, so every direction
+ * passes. Cones feather between their inner and outer angles.
+ *
+ * i:   The index of the light
+ * pos: The position to light
+ */
+float lightshade(int i, vec2 pos) {
+    vec2 v = pos - uLights[i].xy;
+    float d2 = dot(v, v);
+    if (d2 > uLights[i].z) {
+        return 0.0;
     }
-    return a;
-
+    vec4 cone = uLightCones[i];
+    float c = d2 > 0.0 ? dot(v, cone.xy) * inversesqrt(d2) : 1.0;
+    return smoothstep(cone.z, cone.w, c);
 }
 
-
-
-
 /**
  * Performs the main fragment shading.
  * idea for function taken from https://www.shadertoy.com/view/WsySRV
  */
 void main(void) {
-    vec4 result = texture(uTexture, outTexCoord);
+    vec4 result = slotsample(outTexCoord);
     if (result.a == 0.0) {
         frag_color = result;
 
     } else {
         float a = result.w;
-        
-        for (int i = 0; i < 3; i++) {
-            float flashcolor = flashshade(uPlayers[i], outPosition);
-            if (flashcolor > 0.0) {
-                a = max((a - flashcolor),0.0);
-            }
-            
-        }
 
-        for (int i = 0; i < 16; i++) {
-            float roomcolor = roomshade(uRoomLights[i], outPosition);
-            if (roomcolor > 0.0) {
-                a = max((a - roomcolor),0.0);
+        if (uLightMode == 1) {
+            a = max(a - texture(uLightMask, outScreen).r, 0.0);
+        } else {
+            // Only the lights binned into this fragment's tile can reach it
+            ivec2 cell = clamp(ivec2(floor((outPosition - uTileOrigin) / uTileSize)), ivec2(0), ivec2(3));
+            ivec2 tile = uTiles[cell.y * 4 + cell.x];
+            for (int k = tile.x; k < tile.x + tile.y && a > 0.0; k++) {
+                a = max(a - lightshade(uLightIndex[k / 4][k % 4], outPosition), 0.0);
             }
         }
 
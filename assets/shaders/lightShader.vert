@@ -12,6 +12,12 @@ out vec4 outColor;
 in  vec2 aTexCoord;
 out vec2 outTexCoord;
 
+in  float aTexSlot;
+out float outTexSlot;
+
+// Position on the screen, for sampling the light map
+out vec2 outScreen;
+
 // Matrices
 uniform mat4 uPerspective;
 
@@ -23,5 +29,7 @@ void main(void) {
     //outPosition = vec2(0.0, 0.0);
     outColor = aColor;
     outTexCoord = aTexCoord;
+    outTexSlot = aTexSlot;
+    outScreen = gl_Position.xy / gl_Position.w * 0.5 + 0.5;
 }
 )"
\ No newline at end of file
@@ -12,8 +12,10 @@ LOCAL_MODULE := main
 LOCAL_C_INCLUDES := $(CUGL_PATH)/include
 
 # Add your application source files here...
+# (the atlas packer and asset bundler are only for the offline tools)
 LOCAL_SRC_FILES := $(subst $(LOCAL_PATH)/,, \
-	$(wildcard $(PROJ_PATH)/source/*.cpp) \
+	$(filter-out %/AtlasPacker.cpp %/AssetBundler.cpp, \
+	$(wildcard $(PROJ_PATH)/source/*.cpp)) \
 	$(wildcard $(PROJ_PATH)/source/GameEntities/*.cpp) \
 	$(wildcard $(PROJ_PATH)/source/GameEntities/Players/*.cpp) \
 	$(wildcard $(PROJ_PATH)/source/RoomEntities/*.cpp))
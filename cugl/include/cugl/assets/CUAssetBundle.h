@@ -0,0 +1,496 @@
+//
+//  CUAssetBundle.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary bundle of precompiled assets. A bundle packs
+//  many asset files into one file, storing each in the form the game needs at
+//  run time: images as raw RGBA pixels, JSON as a flat binary tree, and sound
+//  samples as decoded PCM. An index hashed on the asset path finds any entry
+//  in constant time. Loading from a bundle therefore skips all decoding and
+//  parsing, and opens one file instead of hundreds.
+//
+//  Bundles are memory mapped where the asset directory is a real directory.
+//  On Android the assets are inside the APK and cannot be mapped, so the
+//  bundle is read into memory in one pass instead.
+//
+//  Bundles are written offline with AssetBundleWriter, and are attached to an
+//  AssetManager with setBundle. All multibyte values are little-endian.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_ASSET_BUNDLE_H__
+#define __CU_ASSET_BUNDLE_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <SDL/SDL.h>
+#include <string>
+#include <vector>
+
+/** The version of the bundle format written by AssetBundleWriter */
+#define ASSET_BUNDLE_VERSION 2
+
+namespace cugl {
+
+/** Forward reference to an audio sample */
+class AudioSample;
+
+/**
+ * This class is a read-only bundle of precompiled assets.
+ *
+ * Each entry of the bundle is named by the path of the asset file it was
+ * built from, relative to the asset directory (e.g. "textures/logo.png").
+ * Images are stored as RGBA pixels, JSON files as a flat binary tree, and
+ * sound samples as decoded PCM.  Looking up an entry is a single hash probe.
+ *
+ * Images are returned as surfaces that borrow the bundle memory, so they are
+ * not copied at all before they are uploaded.  Such a surface must not be
+ * used after the bundle is disposed.
+ *
+ * Once opened, a bundle is never modified, so it is safe to read from any
+ * number of threads at once.
+ */
+class AssetBundle {
+public:
+    /**
+     * This enum lists the kinds of bundle entries.
+     */
+    enum class Type : Uint32 {
+        /** An empty index slot */
+        NONE  = 0,
+        /** An image of RGBA pixels */
+        IMAGE = 1,
+        /** A JSON file stored as a flat binary tree */
+        JSON  = 2,
+        /** A sound sample stored as interleaved float PCM */
+        SOUND = 3
+    };
+
+    /** The bundle file header */
+    struct Header {
+        /** The characters "CUAB" */
+        char magic[4];
+        /** The format version */
+        Uint32 version;
+        /** The number of index slots (a power of two) */
+        Uint32 slots;
+        /** The number of entries */
+        Uint32 count;
+        /** The file offset of the index */
+        Uint64 index;
+        /** The file offset of the entry names */
+        Uint64 names;
+    };
+
+    /** An index slot (an entry, or empty if the type is NONE) */
+    struct Slot {
+        /** The hash of the entry name */
+        Uint64 hash;
+        /** The offset of the entry name in the name block */
+        Uint32 name;
+        /** The entry type */
+        Type type;
+        /** The file offset of the entry payload */
+        Uint64 offset;
+        /** The size of the entry payload in bytes */
+        Uint64 size;
+        /** The modification time of the source file (or 0 if unknown) */
+        Uint64 modified;
+        /** The size of the source file in bytes */
+        Uint64 length;
+        /** The hash of the source file contents */
+        Uint64 digest;
+    };
+
+    /** A node of a JSON tree; the children of a node are contiguous */
+    struct JsonNode {
+        /** The node type (a JsonValue::Type) */
+        Uint32 type;
+        /** The offset of the key in the string block (or -1 for none) */
+        Uint32 key;
+        /** The string offset, or the index of the first child */
+        Uint32 first;
+        /** The string length, or the number of children */
+        Uint32 count;
+        /** The number, or 0/1 for a boolean */
+        double number;
+    };
+
+    /**
+     * Returns the hash of an entry name.
+     *
+     * @param name  The entry name
+     *
+     * @return the hash of an entry name.
+     */
+    static Uint64 hash(const std::string& name);
+
+private:
+    /** This macro disables the copy constructor (not allowed on bundles) */
+    CU_DISALLOW_COPY_AND_ASSIGN(AssetBundle);
+
+    /** The bundle contents */
+    Uint8* _data;
+    /** The size of the bundle in bytes */
+    size_t _size;
+    /** Whether the contents are mapped (as opposed to allocated) */
+    bool _mapped;
+    /** The index slots */
+    const Slot* _slots;
+    /** The number of index slots minus one */
+    Uint32 _mask;
+    /** The number of entries */
+    Uint32 _count;
+
+    /**
+     * Returns the index slot for the given name, or nullptr if it is missing.
+     *
+     * @param name  The entry name
+     *
+     * @return the index slot for the given name, or nullptr if it is missing.
+     */
+    const Slot* find(const std::string& name) const;
+
+    /**
+     * Returns true if the bundle contents have a valid header and index.
+     *
+     * Every entry is checked against the size of the bundle, including the
+     * nodes and strings of each JSON tree, so that a truncated or corrupt
+     * bundle is rejected when it is opened rather than read out of bounds.
+     *
+     * @return true if the bundle contents have a valid header and index.
+     */
+    bool validate();
+
+    /**
+     * Returns true if the given entry payload is well-formed.
+     *
+     * @param slot  The index slot of the entry
+     *
+     * @return true if the given entry payload is well-formed.
+     */
+    bool validate(const Slot* slot) const;
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty asset bundle.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a bundle on
+     * the heap, use one of the static constructors instead.
+     */
+    AssetBundle() : _data(nullptr), _size(0), _mapped(false),
+    _slots(nullptr), _mask(0), _count(0) {}
+
+    /**
+     * Deletes this asset bundle, releasing its memory.
+     */
+    ~AssetBundle() { dispose(); }
+
+    /**
+     * Releases the bundle contents.
+     *
+     * Any image surfaces borrowed from this bundle are no longer valid.
+     */
+    void dispose();
+
+    /**
+     * Initializes a bundle from the file with the given path.
+     *
+     * The file is memory mapped if the platform allows it.
+     *
+     * @param file  The path to the bundle file
+     *
+     * @return true if the bundle was opened successfully
+     */
+    bool init(const std::string& file);
+
+    /**
+     * Initializes a bundle from the given file in the asset directory.
+     *
+     * The file is memory mapped if the platform allows it.  The bundle is
+     * rejected if it is out of date with the asset directory (see
+     * {@link #isCurrent}), so that the caller falls back to the files.
+     *
+     * @param file  The path to the bundle, relative to the asset directory
+     *
+     * @return true if the bundle was opened successfully
+     */
+    bool initWithAsset(const std::string& file);
+
+    /**
+     * Returns a newly opened bundle from the file with the given path.
+     *
+     * The file is memory mapped if the platform allows it.
+     *
+     * @param file  The path to the bundle file
+     *
+     * @return a newly opened bundle from the file with the given path.
+     */
+    static std::shared_ptr<AssetBundle> alloc(const std::string& file) {
+        std::shared_ptr<AssetBundle> result = std::make_shared<AssetBundle>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly opened bundle from the given file in the asset directory.
+     *
+     * The file is memory mapped if the platform allows it.  The bundle is
+     * rejected if it is out of date with the asset directory (see
+     * {@link #isCurrent}), so that the caller falls back to the files.
+     *
+     * @param file  The path to the bundle, relative to the asset directory
+     *
+     * @return a newly opened bundle from the given file in the asset directory.
+     */
+    static std::shared_ptr<AssetBundle> allocWithAsset(const std::string& file) {
+        std::shared_ptr<AssetBundle> result = std::make_shared<AssetBundle>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+#pragma mark Entries
+    /**
+     * Returns the number of entries in this bundle.
+     *
+     * @return the number of entries in this bundle.
+     */
+    size_t size() const { return _count; }
+
+    /**
+     * Returns true if this bundle has an entry with the given name.
+     *
+     * @param name  The asset path, relative to the asset directory
+     *
+     * @return true if this bundle has an entry with the given name.
+     */
+    bool contains(const std::string& name) const { return find(name) != nullptr; }
+
+    /**
+     * Returns true if every entry matches its source file in the directory.
+     *
+     * Each entry records the size, modification time and contents hash of
+     * the file it was built from.  A source file with a different size is
+     * out of date.  A source file with a different modification time is
+     * hashed, so that copying the asset folder does not invalidate the
+     * bundle.  Source files that are missing, or that cannot be examined
+     * (such as assets inside an Android APK), are assumed to match.
+     *
+     * @param directory The directory the entry names are relative to
+     *
+     * @return true if every entry matches its source file in the directory.
+     */
+    bool isCurrent(const std::string& directory) const;
+
+    /**
+     * Returns the type of the entry with the given name.
+     *
+     * @param name  The asset path, relative to the asset directory
+     *
+     * @return the type of the entry with the given name (NONE if missing).
+     */
+    Type getType(const std::string& name) const;
+
+    /**
+     * Returns a surface for the image with the given name.
+     *
+     * The surface has format SDL_PIXELFORMAT_RGBA32 and borrows its pixels
+     * from the bundle, so it must not be modified, and must not be used after
+     * this bundle is disposed.  The caller must free the surface itself.
+     *
+     * @param name  The asset path, relative to the asset directory
+     *
+     * @return a surface for the image (or nullptr if it is not an image).
+     */
+    SDL_Surface* getImage(const std::string& name) const;
+
+    /**
+     * Returns the JSON tree with the given name.
+     *
+     * @param name  The asset path, relative to the asset directory
+     *
+     * @return the JSON tree (or nullptr if it is not a JSON entry).
+     */
+    std::shared_ptr<JsonValue> getJson(const std::string& name) const;
+
+    /**
+     * Returns an in-memory sample with the sound of the given name.
+     *
+     * @param name  The asset path, relative to the asset directory
+     *
+     * @return an in-memory sample (or nullptr if it is not a sound entry).
+     */
+    std::shared_ptr<AudioSample> getSound(const std::string& name) const;
+};
+
+
+#pragma mark -
+/**
+ * This class writes a bundle of precompiled assets.
+ *
+ * Entries are written to the file as they are added, so only the index is
+ * kept in memory.  The bundle is not valid until it is closed.  Entries are
+ * named by their asset path, relative to the asset directory, so that the
+ * loaders can look them up by the paths in an asset directory.
+ */
+class AssetBundleWriter {
+private:
+    /** This macro disables the copy constructor (not allowed on writers) */
+    CU_DISALLOW_COPY_AND_ASSIGN(AssetBundleWriter);
+
+    /** An entry written so far */
+    struct Entry {
+        /** The entry name */
+        std::string name;
+        /** The entry type */
+        AssetBundle::Type type;
+        /** The file offset of the entry payload */
+        Uint64 offset;
+        /** The size of the entry payload in bytes */
+        Uint64 size;
+        /** The modification time of the source file (or 0 if unknown) */
+        Uint64 modified;
+        /** The size of the source file in bytes */
+        Uint64 length;
+        /** The hash of the source file contents */
+        Uint64 digest;
+    };
+
+    /** The output file */
+    SDL_RWops* _file;
+    /** The directory the entry names are relative to (for the staleness check) */
+    std::string _source;
+    /** The entries written so far */
+    std::vector<Entry> _entries;
+
+    /**
+     * Writes a payload at the end of the file, adding it to the index.
+     *
+     * The payload is aligned to 16 bytes.
+     *
+     * @param name  The entry name
+     * @param type  The entry type
+     * @param parts The pieces of the payload, in order
+     *
+     * @return true if the payload was written
+     */
+    bool write(const std::string& name, AssetBundle::Type type,
+               const std::vector<std::pair<const void*,size_t>>& parts);
+
+public:
+    /**
+     * Creates a writer with no file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a writer on
+     * the heap, use one of the static constructors instead.
+     */
+    AssetBundleWriter() : _file(nullptr) {}
+
+    /**
+     * Deletes this writer, closing the bundle if it is open.
+     */
+    ~AssetBundleWriter() { close(); }
+
+    /**
+     * Initializes a writer for a new bundle at the given path.
+     *
+     * Any existing file at that path is replaced.  If source is not empty,
+     * each entry records the file of that name in the source directory, so
+     * that {@link AssetBundle#isCurrent} can detect a stale bundle.
+     *
+     * @param file      The path to the bundle file
+     * @param source    The directory the entry names are relative to
+     *
+     * @return true if the file was created
+     */
+    bool init(const std::string& file, const std::string& source="");
+
+    /**
+     * Returns a newly allocated writer for a new bundle at the given path.
+     *
+     * Any existing file at that path is replaced.  If source is not empty,
+     * each entry records the file of that name in the source directory, so
+     * that {@link AssetBundle#isCurrent} can detect a stale bundle.
+     *
+     * @param file      The path to the bundle file
+     * @param source    The directory the entry names are relative to
+     *
+     * @return a newly allocated writer for a new bundle at the given path.
+     */
+    static std::shared_ptr<AssetBundleWriter> alloc(const std::string& file, const std::string& source="") {
+        std::shared_ptr<AssetBundleWriter> result = std::make_shared<AssetBundleWriter>();
+        return (result->init(file,source) ? result : nullptr);
+    }
+
+    /**
+     * Returns true if the bundle already has an entry with the given name.
+     *
+     * @param name  The entry name
+     *
+     * @return true if the bundle already has an entry with the given name.
+     */
+    bool contains(const std::string& name) const;
+
+    /**
+     * Adds an image to the bundle.
+     *
+     * The image is converted to SDL_PIXELFORMAT_RGBA32, which is the layout
+     * that the texture loader uploads.
+     *
+     * @param name      The entry name
+     * @param surface   The image to add
+     *
+     * @return true if the image was added
+     */
+    bool addImage(const std::string& name, SDL_Surface* surface);
+
+    /**
+     * Adds a JSON tree to the bundle.
+     *
+     * @param name  The entry name
+     * @param json  The JSON tree to add
+     *
+     * @return true if the tree was added
+     */
+    bool addJson(const std::string& name, const std::shared_ptr<JsonValue>& json);
+
+    /**
+     * Adds an in-memory sound sample to the bundle.
+     *
+     * Streamed samples have no decoded buffer, and cannot be added.
+     *
+     * @param name      The entry name
+     * @param sample    The sample to add
+     *
+     * @return true if the sample was added
+     */
+    bool addSound(const std::string& name, const std::shared_ptr<AudioSample>& sample);
+
+    /**
+     * Writes the index and closes the bundle.
+     *
+     * @return true if the bundle was written successfully
+     */
+    bool close();
+};
+
+}
+
+#endif /* __CU_ASSET_BUNDLE_H__ */
@@ -50,8 +50,11 @@
 #include <cugl/util/CUThreadPool.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/assets/CULoader.h>
+#include <cugl/assets/CUAssetBundle.h>
 #include <typeinfo>
 #include <atomic>
+#include <algorithm>
+#include <vector>
 
 
 namespace cugl {
@@ -89,14 +92,29 @@ private:
 protected:
     /** The individual loaders for each type */
     std::unordered_map<size_t,std::shared_ptr<BaseLoader>> _handlers;
-    /** The central thread for managing all of the loaders */
+    /** The worker threads shared by all of the loaders */
     std::shared_ptr<ThreadPool> _workers;
+    /** The precompiled asset bundle (may be nullptr) */
+    std::shared_ptr<AssetBundle> _bundle;
 
-    /** State variable to manage reading JSON directories */
-    bool _preload;
+    /** The number of directory reads not yet handed to their loaders */
+    std::atomic<Uint32> _preload;
     
-    /** Wait variable to create a load barrier for directories. */
-    std::atomic<bool> _wait;
+    /** The asset types that each asset type waits on in a directory */
+    std::unordered_map<size_t,std::vector<size_t>> _dependencies;
+    
+    /** A directory category waiting on the asset types it depends upon */
+    struct Deferred {
+        /** The hash of the asset type */
+        size_t hash;
+        /** The child of asset directory with these assets */
+        std::shared_ptr<JsonValue> json;
+        /** An optional callback after each asset is loaded */
+        LoaderCallback callback;
+    };
+    
+    /** The categories waiting on their dependencies (main thread only) */
+    std::vector<Deferred> _deferred;
 
     /**
      * Synchronously reads an asset category from a JSON file
@@ -173,32 +191,28 @@ protected:
     bool purgeCategory(size_t hash, const std::shared_ptr<JsonValue>& json);
 
     /**
-     * Synchronizes the asset manager to wait until all assets have finished.
+     * Returns true if no asset type that this one depends upon is loading.
      *
-     * This method is necessary for assets whose construction depends on
-     * previously loaded assets (e.g. scene graphs).  In the current architecture,
-     * this method is only correct if the asset manager loads assets in a
-     * single thread.
-     */
-    void sync();
-    
-    /**
-     * Blocks the asset manager until the next animation frame.
+     * The dependencies of an asset type are specified by {@link addDependency}.
+     * Types without an attached loader are never pending.  This method reads
+     * the loader queues, so it should only be called in the main thread.
      *
-     * Any assets queued after a block will not be added to thread pool
-     * until at least one animation frame has passed.  This method is used
-     * to implement the {@link sync()} method.
+     * @param hash      The hash of the asset type
+     *
+     * @return true if no asset type that this one depends upon is loading.
      */
-    void block();
-
+    bool isReady(size_t hash) const;
+    
     /**
-     * Resumes a previously blocked the asset manager.
+     * Reads every deferred category whose dependencies have finished.
      *
-     * Any assets queued after a block will not be added to thread pool
-     * until at least one animation frame has passed.  This method is used
-     * to implement the {@link sync()} method.
+     * A directory category that depends on other asset types (e.g. scene
+     * graphs, which need their textures and fonts) is not given to its loader
+     * until those types have finished.  This method is called in the main
+     * thread each time a dependency finishes, so no worker thread is ever
+     * parked waiting on the main thread.
      */
-    void resume();
+    void release();
     
     
 #pragma mark -
@@ -210,7 +224,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an asset 
      * manager on the heap, use one of the static constructors instead.
      */
-    AssetManager() : _preload(false), _wait(false) {}
+    AssetManager() : _preload(0) {}
     
     /**
      * Deletes this asset manager, disposing of all resources.
@@ -227,11 +241,12 @@ public:
     void dispose();
 
     /**
-     * Initializes a new asset manager with two auxiliary threads.
+     * Initializes a new asset manager with one thread per spare core.
      *
-     * The asset manager will have a thread pool of size 2, giving it two 
-     * threads to load assets asynchronously.  These threads have no effect on 
-     * synchronous loading and will sleep when no assets are being loaded.
+     * The asset manager will have a thread pool with one thread for every
+     * core but the one running the main thread (and at least one thread).
+     * These threads have no effect on synchronous loading and will sleep
+     * when no assets are being loaded.
      *
      * This initializer does not attach any loaders.  It simply creates an 
      * object that is ready to accept loader objects.
@@ -240,63 +255,62 @@ public:
      */
     bool init();
 
-    //
-    // Initializes a new asset manager with the given number of auxiliary threads.
-    //
-    // The asset manager will have a thread pool of the given size, allowing it
-    // load assets asynchronously.  These threads have no effect on synchronous
-    // loading and will sleep when no assets are being loaded.  If threads is
-    // 0, all assets must be loaded synchronously.
-    //
-    // This initializer does not attach any loaders.  It simply creates an
-    // object that is ready to accept loader objects.
-    //
-    // @param threads   The number of threads for asynchronous loading
-    //
-    // @return true if the asset manager was initialized successfully
-    //
-    // TODO: This class must be refactored for this to be safe to use.
-    // bool init(unsigned int threads);
+    /**
+     * Initializes a new asset manager with the given number of auxiliary threads.
+     *
+     * The asset manager will have a thread pool of the given size, allowing it
+     * load assets asynchronously.  These threads have no effect on synchronous
+     * loading and will sleep when no assets are being loaded.  If threads is
+     * 0, all assets must be loaded synchronously.
+     *
+     * This initializer does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param threads   The number of threads for asynchronous loading
+     *
+     * @return true if the asset manager was initialized successfully
+     */
+    bool init(Uint32 threads);
     
 #pragma mark -
 #pragma mark Static Constructors
     /**
-     * Returns a newly allocated asset manager with two auxiliary threads.
+     * Returns a newly allocated asset manager with one thread per spare core.
      *
-     * The asset manager will have a thread pool of size 2, giving it two
-     * threads to load assets asynchronously.  These threads have no effect on
-     * synchronous loading and will sleep when no assets are being loaded.
+     * The asset manager will have a thread pool with one thread for every
+     * core but the one running the main thread (and at least one thread).
+     * These threads have no effect on synchronous loading and will sleep
+     * when no assets are being loaded.
      *
      * This constructor does not attach any loaders.  It simply creates an
      * object that is ready to accept loader objects.
      *
-     * @return a newly allocated asset manager with two auxiliary threads.
+     * @return a newly allocated asset manager with one thread per spare core.
      */
     static std::shared_ptr<AssetManager> alloc() {
         std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
         return (result->init() ? result : nullptr);
     }
     
-    //
-    // Returns a newly allocated asset manager with the given number of auxiliary threads.
-    //
-    // The asset manager will have a thread pool of the given size, allowing it
-    // load assets asynchronously.  These threads have no effect on synchronous
-    // loading and will sleep when no assets are being loaded.  If threads is
-    // 0, all assets must be loaded synchronously.
-    //
-    // This constructor does not attach any loaders.  It simply creates an
-    // object that is ready to accept loader objects.
-    //
-    // @param threads   The number of threads for asynchronous loading
-    //
-    // @return a newly allocated asset manager with the given number of auxiliary threads.
-    //
-    // TODO: This class must be refactored for this to be safe to use.
-    // static std::shared_ptr<AssetManager> alloc(unsigned int threads) {
-    //     std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
-    //     return (result->init(threads) ? result : nullptr);
-    // }
+    /**
+     * Returns a newly allocated asset manager with the given number of auxiliary threads.
+     *
+     * The asset manager will have a thread pool of the given size, allowing it
+     * load assets asynchronously.  These threads have no effect on synchronous
+     * loading and will sleep when no assets are being loaded.  If threads is
+     * 0, all assets must be loaded synchronously.
+     *
+     * This constructor does not attach any loaders.  It simply creates an
+     * object that is ready to accept loader objects.
+     *
+     * @param threads   The number of threads for asynchronous loading
+     *
+     * @return a newly allocated asset manager with the given number of auxiliary threads.
+     */
+    static std::shared_ptr<AssetManager> alloc(Uint32 threads) {
+        std::shared_ptr<AssetManager> result = std::make_shared<AssetManager>();
+        return (result->init(threads) ? result : nullptr);
+    }
 
 #pragma mark -
 #pragma mark Loader Management
@@ -393,6 +407,78 @@ public:
         return std::dynamic_pointer_cast<Loader<T>>(it->second);
     }
     
+    /**
+     * Declares that directory assets of type T wait on those of type D
+     *
+     * When an asset directory is loaded asynchronously, the category for
+     * type T is not given to its loader until no assets of type D are still
+     * loading.  This allows an asset to safely look up the assets it is built
+     * from.  By default, scene graphs depend on textures, fonts and widgets.
+     *
+     * Dependencies only order the categories of a directory.  Synchronous
+     * loading reads the categories in order, and individual asynchronous
+     * loads are never delayed.
+     */
+    template<typename T, typename D>
+    void addDependency() {
+        size_t hash = typeid(T).hash_code();
+        size_t dependency = typeid(D).hash_code();
+        std::vector<size_t>& list = _dependencies[hash];
+        if (std::find(list.begin(), list.end(), dependency) == list.end()) {
+            list.push_back(dependency);
+        }
+    }
+    
+    /**
+     * Removes all dependencies of directory assets of type T
+     *
+     * Afterwards, the category for type T is given to its loader as soon as
+     * it is read from an asset directory.
+     */
+    template<typename T>
+    void clearDependencies() {
+        _dependencies.erase(typeid(T).hash_code());
+    }
+    
+#pragma mark -
+#pragma mark Bundle Support
+    /**
+     * Returns the precompiled asset bundle for this manager.
+     *
+     * If there is no bundle, this method returns nullptr.
+     *
+     * @return the precompiled asset bundle for this manager.
+     */
+    const std::shared_ptr<AssetBundle>& getBundle() const { return _bundle; }
+    
+    /**
+     * Sets the precompiled asset bundle for this manager.
+     *
+     * Once a bundle is attached, the loaders look up each asset file in the
+     * bundle before reading it from the asset directory.  Bundled images,
+     * sound samples and JSON files skip all decoding and parsing.  Any file
+     * missing from the bundle is read from the asset directory as normal.
+     *
+     * The bundle is read by the worker threads, so it should only be changed
+     * when no assets are loading.
+     *
+     * @param bundle    The precompiled asset bundle (or nullptr for none)
+     */
+    void setBundle(const std::shared_ptr<AssetBundle>& bundle) { _bundle = bundle; }
+    
+    /**
+     * Returns the JSON tree for the given file.
+     *
+     * The file is taken from the asset bundle if it is there.  Otherwise it
+     * is read from the asset directory.  This method is safe to call from
+     * any thread.
+     *
+     * @param file  The path to the file, relative to the asset directory
+     *
+     * @return the JSON tree for the given file (or nullptr if it is missing).
+     */
+    std::shared_ptr<JsonValue> readJson(const std::string& file) const;
+
 #pragma mark -
 #pragma mark Progress Monitoring
     /**
@@ -422,6 +508,20 @@ public:
      */
     size_t waitCount() const;
     
+    /**
+     * Returns the number of waiting assets, counting each by the fraction loaded.
+     *
+     * Most assets finish loading all at once, and so count as 0 until they
+     * are loaded.  Textures are uploaded over several frames, and count by
+     * the fraction of rows uploaded.  This allows a progress bar to move
+     * while they load.
+     *
+     * The value returned is the sum of the partialCount for all attached loaders.
+     *
+     * @return the number of waiting assets, counting each by the fraction loaded.
+     */
+    float partialCount() const;
+    
     /**
      * Returns true if the loader has finished loading all assets.
      *
@@ -448,7 +548,7 @@ public:
      */
     float progress() const  {
         size_t size = loadCount()+waitCount();
-        return (size == 0 ? 0.0f : ((float)loadCount())/size);
+        return (size == 0 ? 0.0f : (loadCount()+partialCount())/size);
     }
 
     
@@ -889,11 +989,18 @@ public:
      * You may either poll this interface to determine when the assets are
      * loaded or use optional callbacks.
      *
+     * A category that depends on other asset types (see {@link addDependency})
+     * is not given to its loader until those types have finished loading.
+     * By default, scene graphs wait on textures, fonts and widgets.
+     *
      * The optional callback function will be called each time an individual
      * asset loads or fails to load.  However, if the entire category fails
      * to load, the callback function will be given the asset category name
      * (e.g. "soundfx") as the asset key.
      *
+     * This method must be called in the main thread, as that is where the
+     * loaders queue their assets. Only the decoding runs in the workers.
+     *
      * @param json      The JSON asset directory
      * @param callback  An optional callback after each asset is loaded
      */
@@ -923,6 +1030,10 @@ public:
      * You may either poll this interface to determine when the assets are
      * loaded or use optional callbacks.
      *
+     * A category that depends on other asset types (see {@link addDependency})
+     * is not given to its loader until those types have finished loading.
+     * By default, scene graphs wait on textures, fonts and widgets.
+     *
      * The optional callback function will be called each time an individual
      * asset loads or fails to load.  However, if the entire category fails
      * to load, the callback function will be given the asset category name
@@ -957,6 +1068,10 @@ public:
      * You may either poll this interface to determine when the assets are
      * loaded or use optional callbacks.
      *
+     * A category that depends on other asset types (see {@link addDependency})
+     * is not given to its loader until those types have finished loading.
+     * By default, scene graphs wait on textures, fonts and widgets.
+     *
      * The optional callback function will be called each time an individual
      * asset loads or fails to load.  However, if the entire category fails
      * to load, the callback function will be given the asset category name
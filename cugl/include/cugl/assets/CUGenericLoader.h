@@ -78,6 +78,8 @@ protected:
     using Loader<T>::_queue;
     /** Access the thread pool in the super class */
     using BaseLoader::_loader;
+    /** Access the thread pool priority in the super class */
+    using BaseLoader::_priority;
     
     /**
      * Finishes loading the generic asset, finalizing any features in the main thread.
@@ -146,7 +148,7 @@ protected:
                     this->materialize(key,asset,callback);
                     return false;
                 });
-            });
+            }, _priority);
         }
 
         return success;
@@ -198,7 +200,7 @@ protected:
                     this->materialize(key,asset,callback);
                     return false;
                 });
-            });
+            }, _priority);
         }
         
         return success;
@@ -0,0 +1,688 @@
+//
+//  CUJsonDocument.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a read-only JSON DOM for large or frequently read
+//  files.  JsonValue allocates every node separately, converting from a cJSON
+//  tree that is itself allocated node by node, and looks up object members by
+//  a linear scan of string compares.  A JsonDocument instead parses the text
+//  directly into a single array of nodes, with every string unescaped into
+//  one pool.  Object keys are interned, and each object keeps its members
+//  sorted by key, so a lookup is one hash and a binary search.
+//
+//  Nodes are accessed through lightweight handles that refer back to the
+//  document.  Strings are returned as views into the pool, so reading them
+//  copies nothing.  Handles and views are only valid while the document is.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_JSON_DOCUMENT_H__
+#define __CU_JSON_DOCUMENT_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+/** The deepest nesting of arrays and objects that a document will parse */
+#define JSON_MAX_DEPTH  256
+
+namespace cugl {
+
+/**
+ * This class is a read-only JSON DOM stored in a single arena.
+ *
+ * A document is parsed directly from JSON text, without an intermediate
+ * tree.  All of the nodes are stored in one array, and all of the strings
+ * (keys and values) in one pool, so a document makes a handful of
+ * allocations no matter how large it is.  Object keys are interned, and
+ * every object has an index of its members sorted by key.  Looking up a
+ * member is therefore a single hash of the key followed by a binary search,
+ * instead of a string compare against every member.
+ *
+ * The nodes of a document are accessed through {@link Node} handles.  A
+ * handle is just a reference to the document and an index, and is cheap to
+ * copy.  Strings are returned as views into the document, and are never
+ * copied.  Neither handles nor views may be used once the document is
+ * deleted.
+ *
+ * A document cannot be modified.  Use {@link Node#toJsonValue} to convert
+ * part of a document for an interface that expects a {@link JsonValue}.
+ * Since a document is immutable, it is safe to read from several threads.
+ */
+class JsonDocument {
+public:
+    /**
+     * This class is a handle to a node of a JSON document.
+     *
+     * The API mirrors that of {@link JsonValue}, except that strings are
+     * returned as views.  A default handle refers to no node.  Methods that
+     * look up a child return such a handle if the child does not exist, and
+     * all of the accessors of such a handle return their default value.  So
+     * it is safe to chain lookups without checking each one.
+     *
+     * A handle is only valid while its document exists.
+     */
+    class Node {
+    private:
+        /** The document containing this node (nullptr if there is none) */
+        const JsonDocument* _doc;
+        /** The index of this node in the document */
+        Uint32 _index;
+
+        /** Allows the document to create handles */
+        friend class JsonDocument;
+
+        /**
+         * Creates a handle to the given node of a document.
+         *
+         * @param doc   The document containing the node
+         * @param index The index of the node in the document
+         */
+        Node(const JsonDocument* doc, Uint32 index) : _doc(doc), _index(index) {}
+
+    public:
+        /**
+         * Creates a handle that refers to no node.
+         */
+        Node() : _doc(nullptr), _index(0) {}
+
+#pragma mark Type
+        /**
+         * Returns true if this handle refers to a node.
+         *
+         * @return true if this handle refers to a node.
+         */
+        bool isValid() const { return _doc != nullptr; }
+
+        /**
+         * Returns true if this handle refers to a node.
+         *
+         * @return true if this handle refers to a node.
+         */
+        explicit operator bool() const { return _doc != nullptr; }
+
+        /**
+         * Returns the type of this node.
+         *
+         * A handle that refers to no node is a NullType.
+         *
+         * @return the type of this node.
+         */
+        JsonValue::Type type() const;
+
+        /**
+         * Returns true if this node is NULL (or the handle is invalid).
+         *
+         * @return true if this node is NULL (or the handle is invalid).
+         */
+        bool isNull() const     { return type() == JsonValue::Type::NullType; }
+
+        /**
+         * Returns true if this node is a number.
+         *
+         * @return true if this node is a number.
+         */
+        bool isNumber() const   { return type() == JsonValue::Type::NumberType; }
+
+        /**
+         * Returns true if this node is a boolean.
+         *
+         * @return true if this node is a boolean.
+         */
+        bool isBool() const     { return type() == JsonValue::Type::BoolType; }
+
+        /**
+         * Returns true if this node is a string.
+         *
+         * @return true if this node is a string.
+         */
+        bool isString() const   { return type() == JsonValue::Type::StringType; }
+
+        /**
+         * Returns true if this node is an array.
+         *
+         * @return true if this node is an array.
+         */
+        bool isArray() const    { return type() == JsonValue::Type::ArrayType; }
+
+        /**
+         * Returns true if this node is an object.
+         *
+         * @return true if this node is an object.
+         */
+        bool isObject() const   { return type() == JsonValue::Type::ObjectType; }
+
+        /**
+         * Returns the key of this node in its parent object.
+         *
+         * If the parent is not an object, or this handle is invalid, the key
+         * is empty.
+         *
+         * @return the key of this node in its parent object.
+         */
+        std::string_view key() const;
+
+#pragma mark Values
+        /**
+         * Returns this node as a string view.
+         *
+         * If the node is not a string, this method returns the default value.
+         * The view refers to the document, and is not copied.
+         *
+         * @param defaultValue  The value to return if the node is not a string
+         *
+         * @return this node as a string view.
+         */
+        std::string_view asString(std::string_view defaultValue="") const;
+
+        /**
+         * Returns this node as a double.
+         *
+         * If the node is not a number, this method returns the default value.
+         *
+         * @param defaultValue  The value to return if the node is not a number
+         *
+         * @return this node as a double.
+         */
+        double asDouble(double defaultValue=0.0) const;
+
+        /**
+         * Returns this node as a float.
+         *
+         * If the node is not a number, this method returns the default value.
+         *
+         * @param defaultValue  The value to return if the node is not a number
+         *
+         * @return this node as a float.
+         */
+        float asFloat(float defaultValue=0.0f) const {
+            return (float)asDouble(defaultValue);
+        }
+
+        /**
+         * Returns this node as a long.
+         *
+         * If the node is not a number, this method returns the default value.
+         *
+         * @param defaultValue  The value to return if the node is not a number
+         *
+         * @return this node as a long.
+         */
+        long asLong(long defaultValue=0L) const {
+            return isNumber() ? (long)asDouble() : defaultValue;
+        }
+
+        /**
+         * Returns this node as an int.
+         *
+         * If the node is not a number, this method returns the default value.
+         *
+         * @param defaultValue  The value to return if the node is not a number
+         *
+         * @return this node as an int.
+         */
+        int asInt(int defaultValue=0) const {
+            return isNumber() ? (int)asDouble() : defaultValue;
+        }
+
+        /**
+         * Returns this node as a boolean.
+         *
+         * If the node is not a boolean, this method returns the default value.
+         *
+         * @param defaultValue  The value to return if the node is not a boolean
+         *
+         * @return this node as a boolean.
+         */
+        bool asBool(bool defaultValue=false) const;
+
+#pragma mark Children
+        /**
+         * Returns the number of children of this node.
+         *
+         * Only arrays and objects have children.
+         *
+         * @return the number of children of this node.
+         */
+        size_t size() const;
+
+        /**
+         * Returns the child at the given position.
+         *
+         * Children of objects are in the order of the document.  If there is
+         * no such child, the handle returned is invalid.
+         *
+         * @param index The child position
+         *
+         * @return the child at the given position.
+         */
+        Node get(size_t index) const;
+
+        /**
+         * Returns the child with the given key.
+         *
+         * If an object has several children with this key, this returns the
+         * first one.  If there is no such child, or this node is not an
+         * object, the handle returned is invalid.
+         *
+         * @param key   The child key
+         *
+         * @return the child with the given key.
+         */
+        Node get(std::string_view key) const;
+
+        /**
+         * Returns the child with the given key.
+         *
+         * If an object has several children with this key, this returns the
+         * first one.  If there is no such child, or this node is not an
+         * object, the handle returned is invalid.
+         *
+         * @param key   The child key
+         *
+         * @return the child with the given key.
+         */
+        Node operator[](std::string_view key) const { return get(key); }
+
+        /**
+         * Returns the child at the given position.
+         *
+         * If there is no such child, the handle returned is invalid.
+         *
+         * @param index The child position
+         *
+         * @return the child at the given position.
+         */
+        Node operator[](size_t index) const { return get(index); }
+
+        /**
+         * Returns true if this node is an object with a child of the given key.
+         *
+         * @param key   The child key
+         *
+         * @return true if this node is an object with a child of the given key.
+         */
+        bool has(std::string_view key) const { return get(key).isValid(); }
+
+        /**
+         * Returns the string value of the child with the given key.
+         *
+         * If there is no such child, or it is not a string, this method
+         * returns the default value.
+         *
+         * @param key           The child key
+         * @param defaultValue  The value to return if there is no string child
+         *
+         * @return the string value of the child with the given key.
+         */
+        std::string_view getString(std::string_view key, std::string_view defaultValue="") const {
+            return get(key).asString(defaultValue);
+        }
+
+        /**
+         * Returns the number value of the child with the given key.
+         *
+         * If there is no such child, or it is not a number, this method
+         * returns the default value.
+         *
+         * @param key           The child key
+         * @param defaultValue  The value to return if there is no number child
+         *
+         * @return the number value of the child with the given key.
+         */
+        double getDouble(std::string_view key, double defaultValue=0.0) const {
+            return get(key).asDouble(defaultValue);
+        }
+
+        /**
+         * Returns the number value of the child with the given key.
+         *
+         * If there is no such child, or it is not a number, this method
+         * returns the default value.
+         *
+         * @param key           The child key
+         * @param defaultValue  The value to return if there is no number child
+         *
+         * @return the number value of the child with the given key.
+         */
+        float getFloat(std::string_view key, float defaultValue=0.0f) const {
+            return get(key).asFloat(defaultValue);
+        }
+
+        /**
+         * Returns the number value of the child with the given key.
+         *
+         * If there is no such child, or it is not a number, this method
+         * returns the default value.
+         *
+         * @param key           The child key
+         * @param defaultValue  The value to return if there is no number child
+         *
+         * @return the number value of the child with the given key.
+         */
+        int getInt(std::string_view key, int defaultValue=0) const {
+            return get(key).asInt(defaultValue);
+        }
+
+        /**
+         * Returns the boolean value of the child with the given key.
+         *
+         * If there is no such child, or it is not a boolean, this method
+         * returns the default value.
+         *
+         * @param key           The child key
+         * @param defaultValue  The value to return if there is no boolean child
+         *
+         * @return the boolean value of the child with the given key.
+         */
+        bool getBool(std::string_view key, bool defaultValue=false) const {
+            return get(key).asBool(defaultValue);
+        }
+
+#pragma mark Conversion
+        /**
+         * Returns a newly allocated copy of this subtree as a JsonValue.
+         *
+         * This allows part of a document to be passed to an interface that
+         * expects a {@link JsonValue}.  If this handle is invalid, this
+         * method returns nullptr.
+         *
+         * @return a newly allocated copy of this subtree as a JsonValue.
+         */
+        std::shared_ptr<JsonValue> toJsonValue() const;
+    };
+
+private:
+    /** This macro disables the copy constructor (not allowed on documents) */
+    CU_DISALLOW_COPY_AND_ASSIGN(JsonDocument);
+
+    /** A node in the arena */
+    struct Entry {
+        /** The node type */
+        JsonValue::Type type;
+        /** The key id in the parent object (or JSON_NO_KEY) */
+        Uint32 key;
+        /** The string offset, or the offset of the children in the links */
+        Uint32 first;
+        /** The string length, or the number of children */
+        Uint32 count;
+        /** The number, or 0/1 for a boolean */
+        double number;
+    };
+
+    /** The nodes of the document, with the root first */
+    std::vector<Entry> _nodes;
+    /** The children of every array and object, each contiguous and in order */
+    std::vector<Uint32> _links;
+    /** The same children with the members of each object sorted by key id */
+    std::vector<Uint32> _sorted;
+    /** The string pool (reserved up front so that views never move) */
+    std::string _strings;
+    /** The offsets and lengths of the interned keys, by key id */
+    std::vector<std::pair<Uint32,Uint32>> _keys;
+    /** The interned keys, mapped to their ids */
+    std::unordered_map<std::string_view,Uint32> _keyIds;
+
+    /** The start of the text being parsed */
+    const char* _begin;
+    /** The next character to parse */
+    const char* _cursor;
+    /** The end of the text being parsed */
+    const char* _end;
+    /** The children of the open containers, used as a stack while parsing */
+    std::vector<Uint32> _scratch;
+
+#pragma mark Parsing
+    /**
+     * Parses the value at the cursor, returning its node index.
+     *
+     * @param key   The key id of this value (or JSON_NO_KEY)
+     * @param depth The nesting depth of this value
+     *
+     * @return the node index, or JSON_NO_KEY on an error
+     */
+    Uint32 parseValue(Uint32 key, Uint32 depth);
+
+    /**
+     * Parses the array or object at the cursor into the given node.
+     *
+     * @param index The node index
+     * @param depth The nesting depth of this container
+     *
+     * @return true if the container was parsed
+     */
+    bool parseContainer(Uint32 index, Uint32 depth);
+
+    /**
+     * Parses the string at the cursor into the string pool.
+     *
+     * The string is unescaped and null terminated in the pool.
+     *
+     * @param offset    Set to the offset of the string in the pool
+     * @param length    Set to the length of the string
+     *
+     * @return true if the string was parsed
+     */
+    bool parseString(Uint32& offset, Uint32& length);
+
+    /**
+     * Parses the number at the cursor.
+     *
+     * @param value     Set to the number
+     *
+     * @return true if the number was parsed
+     */
+    bool parseNumber(double& value);
+
+    /**
+     * Returns the id of the key just added to the string pool.
+     *
+     * If the key was seen before, the new copy is removed from the pool.
+     *
+     * @param offset    The offset of the key in the pool
+     * @param length    The length of the key
+     *
+     * @return the id of the key just added to the string pool.
+     */
+    Uint32 internKey(Uint32 offset, Uint32 length);
+
+    /**
+     * Advances the cursor past any whitespace.
+     */
+    void skipSpace();
+
+    /**
+     * Reports a parsing error at the cursor.
+     *
+     * @param message   The error description
+     */
+    void fail(const char* message);
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an empty JSON document.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a document on
+     * the heap, use one of the static constructors instead.
+     */
+    JsonDocument() : _begin(nullptr), _cursor(nullptr), _end(nullptr) {}
+
+    /**
+     * Deletes this document, disposing of all resources.
+     */
+    ~JsonDocument() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this document.
+     *
+     * Every handle and string view taken from this document is invalid
+     * afterwards.  A disposed document can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes a document from the given JSON text.
+     *
+     * If there is a parsing error, this method will return false.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.
+     *
+     * @param json      The JSON text
+     * @param length    The number of characters in the text
+     *
+     * @return true if the document was parsed successfully
+     */
+    bool init(const char* json, size_t length);
+
+    /**
+     * Initializes a document from the given JSON text.
+     *
+     * If there is a parsing error, this method will return false.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.
+     *
+     * @param json      The JSON text
+     *
+     * @return true if the document was parsed successfully
+     */
+    bool init(const std::string& json) {
+        return init(json.data(),json.size());
+    }
+
+    /**
+     * Initializes a document from the JSON file at the given path.
+     *
+     * The file is read in one pass and parsed directly.
+     *
+     * @param file      The path to the file
+     *
+     * @return true if the document was read and parsed successfully
+     */
+    bool initWithFile(const std::string& file);
+
+    /**
+     * Initializes a document from the given file in the asset directory.
+     *
+     * The file is read in one pass and parsed directly.
+     *
+     * @param file      The path to the file, relative to the asset directory
+     *
+     * @return true if the document was read and parsed successfully
+     */
+    bool initWithAsset(const std::string& file);
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated document from the given JSON text.
+     *
+     * If there is a parsing error, this method will return nullptr.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.
+     *
+     * @param json      The JSON text
+     *
+     * @return a newly allocated document from the given JSON text.
+     */
+    static std::shared_ptr<JsonDocument> alloc(const std::string& json) {
+        std::shared_ptr<JsonDocument> result = std::make_shared<JsonDocument>();
+        return (result->init(json) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated document from the JSON file at the given path.
+     *
+     * The file is read in one pass and parsed directly.
+     *
+     * @param file      The path to the file
+     *
+     * @return a newly allocated document from the JSON file at the given path.
+     */
+    static std::shared_ptr<JsonDocument> allocWithFile(const std::string& file) {
+        std::shared_ptr<JsonDocument> result = std::make_shared<JsonDocument>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated document from the given file in the asset directory.
+     *
+     * The file is read in one pass and parsed directly.
+     *
+     * @param file      The path to the file, relative to the asset directory
+     *
+     * @return a newly allocated document from the given file in the asset directory.
+     */
+    static std::shared_ptr<JsonDocument> allocWithAsset(const std::string& file) {
+        std::shared_ptr<JsonDocument> result = std::make_shared<JsonDocument>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the root node of this document.
+     *
+     * If the document is empty, the handle returned is invalid.
+     *
+     * @return the root node of this document.
+     */
+    Node root() const {
+        return _nodes.empty() ? Node() : Node(this,0);
+    }
+
+    /**
+     * Returns the number of nodes in this document.
+     *
+     * @return the number of nodes in this document.
+     */
+    size_t nodeCount() const { return _nodes.size(); }
+
+    /**
+     * Returns the number of bytes used by this document.
+     *
+     * This counts the arena storage, but not the key table.
+     *
+     * @return the number of bytes used by this document.
+     */
+    size_t memoryUsage() const {
+        return _nodes.capacity()*sizeof(Entry)+(_links.capacity()+_sorted.capacity())*sizeof(Uint32)+
+               _strings.capacity()+_keys.capacity()*sizeof(std::pair<Uint32,Uint32>);
+    }
+};
+
+}
+
+#endif /* __CU_JSON_DOCUMENT_H__ */
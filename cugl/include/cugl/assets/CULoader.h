@@ -111,6 +111,28 @@ protected:
      */
     AssetManager* _manager;
     
+    /**
+     * The thread pool priority of asynchronous loads
+     *
+     * Assets that other assets depend upon (e.g. textures and fonts) should
+     * have a higher priority so that they are not stuck behind independent
+     * assets like sounds.
+     */
+    int _priority;
+
+    /**
+     * Returns the JSON tree for the given file.
+     *
+     * If this loader is attached to an asset manager, the file is taken from
+     * its asset bundle when it is there.  Otherwise it is read from the asset
+     * directory.  This method is safe to call from any thread.
+     *
+     * @param source    The path to the file, relative to the asset directory
+     *
+     * @return the JSON tree for the given file (or nullptr if it is missing).
+     */
+    std::shared_ptr<JsonValue> readJson(const std::string& source) const;
+
     /**
      * Internal method to support asset loading.
      *
@@ -219,7 +241,7 @@ public:
      * NEVER CALL THIS CONSTRUCTOR. As this is an abstract class, you should 
      * call one of the static constructors of the appropriate child class.
      */
-    BaseLoader()    {}
+    BaseLoader() : _manager(nullptr), _priority(0) {}
     
     /**
      * Deletes this asset loader, disposing of all resources.
@@ -325,6 +347,32 @@ public:
         _loader = threads;
     }
     
+    /**
+     * Returns the thread pool priority of asynchronous loads
+     *
+     * The thread pool assigns waiting tasks to workers in order of priority,
+     * so assets with a higher priority start loading before those with a
+     * lower one.  Assets that other assets depend upon (e.g. textures and
+     * fonts, which are needed by scene graphs) should have a higher priority.
+     *
+     * @return the thread pool priority of asynchronous loads
+     */
+    int getPriority() const { return _priority; }
+    
+    /**
+     * Sets the thread pool priority of asynchronous loads
+     *
+     * The thread pool assigns waiting tasks to workers in order of priority,
+     * so assets with a higher priority start loading before those with a
+     * lower one.  Assets that other assets depend upon (e.g. textures and
+     * fonts, which are needed by scene graphs) should have a higher priority.
+     *
+     * Changing the priority does not affect assets already queued.
+     *
+     * @param priority  The thread pool priority of asynchronous loads
+     */
+    void setPriority(int priority) { _priority = priority; }
+    
     /**
      * Sets the asset manager for this loader.
      *
@@ -696,6 +744,19 @@ public:
      */
     virtual size_t waitCount() const { return 0; }
     
+    /**
+     * Returns the number of waiting assets, counting each by the fraction loaded.
+     *
+     * Most assets finish loading all at once, and so count as 0 until they
+     * are loaded.  Assets that are loaded over several frames (e.g. textures
+     * waiting in an {@link UploadQueue}) may report partial progress, which
+     * allows a progress bar to move while they load.  This value is never
+     * more than {@link waitCount}.
+     *
+     * @return the number of waiting assets, counting each by the fraction loaded.
+     */
+    virtual float partialCount() const { return 0; }
+    
     /**
      * Returns true if the loader has finished loading all assets.
      *
@@ -722,7 +783,7 @@ public:
      */
     float progress() const  {
         size_t size = loadCount()+waitCount();
-        return (size == 0 ? 0.0f : ((float)loadCount())/size);
+        return (size == 0 ? 0.0f : (loadCount()+partialCount())/size);
     }
     
 };
@@ -47,6 +47,7 @@
 #define __CU_TEXTURE_LOADER_H__
 #include <cugl/assets/CULoader.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CUUploadQueue.h>
 
 namespace cugl {
 
@@ -86,6 +87,8 @@ protected:
     GLuint _wrapt;
     /** The default support for mipmaps */
     bool _mipmaps;
+    /** The queue spreading asynchronous texture uploads over several frames */
+    std::shared_ptr<UploadQueue> _uploads;
     
 #pragma mark Asset Loading
     /**
@@ -94,7 +97,10 @@ protected:
      * An atlas is specified as a list of named, four-element integer arrays.
      * Each integer array specifies the left, top, right, and bottom pixels of
      * the subtexture, respectively.  Each subtexture will have the key of the
-     * main texture as the prefix (together with an underscore _) of its key.
+     * main texture as the prefix (together with an underscore _) of its key,
+     * unless the entry sets "prefix" to false.  In that case the subtexture
+     * keys are used as is, which is how packed atlases stand in for the
+     * individual textures they replace.
      *
      * @param json      The asset directory entry
      * @param texture   The texture loaded for this asset
@@ -109,6 +115,9 @@ protected:
      * we need to create an OpenGL texture.  Hence this method does the maximum
      * amount of work that can be done in asynchronous texture loading.
      *
+     * If the asset manager has a bundle containing this image, the surface
+     * borrows its pixels from the bundle and nothing is decoded.
+     *
      * @param source    The pathname to the asset
      *
      * @return the SDL_Surface with the texture information
@@ -119,8 +128,10 @@ protected:
      * Creates an OpenGL texture from the SDL_Surface, and assigns it the given key.
      *
      * This method finishes the asset loading started in {@link preload}.  This
-     * step is not safe to be done in a separate thread.  Instead, it takes
-     * place in the main CUGL thread via {@link Application#schedule}.
+     * step is not safe to be done in a separate thread.  Instead, the image is
+     * given to the upload queue, which uploads it in the main CUGL thread over
+     * as many frames as its budget requires.  The asset is not available (and
+     * the callback is not called) until the upload is finished.
      *
      * The loaded texture will have default parameters for scaling and wrap.
      * It will only have a mipmap if that is the default.
@@ -138,8 +149,10 @@ protected:
      * Creates an OpenGL texture from the SDL_Surface accoring to the directory entry.
      *
      * This method finishes the asset loading started in {@link preload}.  This
-     * step is not safe to be done in a separate thread.  Instead, it takes
-     * place in the main CUGL thread via {@link Application#schedule}.
+     * step is not safe to be done in a separate thread.  Instead, the image is
+     * given to the upload queue, which uploads it in the main CUGL thread over
+     * as many frames as its budget requires.  The asset is not available (and
+     * the callback is not called) until the upload is finished.
      *
      * This version of read provides support for JSON directories. A texture
      * directory entry has the following values
@@ -152,6 +165,7 @@ protected:
      *      "magfilter":    The name of the min filter ("nearest" or "linear")
      *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
      *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+     *      "priority":     The upload priority (int, defaults to the loader's)
      *
      * The asset key is the key for the JSON directory entry
      *
@@ -260,9 +274,42 @@ public:
      */
     void dispose() override {
         _assets.clear();
+        _uploads = nullptr;
         _loader = nullptr;
     }
     
+    /**
+     * Initializes a new texture loader.
+     *
+     * This method bootstraps the loader with any initial resources that it
+     * needs to load assets. Attempts to load an asset before this method is
+     * called will fail.
+     *
+     * This loader will have no associated threads. That means any asynchronous
+     * loading will fail until a thread is provided via {@link setThreadPool}.
+     *
+     * @return true if the asset loader was initialized successfully
+     */
+    bool init() override {
+        return init(nullptr);
+    }
+    
+    /**
+     * Initializes a new texture loader.
+     *
+     * This method bootstraps the loader with any initial resources that it
+     * needs to load assets. Attempts to load an asset before this method is
+     * called will fail.
+     *
+     * @param threads   The thread pool for asynchronous loading support
+     *
+     * @return true if the asset loader was initialized successfully
+     */
+    bool init(const std::shared_ptr<ThreadPool>& threads) override {
+        _uploads = UploadQueue::alloc();
+        return _uploads != nullptr && Loader<Texture>::init(threads);
+    }
+    
     /**
      * Returns a newly allocated texture loader.
      *
@@ -404,6 +451,29 @@ public:
      * @param flag  Whether this loader generates mipmaps by default.
      */
     void setMipMaps(bool flag) { _mipmaps = flag; }
+    
+    /**
+     * Returns the queue that uploads asynchronously loaded textures.
+     *
+     * Images decoded in a worker thread are uploaded a band of rows at a
+     * time, so that a burst of large textures does not stall a single frame.
+     * Use this queue to change the per-frame byte and time budgets.
+     *
+     * @return the queue that uploads asynchronously loaded textures.
+     */
+    std::shared_ptr<UploadQueue> getUploadQueue() const { return _uploads; }
+    
+    /**
+     * Returns the number of waiting assets, counting each by the fraction loaded.
+     *
+     * A texture that is half uploaded counts as 0.5.  This allows a progress
+     * bar to move while a large texture is uploading.
+     *
+     * @return the number of waiting assets, counting each by the fraction loaded.
+     */
+    float partialCount() const override {
+        return _uploads == nullptr ? 0.0f : _uploads->size()-_uploads->getRemaining();
+    }
 
 };
 
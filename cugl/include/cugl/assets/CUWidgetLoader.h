@@ -136,7 +136,10 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a loader on
      * the heap, use one of the static constructors instead.
      */
-    WidgetLoader() {}
+    WidgetLoader() {
+        // Scene graphs wait on widgets
+        _priority = 1;
+    }
     
     /**
      * Disposes all resources and assets of this loader
@@ -30,7 +30,9 @@
 #define __CU_ASSETS_PKG_H__
 
 #include "CUJsonValue.h"
+#include "CUJsonDocument.h"
 #include "CUWidgetValue.h"
+#include "CUAssetBundle.h"
 #include "CUAssetManager.h"
 #include "CUTextureLoader.h"
 #include "CUFontLoader.h"
@@ -31,6 +31,8 @@
 
 #include <memory>
 #include <string>
+#include <cstring>
+#include <climits>
 #include <SDL/SDL.h>
 
 // The platforms
@@ -44,6 +46,8 @@
 #define CU_PLATFORM_ANDROID 3
 /** The traditional (not mobile) Windows 10 platform */
 #define CU_PLATFORM_WINDOWS 4
+/** Desktop Linux (headless hosts and command line tools) */
+#define CU_PLATFORM_LINUX   5
 // Windows RT is discontinued, so we will not support it
 
 // Determine the correct platform
@@ -63,6 +67,9 @@
 #elif defined (__WINDOWS__)
 /** The current platform being compiled */
     #define CU_PLATFORM 4
+#elif defined (__LINUX__)
+/** The current platform being compiled */
+    #define CU_PLATFORM 5
 #else
 /** The current platform being compiled */
     #define CU_PLATFORM 0
@@ -117,6 +124,12 @@
 	#include <GL/glu.h>	
 	/** The current OpenGL platform */
 	#define CU_GL_PLATFORM   CU_GL_OPENGL
+#elif defined (__LINUX__)
+    #include <GLES3/gl3platform.h>
+    #include <GLES3/gl3.h>
+    #include <GLES3/gl3ext.h>
+    /** The current OpenGL platform */
+    #define CU_GL_PLATFORM   CU_GL_OPENGLES
 #endif
 
 #ifdef _MSC_VER 
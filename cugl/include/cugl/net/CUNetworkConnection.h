@@ -65,14 +65,38 @@ namespace cugl {
 #pragma endregion
 
 #pragma region Main Networking Methods
+		/**
+		 * Delivery guarantees for a message, mirroring the RakNet reliability classes.
+		 */
+		enum class Reliability : uint8_t {
+			// May be lost, duplicated or arrive out of order
+			Unreliable,
+			// May be lost; anything older than the newest message received on the channel is dropped
+			UnreliableSequenced,
+			// Always arrives, possibly out of order
+			Reliable,
+			// Always arrives, in order with the other messages on the channel
+			ReliableOrdered
+		};
+
+		/** Number of ordering channels available to {@link #send} */
+		static constexpr uint8_t NUM_CHANNELS = 32;
+
 		/**
 		 * Sends a byte array to all other players.
 		 *
+		 * Ordered and sequenced messages are only ordered relative to other messages
+		 * on the same channel, so independent streams (e.g. movement and game events)
+		 * should use different channels. When the host relays a message, it keeps the
+		 * reliability and channel the message was sent with.
+		 *
 		 * This requires a connection be established. If not, this is a noop.
 		 *
 		 * @param msg The byte array to send.
+		 * @param reliability The delivery guarantee for this message.
+		 * @param channel The ordering channel, less than NUM_CHANNELS.
 		 */
-		void send(const std::vector<uint8_t>& msg);
+		void send(const std::vector<uint8_t>& msg, Reliability reliability = Reliability::Reliable, uint8_t channel = 1);
 
 		/**
 		 * Method to call every network frame to process incoming network messages.
@@ -179,6 +203,8 @@ namespace cugl {
 		std::string roomID;
 		/** Which players are active */
 		std::bitset<256> connectedPlayers;
+		/** Receive buffer for standard messages, reused across packets */
+		std::vector<uint8_t> msgBuffer;
 #pragma endregion
 
 #pragma region Punchthrough
@@ -298,8 +324,23 @@ namespace cugl {
 		void broadcast(const std::vector<uint8_t>& msg, SLNet::SystemAddress& ignore,
 			CustomDataPackets packetType = Standard);
 
+		/**
+		 * Broadcast a standard message to everyone except the specified connection,
+		 * with the given reliability and channel.
+		 *
+		 * PRECONDITION: This player MUST be the host
+		 *
+		 * @param msg The message to send
+		 * @param ignore The address to not send to
+		 * @param header The reliability and channel, packed as by {@link #send}
+		 */
+		void broadcast(const std::vector<uint8_t>& msg, SLNet::SystemAddress& ignore, uint8_t header);
+
 		void send(const std::vector<uint8_t>& msg, CustomDataPackets packetType);
 
+		/** Sends a packed bitstream to the host, or to every client if this player is the host */
+		void sendStream(SLNet::BitStream& bs, Reliability reliability, uint8_t channel);
+
 	};
 }
 
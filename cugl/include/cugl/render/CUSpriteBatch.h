@@ -53,9 +53,14 @@
 #include <cugl/math/CUMathBase.h>
 #include <cugl/math/CUMat4.h>
 #include <cugl/math/CUColor4.h>
+#include <cugl/math/CURect.h>
 
 // Default memory sizes
 #define DEFAULT_CAPACITY  8192
+// The number of textures that may share a single draw call
+#define SPRITE_TEXTURE_SLOTS  8
+// The number of vertex buffers cycled through by successive flushes
+#define SPRITE_BUFFER_RING  3
 
 namespace cugl {
 
@@ -98,6 +103,18 @@ class Poly2;
  * Even texture switches are batched.  However, it is still true that using a
  * single texture atlas can significantly improve drawing speed.
  *
+ * In addition, up to {@link SPRITE_TEXTURE_SLOTS} different textures can be
+ * drawn in the same OpenGL call. Each texture is bound to its own texture
+ * slot, and every vertex records the slot it samples from. Changing the
+ * texture only forces a new call when all of the slots are taken (or when
+ * switching between textured and untextured drawing).
+ *
+ * Flushes cycle through {@link SPRITE_BUFFER_RING} vertex buffers. Each
+ * flush writes into a buffer the GPU finished with several flushes ago,
+ * so the CPU can fill the next batch while the previous ones are drawn.
+ * A fence on each buffer guards against reusing it too early, and the
+ * time spent waiting on those fences is reported by {@link #getStallTime}.
+ *
  * A review of this class shows that there are a lot of redundant drawing methods.
  * The scene graphs only use the {@link Mesh} methods. This goal has been to make 
  * this class more accessible to students familiar with classic sprite batches 
@@ -107,7 +124,9 @@ class Poly2;
  * shader for this class should support {@link SpriteVertex3} as its vertex data.
  * If you need additional vertex information, such as normals, you should create
  * a new class.  It should also have a uniform for the perspective matrix,
- * texture, and drawing type (type 0).  Support for gradients and scissors
+ * texture, and drawing type (type 0).  To support multiple texture slots, the
+ * shader should have a float attribute aTexSlot and a sampler array uTextures;
+ * otherwise, the sprite batch uses a single slot (and sampler 0).  Support for gradients and scissors
  * occur via a uniform block that is provides the data in the order scissor
  * then gradient.  See SpriteShader.frag for more information.
  */
@@ -115,59 +134,49 @@ class SpriteBatch {
 #pragma mark Values
 private:
     /**
-     * A class storing the drawing context for the associate shader.
+     * A record of the drawing context for the associate shader.
      *
      * Because we want to minimize the number of times we load vertices
      * to the vertex buffer, all uniforms are recorded and delayed until the
      * final graphics call.  We include blending attributes as part of the
      * context, since they have similar performance characteristics to
      * other uniforms
+     *
+     * Contexts are plain values so that recording one is a copy into a
+     * reused array. The perspective and textures are indices into state
+     * tables that live until the next flush.
      */
-    class Context {
-    public:
-        /**
-         * Creates a context of the default uniforms.
-         */
-        Context();
-        
-        /**
-         * Creates a copy of the given uniforms
-         *
-         * @param copy  The uniforms to copy
-         */
-        Context(Context* copy);
-        
-        /**
-         * Disposes this collection of uniforms
-         */
-        ~Context();
-        
+    struct Context {
         /** The first vertex index position for this set of uniforms */
-        GLuint first;
+        GLuint first = 0;
         /** The last vertex index position for this set of uniforms */
-        GLuint last;
+        GLuint last = 0;
         /** The drawing type for the shader */
-        GLint type;
+        GLint type = 0;
         /** The stored drawing command */
-        GLenum command;
+        GLenum command = GL_TRIANGLES;
         /** The stored blending equation */
-        GLenum blendEquation;
+        GLenum blendEquation = GL_FUNC_ADD;
         /** The stored source factor */
-        GLenum srcFactor;
+        GLenum srcFactor = GL_SRC_ALPHA;
         /** The stored destination factor */
-        GLenum dstFactor;
+        GLenum dstFactor = GL_ONE_MINUS_SRC_ALPHA;
         /** The stored depth testing support */
-        GLenum depthFunc;
-        /** The stored perspective matrix */
-        std::shared_ptr<Mat4> perspective;
-        /** The stored texture */
-        std::shared_ptr<Texture> texture;
+        GLenum depthFunc = GL_ALWAYS;
+        /** The perspective matrix (an index into the perspective table) */
+        GLuint perspective = 0;
+        /** The size of the active texture, for blurring (0 if none) */
+        Size texsize;
+        /** The textures bound to each slot (indices into the texture table) */
+        GLuint slots[SPRITE_TEXTURE_SLOTS];
+        /** The number of slots in use */
+        GLuint slotCount = 0;
         /** The stored block offset for gradient and scissor */
-        GLsizei blockptr;
+        GLsizei blockptr = -1;
         /** The pixel step for our blur function */
-        GLuint  blurstep;
+        GLuint  blurstep = 0;
         /** The dirty bits relative to the previous set of uniforms */
-        GLuint dirty;
+        GLuint dirty = 0;
     };
 
     /** Whether this sprite batch has been initialized yet */
@@ -177,8 +186,14 @@ private:
     
     /** The shader for this sprite batch */
     std::shared_ptr<Shader> _shader;
-    /** The vertex buffer for this sprite batch */
+    /** The vertex buffer for the next flush */
     std::shared_ptr<VertexBuffer>  _vertbuff;
+    /** The vertex buffers cycled through by flushes */
+    std::shared_ptr<VertexBuffer>  _ring[SPRITE_BUFFER_RING];
+    /** The position of the active vertex buffer in the ring */
+    unsigned int _ringIndex;
+    /** Whether flushes stream through the ring (instead of reloading one buffer) */
+    bool _streaming;
     /** The vertex buffer for this sprite batch */
     std::shared_ptr<UniformBuffer> _unifbuff;
     
@@ -196,12 +211,23 @@ private:
     /** The number of indices in the current mesh */
     unsigned int _indxSize;
     
+    /** The number of texture slots supported by the shader */
+    GLuint _slotMax;
+    /** The texture slot of the active texture */
+    GLfloat _slot;
+    
     /** The active drawing context */
-    Context* _context;
+    Context _context;
     /** Whether the current context has been used. */
     bool _inflight;
-    /** The drawing context history */
-    std::vector<Context*> _history;
+    /** The drawing context history (reused between flushes) */
+    std::vector<Context> _history;
+    /** The perspective matrices referenced by contexts since the last flush */
+    std::vector<Mat4> _perspectives;
+    /** The textures referenced by context slots since the last flush */
+    std::vector<std::shared_ptr<Texture>> _textures;
+    /** The active texture */
+    std::shared_ptr<Texture> _texture;
     
     /** The active color */
     Color4f _color;
@@ -212,12 +238,21 @@ private:
     std::shared_ptr<Gradient> _gradient;
     /** The active scissor mask */
     std::shared_ptr<Scissor>  _scissor;
+    
+    /** Whether scene graph nodes outside of the view may be skipped */
+    bool _culling;
+    /** The region visible through the perspective matrix (in drawing coordinates) */
+    Rect _cullRect;
 
     // Monitoring values
     /** The number of vertices drawn in this pass (so far) */
     unsigned int _vertTotal;
     /** The number of OpenGL calls in this pass (so far) */
     unsigned int _callTotal;
+    /** The bytes of vertex and index data uploaded since the last reset */
+    Uint64 _uploadTotal;
+    /** The microseconds spent waiting for buffers since the last reset */
+    Uint64 _stallTotal;
     
 
 #pragma mark -
@@ -481,6 +516,51 @@ public:
      * @return the number of OpenGL calls in the latest pass (so far).
      */
     unsigned int getCallsMade() const { return _callTotal; }
+    
+    /**
+     * Returns the bytes of vertex and index data uploaded since the last reset.
+     *
+     * Unlike the other counters, this value is not reset by begin(), so it
+     * can cover every pass in a frame. Use {@link #resetStreamStats} to
+     * reset it.
+     *
+     * @return the bytes of vertex and index data uploaded since the last reset.
+     */
+    Uint64 getBytesUploaded() const { return _uploadTotal; }
+    
+    /**
+     * Returns the time spent waiting for the GPU to release a buffer.
+     *
+     * This is the time, in microseconds, since the last reset. It is not
+     * reset by begin(). Use {@link #resetStreamStats} to reset it.
+     *
+     * @return the time spent waiting for the GPU to release a buffer.
+     */
+    Uint64 getStallTime() const { return _stallTotal; }
+    
+    /**
+     * Resets the upload and stall counters to 0.
+     */
+    void resetStreamStats() { _uploadTotal = 0; _stallTotal = 0; }
+    
+    /**
+     * Returns true if flushes stream through the ring of vertex buffers.
+     *
+     * @return true if flushes stream through the ring of vertex buffers.
+     */
+    bool isStreaming() const { return _streaming; }
+    
+    /**
+     * Sets whether flushes stream through the ring of vertex buffers.
+     *
+     * If false, every flush reloads a single vertex buffer with glBufferData,
+     * the way this class worked before the ring. The driver synchronizes that
+     * reload itself, so the time spent in it is reported as stall time. This
+     * is only useful for comparing the two, and is true by default.
+     *
+     * @param value Whether flushes stream through the ring of vertex buffers.
+     */
+    void setStreaming(bool value) { _streaming = value; }
 
     /**
      * Sets the shader for this sprite batch
@@ -541,7 +621,7 @@ public:
      * @return the active perspective matrix of this sprite batch
      */
     const Mat4& getPerspective() const {
-        return *(_context->perspective.get());
+        return _perspectives[_context.perspective];
     }
     
     /**
@@ -551,6 +631,9 @@ public:
      * this texture.  If the value is nullptr, all shapes and outlines will be
      * draw with a solid color instead.  This value is nullptr by default.
      *
+     * Changing to a texture that is already in a slot, or that fits in a free
+     * slot, does not cause the sprite batch to flush.
+     *
      * @param texture The active texture for this sprite batch
      */
     void setTexture(const std::shared_ptr<Texture>& texture);
@@ -564,7 +647,7 @@ public:
      *
      * @return the active texture of this sprite batch
      */
-    const std::shared_ptr<Texture>& getTexture() const { return _context->texture; }
+    const std::shared_ptr<Texture>& getTexture() const { return _texture; }
 
     /**
      * Sets the active gradient of this sprite batch
@@ -648,6 +731,47 @@ public:
      */
     std::shared_ptr<Scissor> getScissor() const;
     
+    /**
+     * Sets whether scene graph nodes may be culled by this sprite batch
+     *
+     * When culling is active, a scene graph node that is rendered with this
+     * sprite batch is skipped (together with its children) if its bounding
+     * box lies entirely outside of {@link getCullRect}. The sprite batch
+     * itself never culls anything; this is a hint to the scene graph.
+     *
+     * Culling is off by default, as it assumes that every node draws inside
+     * of its content bounds.
+     *
+     * @param culling   Whether scene graph nodes may be culled
+     */
+    void setCulling(bool culling) { _culling = culling; }
+    
+    /**
+     * Returns true if scene graph nodes may be culled by this sprite batch
+     *
+     * When culling is active, a scene graph node that is rendered with this
+     * sprite batch is skipped (together with its children) if its bounding
+     * box lies entirely outside of {@link getCullRect}. The sprite batch
+     * itself never culls anything; this is a hint to the scene graph.
+     *
+     * Culling is off by default, as it assumes that every node draws inside
+     * of its content bounds.
+     *
+     * @return true if scene graph nodes may be culled by this sprite batch
+     */
+    bool isCulling() const { return _culling; }
+    
+    /**
+     * Returns the region visible through the active perspective matrix
+     *
+     * This rectangle is in the same coordinate system as {@link getPerspective}.
+     * It is the bounding box of the clip space square, and is recomputed
+     * whenever the perspective changes.
+     *
+     * @return the region visible through the active perspective matrix
+     */
+    const Rect& getCullRect() const { return _cullRect; }
+    
     /**
      * Sets the blending function for this sprite batch
      *
@@ -674,7 +798,7 @@ public:
      *
      * @return the source blending factor
      */
-    GLenum getSourceBlendFactor() const { return _context->srcFactor; }
+    GLenum getSourceBlendFactor() const { return _context.srcFactor; }
 
     /**
      * Returns the destination blending factor
@@ -685,7 +809,7 @@ public:
      *
      * @return the destination blending factor
      */
-    GLenum getDestinationBlendFactor() const { return _context->dstFactor; }
+    GLenum getDestinationBlendFactor() const { return _context.dstFactor; }
     
     /**
      * Sets the blending equation for this sprite batch
@@ -710,7 +834,7 @@ public:
      *
      * @return the blending equation for this sprite batch
      */
-    GLenum getBlendEquation() const { return _context->blendEquation; }
+    GLenum getBlendEquation() const { return _context.blendEquation; }
     
     /**
      * Sets the depth testing function for this sprite batch 
@@ -739,7 +863,7 @@ public:
      *
      * @return the depth testing function for this sprite batch 
      */
-    GLenum getDepthFunc() const { return _context->depthFunc; }
+    GLenum getDepthFunc() const { return _context.depthFunc; }
     
     /**
      * Sets the current depth of this sprite batch.
@@ -803,7 +927,7 @@ public:
      *
      * @return the blur step in pixels (0 if there is no blurring).
      */
-    GLuint getBlurStep() const { return _context->blurstep; }
+    GLuint getBlurStep() const { return _context.blurstep; }
     
 
 #pragma mark -
@@ -1882,7 +2006,7 @@ private:
      *
      * @return the current drawing command.
      */
-    GLenum getCommand() const { return _context->command; }
+    GLenum getCommand() const { return _context.command; }
 
     /**
      * Records the current drawing context, freezing it.
@@ -1894,9 +2018,10 @@ private:
     void record();
     
     /**
-     * Deletes the recorded uniforms.
+     * Clears the recorded uniforms.
      *
-     * This method is called upon flushing or cleanup.
+     * The state tables are compacted to just the entries used by the active
+     * context. This method is called upon flushing or cleanup.
      */
     void unwind();
     
@@ -1908,7 +2033,7 @@ private:
      * @param context   The current uniform context
      * @param tint      Whether to tint the gradient
      */
-    void setUniformBlock(Context* context, bool tint);
+    void setUniformBlock(Context& context, bool tint);
     
     /**
      * Updates the shader with the current blur offsets
@@ -1917,12 +2042,12 @@ private:
      * blur step into an offset in texture coordinates. It supports
      * non-square textures.
      *
-     * If there is no active texture, the blur offset will be 0.
+     * If there is no active texture (the size is 0), the blur offset will be 0.
      *
-     * @param texture   The texture to blur
+     * @param size      The size of the texture to blur
      * @param step      The blur step in pixels
      */
-    void blurTexture(const std::shared_ptr<Texture>& texture, GLuint step);
+    void blurTexture(Size size, GLuint step);
 
     /**
      * Returns the number of vertices added to the drawing buffer.
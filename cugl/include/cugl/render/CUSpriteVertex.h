@@ -88,13 +88,17 @@ public:
     cugl::Vec4 color;
     /** The vertex texture coordinate */
     cugl::Vec2 texcoord;
+    /** The texture slot to sample (assigned by the {@link SpriteBatch}) */
+    GLfloat texslot = 0;
 
     /** The memory offset of the vertex position */
-    static const GLvoid* positionOffset()   { return (GLvoid*)offsetof(SpriteVertex2, position);  }
+    static const GLvoid* positionOffset()   { return (GLvoid*)offsetof(SpriteVertex3, position);  }
     /** The memory offset of the vertex color */
-    static const GLvoid* colorOffset()      { return (GLvoid*)offsetof(SpriteVertex2, color);     }
+    static const GLvoid* colorOffset()      { return (GLvoid*)offsetof(SpriteVertex3, color);     }
     /** The memory offset of the vertex texture coordinate */
-    static const GLvoid* texcoordOffset()   { return (GLvoid*)offsetof(SpriteVertex2, texcoord);  }
+    static const GLvoid* texcoordOffset()   { return (GLvoid*)offsetof(SpriteVertex3, texcoord);  }
+    /** The memory offset of the vertex texture slot */
+    static const GLvoid* texslotOffset()    { return (GLvoid*)offsetof(SpriteVertex3, texslot);   }
 };
 
 }
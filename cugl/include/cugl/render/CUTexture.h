@@ -406,6 +406,25 @@ public:
      */
     const Texture& set(const void *data);
 
+    /**
+     * Sets a band of rows of this texture to the contents of the given buffer.
+     *
+     * The buffer must have the correct data format. In addition, the buffer
+     * must be size width*rows*bytesize, with no padding between rows.  See
+     * {@link #getByteSize} for a description of the latter.  If a pixel
+     * buffer is bound to GL_PIXEL_UNPACK_BUFFER, data is an offset into that
+     * buffer instead.
+     *
+     * This method is only successful if the texture is currently active.
+     *
+     * @param data  The buffer to read into the texture
+     * @param y     The first row to set
+     * @param rows  The number of rows to set
+     *
+     * @return a reference to this (modified) texture for chaining.
+     */
+    const Texture& setRows(const void *data, int y, int rows);
+
     
 #pragma mark -
 #pragma mark Attributes
@@ -751,6 +770,38 @@ public:
      */
     void bind();
     
+    /**
+     * Binds this texture to the given bind point, making it active.
+     *
+     * This method is identical to {@link #bind}, except that it ignores (and
+     * does not change) the bind point of this texture. It is intended for
+     * classes like {@link SpriteBatch} that sample from several texture slots
+     * at once, where the same texture may occupy a different slot in each
+     * draw call.
+     *
+     * This call is reentrant. If can be safely called multiple times.
+     *
+     * @param point	The bind point to attach this texture to.
+     */
+    void bindAt(GLuint point);
+    
+    /**
+     * Binds this texture to the given bind point, optionally leaving the
+     * active texture as it was.
+     *
+     * If activate is true, this method is identical to {@link #bindAt}.
+     * Otherwise, the active texture is restored after the bind, so that
+     * textures bound later (without a slot) do not replace this one. This is
+     * useful for a texture that must stay bound past the slots of a
+     * {@link SpriteBatch} for a whole pass.
+     *
+     * This call is reentrant. If can be safely called multiple times.
+     *
+     * @param point	    The bind point to attach this texture to.
+     * @param activate  Whether to leave this texture active
+     */
+    void bindAt(GLuint point, bool activate);
+    
     /**
      * Unbinds this texture, making it neither bound nor active.
      *
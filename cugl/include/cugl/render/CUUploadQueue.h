@@ -0,0 +1,279 @@
+//
+//  CUUploadQueue.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a queue for spreading texture uploads over several
+//  frames. Images are decoded outside of the main thread, but the upload to
+//  OpenGL must happen in it. Uploading a burst of large images at once will
+//  cause the frame to hitch. This queue instead uploads a few rows at a time,
+//  stopping each frame once it has spent its byte or time budget. Waiting
+//  images are uploaded in order of priority.
+//
+//  Where the platform supports pixel buffer objects, each batch of rows is
+//  staged in a buffer so that the driver can finish the transfer without
+//  stalling the main thread.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_UPLOAD_QUEUE_H__
+#define __CU_UPLOAD_QUEUE_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/render/CUTexture.h>
+#include <SDL/SDL.h>
+#include <functional>
+#include <vector>
+
+/** The default number of bytes uploaded each frame */
+#define UPLOAD_FRAME_BYTES  (4*1024*1024)
+/** The default number of milliseconds spent uploading each frame */
+#define UPLOAD_FRAME_MILLIS 4
+
+namespace cugl {
+
+/**
+ * This class is a main thread queue of texture uploads.
+ *
+ * An image pushed to this queue is not uploaded immediately.  Instead, the
+ * queue schedules itself with {@link Application#schedule} and uploads a
+ * band of rows each frame until it either exceeds its byte budget or its
+ * time budget.  At least one band is uploaded each frame, so that every image
+ * eventually finishes.  Images are uploaded in order of priority, with higher
+ * priorities going first.  Images of equal priority are uploaded in the order
+ * they were pushed.  A higher priority image will interrupt an image that is
+ * partly uploaded.
+ *
+ * The texture for an image is only handed to its callback once every row has
+ * been uploaded.  Until then, the texture is not safe to use.
+ *
+ * IMPORTANT: This class is not thread-safe.  Do not call any of these methods
+ * outside of the main CUGL thread.
+ */
+class UploadQueue {
+public:
+    /**
+     * @typedef Callback
+     *
+     * This type represents a callback for a finished upload.
+     *
+     * The texture is nullptr if it could not be created.  The callback is
+     * called in the main thread.
+     *
+     * The function type is equivalent to
+     *
+     *      std::function<void(const std::shared_ptr<Texture>& texture)>
+     *
+     * @param texture   The uploaded texture
+     */
+    typedef std::function<void(const std::shared_ptr<Texture>& texture)> Callback;
+
+private:
+    /** This macro disables the copy constructor (not allowed on queues) */
+    CU_DISALLOW_COPY_AND_ASSIGN(UploadQueue);
+
+    /** An image waiting to finish its upload */
+    struct Upload {
+        /** The decoded image (owned by this queue) */
+        SDL_Surface* surface;
+        /** The texture being uploaded (nullptr before the first band) */
+        std::shared_ptr<Texture> texture;
+        /** The upload priority (higher uploads go first) */
+        int priority;
+        /** The number of rows already uploaded */
+        int row;
+        /** The function to call when finished */
+        Callback callback;
+    };
+
+    /** The waiting uploads, with the next one first */
+    std::vector<Upload> _uploads;
+
+    /** The number of bytes uploaded each frame */
+    Uint32 _bytes;
+    /** The number of milliseconds spent uploading each frame */
+    Uint32 _millis;
+
+    /** The staging pixel buffer (0 if not yet created or unsupported) */
+    GLuint _buffer;
+    /** The id of the scheduled update (0 if not scheduled) */
+    Uint32 _scheduled;
+
+    /**
+     * Uploads the given number of rows of the given upload.
+     *
+     * The texture must be bound.  The rows are staged in a pixel buffer if
+     * the platform supports it.  Otherwise they are read from the surface.
+     *
+     * @param upload    The upload to continue
+     * @param rows      The number of rows to upload
+     */
+    void uploadRows(const Upload& upload, int rows);
+
+    /**
+     * Finishes the given upload, calling its callback.
+     *
+     * The upload must be the first one in the queue.
+     *
+     * @param upload    The upload to finish
+     * @param success   Whether the texture was uploaded
+     */
+    void finish(Upload& upload, bool success);
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized upload queue.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a queue on
+     * the heap, use one of the static constructors instead.
+     */
+    UploadQueue() : _bytes(0), _millis(0), _buffer(0), _scheduled(0) {}
+
+    /**
+     * Deletes this upload queue, disposing of all resources.
+     */
+    ~UploadQueue() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this queue.
+     *
+     * Waiting images are released without calling their callbacks.  A
+     * disposed queue can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes an upload queue with the given budgets.
+     *
+     * The queue stops uploading each frame once it has uploaded the given
+     * number of bytes, or has spent the given number of milliseconds. At
+     * least one band of rows is uploaded each frame regardless.
+     *
+     * @param bytes     The number of bytes uploaded each frame
+     * @param millis    The number of milliseconds spent uploading each frame
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 bytes=UPLOAD_FRAME_BYTES, Uint32 millis=UPLOAD_FRAME_MILLIS);
+
+    /**
+     * Returns a newly allocated upload queue with the given budgets.
+     *
+     * The queue stops uploading each frame once it has uploaded the given
+     * number of bytes, or has spent the given number of milliseconds. At
+     * least one band of rows is uploaded each frame regardless.
+     *
+     * @param bytes     The number of bytes uploaded each frame
+     * @param millis    The number of milliseconds spent uploading each frame
+     *
+     * @return a newly allocated upload queue with the given budgets.
+     */
+    static std::shared_ptr<UploadQueue> alloc(Uint32 bytes=UPLOAD_FRAME_BYTES,
+                                              Uint32 millis=UPLOAD_FRAME_MILLIS) {
+        std::shared_ptr<UploadQueue> result = std::make_shared<UploadQueue>();
+        return (result->init(bytes,millis) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Budgets
+    /**
+     * Returns the number of bytes uploaded each frame.
+     *
+     * @return the number of bytes uploaded each frame.
+     */
+    Uint32 getByteBudget() const { return _bytes; }
+
+    /**
+     * Sets the number of bytes uploaded each frame.
+     *
+     * At least one band of rows is uploaded each frame regardless.
+     *
+     * @param bytes     The number of bytes uploaded each frame
+     */
+    void setByteBudget(Uint32 bytes) { _bytes = bytes; }
+
+    /**
+     * Returns the number of milliseconds spent uploading each frame.
+     *
+     * @return the number of milliseconds spent uploading each frame.
+     */
+    Uint32 getTimeBudget() const { return _millis; }
+
+    /**
+     * Sets the number of milliseconds spent uploading each frame.
+     *
+     * At least one band of rows is uploaded each frame regardless.
+     *
+     * @param millis    The number of milliseconds spent uploading each frame
+     */
+    void setTimeBudget(Uint32 millis) { _millis = millis; }
+
+#pragma mark -
+#pragma mark Uploads
+    /**
+     * Adds an image to this queue.
+     *
+     * The queue takes ownership of the surface, and frees it once the image
+     * is uploaded.  The surface must have four bytes per pixel, in the order
+     * expected by {@link Texture::PixelFormat#RGBA}.
+     *
+     * The callback is called in a later frame, once every row of the image
+     * has been uploaded.  If the texture could not be created, the callback
+     * is given nullptr.
+     *
+     * @param surface   The decoded image
+     * @param priority  The upload priority (higher uploads go first)
+     * @param callback  The function to call when finished
+     */
+    void push(SDL_Surface* surface, int priority, Callback callback);
+
+    /**
+     * Uploads one frame of the waiting images.
+     *
+     * This method is called automatically each frame while images are
+     * waiting.  It stops once the byte or time budget is spent.
+     *
+     * @return true if there are still images waiting
+     */
+    bool update();
+
+    /**
+     * Returns the number of images waiting to finish uploading.
+     *
+     * @return the number of images waiting to finish uploading.
+     */
+    size_t size() const { return _uploads.size(); }
+
+    /**
+     * Returns the number of waiting images, counting each by the fraction left.
+     *
+     * An image that is half uploaded counts as 0.5.  This allows a progress
+     * bar to move while a large image is uploading.
+     *
+     * @return the number of waiting images, counting each by the fraction left.
+     */
+    float getRemaining() const;
+};
+
+}
+
+#endif /* __CU_UPLOAD_QUEUE_H__ */
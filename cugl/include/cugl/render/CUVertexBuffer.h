@@ -109,6 +109,13 @@ private:
     /** The index buffer for drawing a shape */
     GLuint _indxBuffer;
     
+    /** The bytes allocated for the vertex buffer by the last load or stream */
+    GLsizeiptr _vertCapacity;
+    /** The bytes allocated for the index buffer by the last load or stream */
+    GLsizeiptr _indxCapacity;
+    /** The fence marking the last draw from this buffer (0 if none) */
+    GLsync _fence;
+    
     /** The shader currently attached to this vertex buffer */
     std::shared_ptr<Shader> _shader;
     
@@ -307,6 +314,61 @@ public:
      */
     void loadIndexData(const void * data, GLsizei size, GLenum usage=GL_STREAM_DRAW);
     
+    /**
+     * Streams the given vertex data into this buffer.
+     *
+     * Unlike {@link #loadVertexData}, this method does not reallocate the
+     * buffer on every call. The buffer only grows (to at least twice its
+     * old size) when the data does not fit. Otherwise the data is written
+     * through an unsynchronized mapping, so the driver never waits for
+     * earlier draws from this buffer.
+     *
+     * That makes it the responsibility of the caller to ensure the GPU is
+     * done with this buffer, typically by calling {@link #waitFence} first.
+     * Cycling through several buffers keeps that wait short.
+     *
+     * This method will only succeed if this buffer is actively bound.
+     *
+     * @param data  The data to load
+     * @param size  The number of vertices to load
+     *
+     * @return the number of bytes uploaded
+     */
+    GLsizeiptr streamVertexData(const void * data, GLsizei size);
+    
+    /**
+     * Streams the given indices into this buffer.
+     *
+     * This method works like {@link #streamVertexData}, and has the same
+     * requirement that the GPU is done with this buffer.
+     *
+     * This method will only succeed if this buffer is actively bound.
+     *
+     * @param data  The indices to load
+     * @param size  The number of indices to load
+     *
+     * @return the number of bytes uploaded
+     */
+    GLsizeiptr streamIndexData(const void * data, GLsizei size);
+    
+    /**
+     * Marks the end of the draw commands that read from this buffer.
+     *
+     * A later call to {@link #waitFence} will block until the GPU has
+     * executed every command issued before this one.
+     */
+    void setFence();
+    
+    /**
+     * Blocks until the GPU is done with the commands before the last fence.
+     *
+     * This method returns immediately if no fence is set or the fence has
+     * already passed.
+     *
+     * @return the time spent waiting, in microseconds
+     */
+    Uint64 waitFence();
+    
     /**
      * Draws to the active framebuffer using this vertex buffer
      *
@@ -30,6 +30,7 @@
 
 #include "CUSpriteVertex.h"
 #include "CUTexture.h"
+#include "CUUploadQueue.h"
 #include "CUFont.h"
 #include "CUMesh.h"
 #include "CUScissor.h"
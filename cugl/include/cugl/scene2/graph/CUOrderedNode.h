@@ -46,6 +46,7 @@
 #ifndef __CU_ORDERED_NODE_H__
 #define __CU_ORDERED_NODE_H__
 #include <cugl/scene2/graph/CUSceneNode.h>
+#include <vector>
 
 namespace cugl {
     namespace scene2 {
@@ -67,10 +68,9 @@ namespace cugl {
  * Any order other than a pre-order traversal comes as a cost, as we must
  * cache the scene graph transform and color context of each node (these
  * values are computed naturally from the recursive calls of a pre-order
- * traversal). In addition, we must call std::sort (currently IntroSort)
- * on all of the descendants every single render pass. However, as long
- * as the number of children of this node is reasonably sized, this should
- * not be an issue.
+ * traversal). These contexts are pooled across render passes. The sorted
+ * order is also kept between passes, and is only repaired when the number
+ * of descendants, or the priority or parent of one of them, has changed.
  *
  * An OrderedNode is a render barrier. This means that if one OrderedNode
  * (the first node) is a descendant of another OrderedNode (the second node),
@@ -177,57 +177,79 @@ protected:
      * the scissor value. Normally these are managed by the call stack during
      * a recursive call. To reorder rendering, we have to make this explicit.
      *
-     * This class is essentially a struct with a sort order.
+     * This class is essentially a struct with a sort key. Contexts are pooled
+     * in {@link #_entries} and overwritten every render pass, so the render
+     * queue does not allocate once it has reached its peak size. The node is
+     * a raw pointer because a context never outlives the render pass that
+     * filled it in.
      */
     class Context {
     public:
-        /** The parent of this inner class (as C++ does not have this Java feature) */
-        OrderedNode* parent;
         /** The node to be drawn at this step */
-        std::shared_ptr<SceneNode> node;
+        SceneNode* node;
         /** The scissor value (possibly nullptr) */
         std::shared_ptr<Scissor> scissor;
         /** The drawing transform */
         Mat4 transform;
         /** The tint color */
         Color4 tint;
-        /** The canonical order (for pre-order and post-order traversals) */
-        Uint32 canonical;
-        
-        /**
-         * Creates a drawing context with the given parent object
-         *
-         * @param parent    The parent object for the inner class
-         */
-        Context(OrderedNode* parent);
-        
-        /**
-         * Creates a copy of the given drawing context
-         *
-         * @param copy      The drawing context to copy
-         */
-        Context(const Context& copy);
+        /** The node priority when this context was filled in */
+        float priority;
+        /** The node parent when this context was filled in (for pre/post sorts) */
+        SceneNode* group;
+        /** Whether the node is a render barrier (another ordered node) */
+        bool barrier;
 
         /**
-         * Deletes this drawing context, disposing of all resources.
+         * Creates an empty drawing context
          */
-        ~Context();
-
-        /**
-         * Returns the value *a < *b
-         *
-         * This function implements a sort order on drawing contexts and
-         * is used to sort the render queue.
-         */
-        static bool sortCompare(Context* a, Context* b);
+        Context() : node(nullptr), tint(Color4::WHITE), priority(0), group(nullptr), barrier(false) {}
     };
 
-    /** The render queue (always use a deque for this functionality) */
-    std::deque<Context*> _entries;
+    /**
+     * The render queue, pooled across render passes.
+     *
+     * Only the first {@link #_count} entries are in use. The index of an entry
+     * is its canonical (pre-order or post-order) position.
+     */
+    std::vector<Context> _entries;
+    /** The number of entries used by the current render pass */
+    size_t _count;
+    /** The render order, as indices into {@link #_entries}, kept from the previous pass */
+    std::vector<Uint32> _sorted;
+    /** The number of entries whose sort key differs from the previous pass */
+    size_t _changed;
     /** The global scissor context (necessary as sprite batches manage this normally) */
     std::shared_ptr<Scissor> _viewport;
+    /** Whether to cull the nodes visited in the current render pass */
+    bool _culling;
+    /** The visible region of the current render pass (if culling) */
+    Rect _cullRect;
     /** The current render order */
     Order _order;
+
+    /**
+     * Returns true if entry a should be drawn before entry b
+     *
+     * This function implements a sort order on drawing contexts and
+     * is used to sort the render queue. Ties are broken by canonical order.
+     *
+     * @param a     The index of the first entry
+     * @param b     The index of the second entry
+     *
+     * @return true if entry a should be drawn before entry b
+     */
+    bool sortCompare(Uint32 a, Uint32 b) const;
+
+    /**
+     * Brings {@link #_sorted} up to date with the current render pass.
+     *
+     * If no sort key changed since the previous pass, the previous order is
+     * reused as is. If only a few keys changed, the previous order is nearly
+     * sorted and is repaired with an insertion sort. Otherwise (including
+     * any change in the number of entries) it is fully sorted again.
+     */
+    void updateOrder();
     
     /**
      * Adds the given node ot the render queue.
@@ -403,6 +403,23 @@ public:
     
 #pragma mark -
 #pragma mark Internal Helpers
+protected:
+    /**
+     * Adds the geometry of this node (but not its children) to a baked mesh.
+     *
+     * This is the baking counterpart of {@link #draw}. The polygon mesh is
+     * transformed, tinted and added to piece with the node texture. A node
+     * with a gradient or a blend mode other than the default cannot be
+     * baked, and this method returns false.
+     *
+     * @param piece     The mesh to add to
+     * @param transform The transform to the baked node
+     * @param tint      The tint to blend with the node color
+     *
+     * @return true if this node could be baked.
+     */
+    virtual bool bakeGeometry(BakedMesh& piece, const Mat4& transform, Color4 tint) override;
+
 private:
     /** This macro disables the copy constructor (not allowed on scene graphs) */
     CU_DISALLOW_COPY_AND_ASSIGN(PolygonNode);
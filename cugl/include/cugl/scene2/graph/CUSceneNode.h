@@ -221,6 +221,34 @@ protected:
     
     /** The rendering priority; used by {@link OrderedNode} */
     float _priority;
+
+    /**
+     * Whether this node is a render barrier for {@link OrderedNode}.
+     *
+     * This is a type tag set by OrderedNode (and its subclasses) so that the
+     * render queue does not need to compare class names.
+     */
+    bool _barrier;
+    
+    /** The bounds of this node and all of its descendants, in parent coordinates */
+    mutable Rect _bounds;
+    /** Whether the cached subtree bounds are out of date */
+    mutable bool _boundsDirty;
+    /** Whether this subtree is culled as a single unit */
+    bool _static;
+
+    /** A run of baked triangles that share a texture buffer */
+    struct BakedMesh {
+        /** The texture of the run (nullptr if untextured) */
+        std::shared_ptr<Texture> texture;
+        /** The triangles, in the coordinate space of the baked node */
+        Mesh<SpriteVertex3> mesh;
+    };
+
+    /** Whether this subtree is drawn from its baked meshes */
+    bool _isBaked;
+    /** The baked meshes of this subtree, in drawing order */
+    std::vector<BakedMesh> _baked;
     
     /** The defining JSON data for this node (if any) */
     std::shared_ptr<JsonValue> _json;
@@ -612,6 +640,19 @@ public:
      */
     virtual const std::string getClassName() const { return "SceneNode"; }
 
+    /**
+     * Returns true if this node is a render barrier for {@link OrderedNode}.
+     *
+     * Only instances of OrderedNode are barriers. This is a type tag, and so
+     * is much cheaper than comparing the result of {@link #getClassName}.
+     *
+     * A baked node is also a render barrier, as its descendants are drawn
+     * with it.
+     *
+     * @return true if this node is a render barrier for {@link OrderedNode}.
+     */
+    bool isRenderBarrier() const { return _barrier || _isBaked; }
+
     /**
      * Returns a string representation of this node for debugging purposes.
      *
@@ -871,6 +912,72 @@ public:
         return getNodeToParentTransform().transform(Rect(Vec2::ZERO, getContentSize()));
     }
     
+    /**
+     * Returns an AABB of this node and all of its descendants in the parent's coordinates.
+     *
+     * This is the union of {@link getBoundingBox} with the subtree bounds of
+     * every child (visible or not). Nodes with no content size contribute
+     * nothing. If no node in the subtree has a content size, the result has
+     * size zero.
+     *
+     * The value is cached, and is only recomputed when the transform, the
+     * content size, or the children of some node in the subtree change.
+     *
+     * @return An AABB of this node and all of its descendants in the parent's coordinates.
+     */
+    const Rect& getSubtreeBounds() const;
+    
+    /**
+     * Marks the subtree bounds of this node, and of all its ancestors, as out of date.
+     *
+     * This is called automatically whenever the transform, content size or
+     * children of this node change. Custom nodes only need to call it if
+     * they change their bounds some other way.
+     */
+    void invalidateBounds();
+    
+    /**
+     * Returns true if this node is outside of the given view.
+     *
+     * This test uses {@link getSubtreeBounds}, so a culled node has no
+     * visible descendants either. A subtree with no content size is never
+     * culled, as its extent is unknown.
+     *
+     * @param view      The visible region, in drawing coordinates
+     * @param transform The parent to drawing coordinate transform
+     *
+     * @return true if this node is outside of the given view.
+     */
+    bool isCulled(const Rect& view, const Mat4& transform) const;
+    
+    /**
+     * Returns true if this subtree is culled as a single unit.
+     *
+     * When a {@link SpriteBatch} has culling enabled, every node normally
+     * tests its own subtree bounds before it is drawn. The descendants of a
+     * static node skip this test: either the whole subtree is culled, or
+     * all of it is drawn. This is appropriate for a subtree (such as a room
+     * of scenery) that is small compared to the view, where a per-node test
+     * would rarely succeed. The default value is false.
+     *
+     * @return true if this subtree is culled as a single unit.
+     */
+    bool isStatic() const { return _static; }
+    
+    /**
+     * Sets whether this subtree is culled as a single unit.
+     *
+     * When a {@link SpriteBatch} has culling enabled, every node normally
+     * tests its own subtree bounds before it is drawn. The descendants of a
+     * static node skip this test: either the whole subtree is culled, or
+     * all of it is drawn. This is appropriate for a subtree (such as a room
+     * of scenery) that is small compared to the view, where a per-node test
+     * would rarely succeed. The default value is false.
+     *
+     * @param value Whether this subtree is culled as a single unit.
+     */
+    void setStatic(bool value) { _static = value; }
+    
 #pragma mark -
 #pragma mark Anchors
     /**
@@ -1983,6 +2090,60 @@ public:
      */
     virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {}
     
+    /**
+     * Flattens this node and all of its descendants into prebuilt meshes.
+     *
+     * The geometry of every visible node in the subtree is transformed into
+     * the coordinate space of this node, tinted, and merged into one mesh
+     * per run of nodes that share a texture buffer. When textures come from
+     * the same atlas, this is usually a single mesh. From then on, render
+     * draws these meshes instead of visiting the subtree, so a baked node
+     * costs a few calls to {@link SpriteBatch#fill} and no per-node work.
+     *
+     * Baking only captures the subtree as it is now. Later changes to the
+     * descendants (including their visibility) are not drawn until the node
+     * is baked again. Changes to this node itself, such as its position or
+     * color, still apply. The children remain in the scene graph, so they
+     * can still be found by name or tag.
+     *
+     * Nodes are normally baked in pre-order, which is the order of render.
+     * If byPriority is true, they are sorted by ascending priority instead
+     * (ties in pre-order), which matches an {@link OrderedNode} with order
+     * ASCEND. A baked node is a render barrier, so it is drawn as one unit
+     * at its own priority.
+     *
+     * A subtree cannot be baked if a descendant has a scissor, does not use
+     * relative color, or cannot be baked itself (see {@link #bakeGeometry}).
+     * In that case this method returns false and the node is unchanged.
+     *
+     * @param byPriority    Whether to order the geometry by priority
+     *
+     * @return true if the subtree was baked.
+     */
+    bool bake(bool byPriority=false);
+
+    /**
+     * Discards the baked meshes, so that the subtree is drawn normally.
+     */
+    void unbake();
+
+    /**
+     * Returns true if this subtree is drawn from baked meshes.
+     *
+     * @return true if this subtree is drawn from baked meshes.
+     */
+    bool isBaked() const { return _isBaked; }
+
+    /**
+     * Returns the number of meshes drawn for this baked subtree.
+     *
+     * This is the number of fill calls made by render, and is 0 if the node
+     * is not baked.
+     *
+     * @return the number of meshes drawn for this baked subtree.
+     */
+    size_t getBakedMeshCount() const { return _baked.size(); }
+
     
 #pragma mark -
 #pragma mark Layout Automation
@@ -2096,6 +2257,38 @@ private:
      */
     virtual void updateTransform();
 
+protected:
+    /**
+     * Adds the geometry of this node (but not its children) to a baked mesh.
+     *
+     * This is the baking counterpart of {@link #draw}. It should append to
+     * piece exactly what draw would send to the {@link SpriteBatch}, with
+     * the positions multiplied by transform and the colors by tint, and set
+     * the piece texture. The mesh is empty when this method is called.
+     *
+     * The default method adds nothing, which is correct for a node that does
+     * not draw anything itself. A subclass that overrides draw must also
+     * override this method, returning false if its drawing cannot be baked
+     * (for example, if it uses a gradient or a custom blend mode).
+     *
+     * @param piece     The mesh to add to
+     * @param transform The transform to the baked node
+     * @param tint      The tint to blend with the node color
+     *
+     * @return true if this node could be baked.
+     */
+    virtual bool bakeGeometry(BakedMesh& /*piece*/, const Mat4& /*transform*/, Color4 /*tint*/) { return true; }
+
+    /**
+     * Draws the baked meshes of this node with the given SpriteBatch.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the node color.
+     */
+    void drawBaked(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint);
+
+private:
     // Copying is only allowed via shared pointer.
     CU_DISALLOW_COPY_AND_ASSIGN(SceneNode);
     
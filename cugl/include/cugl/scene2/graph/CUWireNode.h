@@ -420,6 +420,18 @@ public:
      * @param tint      The tint to blend with the Node color.
      */
     virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) override;
+
+protected:
+    /**
+     * Returns false, as this node cannot be baked.
+     *
+     * @param piece     The mesh to add to
+     * @param transform The transform to the baked node
+     * @param tint      The tint to blend with the node color
+     *
+     * @return false, as this node cannot be baked.
+     */
+    virtual bool bakeGeometry(BakedMesh& /*piece*/, const Mat4& /*transform*/, Color4 /*tint*/) override { return false; }
     
 
 private:
@@ -542,7 +542,20 @@ public:
      */
     virtual void draw(const std::shared_ptr<SpriteBatch>& batch,
                       const Mat4& transform, Color4 tint) override;
+
+protected:
+    /**
+     * Returns false, as this node cannot be baked.
+     *
+     * @param piece     The mesh to add to
+     * @param transform The transform to the baked node
+     * @param tint      The tint to blend with the node color
+     *
+     * @return false, as this node cannot be baked.
+     */
+    virtual bool bakeGeometry(BakedMesh& /*piece*/, const Mat4& /*transform*/, Color4 /*tint*/) override { return false; }
     
+public:
     /**
      * Refreshes this node to restore the render data.
      */
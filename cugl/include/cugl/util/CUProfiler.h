@@ -0,0 +1,525 @@
+//
+//  CUProfiler.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a lightweight frame profiler. Code is divided into
+//  named zones, which are timed on whichever thread they run. Each thread
+//  writes its zones to its own ring buffer without locking, and the main
+//  thread collects them once per frame. Sprite batch flushes are also timed
+//  on the GPU with timer queries (where the platform supports them), and a
+//  few counters (draw calls, vertices, state changes, and allocations if the
+//  application reports them) are kept per frame. A capture of several frames
+//  can be saved as a Chrome trace.
+//
+//  The instrumentation macros are compiled out unless CU_PROFILE is defined,
+//  so the profiler costs nothing in a normal build.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_PROFILER_H__
+#define __CU_PROFILER_H__
+#include <cugl/base/CUBase.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstring>
+
+/** The number of zones a thread can hold before the main thread collects them */
+#define PROFILE_RING_SIZE   4096
+/** The deepest zone nesting that is recorded (deeper zones are ignored) */
+#define PROFILE_MAX_DEPTH   32
+/** The most zones kept in a trace capture */
+#define PROFILE_MAX_CAPTURE 1048576
+
+#define CU_PROFILE_CONCAT2(a,b)  a##b
+#define CU_PROFILE_CONCAT(a,b)   CU_PROFILE_CONCAT2(a,b)
+
+#ifdef CU_PROFILE
+/** Times the rest of the enclosing scope as a zone with the given name (a string literal) */
+#define CU_PROFILE_ZONE(name)   cugl::ProfileZone CU_PROFILE_CONCAT(_cu_profile_zone,__LINE__)(name)
+/** Times the rest of the enclosing scope on the GPU, under the innermost main thread zone */
+#define CU_PROFILE_GPU()        cugl::ProfileGpuZone CU_PROFILE_CONCAT(_cu_profile_gpu,__LINE__)
+/** Adds to the given {@link Profiler::Counter} for this frame */
+#define CU_PROFILE_COUNT(counter,amount)    cugl::Profiler::count(cugl::Profiler::Counter::counter,amount)
+#else
+#define CU_PROFILE_ZONE(name)
+#define CU_PROFILE_GPU()
+#define CU_PROFILE_COUNT(counter,amount)
+#endif
+
+namespace cugl {
+
+/**
+ * This class is a frame profiler for CUGL applications.
+ *
+ * The profiler is a singleton. It is started with {@link #start} and is
+ * afterwards available from {@link #get}. The application should call
+ * {@link #beginFrame} at the start of each frame and {@link #endFrame} at
+ * the end of it, from the same (main) thread.
+ *
+ * Zones are recorded with the macro CU_PROFILE_ZONE, which times the rest
+ * of its scope. Zones may be recorded on any thread. Each thread has its
+ * own ring buffer of {@link #PROFILE_RING_SIZE} finished zones, which it
+ * writes without locking. The main thread drains every ring in endFrame.
+ * If a thread fills its ring before that, the oldest zones are lost and
+ * are counted by {@link #getDroppedZones}.
+ *
+ * The macro CU_PROFILE_GPU times the GPU work of its scope with a timer
+ * query, and files it under the innermost zone of the main thread. Timer
+ * queries are read back a few frames later, when they are ready, so GPU
+ * times lag CPU times slightly. GPU timing requires GL_TIME_ELAPSED, which
+ * is not part of OpenGLES; on mobile platforms only CPU times are kept.
+ *
+ * Zones with the same name are combined into one {@link Stat}, which keeps
+ * the total time of that zone in the last frame and a running average.
+ * Zone names must be string literals (or otherwise outlive the profiler),
+ * as the profiler only keeps the pointer.
+ *
+ * All of this is compiled out unless CU_PROFILE is defined. The class
+ * itself is always available, but will only see zones and counters from
+ * code built with that flag.
+ */
+class Profiler {
+public:
+    /**
+     * The counters kept for each frame.
+     *
+     * The profiler does not count allocations itself, as that would mean
+     * replacing the global operator new inside the library. An application
+     * that wants them counted should replace operator new in its own code
+     * and call {@link count} with ALLOCATIONS from there.
+     */
+    enum class Counter : int {
+        /** The number of draw calls made by sprite batches */
+        DRAW_CALLS = 0,
+        /** The number of vertices (indices) drawn by sprite batches */
+        VERTICES = 1,
+        /** The number of changes of sprite batch state between draw calls */
+        STATE_CHANGES = 2,
+        /** The number of allocations, as reported by the application */
+        ALLOCATIONS = 3,
+        /** The number of counters */
+        COUNT = 4
+    };
+
+    /**
+     * The accumulated timing of all zones with the same name.
+     */
+    class Stat {
+    public:
+        /** The zone name */
+        const char* name;
+        /** Whether this is GPU time rather than CPU time */
+        bool gpu;
+        /** The total time in the last frame, in microseconds */
+        double last;
+        /** The running average time per frame, in microseconds */
+        double average;
+        /** The time so far in the current frame (internal) */
+        double current;
+    };
+
+    /**
+     * A finished zone, as stored in a ring buffer or a capture.
+     */
+    class Zone {
+    public:
+        /** The zone name */
+        const char* name;
+        /** The start time, in microseconds since the profiler started */
+        Uint64 start;
+        /** The end time, in microseconds since the profiler started */
+        Uint64 end;
+        /** The trace thread id (0 is the GPU) */
+        Uint32 thread;
+    };
+
+private:
+    /** The profiler singleton */
+    static Profiler* _gProfiler;
+    /** The counters, which are updated from any thread */
+    static std::atomic<Uint64> _counters[(int)Counter::COUNT];
+
+    /** The zones of a single thread */
+    class Ring {
+    public:
+        /** The finished zones */
+        Zone events[PROFILE_RING_SIZE];
+        /** The number of zones ever written (only written by the owner) */
+        std::atomic<Uint64> head;
+        /** The number of zones ever read (only used by the main thread) */
+        Uint64 tail;
+        /** The names of the open zones (only used by the owner) */
+        const char* names[PROFILE_MAX_DEPTH];
+        /** The start times of the open zones (only used by the owner) */
+        Uint64 starts[PROFILE_MAX_DEPTH];
+        /** The number of open zones (only used by the owner) */
+        Uint32 depth;
+        /** The trace thread id */
+        Uint32 thread;
+        /** The thread name for the trace */
+        std::string label;
+    };
+
+    /** A GPU timer query that has not been read back */
+    class Query {
+    public:
+        /** The query object */
+        GLuint query;
+        /** The zone it is filed under */
+        const char* name;
+        /** The CPU time when it was started */
+        Uint64 start;
+    };
+
+    /** Orders zone names by their contents */
+    struct NameLess {
+        bool operator()(const char* a, const char* b) const { return std::strcmp(a,b) < 0; }
+    };
+
+    /** Guards the list of rings (only taken when a thread records its first zone) */
+    std::mutex _mutex;
+    /** The ring of every thread that has recorded a zone */
+    std::vector<Ring*> _rings;
+    /** The ring of the main thread */
+    Ring* _main;
+    /** The zones lost to full rings */
+    Uint64 _dropped;
+
+    /** The accumulated timings, in order of first appearance */
+    std::vector<Stat> _stats;
+    /** The index of each CPU stat, by name */
+    std::map<const char*,size_t,NameLess> _cpuIndex;
+    /** The index of each GPU stat, by name */
+    std::map<const char*,size_t,NameLess> _gpuIndex;
+
+    /** The counters of the last frame */
+    Uint64 _lastCounts[(int)Counter::COUNT];
+    /** The running average of each counter per frame */
+    double _averageCounts[(int)Counter::COUNT];
+
+    /** The clock ticks at which the profiler started */
+    Uint64 _origin;
+    /** The time at which the current frame started */
+    Uint64 _frameStart;
+    /** The length of the last frame, in microseconds */
+    double _frameTime;
+    /** The running average length of a frame, in microseconds */
+    double _frameAverage;
+    /** The number of frames ended */
+    Uint64 _frames;
+
+    /** Unused timer query objects */
+    std::vector<GLuint> _freeQueries;
+    /** Timer queries that have been issued, oldest first */
+    std::vector<Query> _pending;
+    /** The number of nested GPU zones (only the outermost is timed) */
+    Uint32 _gpuDepth;
+
+    /** Whether zones are being captured for a trace */
+    bool _capturing;
+    /** The captured zones */
+    std::vector<Zone> _capture;
+    /** The captured counters, one row per frame */
+    std::vector<std::pair<Uint64,std::vector<Uint64>>> _captureCounts;
+
+#pragma mark Constructors
+    /**
+     * Creates a new profiler, with the clock started now.
+     *
+     * Access the profiler with the static methods instead.
+     */
+    Profiler();
+
+    /**
+     * Deletes this profiler, releasing all of its rings and queries.
+     */
+    ~Profiler();
+
+#pragma mark Internal Helpers
+    /**
+     * Returns the ring of the calling thread, creating it if necessary.
+     *
+     * @return the ring of the calling thread
+     */
+    Ring* getRing();
+
+    /**
+     * Returns the stat for the given zone name, creating it if necessary.
+     *
+     * @param name  The zone name
+     * @param gpu   Whether the stat is for GPU time
+     *
+     * @return the stat for the given zone name
+     */
+    Stat& getStat(const char* name, bool gpu);
+
+    /**
+     * Moves the finished zones of a ring into the stats (and the capture).
+     *
+     * @param ring  The ring to drain
+     */
+    void drain(Ring* ring);
+
+    /**
+     * Reads back every GPU timer query that is ready.
+     */
+    void collectQueries();
+
+public:
+#pragma mark Static Accessors
+    /**
+     * Returns the profiler singleton, or nullptr if it is not started.
+     *
+     * @return the profiler singleton, or nullptr if it is not started.
+     */
+    static Profiler* get() { return _gProfiler; }
+
+    /**
+     * Starts the profiler singleton.
+     *
+     * The calling thread is taken to be the main thread, which must also be
+     * the thread with the OpenGL context. This method has no effect if the
+     * profiler is already started.
+     *
+     * @return true if the profiler was started
+     */
+    static bool start();
+
+    /**
+     * Stops the profiler singleton, discarding all of its data.
+     *
+     * No zone may be open on any thread when this method is called.
+     */
+    static void stop();
+
+    /**
+     * Adds to a counter for the current frame.
+     *
+     * This method may be called from any thread, and whether or not the
+     * profiler is started.
+     *
+     * @param counter   The counter to add to
+     * @param amount    The amount to add
+     */
+    static void count(Counter counter, Uint64 amount) {
+        _counters[(int)counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the current time, in microseconds since the profiler started.
+     *
+     * @return the current time, in microseconds since the profiler started.
+     */
+    Uint64 now() const;
+
+#pragma mark Frames
+    /**
+     * Marks the start of a frame.
+     *
+     * This must be called on the main thread.
+     */
+    void beginFrame();
+
+    /**
+     * Marks the end of a frame, collecting every zone and counter.
+     *
+     * This must be called on the main thread.
+     */
+    void endFrame();
+
+    /**
+     * Returns the length of the last frame, in microseconds.
+     *
+     * This is the time from beginFrame to endFrame, so it does not include
+     * any time the application spends outside of the frame.
+     *
+     * @return the length of the last frame, in microseconds.
+     */
+    double getFrameTime() const { return _frameTime; }
+
+    /**
+     * Returns the running average length of a frame, in microseconds.
+     *
+     * @return the running average length of a frame, in microseconds.
+     */
+    double getAverageFrameTime() const { return _frameAverage; }
+
+    /**
+     * Returns the accumulated timings, in order of first appearance.
+     *
+     * @return the accumulated timings, in order of first appearance.
+     */
+    const std::vector<Stat>& getStats() const { return _stats; }
+
+    /**
+     * Returns the value of a counter in the last frame.
+     *
+     * @param counter   The counter to read
+     *
+     * @return the value of a counter in the last frame.
+     */
+    Uint64 getCount(Counter counter) const { return _lastCounts[(int)counter]; }
+
+    /**
+     * Returns the running average of a counter per frame.
+     *
+     * @param counter   The counter to read
+     *
+     * @return the running average of a counter per frame.
+     */
+    double getAverageCount(Counter counter) const { return _averageCounts[(int)counter]; }
+
+    /**
+     * Returns the number of zones lost because a ring was full.
+     *
+     * @return the number of zones lost because a ring was full.
+     */
+    Uint64 getDroppedZones() const { return _dropped; }
+
+#pragma mark Zones
+    /**
+     * Opens a zone on the calling thread.
+     *
+     * Every call must be matched by a call to {@link #endZone} on the same
+     * thread. Use CU_PROFILE_ZONE rather than calling this directly.
+     *
+     * @param name  The zone name (which must outlive the profiler)
+     */
+    void beginZone(const char* name);
+
+    /**
+     * Closes the innermost zone on the calling thread.
+     */
+    void endZone();
+
+    /**
+     * Sets the name of the calling thread in trace captures.
+     *
+     * @param name  The thread name
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * Starts timing GPU work, filed under the innermost main thread zone.
+     *
+     * Timer queries cannot nest, so only the outermost call is timed. This
+     * must be called on the main thread. Use CU_PROFILE_GPU rather than
+     * calling this directly.
+     */
+    void beginGpu();
+
+    /**
+     * Stops timing GPU work.
+     */
+    void endGpu();
+
+#pragma mark Trace Capture
+    /**
+     * Starts capturing zones for a trace.
+     *
+     * Any previous capture is discarded. At most {@link #PROFILE_MAX_CAPTURE}
+     * zones are kept.
+     */
+    void startCapture();
+
+    /**
+     * Stops capturing and writes the capture as a Chrome trace.
+     *
+     * The file is in the JSON trace event format, and can be opened with
+     * chrome://tracing or Perfetto. Each thread is a separate track, with
+     * GPU zones on their own track, and the counters are written once per
+     * frame.
+     *
+     * @param path  The file to write
+     *
+     * @return true if the trace was written
+     */
+    bool stopCapture(const std::string& path);
+
+    /**
+     * Returns true if zones are being captured for a trace.
+     *
+     * @return true if zones are being captured for a trace.
+     */
+    bool isCapturing() const { return _capturing; }
+};
+
+/**
+ * A zone that lasts for the lifetime of this object.
+ *
+ * Use CU_PROFILE_ZONE rather than creating these directly.
+ */
+class ProfileZone {
+private:
+    /** The profiler that opened the zone (or nullptr) */
+    Profiler* _profiler;
+
+public:
+    /**
+     * Opens a zone with the given name, if the profiler is started.
+     *
+     * @param name  The zone name (which must outlive the profiler)
+     */
+    ProfileZone(const char* name) : _profiler(Profiler::get()) {
+        if (_profiler) { _profiler->beginZone(name); }
+    }
+
+    /**
+     * Closes the zone.
+     */
+    ~ProfileZone() {
+        if (_profiler && _profiler == Profiler::get()) { _profiler->endZone(); }
+    }
+};
+
+/**
+ * A GPU zone that lasts for the lifetime of this object.
+ *
+ * Use CU_PROFILE_GPU rather than creating these directly.
+ */
+class ProfileGpuZone {
+private:
+    /** The profiler that opened the zone (or nullptr) */
+    Profiler* _profiler;
+
+public:
+    /**
+     * Starts timing GPU work, if the profiler is started.
+     */
+    ProfileGpuZone() : _profiler(Profiler::get()) {
+        if (_profiler) { _profiler->beginGpu(); }
+    }
+
+    /**
+     * Stops timing GPU work.
+     */
+    ~ProfileGpuZone() {
+        if (_profiler && _profiler == Profiler::get()) { _profiler->endGpu(); }
+    }
+};
+
+}
+
+#endif /* __CU_PROFILER_H__ */
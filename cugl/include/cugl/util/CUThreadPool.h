@@ -82,8 +82,28 @@ private:
     std::vector<std::thread> _workers;
 #endif
     
+    /** A task waiting for a worker, ordered by priority and then by age */
+    struct Task {
+        /** The task function */
+        std::function<void()> work;
+        /** The task priority (higher tasks run first) */
+        int priority;
+        /** The number of tasks added before this one */
+        size_t order;
+        
+        /** Returns true if this task should run after the other one */
+        bool operator<(const Task& other) const {
+            if (priority != other.priority) {
+                return priority < other.priority;
+            }
+            return order > other.order;
+        }
+    };
+    
     /** Tasks waiting to be assigned to a thread */
-    std::queue< std::function<void()> > _taskQueue;
+    std::priority_queue<Task> _taskQueue;
+    /** The number of tasks added to this pool (to keep equal priorities FIFO) */
+    size_t _taskCount;
     
     /** A mutex lock for the task queue */
     std::mutex _queueMutex;
@@ -125,7 +145,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool 
      * on the heap, use one of the static constructors instead.
      */
-    ThreadPool() :_stop(false), _complete(0) { }
+    ThreadPool() :_taskCount(0), _stop(false), _complete(0) { }
     
     /**
      * Deletes this thread pool, destroying all resources.
@@ -188,9 +208,14 @@ public:
      * will not be executed immediately, but must wait for the first available 
      * worker.
      *
+     * Waiting tasks are assigned in order of priority, with higher priorities
+     * going first.  Tasks of equal priority are assigned in the order they
+     * were added.  A priority does not preempt a task that is already running.
+     *
      * @param  task     the task function to add to the thread pool
+     * @param  priority the task priority
      */
-    void addTask(const std::function<void()> &task);
+    void addTask(const std::function<void()> &task, int priority = 0);
     
     /**
      * Stop the thread pool, marking it for shut down.
@@ -0,0 +1,849 @@
+//
+//  CUAssetBundle.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a binary bundle of precompiled assets. A bundle packs
+//  many asset files into one file, storing each in the form the game needs at
+//  run time: images as raw RGBA pixels, JSON as a flat binary tree, and sound
+//  samples as decoded PCM. An index hashed on the asset path finds any entry
+//  in constant time. Loading from a bundle therefore skips all decoding and
+//  parsing, and opens one file instead of hundreds.
+//
+//  Bundles are memory mapped where the asset directory is a real directory.
+//  On Android the assets are inside the APK and cannot be mapped, so the
+//  bundle is read into memory in one pass instead.
+//
+//  Bundles are written offline with AssetBundleWriter, and are attached to an
+//  AssetManager with setBundle. All multibyte values are little-endian.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/assets/CUAssetBundle.h>
+#include <cugl/audio/CUAudioSample.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUDebug.h>
+#include <climits>
+#include <cstring>
+#include <deque>
+
+// Assets inside an APK (and Windows handles) are read instead of mapped
+#if !defined (__WINDOWS__) && !defined (__ANDROID__)
+    #define CU_MAP_BUNDLE 1
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Assets inside an APK cannot be examined for the staleness check
+#if !defined (__ANDROID__)
+    #define CU_STAT_BUNDLE 1
+    #include <sys/types.h>
+    #include <sys/stat.h>
+#endif
+
+/** The offset of the pixels in an image payload */
+#define IMAGE_HEADER    16
+/** The offset of the samples in a sound payload */
+#define SOUND_HEADER    16
+/** The offset of the nodes in a JSON payload */
+#define JSON_HEADER     8
+/** A JSON node with no key */
+#define JSON_NO_KEY     0xFFFFFFFF
+
+using namespace cugl;
+
+static_assert(sizeof(AssetBundle::Header) == 32, "Bundle header must be packed");
+static_assert(sizeof(AssetBundle::Slot) == 56, "Bundle slots must be packed");
+static_assert(sizeof(AssetBundle::JsonNode) == 24, "Bundle JSON nodes must be packed");
+
+/**
+ * Returns the hash of an entry name.
+ *
+ * This is 64-bit FNV-1a, which is stable across platforms and runs.
+ *
+ * @param name  The entry name
+ *
+ * @return the hash of an entry name.
+ */
+Uint64 AssetBundle::hash(const std::string& name) {
+    Uint64 result = 14695981039346656037ULL;
+    for(auto it = name.begin(); it != name.end(); ++it) {
+        result ^= (Uint8)*it;
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+/**
+ * Returns the hash of the contents of the given file.
+ *
+ * This is the same 64-bit FNV-1a as the entry names.
+ *
+ * @param path  The path to the file
+ * @param hash  The hash of the file contents
+ *
+ * @return true if the file could be read
+ */
+static bool hash_file(const std::string& path, Uint64& hash) {
+    SDL_RWops* source = SDL_RWFromFile(path.c_str(),"rb");
+    if (source == nullptr) {
+        return false;
+    }
+    Uint8 buffer[4096];
+    size_t amount;
+    hash = 14695981039346656037ULL;
+    while ((amount = SDL_RWread(source,buffer,1,sizeof(buffer))) > 0) {
+        for(size_t ii = 0; ii < amount; ii++) {
+            hash ^= buffer[ii];
+            hash *= 1099511628211ULL;
+        }
+    }
+    SDL_RWclose(source);
+    return true;
+}
+
+/**
+ * Returns true if the size and modification time of the given file are known.
+ *
+ * @param path      The path to the file
+ * @param length    The size of the file in bytes
+ * @param modified  The modification time of the file
+ *
+ * @return true if the size and modification time of the given file are known.
+ */
+static bool stat_file(const std::string& path, Uint64& length, Uint64& modified) {
+#ifdef CU_STAT_BUNDLE
+    struct stat info;
+    if (stat(path.c_str(),&info) != 0) {
+        return false;
+    }
+    length = (Uint64)info.st_size;
+    modified = (Uint64)info.st_mtime;
+    return true;
+#else
+    return false;
+#endif
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Releases the bundle contents.
+ *
+ * Any image surfaces borrowed from this bundle are no longer valid.
+ */
+void AssetBundle::dispose() {
+    if (_data != nullptr) {
+#ifdef CU_MAP_BUNDLE
+        if (_mapped) {
+            munmap(_data,_size);
+        } else {
+            SDL_free(_data);
+        }
+#else
+        SDL_free(_data);
+#endif
+    }
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+    _slots = nullptr;
+    _mask = 0;
+    _count = 0;
+}
+
+/**
+ * Initializes a bundle from the file with the given path.
+ *
+ * The file is memory mapped if the platform allows it.
+ *
+ * @param file  The path to the bundle file
+ *
+ * @return true if the bundle was opened successfully
+ */
+bool AssetBundle::init(const std::string& file) {
+    if (_data != nullptr) {
+        CUAssertLog(false, "Bundle is already initialized");
+        return false;
+    }
+
+#ifdef CU_MAP_BUNDLE
+    int fd = open(file.c_str(),O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        if (fstat(fd,&info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr,(size_t)info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+            if (data != MAP_FAILED) {
+                _data = (Uint8*)data;
+                _size = (size_t)info.st_size;
+                _mapped = true;
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    if (_data == nullptr) {
+        SDL_RWops* source = SDL_RWFromFile(file.c_str(),"rb");
+        if (source == nullptr) {
+            CULogError("Could not open bundle '%s'",file.c_str());
+            return false;
+        }
+        Sint64 size = SDL_RWsize(source);
+        if (size > 0) {
+            _data = (Uint8*)SDL_malloc((size_t)size);
+            if (_data != nullptr && SDL_RWread(source,_data,1,(size_t)size) == (size_t)size) {
+                _size = (size_t)size;
+            } else {
+                SDL_free(_data);
+                _data = nullptr;
+            }
+        }
+        SDL_RWclose(source);
+    }
+
+    if (_data == nullptr || !validate()) {
+        CULogError("Could not read bundle '%s'",file.c_str());
+        dispose();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Initializes a bundle from the given file in the asset directory.
+ *
+ * The file is memory mapped if the platform allows it.
+ *
+ * @param file  The path to the bundle, relative to the asset directory
+ *
+ * @return true if the bundle was opened successfully
+ */
+bool AssetBundle::initWithAsset(const std::string& file) {
+    std::string directory = Application::get()->getAssetDirectory();
+    if (!init(directory+file)) {
+        return false;
+    }
+    if (!isCurrent(directory)) {
+        CULogError("Bundle '%s' is older than its assets",file.c_str());
+        dispose();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns true if the bundle contents have a valid header and index.
+ *
+ * @return true if the bundle contents have a valid header and index.
+ */
+bool AssetBundle::validate() {
+    if (_size < sizeof(Header)) {
+        return false;
+    }
+    const Header* header = (const Header*)_data;
+    if (std::memcmp(header->magic,"CUAB",4) != 0 || header->version != ASSET_BUNDLE_VERSION) {
+        return false;
+    }
+    if (header->slots == 0 || (header->slots & (header->slots-1)) != 0) {
+        return false;
+    }
+    // A full index would never end a probe
+    if (header->count >= header->slots || header->index % alignof(Slot) != 0) {
+        return false;
+    }
+    if (header->index > _size || (Uint64)header->slots*sizeof(Slot) > _size-header->index) {
+        return false;
+    }
+    if (header->names < header->index+(Uint64)header->slots*sizeof(Slot) || header->names > _size) {
+        return false;
+    }
+
+    // Every name must end inside the name block
+    const Slot* slots = (const Slot*)(_data+header->index);
+    const char* names = (const char*)(_data+header->names);
+    size_t length = (size_t)(_size-header->names);
+    Uint32 count = 0;
+    for(Uint32 ii = 0; ii < header->slots; ii++) {
+        const Slot* slot = slots+ii;
+        if (slot->type == Type::NONE) {
+            continue;
+        }
+        if (slot->name >= length || std::memchr(names+slot->name,'\0',length-slot->name) == nullptr) {
+            return false;
+        }
+        if (slot->offset > _size || slot->size > _size-slot->offset || slot->offset % 8 != 0) {
+            return false;
+        }
+        if (!validate(slot)) {
+            return false;
+        }
+        count++;
+    }
+    if (count != header->count) {
+        return false;
+    }
+
+    _slots = slots;
+    _mask  = header->slots-1;
+    _count = header->count;
+    return true;
+}
+
+/**
+ * Returns true if the given entry payload is well-formed.
+ *
+ * @param slot  The index slot of the entry
+ *
+ * @return true if the given entry payload is well-formed.
+ */
+bool AssetBundle::validate(const Slot* slot) const {
+    const Uint8* data = _data+slot->offset;
+    switch (slot->type) {
+        case Type::IMAGE:
+        {
+            if (slot->size < IMAGE_HEADER) {
+                return false;
+            }
+            const Uint32* header = (const Uint32*)data;
+            Uint64 width = header[0];
+            Uint64 height = header[1];
+            Uint64 pitch = header[2];
+            return (width > 0 && height > 0 && pitch >= width*4 && pitch <= INT_MAX &&
+                    height <= INT_MAX && pitch*height <= slot->size-IMAGE_HEADER);
+        }
+        case Type::SOUND:
+        {
+            if (slot->size < SOUND_HEADER) {
+                return false;
+            }
+            const Uint32* header = (const Uint32*)data;
+            Uint64 channels = header[0];
+            Uint64 frames = header[2];
+            return (channels > 0 && channels <= 255 &&
+                    channels*frames*sizeof(float) <= slot->size-SOUND_HEADER);
+        }
+        case Type::JSON:
+        {
+            if (slot->size < JSON_HEADER) {
+                return false;
+            }
+            const Uint32* header = (const Uint32*)data;
+            Uint64 total = header[0];
+            Uint64 length = header[1];
+            if (total*sizeof(JsonNode)+length > slot->size-JSON_HEADER) {
+                return false;
+            }
+
+            // Strings are NUL terminated, and children come after their parents
+            const JsonNode* nodes = (const JsonNode*)(data+JSON_HEADER);
+            const char* strings = (const char*)(nodes+total);
+            if (length > 0 && strings[length-1] != '\0') {
+                return false;
+            }
+            for(Uint32 ii = 0; ii < total; ii++) {
+                const JsonNode& node = nodes[ii];
+                if (node.key != JSON_NO_KEY && node.key >= length) {
+                    return false;
+                }
+                switch ((JsonValue::Type)node.type) {
+                    case JsonValue::Type::NullType:
+                    case JsonValue::Type::BoolType:
+                    case JsonValue::Type::NumberType:
+                        break;
+                    case JsonValue::Type::StringType:
+                        if ((Uint64)node.first+node.count >= length) {
+                            return false;
+                        }
+                        break;
+                    case JsonValue::Type::ArrayType:
+                    case JsonValue::Type::ObjectType:
+                        if (node.count > 0 && (node.first <= ii || (Uint64)node.first+node.count > total)) {
+                            return false;
+                        }
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+
+#pragma mark -
+#pragma mark Entries
+/**
+ * Returns the index slot for the given name, or nullptr if it is missing.
+ *
+ * @param name  The entry name
+ *
+ * @return the index slot for the given name, or nullptr if it is missing.
+ */
+const AssetBundle::Slot* AssetBundle::find(const std::string& name) const {
+    if (_slots == nullptr) {
+        return nullptr;
+    }
+    const char* names = (const char*)(_data+((const Header*)_data)->names);
+    Uint64 code = hash(name);
+    for(Uint32 ii = (Uint32)code & _mask; _slots[ii].type != Type::NONE; ii = (ii+1) & _mask) {
+        const Slot* slot = _slots+ii;
+        if (slot->hash == code && name == names+slot->name) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns true if every entry matches its source file in the directory.
+ *
+ * Each entry records the size, modification time and contents hash of
+ * the file it was built from.  A source file with a different size is
+ * out of date.  A source file with a different modification time is
+ * hashed, so that copying the asset folder does not invalidate the
+ * bundle.  Source files that are missing, or that cannot be examined
+ * (such as assets inside an Android APK), are assumed to match.
+ *
+ * @param directory The directory the entry names are relative to
+ *
+ * @return true if every entry matches its source file in the directory.
+ */
+bool AssetBundle::isCurrent(const std::string& directory) const {
+    if (_slots == nullptr) {
+        return false;
+    }
+    const char* names = (const char*)(_data+((const Header*)_data)->names);
+    for(Uint32 ii = 0; ii <= _mask; ii++) {
+        const Slot* slot = _slots+ii;
+        if (slot->type == Type::NONE || slot->modified == 0) {
+            continue;
+        }
+        std::string path = directory+(names+slot->name);
+        Uint64 length, modified, digest;
+        if (!stat_file(path,length,modified)) {
+            continue;
+        }
+        if (length != slot->length) {
+            return false;
+        }
+        if (modified != slot->modified && (!hash_file(path,digest) || digest != slot->digest)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the type of the entry with the given name.
+ *
+ * @param name  The asset path, relative to the asset directory
+ *
+ * @return the type of the entry with the given name (NONE if missing).
+ */
+AssetBundle::Type AssetBundle::getType(const std::string& name) const {
+    const Slot* slot = find(name);
+    return slot == nullptr ? Type::NONE : slot->type;
+}
+
+/**
+ * Returns a surface for the image with the given name.
+ *
+ * The surface has format SDL_PIXELFORMAT_RGBA32 and borrows its pixels
+ * from the bundle, so it must not be modified, and must not be used after
+ * this bundle is disposed.  The caller must free the surface itself.
+ *
+ * @param name  The asset path, relative to the asset directory
+ *
+ * @return a surface for the image (or nullptr if it is not an image).
+ */
+SDL_Surface* AssetBundle::getImage(const std::string& name) const {
+    const Slot* slot = find(name);
+    if (slot == nullptr || slot->type != Type::IMAGE) {
+        return nullptr;
+    }
+    const Uint32* header = (const Uint32*)(_data+slot->offset);
+    Uint8* pixels = _data+slot->offset+IMAGE_HEADER;
+    return SDL_CreateRGBSurfaceWithFormatFrom(pixels,(int)header[0],(int)header[1],32,
+                                              (int)header[2],SDL_PIXELFORMAT_RGBA32);
+}
+
+/**
+ * Returns the JSON node at the given index, with all of its descendants.
+ *
+ * @param nodes     The nodes of the tree
+ * @param strings   The string block of the tree
+ * @param index     The node index
+ *
+ * @return the JSON node at the given index, with all of its descendants.
+ */
+static std::shared_ptr<JsonValue> build_json(const AssetBundle::JsonNode* nodes,
+                                             const char* strings, Uint32 index) {
+    const AssetBundle::JsonNode& node = nodes[index];
+    std::shared_ptr<JsonValue> result;
+    switch ((JsonValue::Type)node.type) {
+        case JsonValue::Type::NullType:
+            return JsonValue::allocNull();
+        case JsonValue::Type::BoolType:
+            return JsonValue::alloc(node.number != 0);
+        case JsonValue::Type::NumberType:
+            return JsonValue::alloc(node.number);
+        case JsonValue::Type::StringType:
+            return JsonValue::alloc(std::string(strings+node.first,node.count));
+        case JsonValue::Type::ArrayType:
+            result = JsonValue::allocArray();
+            break;
+        case JsonValue::Type::ObjectType:
+            result = JsonValue::allocObject();
+            break;
+    }
+
+    for(Uint32 ii = node.first; ii < node.first+node.count; ii++) {
+        std::shared_ptr<JsonValue> child = build_json(nodes,strings,ii);
+        if (nodes[ii].key != JSON_NO_KEY) {
+            result->appendChild(strings+nodes[ii].key,child);
+        } else {
+            result->appendChild(child);
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the JSON tree with the given name.
+ *
+ * @param name  The asset path, relative to the asset directory
+ *
+ * @return the JSON tree (or nullptr if it is not a JSON entry).
+ */
+std::shared_ptr<JsonValue> AssetBundle::getJson(const std::string& name) const {
+    const Slot* slot = find(name);
+    if (slot == nullptr || slot->type != Type::JSON) {
+        return nullptr;
+    }
+    const Uint32* header = (const Uint32*)(_data+slot->offset);
+    const JsonNode* nodes = (const JsonNode*)(_data+slot->offset+JSON_HEADER);
+    const char* strings = (const char*)(nodes+header[0]);
+    return header[0] == 0 ? nullptr : build_json(nodes,strings,0);
+}
+
+/**
+ * Returns an in-memory sample with the sound of the given name.
+ *
+ * @param name  The asset path, relative to the asset directory
+ *
+ * @return an in-memory sample (or nullptr if it is not a sound entry).
+ */
+std::shared_ptr<AudioSample> AssetBundle::getSound(const std::string& name) const {
+    const Slot* slot = find(name);
+    if (slot == nullptr || slot->type != Type::SOUND) {
+        return nullptr;
+    }
+    const Uint32* header = (const Uint32*)(_data+slot->offset);
+    Uint32 channels = header[0];
+    Uint32 rate = header[1];
+    Uint32 frames = header[2];
+    std::shared_ptr<AudioSample> result = AudioSample::alloc((Uint8)channels,rate,frames);
+    if (result == nullptr || result->getBuffer() == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(result->getBuffer(),_data+slot->offset+SOUND_HEADER,
+                (size_t)channels*frames*sizeof(float));
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Bundle Writer
+/**
+ * Initializes a writer for a new bundle at the given path.
+ *
+ * Any existing file at that path is replaced.  If source is not empty,
+ * each entry records the file of that name in the source directory, so
+ * that {@link AssetBundle#isCurrent} can detect a stale bundle.
+ *
+ * @param file      The path to the bundle file
+ * @param source    The directory the entry names are relative to
+ *
+ * @return true if the file was created
+ */
+bool AssetBundleWriter::init(const std::string& file, const std::string& source) {
+    _source = source;
+    _file = SDL_RWFromFile(file.c_str(),"wb");
+    if (_file == nullptr) {
+        CULogError("Could not create bundle '%s'",file.c_str());
+        return false;
+    }
+
+    // The header is written on close
+    AssetBundle::Header header;
+    std::memset(&header,0,sizeof(header));
+    return SDL_RWwrite(_file,&header,sizeof(header),1) == 1;
+}
+
+/**
+ * Returns true if the bundle already has an entry with the given name.
+ *
+ * @param name  The entry name
+ *
+ * @return true if the bundle already has an entry with the given name.
+ */
+bool AssetBundleWriter::contains(const std::string& name) const {
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Writes a payload at the end of the file, adding it to the index.
+ *
+ * The payload is aligned to 16 bytes.
+ *
+ * @param name  The entry name
+ * @param type  The entry type
+ * @param parts The pieces of the payload, in order
+ *
+ * @return true if the payload was written
+ */
+bool AssetBundleWriter::write(const std::string& name, AssetBundle::Type type,
+                              const std::vector<std::pair<const void*,size_t>>& parts) {
+    if (_file == nullptr || contains(name)) {
+        return false;
+    }
+
+    static const Uint8 zeros[16] = {0};
+    Sint64 offset = SDL_RWtell(_file);
+    size_t pad = (size_t)((16-offset%16)%16);
+    if (pad && SDL_RWwrite(_file,zeros,1,pad) != pad) {
+        return false;
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.type = type;
+    entry.offset = (Uint64)(offset+pad);
+    entry.size = 0;
+    entry.modified = 0;
+    entry.length = 0;
+    entry.digest = 0;
+    if (!_source.empty()) {
+        std::string path = _source+name;
+        if (stat_file(path,entry.length,entry.modified) && !hash_file(path,entry.digest)) {
+            entry.modified = 0;
+        }
+    }
+    for(auto it = parts.begin(); it != parts.end(); ++it) {
+        if (it->second && SDL_RWwrite(_file,it->first,1,it->second) != it->second) {
+            return false;
+        }
+        entry.size += it->second;
+    }
+    _entries.push_back(entry);
+    return true;
+}
+
+/**
+ * Adds an image to the bundle.
+ *
+ * The image is converted to SDL_PIXELFORMAT_RGBA32, which is the layout
+ * that the texture loader uploads.
+ *
+ * @param name      The entry name
+ * @param surface   The image to add
+ *
+ * @return true if the image was added
+ */
+bool AssetBundleWriter::addImage(const std::string& name, SDL_Surface* surface) {
+    SDL_Surface* image = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_RGBA32,0);
+    if (image == nullptr) {
+        return false;
+    }
+
+    // Rows are written without padding
+    Uint32 header[4] = { (Uint32)image->w, (Uint32)image->h, (Uint32)image->w*4, 0 };
+    std::vector<std::pair<const void*,size_t>> parts;
+    parts.push_back(std::make_pair((const void*)header,sizeof(header)));
+    for(int ii = 0; ii < image->h; ii++) {
+        parts.push_back(std::make_pair((const void*)((Uint8*)image->pixels+ii*image->pitch),
+                                       (size_t)image->w*4));
+    }
+    bool result = write(name,AssetBundle::Type::IMAGE,parts);
+    SDL_FreeSurface(image);
+    return result;
+}
+
+/**
+ * Adds a JSON tree to the bundle.
+ *
+ * @param name  The entry name
+ * @param json  The JSON tree to add
+ *
+ * @return true if the tree was added
+ */
+bool AssetBundleWriter::addJson(const std::string& name, const std::shared_ptr<JsonValue>& json) {
+    if (json == nullptr) {
+        return false;
+    }
+
+    std::vector<AssetBundle::JsonNode> nodes;
+    std::string strings;
+    auto intern = [&](const std::string& value) {
+        Uint32 result = (Uint32)strings.size();
+        strings.append(value);
+        strings.push_back('\0');
+        return result;
+    };
+
+    // Breadth first, so that the children of each node are contiguous
+    std::deque<std::pair<JsonValue*,Uint32>> queue;
+    queue.push_back(std::make_pair(json.get(),0));
+    nodes.push_back(AssetBundle::JsonNode());
+    std::memset(&nodes.back(),0,sizeof(AssetBundle::JsonNode));
+    nodes.back().key = JSON_NO_KEY;
+    while (!queue.empty()) {
+        JsonValue* value = queue.front().first;
+        Uint32 index = queue.front().second;
+        queue.pop_front();
+
+        AssetBundle::JsonNode node = nodes[index];
+        node.type = (Uint32)value->type();
+        if (value->isBool()) {
+            node.number = value->asBool() ? 1 : 0;
+        } else if (value->isNumber()) {
+            node.number = value->asDouble();
+        } else if (value->isString()) {
+            std::string text = value->asString();
+            node.first = intern(text);
+            node.count = (Uint32)text.size();
+        } else if (value->isArray() || value->isObject()) {
+            node.first = (Uint32)nodes.size();
+            node.count = (Uint32)value->size();
+            for(int ii = 0; ii < (int)value->size(); ii++) {
+                JsonValue* child = value->get(ii).get();
+                AssetBundle::JsonNode entry;
+                std::memset(&entry,0,sizeof(entry));
+                entry.key = value->isObject() ? intern(child->key()) : JSON_NO_KEY;
+                nodes.push_back(entry);
+                queue.push_back(std::make_pair(child,(Uint32)nodes.size()-1));
+            }
+        }
+        nodes[index] = node;
+    }
+
+    Uint32 header[2] = { (Uint32)nodes.size(), (Uint32)strings.size() };
+    std::vector<std::pair<const void*,size_t>> parts;
+    parts.push_back(std::make_pair((const void*)header,sizeof(header)));
+    parts.push_back(std::make_pair((const void*)nodes.data(),nodes.size()*sizeof(AssetBundle::JsonNode)));
+    parts.push_back(std::make_pair((const void*)strings.data(),strings.size()));
+    return write(name,AssetBundle::Type::JSON,parts);
+}
+
+/**
+ * Adds an in-memory sound sample to the bundle.
+ *
+ * Streamed samples have no decoded buffer, and cannot be added.
+ *
+ * @param name      The entry name
+ * @param sample    The sample to add
+ *
+ * @return true if the sample was added
+ */
+bool AssetBundleWriter::addSound(const std::string& name, const std::shared_ptr<AudioSample>& sample) {
+    if (sample == nullptr || sample->isStreamed() || sample->getBuffer() == nullptr) {
+        return false;
+    }
+
+    Uint32 header[4] = { sample->getChannels(), sample->getRate(), (Uint32)sample->getLength(), 0 };
+    std::vector<std::pair<const void*,size_t>> parts;
+    parts.push_back(std::make_pair((const void*)header,sizeof(header)));
+    parts.push_back(std::make_pair((const void*)sample->getBuffer(),
+                                   (size_t)header[0]*header[2]*sizeof(float)));
+    return write(name,AssetBundle::Type::SOUND,parts);
+}
+
+/**
+ * Writes the index and closes the bundle.
+ *
+ * @return true if the bundle was written successfully
+ */
+bool AssetBundleWriter::close() {
+    if (_file == nullptr) {
+        return false;
+    }
+
+    // Keep the index at most half full so probes stay short
+    Uint32 slots = 16;
+    while (slots < 2*_entries.size()) {
+        slots *= 2;
+    }
+
+    std::string names;
+    std::vector<AssetBundle::Slot> index(slots);
+    std::memset(index.data(),0,slots*sizeof(AssetBundle::Slot));
+    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+        Uint64 code = AssetBundle::hash(it->name);
+        Uint32 ii = (Uint32)code & (slots-1);
+        while (index[ii].type != AssetBundle::Type::NONE) {
+            ii = (ii+1) & (slots-1);
+        }
+        index[ii].hash = code;
+        index[ii].name = (Uint32)names.size();
+        index[ii].type = it->type;
+        index[ii].offset = it->offset;
+        index[ii].size = it->size;
+        index[ii].modified = it->modified;
+        index[ii].length = it->length;
+        index[ii].digest = it->digest;
+        names.append(it->name);
+        names.push_back('\0');
+    }
+
+    bool success = true;
+    AssetBundle::Header header;
+    std::memcpy(header.magic,"CUAB",4);
+    header.version = ASSET_BUNDLE_VERSION;
+    header.slots = slots;
+    header.count = (Uint32)_entries.size();
+
+    // The index is aligned like the payloads
+    static const Uint8 zeros[16] = {0};
+    Sint64 offset = SDL_RWtell(_file);
+    size_t pad = (size_t)((16-offset%16)%16);
+    success = success && (!pad || SDL_RWwrite(_file,zeros,1,pad) == pad);
+    header.index = (Uint64)(offset+pad);
+    success = success && SDL_RWwrite(_file,index.data(),sizeof(AssetBundle::Slot),slots) == slots;
+    header.names = header.index+slots*sizeof(AssetBundle::Slot);
+    success = success && SDL_RWwrite(_file,names.data(),1,names.size()) == names.size();
+    success = success && SDL_RWseek(_file,0,RW_SEEK_SET) == 0;
+    success = success && SDL_RWwrite(_file,&header,sizeof(header),1) == 1;
+
+    SDL_RWclose(_file);
+    _file = nullptr;
+    _entries.clear();
+    return success;
+}
@@ -52,11 +52,12 @@ using namespace cugl;
 #pragma mark -
 #pragma mark Constructors
 /**
- * Initializes a new asset manager with two auxiliary threads.
+ * Initializes a new asset manager with one thread per spare core.
  *
- * The asset manager will have a thread pool of size 2, giving it two
- * threads to load assets asynchronously.  These threads have no effect on
- * synchronous loading and will sleep when no assets are being loaded.
+ * The asset manager will have a thread pool with one thread for every
+ * core but the one running the main thread (and at least one thread).
+ * These threads have no effect on synchronous loading and will sleep
+ * when no assets are being loaded.
  *
  * This initializer does not attach any loaders.  It simply creates an
  * object that is ready to accept loader objects.
@@ -64,7 +65,35 @@ using namespace cugl;
  * @return true if the asset manager was initialized successfully
  */
 bool AssetManager::init() {
-    _workers = ThreadPool::alloc(1);
+    Uint32 cores = std::thread::hardware_concurrency();
+    return init(cores > 1 ? cores-1 : 1);
+}
+
+/**
+ * Initializes a new asset manager with the given number of auxiliary threads.
+ *
+ * The asset manager will have a thread pool of the given size, allowing it
+ * load assets asynchronously.  These threads have no effect on synchronous
+ * loading and will sleep when no assets are being loaded.  If threads is
+ * 0, all assets must be loaded synchronously.
+ *
+ * This initializer does not attach any loaders.  It simply creates an
+ * object that is ready to accept loader objects.
+ *
+ * @param threads   The number of threads for asynchronous loading
+ *
+ * @return true if the asset manager was initialized successfully
+ */
+bool AssetManager::init(Uint32 threads) {
+    if (threads > 0) {
+        _workers = ThreadPool::alloc(threads);
+        if (_workers == nullptr) {
+            return false;
+        }
+    }
+    addDependency<scene2::SceneNode,Texture>();
+    addDependency<scene2::SceneNode,Font>();
+    addDependency<scene2::SceneNode,WidgetValue>();
     return true;
 }
 
@@ -77,7 +106,53 @@ bool AssetManager::init() {
  */
 void AssetManager::dispose() {
     detachAll();
+    _deferred.clear();
+    _dependencies.clear();
     _workers = nullptr;
+    _bundle = nullptr;
+}
+
+#pragma mark -
+#pragma mark Bundle Support
+/**
+ * Returns the JSON tree for the given file.
+ *
+ * The file is taken from the asset bundle if it is there.  Otherwise it
+ * is read from the asset directory.  This method is safe to call from
+ * any thread.
+ *
+ * @param file  The path to the file, relative to the asset directory
+ *
+ * @return the JSON tree for the given file (or nullptr if it is missing).
+ */
+std::shared_ptr<JsonValue> AssetManager::readJson(const std::string& file) const {
+    if (_bundle != nullptr) {
+        std::shared_ptr<JsonValue> json = _bundle->getJson(file);
+        if (json != nullptr) {
+            return json;
+        }
+    }
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(file);
+    return (reader == nullptr ? nullptr : reader->readJson());
+}
+
+/**
+ * Returns the JSON tree for the given file.
+ *
+ * If this loader is attached to an asset manager, the file is taken from
+ * its asset bundle when it is there.  Otherwise it is read from the asset
+ * directory.  This method is safe to call from any thread.
+ *
+ * @param source    The path to the file, relative to the asset directory
+ *
+ * @return the JSON tree for the given file (or nullptr if it is missing).
+ */
+std::shared_ptr<JsonValue> BaseLoader::readJson(const std::string& source) const {
+    if (_manager != nullptr) {
+        return _manager->readJson(source);
+    }
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+    return (reader == nullptr ? nullptr : reader->readJson());
 }
 
 #pragma mark -
@@ -161,7 +236,7 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
 void AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& json,
                                 LoaderCallback callback) {
     auto it = _handlers.find(hash);
-    std::shared_ptr<BaseLoader> loader = it->second;
+    std::shared_ptr<BaseLoader> loader = (it == _handlers.end() ? nullptr : it->second);
     if (loader == nullptr) {
         if (callback) {
             Application::get()->schedule([=] {
@@ -212,49 +287,54 @@ bool AssetManager::purgeCategory(size_t hash, const std::shared_ptr<JsonValue>&
 }
 
 /**
- * Synchronizes the asset manager to wait until all assets have finished.
+ * Returns true if no asset type that this one depends upon is loading.
  *
- * This method is necessary for assets whose construction depends on
- * previously loaded assets (e.g. scene graphs).  In the current architecture,
- * this method is only correct if the asset manager loads assets in a
- * single thread.
- */
-void AssetManager::sync() {
-    _workers->addTask([=](void) {
-        this->block();
-        this->block(); // Two blocks force one complete cycle
-    });
-}
-
-/**
- * Blocks the asset manager until the next animation frame.
+ * The dependencies of an asset type are specified by {@link addDependency}.
+ * Types without an attached loader are never pending.  This method reads
+ * the loader queues, so it should only be called in the main thread.
  *
- * Any assets queued after a block will not be added to thread pool
- * until at least one animation frame has passed.  This method is used
- * to implement the {@link sync()} method.
+ * @param hash      The hash of the asset type
+ *
+ * @return true if no asset type that this one depends upon is loading.
  */
-void AssetManager::block() {
-    Application::get()->schedule([=](void){
-        this->resume();
-        return false;
-    });
-    _wait = true;
-    while (_wait) {
-        int delay = (int)(500/Application::get()->getFPS());
-        SDL_Delay(delay);
+bool AssetManager::isReady(size_t hash) const {
+    auto jt = _dependencies.find(hash);
+    if (jt == _dependencies.end()) {
+        return true;
+    }
+    for(auto kt = jt->second.begin(); kt != jt->second.end(); ++kt) {
+        auto it = _handlers.find(*kt);
+        if (it != _handlers.end() && it->second->waitCount() > 0) {
+            return false;
+        }
     }
-    return;
+    return true;
 }
 
 /**
- * Resumes a previously blocked the asset manager.
+ * Reads every deferred category whose dependencies have finished.
  *
- * Any assets queued after a block will not be added to thread pool
- * until at least one animation frame has passed.  This method is used
- * to implement the {@link sync()} method.
+ * A directory category that depends on other asset types (e.g. scene
+ * graphs, which need their textures and fonts) is not given to its loader
+ * until those types have finished.  This method is called in the main
+ * thread each time a dependency finishes, so no worker thread is ever
+ * parked waiting on the main thread.
  */
-void AssetManager::resume() {
-    _wait = false;
+void AssetManager::release() {
+    // Collect first, as reading a category may call back into this manager
+    std::vector<Deferred> ready;
+    for(auto it = _deferred.begin(); it != _deferred.end(); ) {
+        if (isReady(it->hash)) {
+            ready.push_back(*it);
+            it = _deferred.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for(auto it = ready.begin(); it != ready.end(); ++it) {
+        readCategory(it->hash,it->json,it->callback);
+        _preload--;
+    }
 }
 
 #pragma mark -
@@ -334,13 +414,12 @@ bool AssetManager::loadDirectory(const std::shared_ptr<JsonValue>& json) {
  * @return true if all assets specified in the directory were successfully loaded.
  */
 bool AssetManager::loadDirectory(const std::string& directory) {
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
-    if (reader == nullptr) {
+    std::shared_ptr<JsonValue> json = readJson(directory);
+    if (json == nullptr) {
         CULogError("No asset directory located at '%s'",directory.c_str());
         return false;
     }
     
-    std::shared_ptr<JsonValue> json = reader->readJson();
     return loadDirectory(json);
 }
 
@@ -368,38 +447,71 @@ bool AssetManager::loadDirectory(const std::string& directory) {
  * You may either poll this interface to determine when the assets are
  * loaded or use optional callbacks.
  *
+ * A category that depends on other asset types (see {@link addDependency})
+ * is not given to its loader until those types have finished loading.
+ * By default, scene graphs wait on textures, fonts and widgets.
+ *
  * The optional callback function will be called each time an individual
  * asset loads or fails to load.  However, if the entire category fails
  * to load, the callback function will be given the asset category name
  * (e.g. "soundfx") as the asset key.
  *
+ * This method must be called in the main thread, as that is where the
+ * loaders queue their assets. Only the decoding runs in the workers.
+ *
  * @param json      The JSON asset directory
  * @param callback  An optional callback after each asset is loaded
  */
 void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, LoaderCallback callback) {
+    // Each finished asset may release a category that depends on it. Loaders
+    // call back before they dequeue the asset, so check on the next frame.
+    LoaderCallback notify = [=](const std::string& key, bool success) {
+        if (callback != nullptr) {
+            callback(key,success);
+        }
+        if (!_deferred.empty()) {
+            Application::get()->schedule([=](void) {
+                this->release();
+                return false;
+            });
+        }
+    };
+    
+    std::vector<Deferred> deferred;
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
+        size_t hash = 0;
         if (child->key() == "textures") {
-            readCategory(typeid(Texture).hash_code(),child,callback);
+            hash = typeid(Texture).hash_code();
         } else if (child->key() == "sounds") {
-            readCategory(typeid(Sound).hash_code(),child,callback);
+            hash = typeid(Sound).hash_code();
         } else if (child->key() == "fonts") {
-            readCategory(typeid(Font).hash_code(),child,callback);
+            hash = typeid(Font).hash_code();
         } else if (child->key() == "jsons") {
-            readCategory(typeid(JsonValue).hash_code(),child,callback);
+            hash = typeid(JsonValue).hash_code();
         } else if (child->key() == "widgets") {
-            readCategory(typeid(WidgetValue).hash_code(),child,callback);
-        } else if (child->key() != "scene2s") {
+            hash = typeid(WidgetValue).hash_code();
+        } else if (child->key() == "scene2s") {
+            hash = typeid(scene2::SceneNode).hash_code();
+        } else {
             CULogError("Unknown asset category '%s'",child->key().c_str());
+            continue;
+        }
+        
+        if (_dependencies.find(hash) == _dependencies.end()) {
+            readCategory(hash,child,notify);
+        } else {
+            deferred.push_back({hash,child,notify});
         }
     }
     
-    // Scenes are read after everything else.
-    std::shared_ptr<JsonValue> child = json->get("scene2s");
-    sync();
-    if (child) {
-        readCategory(typeid(scene2::SceneNode).hash_code(),child,callback);
+    if (deferred.empty()) {
+        return;
     }
+    
+    _preload += (Uint32)deferred.size();
+    _deferred.insert(_deferred.end(),deferred.begin(),deferred.end());
+    release();
 }
 
 /**
@@ -426,6 +538,10 @@ void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, Lo
  * You may either poll this interface to determine when the assets are
  * loaded or use optional callbacks.
  *
+ * A category that depends on other asset types (see {@link addDependency})
+ * is not given to its loader until those types have finished loading.
+ * By default, scene graphs wait on textures, fonts and widgets.
+ *
  * The optional callback function will be called each time an individual
  * asset loads or fails to load.  However, if the entire category fails
  * to load, the callback function will be given the asset category name
@@ -435,18 +551,39 @@ void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, Lo
  * @param callback  An optional callback after each asset is loaded
  */
 void AssetManager::loadDirectoryAsync(const std::string& directory, LoaderCallback callback) {
-    _preload = true;
+    // A bundled directory needs no reader
+    std::shared_ptr<AssetBundle> bundle = _bundle;
+    std::shared_ptr<JsonReader> reader;
+    if (bundle == nullptr || bundle->getType(directory) != AssetBundle::Type::JSON) {
+        bundle = nullptr;
+        reader = JsonReader::allocWithAsset(directory);
+        if (reader == nullptr) {
+            if (callback != nullptr) {
+                callback("",false);
+            }
+            return;
+        }
+    }
     
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
-    if (reader == nullptr && callback != nullptr) {
-        callback("",false);
+    if (_workers == nullptr) {
+        loadDirectoryAsync(reader ? reader->readJson() : bundle->getJson(directory),callback);
         return;
     }
     
+    // Only the parse runs in the worker. The loaders queue their assets in
+    // read(), which is not thread safe, so that happens in the main thread.
+    _preload++;
     _workers->addTask([=](void) {
-        std::shared_ptr<JsonValue> json = reader->readJson();
-        loadDirectoryAsync(json,callback);
-        _preload = false;
+        std::shared_ptr<JsonValue> json = reader ? reader->readJson() : bundle->getJson(directory);
+        Application::get()->schedule([=](void) {
+            if (json != nullptr) {
+                this->loadDirectoryAsync(json,callback);
+            } else if (callback != nullptr) {
+                callback("",false);
+            }
+            this->_preload--;
+            return false;
+        });
     });
 }
 
@@ -496,13 +633,12 @@ bool AssetManager::unloadDirectory(const std::shared_ptr<JsonValue>& json) {
  * @param directory The path to the JSON asset directory
  */
 bool AssetManager::unloadDirectory(const std::string& directory) {
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
-    if (reader == nullptr) {
+    std::shared_ptr<JsonValue> json = readJson(directory);
+    if (json == nullptr) {
         CULogError("No asset directory located at '%s'",directory.c_str());
         return false;
     }
     
-    std::shared_ptr<JsonValue> json = reader->readJson();
     return unloadDirectory(json);
 }
 
@@ -546,5 +682,25 @@ size_t AssetManager::waitCount() const {
     for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
         result += it->second->waitCount();
     }
-    return _preload ? result+1 : result;
+    return _preload > 0 ? result+1 : result;
+}
+
+/**
+ * Returns the number of waiting assets, counting each by the fraction loaded.
+ *
+ * Most assets finish loading all at once, and so count as 0 until they
+ * are loaded.  Textures are uploaded over several frames, and count by
+ * the fraction of rows uploaded.  This allows a progress bar to move
+ * while they load.
+ *
+ * The value returned is the sum of the partialCount for all attached loaders.
+ *
+ * @return the number of waiting assets, counting each by the fraction loaded.
+ */
+float AssetManager::partialCount() const {
+    float result = 0;
+    for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+        result += it->second->partialCount();
+    }
+    return result;
 }
@@ -46,6 +46,7 @@
 #include <cugl/assets/CUFontLoader.h>
 #include <cugl/base/CUApplication.h>
 #include <SDL/SDL_ttf.h>
+#include <mutex>
 
 using namespace cugl;
 
@@ -68,6 +69,8 @@ using namespace cugl;
 FontLoader::FontLoader() : Loader<Font>(),
 _fontsize(UNKNOWN_SIZE),
 _charset(UNKNOWN_CHARS) {
+    // Scene graphs wait on fonts
+    _priority = 2;
 }
 
 
@@ -98,7 +101,14 @@ std::shared_ptr<Font> FontLoader::preload(const std::string& source, const std::
     
     std::string path = Application::get()->getAssetDirectory();
     path.append(source);
-    std::shared_ptr<Font> result = Font::alloc(path.c_str(),size);
+    std::shared_ptr<Font> result;
+    {
+        // FreeType shares one library between faces, so opening one is not
+        // thread-safe.  Rasterizing the atlas below is.
+        static std::mutex faceMutex;
+        std::unique_lock<std::mutex> lk(faceMutex);
+        result = Font::alloc(path.c_str(),size);
+    }
     if (result == nullptr) {
         return result;
     }
@@ -186,7 +196,7 @@ bool FontLoader::read(const std::string& key, const std::string& source, int siz
                 this->materialize(key,font,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -243,7 +253,7 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
                 this->materialize(key,font,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
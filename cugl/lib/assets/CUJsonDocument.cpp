@@ -0,0 +1,779 @@
+//
+//  CUJsonDocument.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a read-only JSON DOM for large or frequently read
+//  files.  JsonValue allocates every node separately, converting from a cJSON
+//  tree that is itself allocated node by node, and looks up object members by
+//  a linear scan of string compares.  A JsonDocument instead parses the text
+//  directly into a single array of nodes, with every string unescaped into
+//  one pool.  Object keys are interned, and each object keeps its members
+//  sorted by key, so a lookup is one hash and a binary search.
+//
+//  Nodes are accessed through lightweight handles that refer back to the
+//  document.  Strings are returned as views into the pool, so reading them
+//  copies nothing.  Handles and views are only valid while the document is.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/assets/CUJsonDocument.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/** A node with no key (or a failed parse) */
+#define JSON_NO_KEY     0xFFFFFFFF
+/** Objects with at most this many members are searched without the index */
+#define JSON_LINEAR_LOOKUP  8
+
+using namespace cugl;
+
+#pragma mark Node Access
+/**
+ * Returns the type of this node.
+ *
+ * A handle that refers to no node is a NullType.
+ *
+ * @return the type of this node.
+ */
+JsonValue::Type JsonDocument::Node::type() const {
+    return _doc == nullptr ? JsonValue::Type::NullType : _doc->_nodes[_index].type;
+}
+
+/**
+ * Returns the key of this node in its parent object.
+ *
+ * If the parent is not an object, or this handle is invalid, the key
+ * is empty.
+ *
+ * @return the key of this node in its parent object.
+ */
+std::string_view JsonDocument::Node::key() const {
+    if (_doc == nullptr || _doc->_nodes[_index].key == JSON_NO_KEY) {
+        return std::string_view();
+    }
+    const std::pair<Uint32,Uint32>& key = _doc->_keys[_doc->_nodes[_index].key];
+    return std::string_view(_doc->_strings.data()+key.first,key.second);
+}
+
+/**
+ * Returns this node as a string view.
+ *
+ * If the node is not a string, this method returns the default value.
+ * The view refers to the document, and is not copied.
+ *
+ * @param defaultValue  The value to return if the node is not a string
+ *
+ * @return this node as a string view.
+ */
+std::string_view JsonDocument::Node::asString(std::string_view defaultValue) const {
+    if (type() != JsonValue::Type::StringType) {
+        return defaultValue;
+    }
+    const Entry& entry = _doc->_nodes[_index];
+    return std::string_view(_doc->_strings.data()+entry.first,entry.count);
+}
+
+/**
+ * Returns this node as a double.
+ *
+ * If the node is not a number, this method returns the default value.
+ *
+ * @param defaultValue  The value to return if the node is not a number
+ *
+ * @return this node as a double.
+ */
+double JsonDocument::Node::asDouble(double defaultValue) const {
+    return type() == JsonValue::Type::NumberType ? _doc->_nodes[_index].number : defaultValue;
+}
+
+/**
+ * Returns this node as a boolean.
+ *
+ * If the node is not a boolean, this method returns the default value.
+ *
+ * @param defaultValue  The value to return if the node is not a boolean
+ *
+ * @return this node as a boolean.
+ */
+bool JsonDocument::Node::asBool(bool defaultValue) const {
+    return type() == JsonValue::Type::BoolType ? _doc->_nodes[_index].number != 0 : defaultValue;
+}
+
+/**
+ * Returns the number of children of this node.
+ *
+ * Only arrays and objects have children.
+ *
+ * @return the number of children of this node.
+ */
+size_t JsonDocument::Node::size() const {
+    JsonValue::Type kind = type();
+    if (kind == JsonValue::Type::ArrayType || kind == JsonValue::Type::ObjectType) {
+        return _doc->_nodes[_index].count;
+    }
+    return 0;
+}
+
+/**
+ * Returns the child at the given position.
+ *
+ * Children of objects are in the order of the document.  If there is
+ * no such child, the handle returned is invalid.
+ *
+ * @param index The child position
+ *
+ * @return the child at the given position.
+ */
+JsonDocument::Node JsonDocument::Node::get(size_t index) const {
+    if (index >= size()) {
+        return Node();
+    }
+    return Node(_doc,_doc->_links[_doc->_nodes[_index].first+index]);
+}
+
+/**
+ * Returns the child with the given key.
+ *
+ * If an object has several children with this key, this returns the
+ * first one.  If there is no such child, or this node is not an
+ * object, the handle returned is invalid.
+ *
+ * @param key   The child key
+ *
+ * @return the child with the given key.
+ */
+JsonDocument::Node JsonDocument::Node::get(std::string_view key) const {
+    if (type() != JsonValue::Type::ObjectType) {
+        return Node();
+    }
+
+    // Comparing a few keys is cheaper than hashing one
+    const std::vector<Entry>& nodes = _doc->_nodes;
+    const Entry& entry = nodes[_index];
+    if (entry.count <= JSON_LINEAR_LOOKUP) {
+        for(Uint32 ii = entry.first; ii < entry.first+entry.count; ii++) {
+            const std::pair<Uint32,Uint32>& name = _doc->_keys[nodes[_doc->_links[ii]].key];
+            if (name.second == key.size() &&
+                std::memcmp(_doc->_strings.data()+name.first,key.data(),key.size()) == 0) {
+                return Node(_doc,_doc->_links[ii]);
+            }
+        }
+        return Node();
+    }
+
+    // A key that was never interned is in no object
+    auto it = _doc->_keyIds.find(key);
+    if (it == _doc->_keyIds.end()) {
+        return Node();
+    }
+
+    Uint32 id = it->second;
+    auto begin = _doc->_sorted.begin()+entry.first;
+    auto end = begin+entry.count;
+    auto pos = std::lower_bound(begin, end, id, [&](Uint32 child, Uint32 value) {
+        return nodes[child].key < value;
+    });
+    if (pos == end || nodes[*pos].key != id) {
+        return Node();
+    }
+    return Node(_doc,*pos);
+}
+
+/**
+ * Returns a newly allocated copy of this subtree as a JsonValue.
+ *
+ * This allows part of a document to be passed to an interface that
+ * expects a {@link JsonValue}.  If this handle is invalid, this
+ * method returns nullptr.
+ *
+ * @return a newly allocated copy of this subtree as a JsonValue.
+ */
+std::shared_ptr<JsonValue> JsonDocument::Node::toJsonValue() const {
+    if (_doc == nullptr) {
+        return nullptr;
+    }
+
+    std::shared_ptr<JsonValue> result;
+    switch (type()) {
+        case JsonValue::Type::NullType:
+            return JsonValue::allocNull();
+        case JsonValue::Type::BoolType:
+            return JsonValue::alloc(asBool());
+        case JsonValue::Type::NumberType:
+            return JsonValue::alloc(asDouble());
+        case JsonValue::Type::StringType:
+            return JsonValue::alloc(std::string(asString()));
+        case JsonValue::Type::ArrayType:
+            result = JsonValue::allocArray();
+            break;
+        case JsonValue::Type::ObjectType:
+            result = JsonValue::allocObject();
+            break;
+    }
+
+    bool object = isObject();
+    for(size_t ii = 0; ii < size(); ii++) {
+        Node child = get(ii);
+        if (object) {
+            result->appendChild(std::string(child.key()),child.toJsonValue());
+        } else {
+            result->appendChild(child.toJsonValue());
+        }
+    }
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this document.
+ *
+ * Every handle and string view taken from this document is invalid
+ * afterwards.  A disposed document can be safely reinitialized.
+ */
+void JsonDocument::dispose() {
+    _nodes.clear();
+    _links.clear();
+    _sorted.clear();
+    _strings.clear();
+    _keys.clear();
+    _keyIds.clear();
+    _scratch.clear();
+    _begin = nullptr;
+    _cursor = nullptr;
+    _end = nullptr;
+}
+
+/**
+ * Initializes a document from the given JSON text.
+ *
+ * If there is a parsing error, this method will return false.  Detailed
+ * information about the parsing error will be passed to an assert.  Hence
+ * error messages are suppressed if asserts are turned off.
+ *
+ * @param json      The JSON text
+ * @param length    The number of characters in the text
+ *
+ * @return true if the document was parsed successfully
+ */
+bool JsonDocument::init(const char* json, size_t length) {
+    if (!_nodes.empty()) {
+        CUAssertLog(false, "Document is already initialized");
+        return false;
+    }
+
+    // An unescaped string (plus terminator) is never longer than its quoted
+    // text, so the pool never reallocates and the interned views stay valid
+    _strings.reserve(length+1);
+    _nodes.reserve(length/32+1);
+    _begin  = json;
+    _cursor = json;
+    _end = json+length;
+    if (length >= 3 && std::memcmp(json,"\xEF\xBB\xBF",3) == 0) {
+        _cursor += 3;
+    }
+
+    bool success = parseValue(JSON_NO_KEY,0) != JSON_NO_KEY;
+    if (success) {
+        skipSpace();
+        if (_cursor != _end) {
+            fail("Unexpected text after JSON");
+            success = false;
+        }
+    }
+
+    std::vector<Uint32>().swap(_scratch);
+    _begin = nullptr;
+    _cursor = nullptr;
+    _end = nullptr;
+    if (!success) {
+        dispose();
+    }
+    return success;
+}
+
+/**
+ * Initializes a document from the JSON file at the given path.
+ *
+ * The file is read in one pass and parsed directly.
+ *
+ * @param file      The path to the file
+ *
+ * @return true if the document was read and parsed successfully
+ */
+bool JsonDocument::initWithFile(const std::string& file) {
+    SDL_RWops* source = SDL_RWFromFile(file.c_str(),"rb");
+    if (source == nullptr) {
+        CULogError("Could not open JSON file '%s'",file.c_str());
+        return false;
+    }
+
+    std::string text;
+    Sint64 size = SDL_RWsize(source);
+    if (size > 0) {
+        text.resize((size_t)size);
+        text.resize(SDL_RWread(source,&text[0],1,(size_t)size));
+    }
+    SDL_RWclose(source);
+    return init(text);
+}
+
+/**
+ * Initializes a document from the given file in the asset directory.
+ *
+ * The file is read in one pass and parsed directly.
+ *
+ * @param file      The path to the file, relative to the asset directory
+ *
+ * @return true if the document was read and parsed successfully
+ */
+bool JsonDocument::initWithAsset(const std::string& file) {
+    std::string path = Application::get()->getAssetDirectory();
+    path.append(file);
+    return initWithFile(path);
+}
+
+
+#pragma mark -
+#pragma mark Parsing
+/**
+ * Parses the value at the cursor, returning its node index.
+ *
+ * @param key   The key id of this value (or JSON_NO_KEY)
+ * @param depth The nesting depth of this value
+ *
+ * @return the node index, or JSON_NO_KEY on an error
+ */
+Uint32 JsonDocument::parseValue(Uint32 key, Uint32 depth) {
+    skipSpace();
+    if (_cursor == _end) {
+        fail("Unexpected end of JSON");
+        return JSON_NO_KEY;
+    }
+
+    Uint32 index = (Uint32)_nodes.size();
+    Entry entry;
+    entry.type = JsonValue::Type::NullType;
+    entry.key = key;
+    entry.first = 0;
+    entry.count = 0;
+    entry.number = 0;
+    _nodes.push_back(entry);
+
+    size_t left = _end-_cursor;
+    bool success = true;
+    switch (*_cursor) {
+        case '{':
+            _nodes[index].type = JsonValue::Type::ObjectType;
+            success = parseContainer(index,depth);
+            break;
+        case '[':
+            _nodes[index].type = JsonValue::Type::ArrayType;
+            success = parseContainer(index,depth);
+            break;
+        case '"':
+            _nodes[index].type = JsonValue::Type::StringType;
+            success = parseString(_nodes[index].first,_nodes[index].count);
+            break;
+        case 't':
+            success = left >= 4 && std::memcmp(_cursor,"true",4) == 0;
+            if (success) {
+                _nodes[index].type = JsonValue::Type::BoolType;
+                _nodes[index].number = 1;
+                _cursor += 4;
+            }
+            break;
+        case 'f':
+            success = left >= 5 && std::memcmp(_cursor,"false",5) == 0;
+            if (success) {
+                _nodes[index].type = JsonValue::Type::BoolType;
+                _cursor += 5;
+            }
+            break;
+        case 'n':
+            success = left >= 4 && std::memcmp(_cursor,"null",4) == 0;
+            if (success) {
+                _cursor += 4;
+            }
+            break;
+        default:
+            if (*_cursor == '-' || (*_cursor >= '0' && *_cursor <= '9')) {
+                _nodes[index].type = JsonValue::Type::NumberType;
+                success = parseNumber(_nodes[index].number);
+            } else {
+                success = false;
+            }
+            break;
+    }
+
+    if (!success) {
+        // Containers and strings report their own errors
+        if (_nodes[index].type == JsonValue::Type::NullType ||
+            _nodes[index].type == JsonValue::Type::BoolType) {
+            fail("Invalid token");
+        }
+        return JSON_NO_KEY;
+    }
+    return index;
+}
+
+/**
+ * Parses the array or object at the cursor into the given node.
+ *
+ * @param index The node index
+ * @param depth The nesting depth of this container
+ *
+ * @return true if the container was parsed
+ */
+bool JsonDocument::parseContainer(Uint32 index, Uint32 depth) {
+    if (depth >= JSON_MAX_DEPTH) {
+        fail("JSON is nested too deeply");
+        return false;
+    }
+
+    bool object = (*_cursor == '{');
+    char close = object ? '}' : ']';
+    _cursor++;
+
+    size_t mark = _scratch.size();
+    skipSpace();
+    if (_cursor != _end && *_cursor == close) {
+        _cursor++;
+    } else {
+        while (true) {
+            Uint32 key = JSON_NO_KEY;
+            if (object) {
+                skipSpace();
+                if (_cursor == _end || *_cursor != '"') {
+                    fail("Expected a key");
+                    return false;
+                }
+                Uint32 offset, length;
+                if (!parseString(offset,length)) {
+                    return false;
+                }
+                key = internKey(offset,length);
+                skipSpace();
+                if (_cursor == _end || *_cursor != ':') {
+                    fail("Expected ':'");
+                    return false;
+                }
+                _cursor++;
+            }
+
+            Uint32 child = parseValue(key,depth+1);
+            if (child == JSON_NO_KEY) {
+                return false;
+            }
+            _scratch.push_back(child);
+
+            skipSpace();
+            if (_cursor != _end && *_cursor == ',') {
+                _cursor++;
+            } else if (_cursor != _end && *_cursor == close) {
+                _cursor++;
+                break;
+            } else {
+                fail(object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+                return false;
+            }
+        }
+    }
+
+    // The children are only contiguous once the container is closed
+    Entry& entry = _nodes[index];
+    entry.first = (Uint32)_links.size();
+    entry.count = (Uint32)(_scratch.size()-mark);
+    _links.insert(_links.end(),_scratch.begin()+mark,_scratch.end());
+    _sorted.insert(_sorted.end(),_scratch.begin()+mark,_scratch.end());
+    _scratch.resize(mark);
+
+    // Ties go in document order, so that a lookup finds the first duplicate
+    if (object && entry.count > JSON_LINEAR_LOOKUP) {
+        const std::vector<Entry>& nodes = _nodes;
+        std::sort(_sorted.begin()+entry.first, _sorted.end(), [&](Uint32 a, Uint32 b) {
+            return nodes[a].key != nodes[b].key ? nodes[a].key < nodes[b].key : a < b;
+        });
+    }
+    return true;
+}
+
+/**
+ * Parses the string at the cursor into the string pool.
+ *
+ * The string is unescaped and null terminated in the pool.
+ *
+ * @param offset    Set to the offset of the string in the pool
+ * @param length    Set to the length of the string
+ *
+ * @return true if the string was parsed
+ */
+bool JsonDocument::parseString(Uint32& offset, Uint32& length) {
+    _cursor++;
+    offset = (Uint32)_strings.size();
+    while (true) {
+        // Copy the longest run that needs no unescaping
+        const char* start = _cursor;
+        while (_cursor != _end && *_cursor != '"' && *_cursor != '\\' && (Uint8)*_cursor >= 0x20) {
+            _cursor++;
+        }
+        _strings.append(start,_cursor-start);
+
+        if (_cursor == _end) {
+            fail("Unterminated string");
+            return false;
+        } else if (*_cursor == '"') {
+            _cursor++;
+            break;
+        } else if (*_cursor != '\\') {
+            fail("Control character in string");
+            return false;
+        }
+
+        _cursor++;
+        if (_cursor == _end) {
+            fail("Unterminated string");
+            return false;
+        }
+        char code = *_cursor++;
+        switch (code) {
+            case '"':
+            case '\\':
+            case '/':
+                _strings.push_back(code);
+                break;
+            case 'b':
+                _strings.push_back('\b');
+                break;
+            case 'f':
+                _strings.push_back('\f');
+                break;
+            case 'n':
+                _strings.push_back('\n');
+                break;
+            case 'r':
+                _strings.push_back('\r');
+                break;
+            case 't':
+                _strings.push_back('\t');
+                break;
+            case 'u':
+            {
+                // Read one code unit, or a surrogate pair
+                Uint32 point = 0;
+                for(int pair = 0; pair < 2; pair++) {
+                    if (pair && (_end-_cursor < 2 || _cursor[0] != '\\' || _cursor[1] != 'u')) {
+                        fail("Unpaired surrogate in string");
+                        return false;
+                    } else if (pair) {
+                        _cursor += 2;
+                    }
+                    if (_end-_cursor < 4) {
+                        fail("Invalid unicode escape");
+                        return false;
+                    }
+                    Uint32 unit = 0;
+                    for(int ii = 0; ii < 4; ii++) {
+                        char c = *_cursor++;
+                        unit <<= 4;
+                        if (c >= '0' && c <= '9') {
+                            unit |= c-'0';
+                        } else if (c >= 'a' && c <= 'f') {
+                            unit |= c-'a'+10;
+                        } else if (c >= 'A' && c <= 'F') {
+                            unit |= c-'A'+10;
+                        } else {
+                            fail("Invalid unicode escape");
+                            return false;
+                        }
+                    }
+                    if (pair) {
+                        if (unit < 0xDC00 || unit > 0xDFFF) {
+                            fail("Unpaired surrogate in string");
+                            return false;
+                        }
+                        point = 0x10000+((point-0xD800) << 10)+(unit-0xDC00);
+                    } else {
+                        point = unit;
+                        if (unit < 0xD800 || unit > 0xDBFF) {
+                            break;
+                        }
+                    }
+                }
+
+                // Encode as UTF-8
+                if (point < 0x80) {
+                    _strings.push_back((char)point);
+                } else if (point < 0x800) {
+                    _strings.push_back((char)(0xC0 | (point >> 6)));
+                    _strings.push_back((char)(0x80 | (point & 0x3F)));
+                } else if (point < 0x10000) {
+                    _strings.push_back((char)(0xE0 | (point >> 12)));
+                    _strings.push_back((char)(0x80 | ((point >> 6) & 0x3F)));
+                    _strings.push_back((char)(0x80 | (point & 0x3F)));
+                } else {
+                    _strings.push_back((char)(0xF0 | (point >> 18)));
+                    _strings.push_back((char)(0x80 | ((point >> 12) & 0x3F)));
+                    _strings.push_back((char)(0x80 | ((point >> 6) & 0x3F)));
+                    _strings.push_back((char)(0x80 | (point & 0x3F)));
+                }
+                break;
+            }
+            default:
+                fail("Invalid escape in string");
+                return false;
+        }
+    }
+
+    length = (Uint32)_strings.size()-offset;
+    _strings.push_back('\0');
+    return true;
+}
+
+/**
+ * Parses the number at the cursor.
+ *
+ * @param value     Set to the number
+ *
+ * @return true if the number was parsed
+ */
+bool JsonDocument::parseNumber(double& value) {
+    const char* start = _cursor;
+    auto digits = [&]() {
+        const char* first = _cursor;
+        while (_cursor != _end && *_cursor >= '0' && *_cursor <= '9') {
+            _cursor++;
+        }
+        return _cursor != first;
+    };
+
+    // Check the grammar here, since strtod accepts more than JSON does
+    if (*_cursor == '-') {
+        _cursor++;
+    }
+    if (_cursor != _end && *_cursor == '0') {
+        _cursor++;
+    } else if (!digits()) {
+        fail("Invalid number");
+        return false;
+    }
+    if (_cursor != _end && *_cursor == '.') {
+        _cursor++;
+        if (!digits()) {
+            fail("Invalid number");
+            return false;
+        }
+    }
+    if (_cursor != _end && (*_cursor == 'e' || *_cursor == 'E')) {
+        _cursor++;
+        if (_cursor != _end && (*_cursor == '+' || *_cursor == '-')) {
+            _cursor++;
+        }
+        if (!digits()) {
+            fail("Invalid number");
+            return false;
+        }
+    }
+
+    // The text is not terminated, so copy it out first
+    size_t length = _cursor-start;
+    char buffer[64];
+    if (length < sizeof(buffer)) {
+        std::memcpy(buffer,start,length);
+        buffer[length] = '\0';
+        value = std::strtod(buffer,nullptr);
+    } else {
+        value = std::strtod(std::string(start,length).c_str(),nullptr);
+    }
+    return true;
+}
+
+/**
+ * Returns the id of the key just added to the string pool.
+ *
+ * If the key was seen before, the new copy is removed from the pool.
+ *
+ * @param offset    The offset of the key in the pool
+ * @param length    The length of the key
+ *
+ * @return the id of the key just added to the string pool.
+ */
+Uint32 JsonDocument::internKey(Uint32 offset, Uint32 length) {
+    std::string_view key(_strings.data()+offset,length);
+    auto it = _keyIds.find(key);
+    if (it != _keyIds.end()) {
+        _strings.resize(offset);
+        return it->second;
+    }
+
+    Uint32 id = (Uint32)_keys.size();
+    _keys.push_back(std::make_pair(offset,length));
+    _keyIds.emplace(key,id);
+    return id;
+}
+
+/**
+ * Advances the cursor past any whitespace.
+ */
+void JsonDocument::skipSpace() {
+    while (_cursor != _end && (*_cursor == ' ' || *_cursor == '\n' || *_cursor == '\r' || *_cursor == '\t')) {
+        _cursor++;
+    }
+}
+
+/**
+ * Reports a parsing error at the cursor.
+ *
+ * @param message   The error description
+ */
+void JsonDocument::fail(const char* message) {
+    int line = 1;
+    const char* start = _begin;
+    for(const char* pos = _begin; pos < _cursor; pos++) {
+        if (*pos == '\n') {
+            line++;
+            start = pos+1;
+        }
+    }
+    const char* stop = start;
+    while (stop != _end && *stop != '\n' && *stop != '\r') {
+        stop++;
+    }
+    std::string source(start,stop-start);
+    CULogError("%s at line %d, column %d:\n  %s",
+               message,line,(int)(_cursor-start)+1,source.c_str());
+}
@@ -104,19 +104,17 @@ bool JsonLoader::read(const std::string& key, const std::string& source, LoaderC
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = readJson(source);
         success = (json != nullptr);
         materialize(key,json,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = readJson(source);
             Application::get()->schedule([=](void) {
                 this->materialize(key,json,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -155,19 +153,17 @@ bool JsonLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = readJson(source);
         success = (json != nullptr);
         materialize(key,json,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = readJson(source);
             Application::get()->schedule([=](void) {
                 this->materialize(key,json,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -389,8 +389,7 @@ bool Scene2Loader::read(const std::string& key, const std::string& source,
 
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = readJson(source);
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
         node->doLayout();
         if (node != nullptr) {
@@ -401,15 +400,14 @@ bool Scene2Loader::read(const std::string& key, const std::string& source,
         }
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = readJson(source);
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
             Application::get()->schedule([=](void) {
                 this->materialize(node,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -473,7 +471,7 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
                 this->materialize(node,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -49,6 +49,7 @@
 #include <cugl/audio/CUAudioSample.h>
 #include <cugl/audio/CUAudioWaveform.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/assets/CUAssetManager.h>
 
 using namespace cugl;
 
@@ -75,6 +76,24 @@ _volume(UNKNOWN_VOLUME) {
 
 #pragma mark -
 #pragma mark Asset Loading
+/**
+ * Returns the in-memory sample for the given file from the asset bundle.
+ *
+ * If the manager has no bundle, or the file is not in it, this function
+ * returns nullptr.  Bundled samples are already decoded.
+ *
+ * @param manager   The asset manager (may be nullptr)
+ * @param source    The path to the asset
+ *
+ * @return the in-memory sample for the given file from the asset bundle.
+ */
+static std::shared_ptr<Sound> bundled_sample(const AssetManager* manager, const std::string& source) {
+    if (manager == nullptr || manager->getBundle() == nullptr) {
+        return nullptr;
+    }
+    return manager->getBundle()->getSound(source);
+}
+
 /**
  * Finishes loading the sound file, setting its default volume.
  *
@@ -143,8 +162,8 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
     
     
     if (_loader == nullptr || !async) {
-        std::shared_ptr<Sound> sound = nullptr;
-        if (AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
+        std::shared_ptr<Sound> sound = bundled_sample(_manager,source);
+        if (sound == nullptr && AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
             sound = AudioSample::alloc(path);
         }
         success = (sound != nullptr);
@@ -154,8 +173,8 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
         }
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<Sound> sound = nullptr;
-            if (AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
+            std::shared_ptr<Sound> sound = bundled_sample(_manager,source);
+            if (sound == nullptr && AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
                 sound = AudioSample::alloc(path);
             }
             if (sound != nullptr) {
@@ -165,7 +184,7 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
                     return false;
                 });
             }
-        });
+        }, _priority);
     }
     
     return success;
@@ -199,6 +218,7 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     std::string type = json->getString("type",UNKNOWN_TYPE);
     float volume = json->getFloat("volume",_volume);
     type = cugl::strtool::tolower(type);
+    bool bundle = type == "sample" && !json->getBool("stream",false);
     
     if (_assets.find(key) != _assets.end() || _queue.find(key) != _queue.end()) {
         return false;
@@ -207,7 +227,10 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     bool success = false;
     if (_loader == nullptr || !async) {
         std::shared_ptr<Sound> sound = nullptr;
-        if (type == "sample") {
+        if (bundle) {
+            sound = bundled_sample(_manager,json->getString("file",""));
+        }
+        if (sound == nullptr && type == "sample") {
             sound = AudioSample::allocWithData(json);
         } else if (type == "waveform") {
             sound = AudioWaveform::allocWithData(json);
@@ -220,7 +243,10 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<Sound> sound = nullptr;
-            if (type == "sample") {
+            if (bundle) {
+                sound = bundled_sample(_manager,json->getString("file",""));
+            }
+            if (sound == nullptr && type == "sample") {
                 sound = AudioSample::allocWithData(json);
             } else if (type == "waveform") {
                 sound = AudioWaveform::allocWithData(json);
@@ -232,7 +258,7 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
                     return false;
                 });
             }
-        });
+        }, _priority);
     }
     
     return success;
@@ -45,6 +45,7 @@
 //
 #include <cugl/assets/CUTextureLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/assets/CUAssetManager.h>
 #include <SDL/SDL_image.h>
 
 using namespace cugl;
@@ -139,6 +140,8 @@ _magfilter(GL_LINEAR),
 _wraps(GL_CLAMP_TO_EDGE),
 _wrapt(GL_CLAMP_TO_EDGE),
 _mipmaps(false) {
+    // Scene graphs wait on textures
+    _priority = 2;
 }
 
 
@@ -152,6 +155,9 @@ _mipmaps(false) {
  * we need to create an OpenGL texture.  Hence this method does the maximum
  * amount of work that can be done in asynchronous texture loading.
  *
+ * If the asset manager has a bundle containing this image, the surface
+ * borrows its pixels from the bundle and nothing is decoded.
+ *
  * @param source    The pathname to the asset
  *
  * @return the SDL_Surface with the texture information
@@ -165,19 +171,31 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
 #endif
     CUAssertLog(!absolute, "This loader does not accept absolute paths for assets");
     
-    std::string path = Application::get()->getAssetDirectory();
-    path.append(source);
-    SDL_Surface* surface = IMG_Load(path.c_str());
-    if (surface == nullptr) {
-        return nullptr;
-    }
-    
-    SDL_Surface* normal;
 #if CU_MEMORY_ORDER == CU_ORDER_REVERSED
-    normal = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_ABGR8888,0);
+    Uint32 format = SDL_PIXELFORMAT_ABGR8888;
 #else
-    normal = SDL_ConvertSurfaceFormat(surface,SDL_PIXELFORMAT_RGBA8888,0);
+    Uint32 format = SDL_PIXELFORMAT_RGBA8888;
 #endif
+
+    // Bundled images are already decoded, and borrow the bundle memory
+    SDL_Surface* surface = nullptr;
+    if (_manager != nullptr && _manager->getBundle() != nullptr) {
+        surface = _manager->getBundle()->getImage(source);
+        if (surface != nullptr && surface->format->format == format) {
+            return surface;
+        }
+    }
+    
+    if (surface == nullptr) {
+        std::string path = Application::get()->getAssetDirectory();
+        path.append(source);
+        surface = IMG_Load(path.c_str());
+        if (surface == nullptr) {
+            return nullptr;
+        }
+    }
+    
+    SDL_Surface* normal = SDL_ConvertSurfaceFormat(surface,format,0);
     SDL_FreeSurface(surface);
     return normal;
 }
@@ -200,26 +218,25 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
-    
-    bool success = false;
-    if (texture != nullptr) {
-        _assets[key] = texture;
-        texture->bind();
-        if (_mipmaps) { texture->buildMipMaps(); }
-        texture->setMinFilter(_minfilter);
-        texture->setMagFilter(_magfilter);
-        texture->setWrapS(_wraps);
-        texture->setWrapT(_wrapt);
-        texture->unbind();
-        success = true;
-    }
-    
-    if (callback != nullptr) {
-        callback(key,success);
-    }
-    SDL_FreeSurface(surface);
-    _queue.erase(key);
+    _uploads->push(surface, _priority, [=](const std::shared_ptr<Texture>& texture) {
+        bool success = false;
+        if (texture != nullptr) {
+            _assets[key] = texture;
+            texture->bind();
+            if (_mipmaps) { texture->buildMipMaps(); }
+            texture->setMinFilter(_minfilter);
+            texture->setMagFilter(_magfilter);
+            texture->setWrapS(_wraps);
+            texture->setWrapT(_wrapt);
+            texture->unbind();
+            success = true;
+        }
+        
+        if (callback != nullptr) {
+            callback(key,success);
+        }
+        _queue.erase(key);
+    });
 }
                                 
 /**
@@ -251,35 +268,35 @@ void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, Lo
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
-    std::string key = json->key();
-
-    bool success = false;
-    if (texture != nullptr) {
-        GLuint minflt = decodeMinFilter(json->getString("minfilter",UNKNOWN_MINFLT));
-        GLuint magflt = decodeMinFilter(json->getString("magfilter",UNKNOWN_MAGFLT));
-        GLuint wrapS = decodeWrap(json->getString("wrapS",UNKNOWN_WRAP));
-        GLuint wrapT = decodeWrap(json->getString("wrapT",UNKNOWN_WRAP));
-        bool mipmaps = json->getBool("mipmaps",false);
+    int priority = json->getInt("priority",_priority);
+    _uploads->push(surface, priority, [=](const std::shared_ptr<Texture>& texture) {
+        std::string key = json->key();
+        bool success = false;
+        if (texture != nullptr) {
+            GLuint minflt = decodeMinFilter(json->getString("minfilter",UNKNOWN_MINFLT));
+            GLuint magflt = decodeMinFilter(json->getString("magfilter",UNKNOWN_MAGFLT));
+            GLuint wrapS = decodeWrap(json->getString("wrapS",UNKNOWN_WRAP));
+            GLuint wrapT = decodeWrap(json->getString("wrapT",UNKNOWN_WRAP));
+            bool mipmaps = json->getBool("mipmaps",false);
 
-        _assets[key] = texture;
-        texture->bind();
-        if (mipmaps) { texture->buildMipMaps(); }
-        texture->setMinFilter(minflt);
-        texture->setMagFilter(magflt);
-        texture->setWrapS(wrapS);
-        texture->setWrapT(wrapT);
-        texture->unbind();
-        parseAtlas(json,texture);
+            _assets[key] = texture;
+            texture->bind();
+            if (mipmaps) { texture->buildMipMaps(); }
+            texture->setMinFilter(minflt);
+            texture->setMagFilter(magflt);
+            texture->setWrapS(wrapS);
+            texture->setWrapT(wrapT);
+            texture->unbind();
+            parseAtlas(json,texture);
+            
+            success = true;
+        }
         
-        success = true;
-    }
-    
-    if (callback != nullptr) {
-        callback(key,success);
-    }
-    SDL_FreeSurface(surface);
-    _queue.erase(key);
+        if (callback != nullptr) {
+            callback(key,success);
+        }
+        _queue.erase(key);
+    });
 }
 
 /**
@@ -321,7 +338,7 @@ bool TextureLoader::read(const std::string& key, const std::string& source, Load
                 this->materialize(key,surface,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
 
 	if (success) {
@@ -390,7 +407,7 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
                 this->materialize(json,surface,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     if (success) {
@@ -440,11 +457,12 @@ bool TextureLoader::purge(const std::shared_ptr<JsonValue>& json) {
     _assets.erase(it);
     
     JsonValue* child = json->get("atlas").get();
+    bool prefix = json->getBool("prefix",true);
     bool success = true;
     if (child) {
         for(int ii = 0; ii < child->size(); ii++) {
             JsonValue* item = child->get(ii).get();
-            std::string name = key+"_"+item->key();
+            std::string name = prefix ? key+"_"+item->key() : item->key();
             auto jt = _assets.find(name);
             success = (jt != _assets.end()) && success;
             if (jt != _assets.end()) {
@@ -464,7 +482,10 @@ bool TextureLoader::purge(const std::shared_ptr<JsonValue>& json) {
  * An atlas is specified as a list of named, four-element integer arrays.
  * Each integer array specifies the left, top, right, and bottom pixels of
  * the subtexture, respectively.  Each subtexture will have the key of the
- * main texture as the prefix (together with an underscore _) of its key.
+ * main texture as the prefix (together with an underscore _) of its key,
+ * unless the entry sets "prefix" to false.  In that case the subtexture
+ * keys are used as is, which is how packed atlases stand in for the
+ * individual textures they replace.
  *
  * @param json      The asset directory entry
  * @param texture   The texture loaded for this asset
@@ -472,11 +493,12 @@ bool TextureLoader::purge(const std::shared_ptr<JsonValue>& json) {
 void TextureLoader::parseAtlas(const std::shared_ptr<JsonValue>& json, const std::shared_ptr<Texture>& texture) {
     std::string key = json->key();
     JsonValue* child = json->get("atlas").get();
+    bool prefix = json->getBool("prefix",true);
     Size size = texture->getSize();
     if (child) {
         for(int ii = 0; ii < child->size(); ii++) {
             JsonValue* item = child->get(ii).get();
-            std::string name = key+"_"+item->key();
+            std::string name = prefix ? key+"_"+item->key() : item->key();
             std::vector<int> values = item->asIntArray();
             CUAssertLog(values.size() == 4, "Atlas dimensions are incorrect: %d",(Uint32)values.size());
             _assets[name] = texture->getSubTexture(values[0]/size.width, values[2]/size.width,
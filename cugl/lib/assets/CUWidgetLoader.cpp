@@ -111,21 +111,19 @@ bool WidgetLoader::read(const std::string& key, const std::string& source, Loade
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = readJson(source);
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = readJson(source);
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=](void) {
                 this->materialize(key,widget,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -161,21 +159,19 @@ bool WidgetLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-        std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+        std::shared_ptr<JsonValue> json = readJson(source);
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
-            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            std::shared_ptr<JsonValue> json = readJson(source);
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=](void) {
                 this->materialize(key,widget,callback);
                 return false;
             });
-        });
+        }, _priority);
     }
     
     return success;
@@ -235,7 +235,13 @@ std::shared_ptr<audio::AudioDecoder> AudioSample::getDecoder() {
             return audio::WAVDecoder::alloc(_file);
             break;
         case Type::MP3_FILE:
+#ifdef CU_NO_MP3
+            // The MP3 decoder lives in SDL2_codec, which not every platform has
+            CULogError("MP3 support is not compiled in: '%s'", _file.c_str());
+            return nullptr;
+#else
             return audio::MP3Decoder::alloc(_file);
+#endif
             break;
         case Type::OGG_FILE:
             return audio::OGGDecoder::alloc(_file);
@@ -159,7 +159,7 @@ void AudioFader::dispose() {
 bool AudioFader::attach(const std::shared_ptr<AudioNode>& node) {
     if (!_booted) {
         CUAssertLog(_booted, "Cannot attach to an uninitialized audio node");
-        return nullptr;
+        return false;
     } else if (node == nullptr) {
         detach();
         return true;
@@ -143,7 +143,7 @@ void AudioPanner::dispose() {
 bool AudioPanner::attach(const std::shared_ptr<AudioNode>& node) {
     if (!_booted) {
         CUAssertLog(_booted, "Cannot attach to an uninitialized audio node");
-        return nullptr;
+        return false;
     } else if (node == nullptr) {
         detach();
         return true;
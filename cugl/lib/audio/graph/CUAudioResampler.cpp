@@ -163,7 +163,7 @@ void AudioResampler::dispose() {
 bool AudioResampler::attach(const std::shared_ptr<AudioNode>& node) {
     if (!_booted) {
         CUAssertLog(_booted, "Cannot attach to an uninitialized audio node");
-        return nullptr;
+        return false;
     } else if (node == nullptr) {
         detach();
         return true;
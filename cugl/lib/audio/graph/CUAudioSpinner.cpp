@@ -357,7 +357,7 @@ void AudioSpinner::initPlan(Plan plan, std::atomic<float>* lines) {
 bool AudioSpinner::attach(const std::shared_ptr<AudioNode>& node) {
     if (!_booted) {
         CUAssertLog(_booted, "Cannot attach to an uninitialized audio node");
-        return nullptr;
+        return false;
     } else if (node == nullptr) {
         detach();
         return true;
@@ -35,6 +35,7 @@
 #include <cugl/render/CUTexture.h>
 #include <cugl/input/CUInput.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUProfiler.h>
 #include <algorithm>
 #include <vector>
 
@@ -270,13 +271,26 @@ bool Application::step() {
     _start.mark();
     bool running = getInput();
     if (running &&  _state == State::FOREGROUND) {
-        processCallbacks(((Uint32)micros)/1000);
-        update(micros/1000000.0f);
+        // The profiled frame does not include waiting for the display
+        Profiler* profiler = Profiler::get();
+        if (profiler) { profiler->beginFrame(); }
+        {
+            CU_PROFILE_ZONE("Application::callbacks");
+            processCallbacks(((Uint32)micros)/1000);
+        }
+        {
+            CU_PROFILE_ZONE("Application::update");
+            update(micros/1000000.0f);
+        }
 
         glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
         glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        draw();
+        {
+            CU_PROFILE_ZONE("Application::draw");
+            draw();
+        }
+        if (profiler && profiler == Profiler::get()) { profiler->endFrame(); }
         Display::get()->refresh();
     } else {
         running = _state == State::BACKGROUND;
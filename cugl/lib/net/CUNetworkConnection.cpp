@@ -85,20 +85,109 @@ CUNetworkConnection::~CUNetworkConnection() {
 }
 
 /**
- * Read the message from a bitstream into a byte vector.
+ * Write a message length as a variable-length integer.
+ *
+ * Seven bits are stored per byte, least significant group first, with the
+ * high bit set on every byte but the last. Messages under 128 bytes pay the
+ * same single byte as before.
+ */
+void writeLength(SLNet::BitStream& bs, size_t length) {
+	while (length >= 0x80) {
+		bs.Write(static_cast<uint8_t>((length & 0x7F) | 0x80));
+		length >>= 7;
+	}
+	bs.Write(static_cast<uint8_t>(length));
+}
+
+/**
+ * Read a message length written by writeLength.
+ *
+ * Lengths that would run past the end of the bitstream are clamped to
+ * the bytes actually available.
+ */
+uint32_t readLength(SLNet::BitStream& bts) {
+	uint32_t length = 0;
+	for (unsigned shift = 0; shift < 32; shift += 7) {
+		uint8_t b = 0;
+		if (!bts.Read(b)) break;
+		length |= static_cast<uint32_t>(b & 0x7F) << shift;
+		if ((b & 0x80) == 0) break;
+	}
+	uint32_t available = BITS_TO_BYTES(bts.GetNumberOfUnreadBits());
+	return length < available ? length : available;
+}
+
+/**
+ * Read the message from a bitstream into an existing byte vector.
+ *
+ * The vector is resized to the message length, so reusing one vector across
+ * packets avoids an allocation per message.
  *
  * Only works if the BitStream was encoded in the standard format used by this clas.
  */
-std::vector<uint8_t> readBs(SLNet::BitStream& bts) {
+void readBs(SLNet::BitStream& bts, std::vector<uint8_t>& msgConverted) {
 	uint8_t ignored;
 	bts.Read(ignored);
-	uint8_t length;
-	bts.Read(length);
+	uint32_t length = readLength(bts);
+
+	msgConverted.resize(length, 0);
+
+	bts.ReadAlignedBytes(msgConverted.data(), length);
+}
+
+/**
+ * Read a standard message from a bitstream into an existing byte vector.
+ *
+ * Standard messages carry a header byte with the reliability and channel
+ * they were sent with, so that the host can relay them unchanged.
+ */
+void readStandardBs(SLNet::BitStream& bts, std::vector<uint8_t>& msgConverted, uint8_t& header) {
+	uint8_t ignored;
+	bts.Read(ignored);
+	bts.Read(header);
+	uint32_t length = readLength(bts);
 
-	std::vector<uint8_t> msgConverted;
 	msgConverted.resize(length, 0);
 
 	bts.ReadAlignedBytes(msgConverted.data(), length);
+}
+
+/** Packs a reliability class and channel into a standard message header */
+uint8_t packHeader(CUNetworkConnection::Reliability reliability, uint8_t channel) {
+	return static_cast<uint8_t>(static_cast<uint8_t>(reliability) << 5 | (channel & 0x1F));
+}
+
+CUNetworkConnection::Reliability headerReliability(uint8_t header) {
+	return static_cast<CUNetworkConnection::Reliability>((header >> 5) & 0x3);
+}
+
+uint8_t headerChannel(uint8_t header) {
+	return header & 0x1F;
+}
+
+/** Converts a reliability class to its RakNet equivalent */
+PacketReliability toPacketReliability(CUNetworkConnection::Reliability reliability) {
+	switch (reliability) {
+	case CUNetworkConnection::Reliability::Unreliable:
+		return UNRELIABLE;
+	case CUNetworkConnection::Reliability::UnreliableSequenced:
+		return UNRELIABLE_SEQUENCED;
+	case CUNetworkConnection::Reliability::ReliableOrdered:
+		return RELIABLE_ORDERED;
+	case CUNetworkConnection::Reliability::Reliable:
+	default:
+		return RELIABLE;
+	}
+}
+
+/**
+ * Read the message from a bitstream into a byte vector.
+ *
+ * Only works if the BitStream was encoded in the standard format used by this clas.
+ */
+std::vector<uint8_t> readBs(SLNet::BitStream& bts) {
+	std::vector<uint8_t> msgConverted;
+	readBs(bts, msgConverted);
 	return msgConverted;
 }
 
@@ -222,7 +311,7 @@ void cugl::CUNetworkConnection::cc5HostConfirmClient(HostPeers& h, SLNet::Packet
 				std::vector<uint8_t> connMsg = { numPlayers, maxPlayers, pID, apiVer };
 				bs.Write(
 					static_cast<uint8_t>(ID_USER_PACKET_ENUM + Reconnect));
-				bs.Write(static_cast<uint8_t>(connMsg.size()));
+				writeLength(bs, connMsg.size());
 				bs.WriteAlignedBytes(
 					connMsg.data(),
 					static_cast<unsigned int>(connMsg.size()));
@@ -236,7 +325,7 @@ void cugl::CUNetworkConnection::cc5HostConfirmClient(HostPeers& h, SLNet::Packet
 				std::vector<uint8_t> connMsg = { numPlayers, maxPlayers, pID, apiVer };
 				bs.Write(
 					static_cast<uint8_t>(ID_USER_PACKET_ENUM + JoinRoom));
-				bs.Write(static_cast<uint8_t>(connMsg.size()));
+				writeLength(bs, connMsg.size());
 				bs.WriteAlignedBytes(
 					connMsg.data(),
 					static_cast<unsigned int>(connMsg.size()));
@@ -269,28 +358,49 @@ void CUNetworkConnection::broadcast(const std::vector<uint8_t>& msg, SLNet::Syst
 	CustomDataPackets packetType) {
 	SLNet::BitStream bs;
 	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType));
-	bs.Write(static_cast<uint8_t>(msg.size()));
+	writeLength(bs, msg.size());
 	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
 	peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, ignore, true);
 }
 
-void CUNetworkConnection::send(const std::vector<uint8_t>& msg) { send(msg, Standard); }
+void CUNetworkConnection::broadcast(const std::vector<uint8_t>& msg, SLNet::SystemAddress& ignore, uint8_t header) {
+	SLNet::BitStream bs;
+	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + Standard));
+	bs.Write(header);
+	writeLength(bs, msg.size());
+	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
+	peer->Send(&bs, MEDIUM_PRIORITY, toPacketReliability(headerReliability(header)),
+		headerChannel(header), ignore, true);
+}
+
+void CUNetworkConnection::send(const std::vector<uint8_t>& msg, Reliability reliability, uint8_t channel) {
+	CUAssertLog(channel < NUM_CHANNELS, "Channel %d is out of range.", channel);
+	SLNet::BitStream bs;
+	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + Standard));
+	bs.Write(packHeader(reliability, channel));
+	writeLength(bs, msg.size());
+	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
+	sendStream(bs, reliability, channel);
+}
 
 void CUNetworkConnection::send(const std::vector<uint8_t>& msg, CustomDataPackets packetType) {
 	SLNet::BitStream bs;
 	bs.Write(static_cast<uint8_t>(ID_USER_PACKET_ENUM + packetType));
-	bs.Write(static_cast<uint8_t>(msg.size()));
+	writeLength(bs, msg.size());
 	bs.WriteAlignedBytes(msg.data(), static_cast<unsigned int>(msg.size()));
+	sendStream(bs, Reliability::Reliable, 1);
+}
 
+void CUNetworkConnection::sendStream(SLNet::BitStream& bs, Reliability reliability, uint8_t channel) {
 	std::visit(make_visitor(
 		[&](HostPeers& /*h*/) {
-			peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, *natPunchServerAddress, true);
+			peer->Send(&bs, MEDIUM_PRIORITY, toPacketReliability(reliability), channel, *natPunchServerAddress, true);
 		},
 		[&](ClientPeer& c) {
 			if (c.addr == nullptr) {
 				return;
 			}
-			peer->Send(&bs, MEDIUM_PRIORITY, RELIABLE, 1, *c.addr, false);
+			peer->Send(&bs, MEDIUM_PRIORITY, toPacketReliability(reliability), channel, *c.addr, false);
 		}), remotePeer);
 }
 
@@ -402,11 +512,12 @@ void CUNetworkConnection::receive(
 
 		// Begin Non-SLikeNet Reported Codes
 		case ID_USER_PACKET_ENUM + Standard: {
-			auto msgConverted = readBs(bts);
-			dispatcher(msgConverted);
+			uint8_t header;
+			readStandardBs(bts, msgBuffer, header);
+			dispatcher(msgBuffer);
 
 			std::visit(make_visitor(
-				[&](HostPeers& /*h*/) { broadcast(msgConverted, packet->systemAddress); },
+				[&](HostPeers& /*h*/) { broadcast(msgBuffer, packet->systemAddress, header); },
 				[&](ClientPeer& c) {}), remotePeer);
 
 			break;
@@ -50,6 +50,8 @@
 #include <cugl/render/CUShader.h>
 #include <cugl/render/CUGradient.h>
 #include <cugl/render/CUScissor.h>
+#include <cugl/util/CUProfiler.h>
+#include <cugl/util/CUTimestamp.h>
 
 /**
  * Default fragment shader
@@ -110,63 +112,6 @@ using namespace cugl;
 /** All values have changed */
 #define DIRTY_ALL_VALS      511
 
-/**
- * Creates a context of the default uniforms.
- */
-SpriteBatch::Context::Context() {
-    first = 0;
-    last  = 0;
-    command = GL_TRIANGLES;
-    blendEquation = GL_FUNC_ADD;
-    srcFactor = GL_SRC_ALPHA;
-    dstFactor = GL_ONE_MINUS_SRC_ALPHA;
-    depthFunc = GL_ALWAYS;
-    perspective = std::make_shared<Mat4>();
-    perspective->setIdentity();
-    texture  = nullptr;
-    blurstep = 0;
-    blockptr = -1;
-    type = 0;
-}
-
-/**
- * Creates a copy of the given uniforms
- *
- * @param copy  The uniforms to copy
- */
-SpriteBatch::Context::Context(Context* copy) {
-    first = copy->first;
-    last  = copy->last;
-    type  = copy->type;
-    command = copy->command;
-    srcFactor = copy->srcFactor;
-    dstFactor = copy->dstFactor;
-    depthFunc = copy->depthFunc;
-    blendEquation = copy->blendEquation;
-    perspective = copy->perspective;
-    texture  = copy->texture;
-    blockptr = copy->blockptr;
-    blurstep = copy->blurstep;
-    dirty = 0;
-}
-
-/**
- * Disposes this collection of uniforms
- */
-SpriteBatch::Context::~Context() {
-    first = 0;
-    last  = 0;
-    command = GL_FALSE;
-    blendEquation = GL_FALSE;
-    srcFactor = GL_FALSE;
-    dstFactor = GL_FALSE;
-    depthFunc = GL_ALWAYS;
-    perspective = nullptr;
-    texture  = nullptr;
-    blockptr = -1;
-    type = 0;
-}
-
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -177,18 +122,25 @@ SpriteBatch::Context::~Context() {
 SpriteBatch::SpriteBatch() :
 _initialized(false),
 _active(false),
-_inflight(false),
+_ringIndex(0),
+_streaming(true),
 _vertData(nullptr),
-_indxData(nullptr),
-_color(Color4f::WHITE),
-_context(nullptr),
-_depth(0),
 _vertMax(0),
 _vertSize(0),
+_indxData(nullptr),
 _indxMax(0),
 _indxSize(0),
+_slotMax(1),
+_slot(0),
+_inflight(false),
+_color(Color4f::WHITE),
+_depth(0),
+_culling(false),
+_cullRect(-1,-1,2,2),
 _vertTotal(0),
-_callTotal(0) {
+_callTotal(0),
+_uploadTotal(0),
+_stallTotal(0) {
     _shader = nullptr;
     _vertbuff = nullptr;
     _unifbuff = nullptr;
@@ -208,11 +160,17 @@ void SpriteBatch::dispose() {
     if (_indxData) {
         delete[] _indxData; _indxData = nullptr;
     }
-    if (_context != nullptr) {
-        delete _context; _context = nullptr;
-    }
+    _history.clear();
+    _perspectives.clear();
+    _textures.clear();
+    _texture = nullptr;
+    _context = Context();
     _shader = nullptr;
     _vertbuff = nullptr;
+    for(int ii = 0; ii < SPRITE_BUFFER_RING; ii++) {
+        _ring[ii] = nullptr;
+    }
+    _ringIndex = 0;
     _unifbuff = nullptr;
     _gradient = nullptr;
     _scissor  = nullptr;
@@ -313,13 +271,20 @@ bool SpriteBatch::init(unsigned int capacity, const std::shared_ptr<Shader>& sha
     
     _shader = shader;
     
-    _vertbuff = VertexBuffer::alloc(sizeof(SpriteVertex3));
-    _vertbuff->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE, 0);
-    _vertbuff->setupAttribute("aColor",    4, GL_FLOAT, GL_TRUE,
-                            offsetof(cugl::SpriteVertex3,color));
-    _vertbuff->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
-                            offsetof(cugl::SpriteVertex3,texcoord));
-    _vertbuff->attach(_shader);
+    for(int ii = 0; ii < SPRITE_BUFFER_RING; ii++) {
+        _ring[ii] = VertexBuffer::alloc(sizeof(SpriteVertex3));
+        _ring[ii]->setupAttribute("aPosition", 3, GL_FLOAT, GL_FALSE, 0);
+        _ring[ii]->setupAttribute("aColor",    4, GL_FLOAT, GL_TRUE,
+                                offsetof(cugl::SpriteVertex3,color));
+        _ring[ii]->setupAttribute("aTexCoord", 2, GL_FLOAT, GL_FALSE,
+                                offsetof(cugl::SpriteVertex3,texcoord));
+        _ring[ii]->setupAttribute("aTexSlot",  1, GL_FLOAT, GL_FALSE,
+                                offsetof(cugl::SpriteVertex3,texslot));
+        _ring[ii]->attach(_shader);
+    }
+    _ringIndex = 0;
+    _vertbuff = _ring[0];
+    _slotMax = _shader->getAttributeLocation("aTexSlot") == -1 ? 1 : SPRITE_TEXTURE_SLOTS;
     
     // Set up data arrays;
     _vertMax = capacity;
@@ -343,8 +308,10 @@ bool SpriteBatch::init(unsigned int capacity, const std::shared_ptr<Shader>& sha
 
     _shader->setUniformBlock("uContext",_unifbuff);
     
-    _context = new Context();
-    _context->dirty = DIRTY_ALL_VALS;
+    _context = Context();
+    _context.dirty = DIRTY_ALL_VALS;
+    _perspectives.push_back(Mat4::IDENTITY);
+    _history.reserve(64);
     return true;
 }
 
@@ -367,7 +334,7 @@ void SpriteBatch::setColor(const Color4f color) {
     if (_gradient != nullptr) {
         if (_inflight) { record(); }
         _gradient->setTintColor(color);
-        _context->dirty = _context->dirty | DIRTY_UNIBLOCK;
+        _context.dirty = _context.dirty | DIRTY_UNIBLOCK;
     }
 }
 
@@ -381,10 +348,15 @@ void SpriteBatch::setColor(const Color4f color) {
 void SpriteBatch::setShader(const std::shared_ptr<Shader>& shader) {
     CUAssertLog(_active, "Attempt to reassign shader while drawing is active");
     CUAssertLog(shader != nullptr, "Shader cannot be null");
-    _vertbuff->detach();
+    for(int ii = 0; ii < SPRITE_BUFFER_RING; ii++) {
+        _ring[ii]->detach();
+    }
     _shader = shader;
-    _vertbuff->attach(_shader);
+    for(int ii = 0; ii < SPRITE_BUFFER_RING; ii++) {
+        _ring[ii]->attach(_shader);
+    }
     _shader->setUniformBlock("uContext", _unifbuff);
+    _slotMax = _shader->getAttributeLocation("aTexSlot") == -1 ? 1 : SPRITE_TEXTURE_SLOTS;
 }
 
 
@@ -398,11 +370,12 @@ void SpriteBatch::setShader(const std::shared_ptr<Shader>& shader) {
  * @param perspective   The active perspective matrix for this sprite batch
  */
 void SpriteBatch::setPerspective(const Mat4& perspective) {
-    if (_context->perspective.get() != &perspective) {
+    if (_perspectives[_context.perspective] != perspective) {
         if (_inflight) { record(); }
-        auto matrix = std::make_shared<Mat4>(perspective);
-        _context->perspective = matrix;
-        _context->dirty = _context->dirty | DIRTY_PERSPECTIVE;
+        _context.perspective = (GLuint)_perspectives.size();
+        _perspectives.push_back(perspective);
+        _context.dirty = _context.dirty | DIRTY_PERSPECTIVE;
+        _cullRect = perspective.getInverse().transform(Rect(-1,-1,2,2));
     }
 }
 
@@ -414,38 +387,55 @@ void SpriteBatch::setPerspective(const Mat4& perspective) {
  * this texture.  If the value is nullptr, all shapes and outlines will be
  * draw with a solid color instead.  This value is nullptr by default.
  *
- * Changing this value will cause the sprite batch to flush.  However, a
- * subtexture will not cause a pipeline flush.  This is an important
- * argument for using texture atlases.
+ * Changing this value will only cause the sprite batch to flush if the
+ * texture does not fit in a free slot (see {@link SPRITE_TEXTURE_SLOTS}).
+ * A subtexture shares the slot of its parent, so texture atlases never
+ * use more than one slot.
  *
  * @param color The active texture for this sprite batch
  */
 void SpriteBatch::setTexture(const std::shared_ptr<Texture>& texture) {
-    if (texture == _context->texture) {
+    if (texture == _texture) {
         return;
     }
 
-    if (_inflight) { record(); }
     if (texture == nullptr) {
         // Active texture is not null
-        _context->dirty = _context->dirty | DIRTY_DRAWTYPE;
-        _context->texture = nullptr;
-        _context->type = _context->type & ~TYPE_TEXTURE;
-    } else if (_context->texture == nullptr) {
-        // Texture is not null
-        _context->dirty = _context->dirty | DIRTY_DRAWTYPE | DIRTY_TEXTURE;
-        _context->texture = texture;
-        _context->type = _context->type | TYPE_TEXTURE;
-    } else {
-        // Both must be not nullptr
-        if (_context->texture->getBuffer() != texture->getBuffer()) {
-            _context->dirty = _context->dirty | DIRTY_TEXTURE;
-        }
-        _context->texture = texture;
-        if (_context->texture->getBindPoint()) {
-            _context->texture->setBindPoint(0);
+        if (_inflight) { record(); }
+        _context.dirty = _context.dirty | DIRTY_DRAWTYPE;
+        _context.type = _context.type & ~TYPE_TEXTURE;
+        _context.texsize = Size::ZERO;
+        _texture = nullptr;
+        return;
+    }
+    
+    // Look for a slot that already has this texture buffer
+    GLuint slot = 0;
+    while (slot < _context.slotCount && _textures[_context.slots[slot]]->getBuffer() != texture->getBuffer()) {
+        slot++;
+    }
+    if (slot == _context.slotCount) {
+        if (slot == _slotMax) {
+            // Out of slots, so start a new call
+            if (_inflight) { record(); }
+            _context.slotCount = 0;
+            slot = 0;
         }
+        _context.slots[slot] = (GLuint)_textures.size();
+        _context.slotCount = slot+1;
+        _context.dirty = _context.dirty | DIRTY_TEXTURE;
+        _textures.push_back(texture);
     }
+    
+    if (_texture == nullptr) {
+        // Switching from untextured drawing
+        if (_inflight) { record(); }
+        _context.dirty = _context.dirty | DIRTY_DRAWTYPE;
+        _context.type = _context.type | TYPE_TEXTURE;
+    }
+    _context.texsize = texture->getSize();
+    _texture = texture;
+    _slot = (GLfloat)slot;
 }
 
 /**
@@ -508,12 +498,12 @@ void SpriteBatch::setGradient(const std::shared_ptr<Gradient>& gradient) {
     if (_inflight) { record(); }
     if (gradient == nullptr) {
         // Active gradient is not null
-        _context->dirty = _context->dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
-        _context->type = _context->type & ~TYPE_GRADIENT;
+        _context.dirty = _context.dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
+        _context.type = _context.type & ~TYPE_GRADIENT;
         _gradient = nullptr;
     } else {
-        _context->dirty = _context->dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
-        _context->type = _context->type | TYPE_GRADIENT;
+        _context.dirty = _context.dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
+        _context.type = _context.type | TYPE_GRADIENT;
         _gradient = Gradient::alloc(gradient);
         _gradient->setTintColor(_color);
     }
@@ -564,12 +554,12 @@ void SpriteBatch::setScissor(const std::shared_ptr<Scissor>& scissor) {
     if (_inflight) { record(); }
     if (scissor == nullptr) {
         // Active gradient is not null
-        _context->dirty = _context->dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
-        _context->type = _context->type & ~TYPE_SCISSOR;
+        _context.dirty = _context.dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
+        _context.type = _context.type & ~TYPE_SCISSOR;
         _scissor = nullptr;
     } else {
-        _context->dirty = _context->dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
-        _context->type = _context->type | TYPE_SCISSOR;
+        _context.dirty = _context.dirty | DIRTY_UNIBLOCK | DIRTY_DRAWTYPE;
+        _context.type = _context.type | TYPE_SCISSOR;
         _scissor = Scissor::alloc(scissor);
     }
 }
@@ -592,11 +582,11 @@ void SpriteBatch::setScissor(const std::shared_ptr<Scissor>& scissor) {
  * @param dstFactor Specifies how the destination blending factors are computed.
  */
 void SpriteBatch::setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
-    if (_context->srcFactor != srcFactor || _context->dstFactor != dstFactor) {
+    if (_context.srcFactor != srcFactor || _context.dstFactor != dstFactor) {
         if (_inflight) { record(); }
-        _context->srcFactor = srcFactor;
-        _context->dstFactor = dstFactor;
-        _context->dirty = _context->dirty | DIRTY_BLENDFACTOR;
+        _context.srcFactor = srcFactor;
+        _context.dstFactor = dstFactor;
+        _context.dirty = _context.dirty | DIRTY_BLENDFACTOR;
     }
 }
 
@@ -615,10 +605,10 @@ void SpriteBatch::setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
  * @param equation  Specifies how source and destination colors are combined
  */
 void SpriteBatch::setBlendEquation(GLenum equation) {
-    if (_context->blendEquation != equation) {
+    if (_context.blendEquation != equation) {
         if (_inflight) { record(); }
-        _context->blendEquation = equation;
-        _context->dirty = _context->dirty | DIRTY_EQUATION;
+        _context.blendEquation = equation;
+        _context.dirty = _context.dirty | DIRTY_EQUATION;
     }
 }
 
@@ -631,10 +621,10 @@ void SpriteBatch::setBlendEquation(GLenum equation) {
  * @return the current drawing command.
  */
 void SpriteBatch::setCommand(GLenum command) {
-    if (_context->command != command) {
+    if (_context.command != command) {
         if (_inflight) { record(); }
-        _context->command = command;
-        _context->dirty = _context->dirty | DIRTY_COMMAND;
+        _context.command = command;
+        _context.dirty = _context.dirty | DIRTY_COMMAND;
     }
 }
 
@@ -655,10 +645,10 @@ void SpriteBatch::setCommand(GLenum command) {
  * @param function  Specifies how to accept fragments by depth value
  */
 void SpriteBatch::setDepthFunc(GLenum function) {
-    if (_context->depthFunc != function) {
+    if (_context.depthFunc != function) {
         if (_inflight) { record(); }
-        _context->depthFunc = function;
-        _context->dirty = _context->dirty | DIRTY_DEPTHTEST;
+        _context.depthFunc = function;
+        _context.dirty = _context.dirty | DIRTY_DEPTHTEST;
     }
 }
 
@@ -682,22 +672,22 @@ void SpriteBatch::setDepthFunc(GLenum function) {
  * @param step  The blur step in pixels
  */
 void SpriteBatch::setBlurStep(GLuint step) {
-    if (_context->blurstep == step) {
+    if (_context.blurstep == step) {
         return;
     }
     
     if (_inflight) { record(); }
     if (step == 0) {
         // Active gradient is not null
-        _context->dirty = _context->dirty | DIRTY_BLURSTEP | DIRTY_DRAWTYPE;
-        _context->type = _context->type & ~TYPE_GAUSSBLUR;
-    } else if (_context->blurstep == 0){
-        _context->dirty = _context->dirty | DIRTY_BLURSTEP | DIRTY_DRAWTYPE;
-        _context->type = _context->type | TYPE_GAUSSBLUR;
+        _context.dirty = _context.dirty | DIRTY_BLURSTEP | DIRTY_DRAWTYPE;
+        _context.type = _context.type & ~TYPE_GAUSSBLUR;
+    } else if (_context.blurstep == 0){
+        _context.dirty = _context.dirty | DIRTY_BLURSTEP | DIRTY_DRAWTYPE;
+        _context.type = _context.type | TYPE_GAUSSBLUR;
     } else {
-        _context->dirty = _context->dirty | DIRTY_BLURSTEP;
+        _context.dirty = _context.dirty | DIRTY_BLURSTEP;
     }
-    _context->blurstep = step;
+    _context.blurstep = step;
 }
 
 
@@ -718,6 +708,13 @@ void SpriteBatch::begin() {
 
     // DO NOT CLEAR.  This responsibility lies elsewhere
     _shader->bind();
+    if (_slotMax > 1) {
+        GLint units[SPRITE_TEXTURE_SLOTS];
+        for(GLint ii = 0; ii < SPRITE_TEXTURE_SLOTS; ii++) {
+            units[ii] = ii;
+        }
+        _shader->setUniform1iv("uTextures", SPRITE_TEXTURE_SLOTS, units);
+    }
     _vertbuff->bind();
     _unifbuff->bind(false);
     _unifbuff->deactivate();
@@ -737,6 +734,14 @@ void SpriteBatch::end() {
     flush();
     _shader->unbind();
     _active = false;
+    
+    // Other passes may rebind the slots, so forget them
+    _context.slotCount = 0;
+    _context.texsize = Size::ZERO;
+    _textures.clear();
+    _texture = nullptr;
+    _context.type = _context.type & ~TYPE_TEXTURE;
+    _context.dirty = _context.dirty | DIRTY_DRAWTYPE;
 }
 
 
@@ -750,20 +755,35 @@ void SpriteBatch::end() {
 void SpriteBatch::flush() {
     if (_indxSize == 0 || _vertSize == 0) {
         return;
-    } else if (_context->first != _indxSize) {
+    } else if (_context.first != _indxSize) {
         record();
     }
     
-    // Load all the vertex data at once
-    _vertbuff->loadVertexData(_vertData, _vertSize);
-    _vertbuff->loadIndexData(_indxData, _indxSize);
+    // The GPU time is filed under the pass that is flushing, so start it first
+    CU_PROFILE_GPU();
+    CU_PROFILE_ZONE("SpriteBatch::flush");
+    
+    // Load all the vertex data at once, once the GPU is done with this buffer
+    _vertbuff->bind();
+    if (_streaming) {
+        _stallTotal  += _vertbuff->waitFence();
+        _uploadTotal += _vertbuff->streamVertexData(_vertData, _vertSize);
+        _uploadTotal += _vertbuff->streamIndexData(_indxData, _indxSize);
+    } else {
+        // The driver waits on the GPU inside glBufferData instead
+        Timestamp start;
+        _vertbuff->loadVertexData(_vertData, _vertSize);
+        _vertbuff->loadIndexData(_indxData, _indxSize);
+        Timestamp end;
+        _stallTotal  += Timestamp::ellapsedMicros(start, end);
+        _uploadTotal += (Uint64)_vertSize*sizeof(SpriteVertex3) + (Uint64)_indxSize*sizeof(GLuint);
+    }
     _unifbuff->activate();
     _unifbuff->flush();
     
     // Chunk the uniforms
-    std::shared_ptr<Texture> previous = _context->texture;
     for(auto it = _history.begin(); it != _history.end(); ++it) {
-        Context* next = *it;
+        const Context* next = &(*it);
         if (next->dirty & DIRTY_EQUATION) {
             glBlendEquation(next->blendEquation);
         }
@@ -785,35 +805,46 @@ void SpriteBatch::flush() {
              _shader->setUniform1i("uType", next->type);
         }
         if (next->dirty & DIRTY_PERSPECTIVE) {
-            _shader->setUniformMat4("uPerspective",*(next->perspective.get()));
+            _shader->setUniformMat4("uPerspective",_perspectives[next->perspective]);
         }
         if (next->dirty & DIRTY_TEXTURE) {
-            previous = next->texture;
-            if (previous != nullptr) {
-                previous->bind();
+            for(GLuint ii = 0; ii < next->slotCount; ii++) {
+                _textures[next->slots[ii]]->bindAt(ii);
             }
         }
         if (next->dirty & DIRTY_UNIBLOCK) {
             _unifbuff->setBlock(next->blockptr);
         }
         if (next->dirty & DIRTY_BLURSTEP) {
-            blurTexture(next->texture,next->blurstep);
+            blurTexture(next->texsize,next->blurstep);
+        }
+        if (next->dirty) {
+            CU_PROFILE_COUNT(STATE_CHANGES,1);
         }
         GLuint amt = next->last-next->first;
         _vertbuff->draw(next->command, amt, next->first);
         _callTotal++;
     }
+    CU_PROFILE_COUNT(DRAW_CALLS,_history.size());
+    CU_PROFILE_COUNT(VERTICES,_indxSize);
     
     _unifbuff->deactivate();
     
+    // Move on to the buffer drawn from longest ago
+    if (_streaming) {
+        _vertbuff->setFence();
+        _ringIndex = (_ringIndex+1) % SPRITE_BUFFER_RING;
+        _vertbuff = _ring[_ringIndex];
+    }
+    
     // Increment the counters
     _vertTotal += _indxSize;
     
     _vertSize = _indxSize = 0;
     unwind();
-    _context->first = 0;
-    _context->last  = 0;
-    _context->blockptr = -1;
+    _context.first = 0;
+    _context.last  = 0;
+    _context.blockptr = -1;
 }
 
 
@@ -2020,25 +2051,35 @@ void SpriteBatch::draw(const std::shared_ptr<Texture>& texture, const Color4f co
  * will use the correct set of uniforms.
  */
 void SpriteBatch::record() {
-    Context* next = new Context(_context);
-    _context->last = _indxSize;
-    next->first = _indxSize;
+    _context.last = _indxSize;
     _history.push_back(_context);
-    _context = next;
+    _context.first = _indxSize;
+    _context.dirty = 0;
     _inflight = false;
 }
 
 /**
- * Deletes the recorded uniforms.
+ * Clears the recorded uniforms.
  *
- * This method is called upon flushing or cleanup.
+ * The state tables are compacted to just the entries used by the active
+ * context. This method is called upon flushing or cleanup.
  */
 void SpriteBatch::unwind() {
-    for(auto it = _history.begin(); it != _history.end(); ++it) {
-        delete *it;
-    }
     _history.clear();
-    _context->texture = nullptr;
+    
+    if (_context.perspective != 0) {
+        _perspectives[0] = _perspectives[_context.perspective];
+        _context.perspective = 0;
+    }
+    _perspectives.resize(1);
+    
+    for(GLuint ii = 0; ii < _context.slotCount; ii++) {
+        if (_context.slots[ii] != ii) {
+            _textures[ii] = _textures[_context.slots[ii]];
+            _context.slots[ii] = ii;
+        }
+    }
+    _textures.resize(_context.slotCount);
 }
 
 /**
@@ -2049,11 +2090,11 @@ void SpriteBatch::unwind() {
  * @param context   The current uniform context
  * @param tint      Whether to tint the gradient
  */
-void SpriteBatch::setUniformBlock(Context* context, bool tint) {
-    if (!(_context->dirty & DIRTY_UNIBLOCK)) {
+void SpriteBatch::setUniformBlock(Context& context, bool tint) {
+    if (!(context.dirty & DIRTY_UNIBLOCK)) {
         return;
     }
-    if (_context->blockptr+1 >= _unifbuff->getBlockCount()) {
+    if (context.blockptr+1 >= (GLsizei)_unifbuff->getBlockCount()) {
         flush();
     }
     float data[40];
@@ -2068,8 +2109,8 @@ void SpriteBatch::setUniformBlock(Context* context, bool tint) {
     } else {
         std::memset(data+16,0,24*sizeof(float));
     }
-    _context->blockptr++;
-    _unifbuff->setUniformfv(_context->blockptr,0,40,data);
+    context.blockptr++;
+    _unifbuff->setUniformfv(context.blockptr,0,40,data);
 }
 
 /**
@@ -2079,17 +2120,16 @@ void SpriteBatch::setUniformBlock(Context* context, bool tint) {
  * blur step into an offset in texture coordinates. It supports
  * non-square textures.
  *
- * If there is no active texture, the blur offset will be 0.
+ * If there is no active texture (the size is 0), the blur offset will be 0.
  *
- * @param texture   The texture to blur
+ * @param size      The size of the texture to blur
  * @param step      The blur step in pixels
  */
-void SpriteBatch::blurTexture(const std::shared_ptr<Texture>& texture, GLuint step) {
-    if (texture == nullptr) {
+void SpriteBatch::blurTexture(Size size, GLuint step) {
+    if (size.width == 0 || size.height == 0) {
         _shader->setUniform2f("uBlur", 0, 0);
         return;
     }
-    Size size = texture->getSize();
     size.width  = step/size.width;
     size.height = step/size.height;
     _shader->setUniform2f("uBlur",size.width,size.height);
@@ -2115,7 +2155,7 @@ unsigned int SpriteBatch::prepare(const Rect rect) {
         flush();
     }
     
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     float tsmax, tsmin;
     float ttmax, ttmin;
     
@@ -2130,12 +2170,13 @@ unsigned int SpriteBatch::prepare(const Rect rect) {
     }
     
     setUniformBlock(_context,true);
-    Poly2 poly(rect, _context->command == GL_TRIANGLES);
+    Poly2 poly(rect, _context.command == GL_TRIANGLES);
     unsigned int vstart = _vertSize;
     int ii = 0;
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
         _vertData[vstart+ii].position = point;
+        _vertData[vstart+ii].texslot = _slot;
         
         point.x = (point.x-rect.origin.x)/rect.size.width;
         point.y = 1-(point.y-rect.origin.y)/rect.size.height;
@@ -2181,7 +2222,7 @@ unsigned int SpriteBatch::prepare(const Rect rect, const Mat4& mat) {
         flush();
     }
 
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     float tsmax, tsmin;
     float ttmax, ttmin;
     
@@ -2196,12 +2237,13 @@ unsigned int SpriteBatch::prepare(const Rect rect, const Mat4& mat) {
     }
     
     setUniformBlock(_context,true);
-    Poly2 poly(rect, _context->command == GL_TRIANGLES);
+    Poly2 poly(rect, _context.command == GL_TRIANGLES);
     unsigned int vstart = _vertSize;
     int ii = 0;
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
         _vertData[vstart+ii].position = point*mat;
+        _vertData[vstart+ii].texslot = _slot;
         
         point.x = (point.x-rect.origin.x)/rect.size.width;
         point.y = 1-(point.y-rect.origin.y)/rect.size.height;
@@ -2241,7 +2283,7 @@ unsigned int SpriteBatch::prepare(const Rect rect, const Mat4& mat) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::prepare(const Poly2& poly) {
-    CUAssertLog(_context->command == GL_TRIANGLES ?
+    CUAssertLog(_context.command == GL_TRIANGLES ?
                  poly.indices().size() % 3 == 0 :
                  poly.indices().size() % 2 == 0,
                 "Polynomial has the wrong number of indices: %d", (int)poly.indices().size());
@@ -2252,7 +2294,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly) {
         flush();
     }
 
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     float twidth, theight;
     float tsmax, tsmin;
     float ttmax, ttmin;
@@ -2277,6 +2319,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly) {
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
         _vertData[vstart+ii].position = point;
+        _vertData[vstart+ii].texslot = _slot;
         
         point.x /= twidth;
         point.y = 1-point.y/theight;
@@ -2318,7 +2361,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::prepare(const Poly2& poly, const Vec2 off) {
-    CUAssertLog(_context->command == GL_TRIANGLES ?
+    CUAssertLog(_context.command == GL_TRIANGLES ?
                  poly.indices().size() % 3 == 0 :
                  poly.indices().size() % 2 == 0,
                 "Polynomial has the wrong number of indices: %d", (int)poly.indices().size());
@@ -2331,7 +2374,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Vec2 off) {
         flush();
     }
 
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     float twidth, theight;
     float tsmax, tsmin;
     float ttmax, ttmin;
@@ -2357,6 +2400,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Vec2 off) {
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
         _vertData[vstart+ii].position = point+off1;
+        _vertData[vstart+ii].texslot = _slot;
         
         point.x /= twidth;
         point.y = 1-point.y/theight;
@@ -2398,7 +2442,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Vec2 off) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
-    CUAssertLog(_context->command == GL_TRIANGLES ?
+    CUAssertLog(_context.command == GL_TRIANGLES ?
                  poly.indices().size() % 3 == 0 :
                  poly.indices().size() % 2 == 0,
                 "Polynomial has the wrong number of indices: %d", (int)poly.indices().size());
@@ -2409,7 +2453,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
         flush();
     }
 
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     float twidth, theight;
     float tsmax, tsmin;
     float ttmax, ttmin;
@@ -2434,6 +2478,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
         _vertData[vstart+ii].position = point*mat;
+        _vertData[vstart+ii].texslot = _slot;
         
         point.x /= twidth;
         point.y = 1-point.y/theight;
@@ -2475,13 +2520,13 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::chunkify(const Poly2& poly, const Mat4& mat) {
-    Texture* texture = _context->texture.get();
+    Texture* texture = _texture.get();
     std::unordered_map<Uint32, Uint32> offsets;
     const std::vector<cugl::Vec2> vertices  = poly.vertices();
     const std::vector<Uint32> indices = poly.indices();
     
     setUniformBlock(_context,true);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    int chunksize = _context.command == GL_TRIANGLES ? 3 : 2;
     unsigned int start = _indxSize;
 
     float twidth, theight;
@@ -2516,6 +2561,7 @@ unsigned int SpriteBatch::chunkify(const Poly2& poly, const Mat4& mat) {
                 Vec3 point = Vec3(vertices[indices[ii+jj]],_depth);
                 _indxData[_indxSize] = _vertSize;
                 _vertData[_vertSize].position = point*mat;
+                _vertData[_vertSize].texslot = _slot;
                 
                 point.x /= twidth;
                 point.y = 1-point.y/theight;
@@ -2562,6 +2608,7 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex2>& mesh, const Mat4& m
     int ii = 0;
     for(auto it = mesh.vertices.begin(); it != mesh.vertices.end(); ++it) {
         _vertData[_vertSize+ii].position = Vec3(it->position,_depth);
+        _vertData[_vertSize+ii].texslot = _slot;
         _vertData[_vertSize+ii].color = it->color;
         _vertData[_vertSize+ii].texcoord = it->texcoord;
         _vertData[_vertSize+ii].position *= mat;
@@ -2602,7 +2649,7 @@ unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex2>& mesh, const Mat4&
     std::unordered_map<Uint32, Uint32> offsets;
     
     setUniformBlock(_context,tint);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    int chunksize = _context.command == GL_TRIANGLES ? 3 : 2;
     unsigned int start = _indxSize;
     
     for(int ii = 0;  ii < mesh.indices.size(); ii += chunksize) {
@@ -2618,6 +2665,7 @@ unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex2>& mesh, const Mat4&
             } else {
                 _indxData[_indxSize] = _vertSize;
                 _vertData[_vertSize].position = Vec3(mesh.vertices[ii+jj].position,_depth);
+                _vertData[_vertSize].texslot = _slot;
                 _vertData[_vertSize].color = mesh.vertices[ii+jj].color;
                 _vertData[_vertSize].texcoord = mesh.vertices[ii+jj].texcoord;
                 _vertData[_vertSize].position *= mat;
@@ -2660,6 +2708,7 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex3>& mesh, const Mat4& m
     int ii = 0;
     for(auto it = mesh.vertices.begin(); it != mesh.vertices.end(); ++it) {
         _vertData[_vertSize+ii] = *it;
+        _vertData[_vertSize+ii].texslot = _slot;
         _vertData[_vertSize+ii].position *= mat;
         if (tint && _gradient == nullptr) {
             _vertData[_vertSize+ii].color *= _color;
@@ -2697,7 +2746,7 @@ unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex3>& mesh, const Mat4&
     std::unordered_map<Uint32, Uint32> offsets;
     
     setUniformBlock(_context,tint);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    int chunksize = _context.command == GL_TRIANGLES ? 3 : 2;
     unsigned int start = _indxSize;
     
     for(int ii = 0;  ii < mesh.indices.size(); ii += chunksize) {
@@ -2713,6 +2762,7 @@ unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex3>& mesh, const Mat4&
             } else {
                 _indxData[_indxSize] = _vertSize;
                 _vertData[_vertSize] = mesh.vertices[ii+jj];
+                _vertData[_vertSize].texslot = _slot;
                 _vertData[_vertSize].position *= mat;
                 if (tint && _gradient == nullptr) {
                     _vertData[_vertSize].color *= _color;
@@ -373,6 +373,35 @@ const Texture& Texture::set(const void *data) {
     return *this;
 }
 
+/**
+ * Sets a band of rows of this texture to the contents of the given buffer.
+ *
+ * The buffer must have the correct data format. In addition, the buffer
+ * must be size width*rows*bytesize, with no padding between rows.  See
+ * {@link #getByteSize} for a description of the latter.  If a pixel
+ * buffer is bound to GL_PIXEL_UNPACK_BUFFER, data is an offset into that
+ * buffer instead.
+ *
+ * This method is only successful if the texture is currently active.
+ *
+ * @param data  The buffer to read into the texture
+ * @param y     The first row to set
+ * @param rows  The number of rows to set
+ *
+ * @return a reference to this (modified) texture for chaining.
+ */
+const Texture& Texture::setRows(const void *data, int y, int rows) {
+    if (!isActive()) {
+        CUAssertLog(false,"Texture %s is not currently active.",_name.c_str());
+        return *this;
+    }
+    CUAssertLog(y >= 0 && y+rows <= _height, "Rows %d-%d are out of bounds",y,y+rows);
+    
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, _width, rows,
+                    (GLenum)_pixelFormat, format_type(_pixelFormat), data);
+    return *this;
+}
+
 
 #pragma mark -
 #pragma mark Attributes
@@ -633,7 +662,29 @@ void Texture::bind() {
         return;
     }
     
-    glActiveTexture(GL_TEXTURE0+_bindpoint);
+    bindAt(_bindpoint);
+}
+
+/**
+ * Binds this texture to the given bind point, making it active.
+ *
+ * This method is identical to {@link #bind}, except that it ignores (and
+ * does not change) the bind point of this texture. It is intended for
+ * classes like {@link SpriteBatch} that sample from several texture slots
+ * at once, where the same texture may occupy a different slot in each
+ * draw call.
+ *
+ * This call is reentrant. If can be safely called multiple times.
+ *
+ * @param point	The bind point to attach this texture to.
+ */
+void Texture::bindAt(GLuint point) {
+    if (_parent != nullptr) {
+        _parent->bindAt(point);
+        return;
+    }
+    
+    glActiveTexture(GL_TEXTURE0+point);
     glBindTexture(GL_TEXTURE_2D,_buffer);
     if (_dirty) {
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _minFilter);
@@ -644,6 +695,35 @@ void Texture::bind() {
     }
 }
 
+/**
+ * Binds this texture to the given bind point, optionally leaving the
+ * active texture as it was.
+ *
+ * If activate is true, this method is identical to {@link #bindAt}.
+ * Otherwise, the active texture is restored after the bind, so that
+ * textures bound later (without a slot) do not replace this one. This is
+ * useful for a texture that must stay bound past the slots of a
+ * {@link SpriteBatch} for a whole pass.
+ *
+ * This call is reentrant. If can be safely called multiple times.
+ *
+ * @param point	    The bind point to attach this texture to.
+ * @param activate  Whether to leave this texture active
+ */
+void Texture::bindAt(GLuint point, bool activate) {
+    if (activate) {
+        bindAt(point);
+        return;
+    }
+    
+    GLint orig;
+    glGetIntegerv(GL_ACTIVE_TEXTURE,&orig);
+    bindAt(point);
+    if (orig != (GLint)(GL_TEXTURE0+point)) {
+        glActiveTexture(orig);
+    }
+}
+
 /**
  * Unbinds this texture, making it neither bound nor active.
  *
@@ -0,0 +1,271 @@
+//
+//  CUUploadQueue.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a queue for spreading texture uploads over several
+//  frames. Images are decoded outside of the main thread, but the upload to
+//  OpenGL must happen in it. Uploading a burst of large images at once will
+//  cause the frame to hitch. This queue instead uploads a few rows at a time,
+//  stopping each frame once it has spent its byte or time budget. Waiting
+//  images are uploaded in order of priority.
+//
+//  Where the platform supports pixel buffer objects, each batch of rows is
+//  staged in a buffer so that the driver can finish the transfer without
+//  stalling the main thread.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/render/CUUploadQueue.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUTimestamp.h>
+#include <cugl/util/CUProfiler.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this queue.
+ *
+ * Waiting images are released without calling their callbacks.  A
+ * disposed queue can be safely reinitialized.
+ */
+void UploadQueue::dispose() {
+    if (_scheduled && Application::get() != nullptr) {
+        Application::get()->unschedule(_scheduled);
+    }
+    _scheduled = 0;
+    for(auto it = _uploads.begin(); it != _uploads.end(); ++it) {
+        SDL_FreeSurface(it->surface);
+    }
+    _uploads.clear();
+    if (_buffer) {
+        glDeleteBuffers(1,&_buffer);
+        _buffer = 0;
+    }
+    _bytes = 0;
+    _millis = 0;
+}
+
+/**
+ * Initializes an upload queue with the given budgets.
+ *
+ * The queue stops uploading each frame once it has uploaded the given
+ * number of bytes, or has spent the given number of milliseconds. At
+ * least one band of rows is uploaded each frame regardless.
+ *
+ * @param bytes     The number of bytes uploaded each frame
+ * @param millis    The number of milliseconds spent uploading each frame
+ *
+ * @return true if initialization was successful.
+ */
+bool UploadQueue::init(Uint32 bytes, Uint32 millis) {
+    _bytes = bytes;
+    _millis = millis;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Uploads
+/**
+ * Adds an image to this queue.
+ *
+ * The queue takes ownership of the surface, and frees it once the image
+ * is uploaded.  The surface must have four bytes per pixel, in the order
+ * expected by {@link Texture::PixelFormat#RGBA}.
+ *
+ * The callback is called in a later frame, once every row of the image
+ * has been uploaded.  If the texture could not be created, the callback
+ * is given nullptr.
+ *
+ * @param surface   The decoded image
+ * @param priority  The upload priority (higher uploads go first)
+ * @param callback  The function to call when finished
+ */
+void UploadQueue::push(SDL_Surface* surface, int priority, Callback callback) {
+    Upload upload;
+    upload.surface = surface;
+    upload.priority = priority;
+    upload.row = 0;
+    upload.callback = callback;
+
+    // After every upload of the same or higher priority
+    auto pos = std::upper_bound(_uploads.begin(), _uploads.end(), upload,
+                                [](const Upload& a, const Upload& b) {
+        return a.priority > b.priority;
+    });
+    _uploads.insert(pos,upload);
+
+    if (!_scheduled) {
+        _scheduled = Application::get()->schedule([=](void) {
+            bool more = this->update();
+            if (!more) {
+                this->_scheduled = 0;
+            }
+            return more;
+        });
+    }
+}
+
+/**
+ * Uploads one frame of the waiting images.
+ *
+ * This method is called automatically each frame while images are
+ * waiting.  It stops once the byte or time budget is spent.
+ *
+ * @return true if there are still images waiting
+ */
+bool UploadQueue::update() {
+    CU_PROFILE_ZONE("UploadQueue::update");
+    Timestamp start;
+    Uint64 spent = 0;
+    bool first = true;
+    while (!_uploads.empty()) {
+        if (!first) {
+            Timestamp now;
+            if (spent >= _bytes || Timestamp::ellapsedMillis(start,now) >= _millis) {
+                break;
+            }
+        }
+        first = false;
+
+        Upload& upload = _uploads.front();
+        SDL_Surface* surface = upload.surface;
+        if (surface == nullptr) {
+            finish(upload,false);
+            continue;
+        }
+        if (upload.texture == nullptr) {
+            upload.texture = Texture::alloc(surface->w,surface->h);
+            if (upload.texture == nullptr) {
+                finish(upload,false);
+                continue;
+            }
+        }
+
+        // Take as many rows as the budget has left (at least one)
+        Uint64 stride = (Uint64)surface->w*surface->format->BytesPerPixel;
+        Uint64 left = spent < _bytes ? _bytes-spent : 0;
+        int rows = (int)std::min<Uint64>(std::max<Uint64>(left/stride,1),surface->h-upload.row);
+
+        upload.texture->bind();
+        uploadRows(upload,rows);
+        upload.texture->unbind();
+        upload.row += rows;
+        spent += rows*stride;
+
+        if (upload.row == surface->h) {
+            finish(upload,true);
+        }
+    }
+    return !_uploads.empty();
+}
+
+/**
+ * Returns the number of waiting images, counting each by the fraction left.
+ *
+ * An image that is half uploaded counts as 0.5.  This allows a progress
+ * bar to move while a large image is uploading.
+ *
+ * @return the number of waiting images, counting each by the fraction left.
+ */
+float UploadQueue::getRemaining() const {
+    float result = 0;
+    for(auto it = _uploads.begin(); it != _uploads.end(); ++it) {
+        if (it->surface == nullptr || it->surface->h == 0) {
+            result += 1;
+        } else {
+            result += 1-((float)it->row)/it->surface->h;
+        }
+    }
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Uploads the given number of rows of the given upload.
+ *
+ * The texture must be bound.  The rows are staged in a pixel buffer if
+ * the platform supports it.  Otherwise they are read from the surface.
+ *
+ * @param upload    The upload to continue
+ * @param rows      The number of rows to upload
+ */
+void UploadQueue::uploadRows(const Upload& upload, int rows) {
+    SDL_Surface* surface = upload.surface;
+    size_t stride = (size_t)surface->w*surface->format->BytesPerPixel;
+    const Uint8* pixels = (const Uint8*)surface->pixels+(size_t)upload.row*surface->pitch;
+
+#ifdef GL_PIXEL_UNPACK_BUFFER
+    if (!_buffer) {
+        glGenBuffers(1,&_buffer);
+    }
+    if (_buffer) {
+        // Orphan the last band so that mapping does not wait on its transfer
+        GLsizeiptr size = (GLsizeiptr)(stride*rows);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER,_buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER,size,NULL,GL_STREAM_DRAW);
+        Uint8* staged = (Uint8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,0,size,
+                                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (staged != nullptr) {
+            for(int ii = 0; ii < rows; ii++) {
+                std::memcpy(staged+ii*stride,pixels+(size_t)ii*surface->pitch,stride);
+            }
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            upload.texture->setRows(NULL,upload.row,rows);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+            return;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+    }
+#endif
+
+    if ((size_t)surface->pitch == stride) {
+        upload.texture->setRows(pixels,upload.row,rows);
+    } else {
+        for(int ii = 0; ii < rows; ii++) {
+            upload.texture->setRows(pixels+(size_t)ii*surface->pitch,upload.row+ii,1);
+        }
+    }
+}
+
+/**
+ * Finishes the given upload, calling its callback.
+ *
+ * The upload must be the first one in the queue.
+ *
+ * @param upload    The upload to finish
+ * @param success   Whether the texture was uploaded
+ */
+void UploadQueue::finish(Upload& upload, bool success) {
+    // The callback may push another upload, so take it out of the queue first
+    Upload done = upload;
+    _uploads.erase(_uploads.begin());
+    SDL_FreeSurface(done.surface);
+    if (done.callback != nullptr) {
+        done.callback(success ? done.texture : nullptr);
+    }
+}
@@ -33,6 +33,9 @@
 #include <cugl/render/CUVertexBuffer.h>
 #include <cugl/render/CUShader.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/util/CUTimestamp.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace cugl;
 
@@ -43,10 +46,13 @@ using namespace cugl;
  * You must initialize the vertex buffer to allocate buffer memory.
  */
 VertexBuffer::VertexBuffer() :
+_stride(0),
 _vertArray(0),
 _vertBuffer(0),
 _indxBuffer(0),
-_stride(0) {
+_vertCapacity(0),
+_indxCapacity(0),
+_fence(0) {
     _shader = nullptr;
 }
 
@@ -113,6 +119,12 @@ void VertexBuffer::dispose() {
     }
     _enabled.clear();
     _attributes.clear();
+    if (_fence) {
+        glDeleteSync(_fence);
+        _fence = 0;
+    }
+    _vertCapacity = 0;
+    _indxCapacity = 0;
     glDeleteBuffers(1,&_indxBuffer);
     glDeleteBuffers(1,&_vertBuffer);
     glDeleteVertexArrays(1,&_vertArray);
@@ -261,6 +273,7 @@ bool VertexBuffer::isBound() const {
 void VertexBuffer::loadVertexData(const void * data, GLsizei size, GLenum usage) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
     glBufferData( GL_ARRAY_BUFFER, _stride * size, data, usage );
+    _vertCapacity = (GLsizeiptr)_stride * size;
     
     GLenum error = glGetError();
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
@@ -295,10 +308,132 @@ void VertexBuffer::loadVertexData(const void * data, GLsizei size, GLenum usage)
 void VertexBuffer::loadIndexData(const void * data, GLsizei size, GLenum usage) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, size * sizeof(GLuint), data, usage );
+    _indxCapacity = (GLsizeiptr)sizeof(GLuint) * size;
+    GLenum error = glGetError();
+    CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
+}
+
+/**
+ * Writes data to the start of the bound buffer for the given target
+ *
+ * The buffer grows to at least twice its old size if the data does not fit.
+ * Otherwise the data is written through an unsynchronized mapping, falling
+ * back to an orphaning upload if the buffer cannot be mapped.
+ *
+ * @param target    The buffer target
+ * @param data      The data to write
+ * @param bytes     The size of the data in bytes
+ * @param capacity  The current buffer size in bytes (updated on growth)
+ */
+static void stream_data(GLenum target, const void * data, GLsizeiptr bytes, GLsizeiptr& capacity) {
+    if (bytes > capacity) {
+        capacity = std::max(bytes, 2*capacity);
+        glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, bytes, data);
+    } else {
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void* dst = glMapBufferRange(target, 0, bytes, access);
+        if (dst) {
+            std::memcpy(dst, data, bytes);
+            glUnmapBuffer(target);
+        } else {
+            glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(target, 0, bytes, data);
+        }
+    }
+    
     GLenum error = glGetError();
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
 }
 
+/**
+ * Streams the given vertex data into this buffer.
+ *
+ * Unlike {@link #loadVertexData}, this method does not reallocate the
+ * buffer on every call. The buffer only grows (to at least twice its
+ * old size) when the data does not fit. Otherwise the data is written
+ * through an unsynchronized mapping, so the driver never waits for
+ * earlier draws from this buffer.
+ *
+ * That makes it the responsibility of the caller to ensure the GPU is
+ * done with this buffer, typically by calling {@link #waitFence} first.
+ * Cycling through several buffers keeps that wait short.
+ *
+ * This method will only succeed if this buffer is actively bound.
+ *
+ * @param data  The data to load
+ * @param size  The number of vertices to load
+ *
+ * @return the number of bytes uploaded
+ */
+GLsizeiptr VertexBuffer::streamVertexData(const void * data, GLsizei size) {
+    GLsizeiptr bytes = (GLsizeiptr)_stride * size;
+    stream_data(GL_ARRAY_BUFFER, data, bytes, _vertCapacity);
+    return bytes;
+}
+
+/**
+ * Streams the given indices into this buffer.
+ *
+ * This method works like {@link #streamVertexData}, and has the same
+ * requirement that the GPU is done with this buffer.
+ *
+ * This method will only succeed if this buffer is actively bound.
+ *
+ * @param data  The indices to load
+ * @param size  The number of indices to load
+ *
+ * @return the number of bytes uploaded
+ */
+GLsizeiptr VertexBuffer::streamIndexData(const void * data, GLsizei size) {
+    GLsizeiptr bytes = (GLsizeiptr)sizeof(GLuint) * size;
+    stream_data(GL_ELEMENT_ARRAY_BUFFER, data, bytes, _indxCapacity);
+    return bytes;
+}
+
+/**
+ * Marks the end of the draw commands that read from this buffer.
+ *
+ * A later call to {@link #waitFence} will block until the GPU has
+ * executed every command issued before this one.
+ */
+void VertexBuffer::setFence() {
+    if (_fence) {
+        glDeleteSync(_fence);
+    }
+    _fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/**
+ * Blocks until the GPU is done with the commands before the last fence.
+ *
+ * This method returns immediately if no fence is set or the fence has
+ * already passed.
+ *
+ * @return the time spent waiting, in microseconds
+ */
+Uint64 VertexBuffer::waitFence() {
+    if (!_fence) {
+        return 0;
+    }
+    
+    Uint64 result = 0;
+    GLenum status = glClientWaitSync(_fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        Timestamp start;
+        while (status == GL_TIMEOUT_EXPIRED) {
+            // Flush so the fence is guaranteed to be reached
+            status = glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        Timestamp end;
+        result = Timestamp::ellapsedMicros(start, end);
+    }
+    CUAssertLog(status != GL_WAIT_FAILED, "VertexBuffer: fence wait failed");
+    glDeleteSync(_fence);
+    _fence = 0;
+    return result;
+}
+
 /**
  * Draws to the active framebuffer using this vertex buffer
  *
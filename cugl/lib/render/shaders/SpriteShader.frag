@@ -40,8 +40,8 @@ uniform int  uType;
 // Blur offset for simple kernel blur
 uniform vec2 uBlur;
 
-// The texture for sampling
-uniform sampler2D uTexture;
+// The textures for sampling (one per slot)
+uniform sampler2D uTextures[8];
 
 // The output color
 out vec4 frag_color;
@@ -50,6 +50,7 @@ out vec4 frag_color;
 in vec2 outPosition;
 in vec4 outColor;
 in vec2 outTexCoord;
+in float outTexSlot;
 
 // The stroke+gradient uniform block
 layout (std140) uniform uContext
@@ -101,6 +102,27 @@ float scissormask(vec2 pt) {
     return clamp(sc.x,0.0,1.0) * clamp(sc.y,0.0,1.0);
 }
 
+/**
+ * Returns the texture color at the given coordinate
+ *
+ * The texture is the one in the slot for this vertex. Samplers
+ * may only be indexed by constants, hence the branches.
+ *
+ * coord: The texture coordinate to sample
+ */
+vec4 slotsample(vec2 coord) {
+    int slot = int(outTexSlot+0.5);
+    if (slot < 4) {
+        if (slot < 2) {
+            return slot == 0 ? texture(uTextures[0], coord) : texture(uTextures[1], coord);
+        }
+        return slot == 2 ? texture(uTextures[2], coord) : texture(uTextures[3], coord);
+    } else if (slot < 6) {
+        return slot == 4 ? texture(uTextures[4], coord) : texture(uTextures[5], coord);
+    }
+    return slot == 6 ? texture(uTextures[6], coord) : texture(uTextures[7], coord);
+}
+
 /**
  * Returns the result of a simple kernel blur
  *
@@ -138,7 +160,7 @@ vec4 blursample(vec2 coord) {
     // Sample from the texture and average
     vec4 result = vec4(0.0);
     for(int ii = 0; ii < 9; ii++) {
-        result += texture(uTexture, coord + off[ii])*kernel[ii];
+        result += slotsample(coord + off[ii])*kernel[ii];
     }
 
     return result;
@@ -180,7 +202,7 @@ void main(void) {
         if (uType >= 8) {
             result *= blursample(outTexCoord);
         } else {
-            result *= texture(uTexture, outTexCoord);
+            result *= slotsample(outTexCoord);
         }
     }
     
@@ -45,93 +45,97 @@
 //  Version: 3/7/21
 #include <cugl/scene2/graph/CUOrderedNode.h>
 #include <cugl/render/CUScissor.h>
+#include <algorithm>
 
 using namespace cugl;
 using namespace cugl::scene2;
 
-#pragma mark Context
-/**
- * Creates a drawing context with the given parent object
- *
- * @param parent    The parent object for the inner class
- */
-OrderedNode::Context::Context(OrderedNode* parent) :
-node(nullptr),
-scissor(nullptr),
-canonical(0) {
-    this->parent = parent;
-    tint = Color4::WHITE;
-}
-       
+#pragma mark Render Queue
+/** If more entries than this change sort key, do a full sort instead of a repair */
+#define ORDER_REPAIR_LIMIT 32
 
 /**
- * Creates a copy of the given drawing context
- *
- * @param copy      The drawing context to copy
- */
-OrderedNode::Context::Context(const Context& copy) {
-    node = copy.node;
-    scissor = copy.scissor;
-    canonical = copy.canonical;
-    transform = copy.transform;
-    tint = copy.tint;
-}
-
-/**
- * Deletes this drawing context, disposing of all resources.
- */
-OrderedNode::Context::~Context() {
-    node = nullptr;
-    scissor = nullptr;
-}
-
-/**
- * Returns the value *a < *b
+ * Returns true if entry a should be drawn before entry b
  *
  * This function implements a sort order on drawing contexts and
- * is used to sort the render queue.
+ * is used to sort the render queue. Ties are broken by canonical order.
  *
- * @param a        The first (pointer) to compare
- * @param b        The first (pointer) to compare
+ * @param a     The index of the first entry
+ * @param b     The index of the second entry
  *
- * @return the value *a < *b
+ * @return true if entry a should be drawn before entry b
  */
-bool OrderedNode::Context::sortCompare(Context* a, Context* b) {
+bool OrderedNode::sortCompare(Uint32 a, Uint32 b) const {
     // NOTE: Pre or post is determined by canonical order
-    switch (a->parent->_order) {
+    const Context& ca = _entries[a];
+    const Context& cb = _entries[b];
+    switch (_order) {
         case PRE_ORDER:
         case POST_ORDER:
-            return a->canonical < b->canonical;
+            return a < b;
         case ASCEND:
-            if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
+            if (ca.priority == cb.priority) {
+                return a < b;
             }
-            return a->node->getPriority() < b->node->getPriority();
+            return ca.priority < cb.priority;
         case PRE_ASCEND:
         case POST_ASCEND:
-            if (a->node->getParent() != b->node->getParent()) {
-                return a->canonical < b->canonical;
-            } else if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
+            if (ca.group != cb.group) {
+                return a < b;
+            } else if (ca.priority == cb.priority) {
+                return a < b;
             }
-            return a->node->getPriority() < b->node->getPriority();
+            return ca.priority < cb.priority;
         case DESCEND:
-            if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
+            if (ca.priority == cb.priority) {
+                return a < b;
             }
-            return a->node->getPriority() > b->node->getPriority();
+            return ca.priority > cb.priority;
         case PRE_DESCEND:
         case POST_DESCEND:
-            if (a->node->getParent() != b->node->getParent()) {
-                return a->canonical < b->canonical;
-            } else if (a->node->getPriority() == b->node->getPriority()) {
-                return a->canonical < b->canonical;
+            if (ca.group != cb.group) {
+                return a < b;
+            } else if (ca.priority == cb.priority) {
+                return a < b;
             }
-            return a->node->getPriority() > b->node->getPriority();
+            return ca.priority > cb.priority;
     }
     return false;
 }
 
+/**
+ * Brings the render order up to date with the current render pass.
+ *
+ * If no sort key changed since the previous pass, the previous order is
+ * reused as is. If only a few keys changed, the previous order is nearly
+ * sorted and is repaired with an insertion sort. Otherwise (including
+ * any change in the number of entries) it is fully sorted again.
+ */
+void OrderedNode::updateOrder() {
+    auto compare = [this](Uint32 a, Uint32 b) { return sortCompare(a, b); };
+    if (_sorted.size() != _count) {
+        _sorted.resize(_count);
+        for (Uint32 ii = 0; ii < _count; ii++) {
+            _sorted[ii] = ii;
+        }
+        std::sort(_sorted.begin(), _sorted.end(), compare);
+    } else if (_changed > ORDER_REPAIR_LIMIT) {
+        std::sort(_sorted.begin(), _sorted.end(), compare);
+    } else if (_changed > 0) {
+        // Insertion sort is linear in the size plus the number of inversions
+        for (size_t ii = 1; ii < _sorted.size(); ii++) {
+            Uint32 value = _sorted[ii];
+            size_t jj = ii;
+            while (jj > 0 && compare(value, _sorted[jj-1])) {
+                _sorted[jj] = _sorted[jj-1];
+                jj--;
+            }
+            _sorted[jj] = value;
+        }
+    }
+    _changed = 0;
+}
+
 #pragma mark -
 #pragma mark Ordered Node
 /**
@@ -143,8 +147,12 @@ bool OrderedNode::Context::sortCompare(Context* a, Context* b) {
  * on the heap, use one of the static constructors instead.
  */
 OrderedNode::OrderedNode() :
+_count(0),
+_changed(0),
 _viewport(nullptr),
+_culling(false),
 _order(PRE_ORDER) {
+    _barrier = true;
 }
 
 /**
@@ -157,11 +165,10 @@ _order(PRE_ORDER) {
  * a scene graph.
  */
 void OrderedNode::dispose() {
-    for(auto it = _entries.begin(); it != _entries.end(); ++it) {
-        delete *it;
-        *it = nullptr;
-    }
     _entries.clear();
+    _sorted.clear();
+    _count = 0;
+    _changed = 0;
     _viewport = nullptr;
     SceneNode::dispose();
 }
@@ -288,6 +295,11 @@ bool OrderedNode::initWithData(const Scene2Loader* loader, const std::shared_ptr
  */
 void OrderedNode::visit(const std::shared_ptr<SceneNode>& node, const Mat4& transform, Color4 tint) {
     if (!node->isVisible()) { return; }
+    if (_culling && node->isCulled(_cullRect, transform)) { return; }
+    
+    // Descendants of a static node are drawn (or culled) with it
+    bool unit = _culling && node->isStatic();
+    if (unit) { _culling = false; }
 
     Mat4 matrix;
     Mat4::multiply(node->getTransform(),transform,&matrix);
@@ -310,33 +322,39 @@ void OrderedNode::visit(const std::shared_ptr<SceneNode>& node, const Mat4& tran
     
     // Identify pre or post. Block at child ordered nodes
     bool ispost = (_order == POST_ORDER || _order == POST_ASCEND || _order == POST_DESCEND);
-    bool barrier = node->getClassName() == getClassName();
+    bool barrier = node->isRenderBarrier();
+    // The const overload returns the children by reference rather than a copy
+    const std::vector<std::shared_ptr<SceneNode>>& children = static_cast<const SceneNode*>(node.get())->getChildren();
     if (ispost && !barrier) {
-        auto children = node->getChildren();
         for(auto it = children.begin(); it != children.end(); ++it) {
             visit(*it, matrix, color);
         }
     }
     
-    // Capture pre or post order traversal
-    Uint32 canonical = (_entries.empty() ? 0 : _entries.back()->canonical+1);
-    
-    Context* context = new Context(this);
-    _entries.push_back(context);
-    context->node = node;
-    context->transform = barrier ? transform : matrix;
-    context->scissor = _viewport;
-    context->tint = barrier ? tint : color;
-    context->canonical = canonical;
+    // Capture pre or post order traversal, reusing a pooled context
+    if (_count == _entries.size()) {
+        _entries.emplace_back();
+    }
+    Context& context = _entries[_count++];
+    if (context.priority != node->getPriority() || context.group != node->getParent()) {
+        _changed++;
+    }
+    context.node = node.get();
+    context.transform = barrier ? transform : matrix;
+    context.scissor = _viewport;
+    context.tint = barrier ? tint : color;
+    context.priority = node->getPriority();
+    context.group = node->getParent();
+    context.barrier = barrier;
     
     if (!ispost && !barrier) {
-        auto children = node->getChildren();
         for(auto it = children.begin(); it != children.end(); ++it) {
             visit(*it, matrix, color);
         }
     }
 
     _viewport = previous;
+    if (unit) { _culling = true; }
 }
 
 /**
@@ -356,10 +374,14 @@ void OrderedNode::visit(const std::shared_ptr<SceneNode>& node, const Mat4& tran
 void OrderedNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
     if (!_isVisible) { return; }
     
-    if (_order == PRE_ORDER) {
-        // Drop to standard for efficiency
+    if (_order == PRE_ORDER || _isBaked) {
+        // Drop to standard for efficiency (a baked subtree is already flat)
         SceneNode::render(batch,transform,tint);
     } else {
+        if (batch->isCulling() && isCulled(batch->getCullRect(), transform)) { return; }
+        _culling = batch->isCulling() && !_static;
+        _cullRect = batch->getCullRect();
+        
         Mat4 matrix;
         Mat4::multiply(_combined,transform,&matrix);
         Color4 color = _tintColor;
@@ -380,28 +402,24 @@ void OrderedNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4&
         }
 
         // Build and sort
+        _count = 0;
         for(auto it = _children.begin(); it != _children.end(); ++it) {
             visit(*it, matrix, color);
         }
+        updateOrder();
 
-        std::sort(_entries.begin(), _entries.end(), Context::sortCompare);
-        for(auto it = _entries.begin(); it != _entries.end(); ++it) {
-            Context* context = *it;
-            batch->setScissor(context->scissor); // This is in render, so must be applied
-            if (context->node->getClassName() == getClassName()) {
+        for(auto it = _sorted.begin(); it != _sorted.end(); ++it) {
+            Context& context = _entries[*it];
+            batch->setScissor(context.scissor); // This is in render, so must be applied
+            if (context.barrier) {
                 // Render barrier at an ordered node
-                context->node->render(batch, context->transform, context->tint);
+                context.node->render(batch, context.transform, context.tint);
             } else {
-                context->node->draw(batch, context->transform, context->tint);
+                context.node->draw(batch, context.transform, context.tint);
             }
         }
 
-        // Clean up and restore state
-        for(auto it = _entries.begin(); it != _entries.end(); ++it) {
-            delete *it;
-            *it = nullptr;
-        }
-        _entries.clear();
+        // Restore state; the contexts are kept for the next pass
         _viewport = nullptr;
         batch->setScissor(active);
     }
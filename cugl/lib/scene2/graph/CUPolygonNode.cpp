@@ -138,6 +138,44 @@ void PolygonNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& tr
     batch->setGradient(nullptr);
 }
 
+/**
+ * Adds the geometry of this node (but not its children) to a baked mesh.
+ *
+ * This is the baking counterpart of {@link #draw}. The polygon mesh is
+ * transformed, tinted and added to piece with the node texture. A node
+ * with a gradient or a blend mode other than the default cannot be
+ * baked, and this method returns false.
+ *
+ * @param piece     The mesh to add to
+ * @param transform The transform to the baked node
+ * @param tint      The tint to blend with the node color
+ *
+ * @return true if this node could be baked.
+ */
+bool PolygonNode::bakeGeometry(BakedMesh& piece, const Mat4& transform, Color4 tint) {
+    if (_gradient || _blendEquation != GL_FUNC_ADD ||
+        _srcFactor != GL_SRC_ALPHA || _dstFactor != GL_ONE_MINUS_SRC_ALPHA) {
+        return false;
+    }
+    if (!_rendered) {
+        generateRenderData();
+    }
+    
+    piece.texture = _texture;
+    Vec4 color = Color4f(tint);
+    for(auto it = _mesh.vertices.begin(); it != _mesh.vertices.end(); ++it) {
+        SpriteVertex3 vert;
+        vert.position = Vec3(it->position,0);
+        vert.position *= transform;
+        vert.color = it->color;
+        vert.color *= color;
+        vert.texcoord = it->texcoord;
+        piece.mesh.vertices.push_back(vert);
+    }
+    piece.mesh.indices = _mesh.indices;
+    return true;
+}
+
 /** A triangulator for those incomplete polygons */
 cugl::SimpleTriangulator PolygonNode::_triangulator;
 
@@ -38,10 +38,12 @@
 #include <cugl/scene2/CUScene2.h>
 #include <cugl/scene2/layout/CULayout.h>
 #include <cugl/render/CUCamera.h>
+#include <cugl/render/CUTexture.h>
 #include <cugl/util/CUStrings.h>
 #include <cugl/assets/CUAssetManager.h>
 #include <sstream>
 #include <algorithm>
+#include <tuple>
 
 using namespace cugl;
 using namespace cugl::scene2;
@@ -56,22 +58,26 @@ using namespace cugl::scene2;
  * heap, use one of the static constructors instead.
  */
 SceneNode::SceneNode() :
-_tag(0),
-_name(""),
-_hashOfName(0),
+_anchor(Vec2::ANCHOR_BOTTOM_LEFT),
 _tintColor(Color4::WHITE),
 _hasParentColor(true),
 _isVisible(true),
-_anchor(Vec2::ANCHOR_BOTTOM_LEFT),
 _scale(Vec2::ONE),
 _angle(0),
 _useTransform(false),
 _parent(nullptr),
 _graph(nullptr),
+_childOffset(-2),
+_tag(0),
+_name(""),
+_hashOfName(0),
 _zOrder(0),
 _zDirty(false),
 _priority(0),
-_childOffset(-2) {}
+_barrier(false),
+_boundsDirty(true),
+_static(false),
+_isBaked(false) {}
 
 /**
  * Initializes a node at the given position.
@@ -275,6 +281,7 @@ void SceneNode::dispose() {
     _zOrder = 0;
     _zDirty = false;
     _json = nullptr;
+    unbake();
 }
 
 /**
@@ -327,6 +334,7 @@ void SceneNode::setPosition(float x, float y) {
     _combined.m[12] += (x-_position.x);
     _combined.m[13] += (y-_position.y);
     _position.set(x,y);
+    invalidateBounds();
 }
 
 /**
@@ -346,6 +354,7 @@ void SceneNode::setContentSize(const Size size) {
     _position += _anchor*(size-_contentSize);
     _contentSize.set(size);
     if (!_useTransform) updateTransform();
+    invalidateBounds();
     if (_layout) {
         doLayout();
     }
@@ -502,6 +511,80 @@ void SceneNode::updateTransform() {
     }
     _combined.m[12] += _position.x-offset.x;
     _combined.m[13] += _position.y-offset.y;
+    invalidateBounds();
+}
+
+/**
+ * Returns an AABB of this node and all of its descendants in the parent's coordinates.
+ *
+ * This is the union of {@link getBoundingBox} with the subtree bounds of
+ * every child (visible or not). Nodes with no content size contribute
+ * nothing. If no node in the subtree has a content size, the result has
+ * size zero.
+ *
+ * The value is cached, and is only recomputed when the transform, the
+ * content size, or the children of some node in the subtree change.
+ *
+ * @return An AABB of this node and all of its descendants in the parent's coordinates.
+ */
+const Rect& SceneNode::getSubtreeBounds() const {
+    if (!_boundsDirty) {
+        return _bounds;
+    }
+    
+    // Gather in node space, and transform once at the end
+    Rect local(Vec2::ZERO, _contentSize);
+    bool empty = _contentSize == Size::ZERO;
+    for(auto it = _children.begin(); it != _children.end(); ++it) {
+        const Rect& child = (*it)->getSubtreeBounds();
+        if (child.size == Size::ZERO) {
+            continue;
+        } else if (empty) {
+            local = child;
+            empty = false;
+        } else {
+            local.merge(child);
+        }
+    }
+    
+    _bounds = empty ? Rect(_combined.transform(Vec2::ZERO), Size::ZERO) : _combined.transform(local);
+    _boundsDirty = false;
+    return _bounds;
+}
+
+/**
+ * Marks the subtree bounds of this node, and of all its ancestors, as out of date.
+ *
+ * This is called automatically whenever the transform, content size or
+ * children of this node change. Custom nodes only need to call it if
+ * they change their bounds some other way.
+ */
+void SceneNode::invalidateBounds() {
+    // A clean node has clean descendants, so we can stop at a dirty ancestor
+    _boundsDirty = true;
+    for(SceneNode* node = _parent; node != nullptr && !node->_boundsDirty; node = node->_parent) {
+        node->_boundsDirty = true;
+    }
+}
+
+/**
+ * Returns true if this node is outside of the given view.
+ *
+ * This test uses {@link getSubtreeBounds}, so a culled node has no
+ * visible descendants either. A subtree with no content size is never
+ * culled, as its extent is unknown.
+ *
+ * @param view      The visible region, in drawing coordinates
+ * @param transform The parent to drawing coordinate transform
+ *
+ * @return true if this node is outside of the given view.
+ */
+bool SceneNode::isCulled(const Rect& view, const Mat4& transform) const {
+    const Rect& bounds = getSubtreeBounds();
+    if (bounds.size == Size::ZERO) {
+        return false;
+    }
+    return !view.doesIntersect(transform.transform(bounds));
 }
 
 
@@ -615,6 +698,7 @@ void SceneNode::addChild(const std::shared_ptr<SceneNode>& child, int zval) {
     _children.push_back(child);
     child->setParent(this);
     child->pushScene(_graph);
+    invalidateBounds();
     
 }
 
@@ -639,6 +723,7 @@ void SceneNode::swapChild(const std::shared_ptr<SceneNode>& child1,
     child1->setParent(nullptr);
     child2->pushScene(_graph);
     child1->pushScene(nullptr);
+    invalidateBounds();
     
     // Check if we are dirty and/or inherit children
     bool childdirty = false;
@@ -672,6 +757,7 @@ void SceneNode::removeChild(unsigned int pos) {
         _children[ii]->_childOffset = ii;
     }
     _children.resize(_children.size()-1);
+    invalidateBounds();
 }
 
 /**
@@ -736,6 +822,7 @@ void SceneNode::removeAllChildren() {
     }
     _children.clear();
     _zDirty = false;
+    invalidateBounds();
 }
 
 /**
@@ -900,6 +987,13 @@ void SceneNode::sortZOrder() {
 void SceneNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
     if (!_isVisible) { return; }
     
+    // Skip this subtree if it is off screen; a static subtree is one test
+    bool unit = false;
+    if (batch->isCulling()) {
+        if (isCulled(batch->getCullRect(), transform)) { return; }
+        unit = _static;
+    }
+    
     Mat4 matrix;
     Mat4::multiply(_combined,transform,&matrix);
     Color4 color = _tintColor;
@@ -917,9 +1011,15 @@ void SceneNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& tr
         batch->setScissor(local);
     }
 
-    draw(batch,matrix,color);
-    for(auto it = _children.begin(); it != _children.end(); ++it) {
-        (*it)->render(batch, matrix, color);
+    if (_isBaked) {
+        drawBaked(batch,matrix,color);
+    } else {
+        draw(batch,matrix,color);
+        if (unit) { batch->setCulling(false); }
+        for(auto it = _children.begin(); it != _children.end(); ++it) {
+            (*it)->render(batch, matrix, color);
+        }
+        if (unit) { batch->setCulling(true); }
     }
 
     if (_scissor) {
@@ -927,6 +1027,140 @@ void SceneNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& tr
     }
 }
 
+/** A piece of baked geometry, with its place in the drawing order */
+typedef struct {
+    float priority;
+    size_t index;
+    std::shared_ptr<Texture> texture;
+    Mesh<SpriteVertex3> mesh;
+} BakedPiece;
+
+/**
+ * Flattens this node and all of its descendants into prebuilt meshes.
+ *
+ * The geometry of every visible node in the subtree is transformed into
+ * the coordinate space of this node, tinted, and merged into one mesh
+ * per run of nodes that share a texture buffer. When textures come from
+ * the same atlas, this is usually a single mesh. From then on, render
+ * draws these meshes instead of visiting the subtree, so a baked node
+ * costs a few calls to {@link SpriteBatch#fill} and no per-node work.
+ *
+ * Baking only captures the subtree as it is now. Later changes to the
+ * descendants (including their visibility) are not drawn until the node
+ * is baked again. Changes to this node itself, such as its position or
+ * color, still apply. The children remain in the scene graph, so they
+ * can still be found by name or tag.
+ *
+ * Nodes are normally baked in pre-order, which is the order of render.
+ * If byPriority is true, they are sorted by ascending priority instead
+ * (ties in pre-order), which matches an {@link OrderedNode} with order
+ * ASCEND. A baked node is a render barrier, so it is drawn as one unit
+ * at its own priority.
+ *
+ * A subtree cannot be baked if a descendant has a scissor, does not use
+ * relative color, or cannot be baked itself (see {@link #bakeGeometry}).
+ * In that case this method returns false and the node is unchanged.
+ *
+ * @param byPriority    Whether to order the geometry by priority
+ *
+ * @return true if the subtree was baked.
+ */
+bool SceneNode::bake(bool byPriority) {
+    std::vector<BakedPiece> pieces;
+    
+    // Gather the subtree in pre-order. This node is the origin, and its own
+    // color is applied when the meshes are drawn.
+    std::vector<std::tuple<SceneNode*,Mat4,Color4>> stack;
+    stack.emplace_back(this, Mat4::IDENTITY, Color4::WHITE);
+    while (!stack.empty()) {
+        SceneNode* node = std::get<0>(stack.back());
+        Mat4 matrix = std::get<1>(stack.back());
+        Color4 color = std::get<2>(stack.back());
+        stack.pop_back();
+        
+        if (node != this) {
+            if (node->_scissor || !node->_hasParentColor) {
+                return false;
+            }
+            Mat4 parent = matrix;
+            Mat4::multiply(node->_combined,parent,&matrix);
+            color *= node->_tintColor;
+        }
+        
+        BakedPiece piece;
+        piece.priority = node->_priority;
+        piece.index = pieces.size();
+        BakedMesh baked;
+        baked.mesh.command = GL_TRIANGLES;
+        if (!node->bakeGeometry(baked, matrix, color)) {
+            return false;
+        }
+        if (!baked.mesh.indices.empty()) {
+            piece.texture = baked.texture;
+            piece.mesh = std::move(baked.mesh);
+            pieces.push_back(std::move(piece));
+        }
+        
+        // Push in reverse so that the first child is baked first
+        for(auto it = node->_children.rbegin(); it != node->_children.rend(); ++it) {
+            if ((*it)->_isVisible) {
+                stack.emplace_back(it->get(), matrix, color);
+            }
+        }
+    }
+    
+    if (byPriority) {
+        std::stable_sort(pieces.begin(), pieces.end(), [](const BakedPiece& a, const BakedPiece& b) {
+            return a.priority < b.priority;
+        });
+    }
+    
+    // Merge runs that share a texture buffer
+    _baked.clear();
+    for(auto it = pieces.begin(); it != pieces.end(); ++it) {
+        GLuint buffer = it->texture ? it->texture->getBuffer() : 0;
+        if (_baked.empty() || buffer != (_baked.back().texture ? _baked.back().texture->getBuffer() : 0)) {
+            _baked.emplace_back();
+            _baked.back().texture = it->texture;
+            _baked.back().mesh.command = GL_TRIANGLES;
+        }
+        Mesh<SpriteVertex3>& mesh = _baked.back().mesh;
+        GLuint offset = (GLuint)mesh.vertices.size();
+        mesh.vertices.insert(mesh.vertices.end(), it->mesh.vertices.begin(), it->mesh.vertices.end());
+        for(auto jt = it->mesh.indices.begin(); jt != it->mesh.indices.end(); ++jt) {
+            mesh.indices.push_back(offset+*jt);
+        }
+    }
+    _isBaked = true;
+    return true;
+}
+
+/**
+ * Discards the baked meshes, so that the subtree is drawn normally.
+ */
+void SceneNode::unbake() {
+    _baked.clear();
+    _isBaked = false;
+}
+
+/**
+ * Draws the baked meshes of this node with the given SpriteBatch.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the node color.
+ */
+void SceneNode::drawBaked(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+    // Only nodes with the default blend mode can be baked
+    batch->setColor(tint);
+    batch->setBlendEquation(GL_FUNC_ADD);
+    batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for(auto it = _baked.begin(); it != _baked.end(); ++it) {
+        batch->setTexture(it->texture);
+        batch->fill(it->mesh, transform);
+    }
+}
+
 /**
  * Returns the absolute color tinting this node.
  *
@@ -0,0 +1,480 @@
+//
+//  CUProfiler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a lightweight frame profiler. Code is divided into
+//  named zones, which are timed on whichever thread they run. Each thread
+//  writes its zones to its own ring buffer without locking, and the main
+//  thread collects them once per frame. Sprite batch flushes are also timed
+//  on the GPU with timer queries (where the platform supports them), and a
+//  few counters (draw calls, vertices, state changes, and allocations if the
+//  application reports them) are kept per frame. A capture of several frames
+//  can be saved as a Chrome trace.
+//
+//  The instrumentation macros are compiled out unless CU_PROFILE is defined,
+//  so the profiler costs nothing in a normal build.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/util/CUProfiler.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/io/CUTextWriter.h>
+#include <chrono>
+
+/** The weight of the latest frame in the running averages */
+#define PROFILE_SMOOTHING   0.05
+
+using namespace cugl;
+
+/** The profiler singleton */
+Profiler* Profiler::_gProfiler = nullptr;
+/** The counters, which are updated from any thread */
+std::atomic<Uint64> Profiler::_counters[(int)Profiler::Counter::COUNT];
+
+/** Incremented on every start, so that threads do not reuse an old ring */
+static Uint32 _gGeneration = 0;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a new profiler, with the clock started now.
+ *
+ * Access the profiler with the static methods instead.
+ */
+Profiler::Profiler() :
+_main(nullptr),
+_dropped(0),
+_frameStart(0),
+_frameTime(0),
+_frameAverage(0),
+_frames(0),
+_gpuDepth(0),
+_capturing(false) {
+    _origin = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    for(int ii = 0; ii < (int)Counter::COUNT; ii++) {
+        _lastCounts[ii] = 0;
+        _averageCounts[ii] = 0;
+    }
+}
+
+/**
+ * Deletes this profiler, releasing all of its rings and queries.
+ */
+Profiler::~Profiler() {
+    for(auto it = _rings.begin(); it != _rings.end(); ++it) {
+        delete *it;
+    }
+    _rings.clear();
+#ifdef GL_TIME_ELAPSED
+    for(auto it = _pending.begin(); it != _pending.end(); ++it) {
+        _freeQueries.push_back(it->query);
+    }
+    if (!_freeQueries.empty()) {
+        glDeleteQueries((GLsizei)_freeQueries.size(), _freeQueries.data());
+    }
+#endif
+}
+
+/**
+ * Starts the profiler singleton.
+ *
+ * The calling thread is taken to be the main thread, which must also be
+ * the thread with the OpenGL context. This method has no effect if the
+ * profiler is already started.
+ *
+ * @return true if the profiler was started
+ */
+bool Profiler::start() {
+    if (_gProfiler != nullptr) {
+        return false;
+    }
+    _gGeneration++;
+    _gProfiler = new Profiler();
+    _gProfiler->_main = _gProfiler->getRing();
+    _gProfiler->_main->label = "main";
+    return true;
+}
+
+/**
+ * Stops the profiler singleton, discarding all of its data.
+ *
+ * No zone may be open on any thread when this method is called.
+ */
+void Profiler::stop() {
+    if (_gProfiler == nullptr) {
+        return;
+    }
+    Profiler* profiler = _gProfiler;
+    _gProfiler = nullptr;
+    delete profiler;
+}
+
+/**
+ * Returns the current time, in microseconds since the profiler started.
+ *
+ * @return the current time, in microseconds since the profiler started.
+ */
+Uint64 Profiler::now() const {
+    Uint64 micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return micros-_origin;
+}
+
+#pragma mark -
+#pragma mark Frames
+/**
+ * Marks the start of a frame.
+ *
+ * This must be called on the main thread.
+ */
+void Profiler::beginFrame() {
+    _frameStart = now();
+    beginZone("frame");
+}
+
+/**
+ * Marks the end of a frame, collecting every zone and counter.
+ *
+ * This must be called on the main thread.
+ */
+void Profiler::endFrame() {
+    endZone();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(auto it = _rings.begin(); it != _rings.end(); ++it) {
+            drain(*it);
+        }
+    }
+    collectQueries();
+
+    Uint64 end = now();
+    _frameTime = (double)(end-_frameStart);
+    _frameAverage = _frames == 0 ? _frameTime : _frameAverage+(_frameTime-_frameAverage)*PROFILE_SMOOTHING;
+    for(auto it = _stats.begin(); it != _stats.end(); ++it) {
+        it->last = it->current;
+        it->average = it->average < 0 ? it->last : it->average+(it->last-it->average)*PROFILE_SMOOTHING;
+        it->current = 0;
+    }
+
+    std::vector<Uint64> row;
+    for(int ii = 0; ii < (int)Counter::COUNT; ii++) {
+        _lastCounts[ii] = _counters[ii].exchange(0, std::memory_order_relaxed);
+        double last = (double)_lastCounts[ii];
+        _averageCounts[ii] = _frames == 0 ? last : _averageCounts[ii]+(last-_averageCounts[ii])*PROFILE_SMOOTHING;
+        if (_capturing) {
+            row.push_back(_lastCounts[ii]);
+        }
+    }
+    if (_capturing) {
+        _captureCounts.emplace_back(end, row);
+    }
+    _frames++;
+}
+
+#pragma mark -
+#pragma mark Zones
+/**
+ * Opens a zone on the calling thread.
+ *
+ * Every call must be matched by a call to {@link #endZone} on the same
+ * thread. Use CU_PROFILE_ZONE rather than calling this directly.
+ *
+ * @param name  The zone name (which must outlive the profiler)
+ */
+void Profiler::beginZone(const char* name) {
+    Ring* ring = getRing();
+    if (ring->depth < PROFILE_MAX_DEPTH) {
+        ring->names[ring->depth] = name;
+        ring->starts[ring->depth] = now();
+    }
+    ring->depth++;
+}
+
+/**
+ * Closes the innermost zone on the calling thread.
+ */
+void Profiler::endZone() {
+    Ring* ring = getRing();
+    if (ring->depth == 0) {
+        return;
+    }
+    ring->depth--;
+    if (ring->depth < PROFILE_MAX_DEPTH) {
+        // Only this thread writes the head, so a relaxed load is enough
+        Uint64 head = ring->head.load(std::memory_order_relaxed);
+        Zone& zone = ring->events[head % PROFILE_RING_SIZE];
+        zone.name  = ring->names[ring->depth];
+        zone.start = ring->starts[ring->depth];
+        zone.end   = now();
+        zone.thread = ring->thread;
+        ring->head.store(head+1, std::memory_order_release);
+    }
+}
+
+/**
+ * Sets the name of the calling thread in trace captures.
+ *
+ * @param name  The thread name
+ */
+void Profiler::setThreadName(const std::string& name) {
+    Ring* ring = getRing();
+    std::lock_guard<std::mutex> lock(_mutex);
+    ring->label = name;
+}
+
+/**
+ * Starts timing GPU work, filed under the innermost main thread zone.
+ *
+ * Timer queries cannot nest, so only the outermost call is timed. This
+ * must be called on the main thread. Use CU_PROFILE_GPU rather than
+ * calling this directly.
+ */
+void Profiler::beginGpu() {
+#ifdef GL_TIME_ELAPSED
+    if (_gpuDepth++ > 0) {
+        return;
+    }
+
+    Query query;
+    if (_freeQueries.empty()) {
+        glGenQueries(1, &query.query);
+    } else {
+        query.query = _freeQueries.back();
+        _freeQueries.pop_back();
+    }
+    Uint32 depth = _main->depth;
+    query.name  = (depth > 0 && depth <= PROFILE_MAX_DEPTH) ? _main->names[depth-1] : "gpu";
+    query.start = now();
+    glBeginQuery(GL_TIME_ELAPSED, query.query);
+    _pending.push_back(query);
+#endif
+}
+
+/**
+ * Stops timing GPU work.
+ */
+void Profiler::endGpu() {
+#ifdef GL_TIME_ELAPSED
+    if (_gpuDepth == 0) {
+        return;
+    } else if (--_gpuDepth == 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+#endif
+}
+
+#pragma mark -
+#pragma mark Trace Capture
+/**
+ * Starts capturing zones for a trace.
+ *
+ * Any previous capture is discarded. At most {@link #PROFILE_MAX_CAPTURE}
+ * zones are kept.
+ */
+void Profiler::startCapture() {
+    _capture.clear();
+    _captureCounts.clear();
+    _capturing = true;
+}
+
+/** Returns the string as a JSON string literal */
+static std::string quote(const std::string& text) {
+    std::string result = "\"";
+    for(auto it = text.begin(); it != text.end(); ++it) {
+        if (*it == '"' || *it == '\\') {
+            result += '\\';
+        }
+        result += (*it < ' ' ? ' ' : *it);
+    }
+    return result+"\"";
+}
+
+/**
+ * Stops capturing and writes the capture as a Chrome trace.
+ *
+ * The file is in the JSON trace event format, and can be opened with
+ * chrome://tracing or Perfetto. Each thread is a separate track, with
+ * GPU zones on their own track, and the counters are written once per
+ * frame.
+ *
+ * @param path  The file to write
+ *
+ * @return true if the trace was written
+ */
+bool Profiler::stopCapture(const std::string& path) {
+    _capturing = false;
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(path);
+    if (writer == nullptr) {
+        CULogError("Cannot write trace %s", path.c_str());
+        return false;
+    }
+
+    static const char* counters[] = { "draw calls", "vertices", "state changes", "allocations" };
+    writer->writeLine("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    writer->write("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(auto it = _rings.begin(); it != _rings.end(); ++it) {
+            writer->writeLine(",");
+            writer->write("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"+std::to_string((*it)->thread)+
+                          ",\"args\":{\"name\":"+quote((*it)->label)+"}}");
+        }
+    }
+    for(auto it = _capture.begin(); it != _capture.end(); ++it) {
+        writer->writeLine(",");
+        writer->write("{\"name\":"+quote(it->name)+",\"cat\":\""+(it->thread == 0 ? "gpu" : "cpu")+
+                      "\",\"ph\":\"X\",\"pid\":1,\"tid\":"+std::to_string(it->thread)+
+                      ",\"ts\":"+std::to_string(it->start)+",\"dur\":"+std::to_string(it->end-it->start)+"}");
+    }
+    for(auto it = _captureCounts.begin(); it != _captureCounts.end(); ++it) {
+        std::string args;
+        for(size_t ii = 0; ii < it->second.size(); ii++) {
+            args += (ii == 0 ? "" : ",")+quote(counters[ii])+":"+std::to_string(it->second[ii]);
+        }
+        writer->writeLine(",");
+        writer->write("{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":"+std::to_string(it->first)+
+                      ",\"args\":{"+args+"}}");
+    }
+    writer->writeLine("");
+    writer->writeLine("]}");
+    writer->close();
+
+    _capture.clear();
+    _captureCounts.clear();
+    return true;
+}
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Returns the ring of the calling thread, creating it if necessary.
+ *
+ * @return the ring of the calling thread
+ */
+Profiler::Ring* Profiler::getRing() {
+    static thread_local Ring* ring = nullptr;
+    static thread_local Uint32 generation = 0;
+    if (generation != _gGeneration) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ring = new Ring();
+        ring->head.store(0);
+        ring->tail = 0;
+        ring->depth = 0;
+        ring->thread = (Uint32)_rings.size()+1;
+        ring->label = "thread "+std::to_string(ring->thread);
+        _rings.push_back(ring);
+        generation = _gGeneration;
+    }
+    return ring;
+}
+
+/**
+ * Returns the stat for the given zone name, creating it if necessary.
+ *
+ * @param name  The zone name
+ * @param gpu   Whether the stat is for GPU time
+ *
+ * @return the stat for the given zone name
+ */
+Profiler::Stat& Profiler::getStat(const char* name, bool gpu) {
+    std::map<const char*,size_t,NameLess>& index = gpu ? _gpuIndex : _cpuIndex;
+    auto it = index.find(name);
+    if (it != index.end()) {
+        return _stats[it->second];
+    }
+
+    Stat stat;
+    stat.name = name;
+    stat.gpu = gpu;
+    stat.last = 0;
+    stat.average = -1;
+    stat.current = 0;
+    index[name] = _stats.size();
+    _stats.push_back(stat);
+    return _stats.back();
+}
+
+/**
+ * Moves the finished zones of a ring into the stats (and the capture).
+ *
+ * @param ring  The ring to drain
+ */
+void Profiler::drain(Ring* ring) {
+    Uint64 head = ring->head.load(std::memory_order_acquire);
+    if (head-ring->tail > PROFILE_RING_SIZE) {
+        _dropped += head-ring->tail-PROFILE_RING_SIZE;
+        ring->tail = head-PROFILE_RING_SIZE;
+    }
+
+    for(Uint64 ii = ring->tail; ii < head; ii++) {
+        Zone zone = ring->events[ii % PROFILE_RING_SIZE];
+
+        // The owner may have lapped us while we copied this zone
+        Uint64 now = ring->head.load(std::memory_order_acquire);
+        if (now-ii > PROFILE_RING_SIZE) {
+            _dropped++;
+            continue;
+        }
+
+        getStat(zone.name, false).current += (double)(zone.end-zone.start);
+        if (_capturing && _capture.size() < PROFILE_MAX_CAPTURE) {
+            _capture.push_back(zone);
+        }
+    }
+    ring->tail = head;
+}
+
+/**
+ * Reads back every GPU timer query that is ready.
+ */
+void Profiler::collectQueries() {
+#ifdef GL_TIME_ELAPSED
+    // Queries finish in order, so stop at the first one that is not ready
+    size_t done = 0;
+    while (done < _pending.size()) {
+        if (_gpuDepth > 0 && done+1 == _pending.size()) {
+            break;
+        }
+        const Query& query = _pending[done];
+        GLuint available = 0;
+        glGetQueryObjectuiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query.query, GL_QUERY_RESULT, &elapsed);
+
+        Uint64 micros = elapsed/1000;
+        getStat(query.name, true).current += (double)elapsed/1000.0;
+        if (_capturing && _capture.size() < PROFILE_MAX_CAPTURE) {
+            Zone zone;
+            zone.name  = query.name;
+            zone.start = query.start;
+            zone.end   = query.start+micros;
+            zone.thread = 0;
+            _capture.push_back(zone);
+        }
+        _freeQueries.push_back(query.query);
+        done++;
+    }
+    _pending.erase(_pending.begin(), _pending.begin()+done);
+#endif
+}
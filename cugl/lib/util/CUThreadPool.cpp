@@ -33,6 +33,7 @@
 //  Version: 11/29/16
 //
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUProfiler.h>
 
 using namespace cugl;
 
@@ -94,7 +95,7 @@ void ThreadPool::threadFunc() {
             }
             // Pull the next task off the queue
             if (!_taskQueue.empty()) {
-                task = std::move(_taskQueue.front());
+                task = _taskQueue.top().work;
                 _taskQueue.pop();
             } else {
                 _taskCondition.wait(lk);
@@ -102,6 +103,7 @@ void ThreadPool::threadFunc() {
             }
         }
         // Perform the current task
+        CU_PROFILE_ZONE("ThreadPool::task");
         task();
     }
     _complete++;
@@ -126,7 +128,7 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
             }
             // Pull the next task off the queue
             if (!self->_taskQueue.empty()) {
-                task = std::move(self->_taskQueue.front());
+                task = self->_taskQueue.top().work;
                 self->_taskQueue.pop();
             } else {
                 self->_taskCondition.wait(lk);
@@ -134,6 +136,7 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
             }
         }
         // Perform the current task
+        CU_PROFILE_ZONE("ThreadPool::task");
         task();
     }
     self->_complete++;
@@ -152,11 +155,16 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
  * will not be executed immediately, but must wait for the first available
  * worker.
  *
+ * Waiting tasks are assigned in order of priority, with higher priorities
+ * going first.  Tasks of equal priority are assigned in the order they
+ * were added.  A priority does not preempt a task that is already running.
+ *
  * @param  task     the task function to add to the thread pool
+ * @param  priority the task priority
  */
-void ThreadPool::addTask(const std::function<void()> &task){
+void ThreadPool::addTask(const std::function<void()> &task, int priority){
     std::unique_lock<std::mutex> lk(_queueMutex);
-    _taskQueue.emplace(task);
+    _taskQueue.push({task, priority, _taskCount++});
     _taskCondition.notify_one();
 }
 
@@ -0,0 +1,106 @@
+#include "AssetBundler.h"
+#include <SDL/SDL_image.h>
+
+using namespace std;
+using namespace cugl;
+
+bool AssetBundler::open(const string& bundle) {
+    _writer = AssetBundleWriter::alloc(_assets + bundle, _assets);
+    return _writer != nullptr;
+}
+
+bool AssetBundler::close() {
+    bool result = _writer != nullptr && _writer->close();
+    _writer = nullptr;
+    return result;
+}
+
+#pragma mark Files
+bool AssetBundler::addImage(const string& file) {
+    if (_writer->contains(file)) return true;
+
+    SDL_Surface* image = IMG_Load((_assets + file).c_str());
+    if (image == nullptr) {
+        CULogError("Cannot load %s", file.c_str());
+        return false;
+    }
+    bool result = _writer->addImage(file, image);
+    SDL_FreeSurface(image);
+    return result;
+}
+
+bool AssetBundler::addSound(const string& file) {
+    if (_writer->contains(file)) return true;
+
+    auto sample = AudioSample::alloc(_assets + file);
+    if (sample == nullptr) {
+        CULogError("Cannot load %s", file.c_str());
+        return false;
+    }
+    return _writer->addSound(file, sample);
+}
+
+bool AssetBundler::addJson(const string& file) {
+    if (_writer->contains(file)) return true;
+
+    auto reader = JsonReader::alloc(_assets + file);
+    shared_ptr<JsonValue> json = reader == nullptr ? nullptr : reader->readJson();
+    if (json == nullptr) {
+        CULogError("Cannot read %s", file.c_str());
+        return false;
+    }
+    return _writer->addJson(file, json);
+}
+
+bool AssetBundler::addFile(const string& file) {
+    size_t dot = file.rfind('.');
+    string suffix = strtool::tolower(dot == string::npos ? "" : file.substr(dot + 1));
+    if (suffix == "json") {
+        return addJson(file);
+    }
+    else if (suffix == "png" || suffix == "jpg" || suffix == "jpeg" || suffix == "bmp" || suffix == "tga") {
+        return addImage(file);
+    }
+    else if (suffix == "wav" || suffix == "ogg" || suffix == "mp3" || suffix == "flac") {
+        return addSound(file);
+    }
+    CULogError("Cannot bundle %s", file.c_str());
+    return false;
+}
+
+#pragma mark Directories
+bool AssetBundler::addDirectory(const string& directory) {
+    if (!addJson(directory)) return false;
+
+    auto reader = JsonReader::alloc(_assets + directory);
+    shared_ptr<JsonValue> json = reader == nullptr ? nullptr : reader->readJson();
+    bool result = true;
+    for (int i = 0; i < (int)json->size(); ++i) {
+        auto category = json->get(i);
+        string name = category->key();
+        for (int j = 0; j < (int)category->size(); ++j) {
+            auto entry = category->get(j);
+            if (name == "textures") {
+                // atlas entries have no file of their own
+                if (entry->isString()) {
+                    result = addImage(entry->asString()) && result;
+                }
+                else if (entry->has("file")) {
+                    result = addImage(entry->getString("file")) && result;
+                }
+            }
+            else if (name == "sounds") {
+                // streamed samples and waveforms are not decoded ahead of time
+                if (entry->getString("type") == "sample" && !entry->getBool("stream", false)) {
+                    result = addSound(entry->getString("file")) && result;
+                }
+            }
+            else if (name == "jsons" || name == "widgets") {
+                if (entry->isString()) {
+                    result = addJson(entry->asString()) && result;
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef __ASSET_BUNDLER_H__
+#define __ASSET_BUNDLER_H__
+#include <cugl/cugl.h>
+
+using namespace std;
+using namespace cugl;
+
+/**
+ * Offline asset bundle builder.
+ *
+ * The bundler reads asset directories (such as json/game.json) and writes
+ * every file they reference to one precompiled bundle, along with the
+ * directories themselves. Textures are stored decoded, sound samples as PCM
+ * and JSON files as binary trees, so loading from the bundle decodes and
+ * parses nothing. Fonts and streamed music are left as files, since they are
+ * read incrementally at run time.
+ */
+class AssetBundler {
+private:
+    string _assets;
+    shared_ptr<AssetBundleWriter> _writer;
+
+    /** Adds a texture file; true if it was added or is already in the bundle */
+    bool addImage(const string& file);
+
+    /** Adds an in-memory sound file; true if it was added or is already in the bundle */
+    bool addSound(const string& file);
+
+    /** Adds a JSON file; true if it was added or is already in the bundle */
+    bool addJson(const string& file);
+
+public:
+    AssetBundler(const string& assets) : _assets(assets) { }
+
+    /**
+     * Starts a new bundle.
+     *
+     * @param bundle    The bundle file, relative to the assets folder
+     *
+     * @return true if the bundle was created
+     */
+    bool open(const string& bundle);
+
+    /**
+     * Adds an asset directory and every file it references.
+     *
+     * @param directory The asset directory, relative to the assets folder
+     *
+     * @return true if every file was added
+     */
+    bool addDirectory(const string& directory);
+
+    /**
+     * Adds a single file, chosen by its extension.
+     *
+     * @param file  The file, relative to the assets folder
+     *
+     * @return true if the file was added
+     */
+    bool addFile(const string& file);
+
+    /** Writes the index and finishes the bundle */
+    bool close();
+};
+
+#endif /** __ASSET_BUNDLER_H__ */
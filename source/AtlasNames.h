@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef __ATLAS_NAMES_H__
+#define __ATLAS_NAMES_H__
+#include <string>
+
+/**
+ * File names shared by the atlas tool and the game.
+ *
+ * This is kept apart from AtlasPacker so that the game can find the packed
+ * directories without linking the packer itself.
+ */
+namespace atlas {
+    /** Returns the name of the packed version of an asset directory */
+    inline std::string packedName(const std::string& directory) {
+        size_t dot = directory.rfind('.');
+        return directory.substr(0, dot) + ".packed.json";
+    }
+}
+
+#endif /** __ATLAS_NAMES_H__ */
@@ -0,0 +1,315 @@
+#include "AtlasPacker.h"
+#include <SDL/SDL_image.h>
+#include <algorithm>
+#include <map>
+
+using namespace std;
+using namespace cugl;
+
+#pragma mark Rectangle Packing
+void RectPacker::reset(int width, int height) {
+    _free.clear();
+    _free.emplace_back(0, 0, width, height);
+}
+
+PixelRect RectPacker::insert(int width, int height) {
+    // best short side fit, ties broken by long side
+    PixelRect best;
+    int bestShort = numeric_limits<int>::max();
+    int bestLong = numeric_limits<int>::max();
+    for (auto& f : _free) {
+        if (f.w < width || f.h < height) continue;
+        int dw = f.w - width;
+        int dh = f.h - height;
+        int shortSide = min(dw, dh);
+        int longSide = max(dw, dh);
+        if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+            best = PixelRect(f.x, f.y, width, height);
+            bestShort = shortSide;
+            bestLong = longSide;
+        }
+    }
+    if (best.w == 0) return best;
+
+    vector<PixelRect> pieces;
+    for (size_t i = 0; i < _free.size(); ) {
+        if (split(_free[i], best, pieces)) {
+            _free[i] = _free.back();
+            _free.pop_back();
+        }
+        else {
+            ++i;
+        }
+    }
+    _free.insert(_free.end(), pieces.begin(), pieces.end());
+    prune();
+    return best;
+}
+
+bool RectPacker::split(const PixelRect& f, const PixelRect& used, vector<PixelRect>& pieces) {
+    if (!f.overlaps(used)) return false;
+
+    // up to four maximal pieces of f are left around used
+    if (used.x > f.x) {
+        pieces.emplace_back(f.x, f.y, used.x - f.x, f.h);
+    }
+    if (used.right() < f.right()) {
+        pieces.emplace_back(used.right(), f.y, f.right() - used.right(), f.h);
+    }
+    if (used.y > f.y) {
+        pieces.emplace_back(f.x, f.y, f.w, used.y - f.y);
+    }
+    if (used.bottom() < f.bottom()) {
+        pieces.emplace_back(f.x, used.bottom(), f.w, f.bottom() - used.bottom());
+    }
+    return true;
+}
+
+void RectPacker::prune() {
+    for (size_t i = 0; i < _free.size(); ++i) {
+        for (size_t j = i + 1; j < _free.size(); ) {
+            if (_free[i].contains(_free[j])) {
+                _free.erase(_free.begin() + j);
+            }
+            else if (_free[j].contains(_free[i])) {
+                _free.erase(_free.begin() + i);
+                --i;
+                break;
+            }
+            else {
+                ++j;
+            }
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Atlas Packing
+/** Returns the smallest power of two at least n */
+static int nextPow2(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/** Returns the bounds of the non-transparent pixels of an RGBA32 image */
+static PixelRect opaqueBounds(SDL_Surface* image) {
+    int x0 = image->w, y0 = image->h, x1 = -1, y1 = -1;
+    for (int y = 0; y < image->h; ++y) {
+        const Uint8* row = static_cast<const Uint8*>(image->pixels) + y * image->pitch;
+        for (int x = 0; x < image->w; ++x) {
+            if (row[x * 4 + 3] != 0) {
+                x0 = min(x0, x);
+                x1 = max(x1, x);
+                y0 = min(y0, y);
+                y1 = max(y1, y);
+            }
+        }
+    }
+    // keep one pixel of a fully transparent image
+    if (x1 < 0) return PixelRect(0, 0, 1, 1);
+    return PixelRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+AtlasPacker::~AtlasPacker() {
+    for (auto& s : _sprites) {
+        SDL_FreeSurface(s.image);
+    }
+}
+
+bool AtlasPacker::isPackable(const shared_ptr<JsonValue>& entry) const {
+    if (!entry->isObject()) return false;
+    if (entry->has("atlas") || entry->getBool("mipmaps", false)) return false;
+    return entry->getString("wrapS", "clamp") == "clamp" && entry->getString("wrapT", "clamp") == "clamp";
+}
+
+string AtlasPacker::groupOf(const shared_ptr<JsonValue>& entry) {
+    // the defaults of TextureLoader
+    return entry->getString("minfilter", "nearest") + "_" + entry->getString("magfilter", "linear");
+}
+
+bool AtlasPacker::packGroup(const string& group, vector<size_t>& sprites) {
+    int pad = _options.padding;
+    auto padded = [&](const Sprite& s) { return PixelRect(0, 0, s.source.w + 2 * pad, s.source.h + 2 * pad); };
+
+    // biggest first packs tightest
+    sort(sprites.begin(), sprites.end(), [&](size_t a, size_t b) {
+        PixelRect ra = padded(_sprites[a]);
+        PixelRect rb = padded(_sprites[b]);
+        int ma = max(ra.w, ra.h), mb = max(rb.w, rb.h);
+        return ma != mb ? ma > mb : ra.w * ra.h > rb.w * rb.h;
+    });
+
+    RectPacker packer;
+    while (!sprites.empty()) {
+        long area = 0;
+        for (size_t i : sprites) {
+            PixelRect r = padded(_sprites[i]);
+            area += (long)r.w * r.h;
+        }
+
+        // grow the page (square, then twice as wide) until everything fits or it is full size
+        int side = min(_options.maxSize, nextPow2((int)ceil(sqrt((double)area))));
+        int width = side, height = side;
+        vector<size_t> placed, left;
+        while (true) {
+            packer.reset(width, height);
+            placed.clear();
+            left.clear();
+            for (size_t i : sprites) {
+                PixelRect r = padded(_sprites[i]);
+                PixelRect spot = packer.insert(r.w, r.h);
+                if (spot.w == 0) {
+                    left.push_back(i);
+                    continue;
+                }
+                _sprites[i].placed = PixelRect(spot.x + pad, spot.y + pad, _sprites[i].source.w, _sprites[i].source.h);
+                placed.push_back(i);
+            }
+            if (left.empty() || (width == _options.maxSize && height == _options.maxSize)) break;
+            if (width == height) width = min(width * 2, _options.maxSize);
+            else height = min(height * 2, _options.maxSize);
+        }
+
+        if (placed.empty()) {
+            CULogError("%s does not fit in a %d page", _sprites[left.front()].key.c_str(), _options.maxSize);
+            return false;
+        }
+
+        sprites = left;
+        if (placed.size() == 1) {
+            // a page of one texture saves no binds; leave it as it is
+            continue;
+        }
+
+        Page page;
+        page.group = group;
+        page.width = width;
+        page.height = height;
+        page.sprites = placed;
+        for (size_t i : placed) {
+            _sprites[i].page = (int)_pages.size();
+        }
+        _pages.push_back(page);
+    }
+    return true;
+}
+
+SDL_Surface* AtlasPacker::render(const Page& page) const {
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, page.width, page.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas == nullptr) return nullptr;
+    SDL_memset(atlas->pixels, 0, atlas->h * atlas->pitch);
+
+    // each padding pixel repeats the nearest edge pixel of the sprite
+    int pad = _options.padding;
+    for (size_t i : page.sprites) {
+        const Sprite& s = _sprites[i];
+        for (int y = -pad; y < s.placed.h + pad; ++y) {
+            int sy = s.source.y + min(max(y, 0), s.source.h - 1);
+            const Uint32* src = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(s.image->pixels) + sy * s.image->pitch);
+            Uint32* dst = reinterpret_cast<Uint32*>(static_cast<Uint8*>(atlas->pixels) + (s.placed.y + y) * atlas->pitch);
+            for (int x = -pad; x < s.placed.w + pad; ++x) {
+                int sx = s.source.x + min(max(x, 0), s.source.w - 1);
+                dst[s.placed.x + x] = src[sx];
+            }
+        }
+    }
+    return atlas;
+}
+
+bool AtlasPacker::pack(const string& directory) {
+    auto reader = JsonReader::alloc(_assets + directory);
+    shared_ptr<JsonValue> json = reader == nullptr ? nullptr : reader->readJson();
+    if (json == nullptr || !json->has("textures")) {
+        CULogError("Cannot read textures from %s", directory.c_str());
+        return false;
+    }
+
+    // Load everything that may share a page
+    auto textures = json->get("textures");
+    map<string, vector<size_t>> groups;
+    for (int i = 0; i < (int)textures->size(); ++i) {
+        auto entry = textures->get(i);
+        if (!isPackable(entry)) continue;
+
+        string file = entry->getString("file");
+        SDL_Surface* loaded = IMG_Load((_assets + file).c_str());
+        SDL_Surface* image = loaded == nullptr ? nullptr : SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (image == nullptr) {
+            // the game reports this too; leave it as it is
+            CULogError("Cannot load %s", file.c_str());
+            continue;
+        }
+
+        Sprite sprite;
+        sprite.key = entry->key();
+        sprite.image = image;
+        sprite.source = _options.trim ? opaqueBounds(image) : PixelRect(0, 0, image->w, image->h);
+        sprite.page = -1;
+        if (sprite.source.w + 2 * _options.padding > _options.maxSize || sprite.source.h + 2 * _options.padding > _options.maxSize) {
+            // too big to share a page; leave it as it is
+            SDL_FreeSurface(image);
+            continue;
+        }
+        groups[groupOf(entry)].push_back(_sprites.size());
+        _sprites.push_back(sprite);
+    }
+
+    for (auto& group : groups) {
+        if (!packGroup(group.first, group.second)) return false;
+    }
+
+    // Write the pages, and replace the packed entries with them
+    string base = filetool::base_prefix(directory);
+    string folder = _assets + "textures/atlas";
+    if (!_pages.empty() && !filetool::file_exists(folder) && !filetool::dir_create(folder)) {
+        CULogError("Cannot create %s", folder.c_str());
+        return false;
+    }
+    for (size_t p = 0; p < _pages.size(); ++p) {
+        const Page& page = _pages[p];
+        string file = "textures/atlas/" + base + "_" + to_string(p) + ".png";
+        SDL_Surface* image = render(page);
+        if (image == nullptr || IMG_SavePNG(image, (_assets + file).c_str()) != 0) {
+            CULogError("Cannot write %s", file.c_str());
+            SDL_FreeSurface(image);
+            return false;
+        }
+        SDL_FreeSurface(image);
+
+        auto entry = JsonValue::allocObject();
+        entry->appendValue("file", file);
+        size_t split = page.group.find('_');
+        entry->appendValue("minfilter", page.group.substr(0, split));
+        entry->appendValue("magfilter", page.group.substr(split + 1));
+        entry->appendValue("wrapS", string("clamp"));
+        entry->appendValue("wrapT", string("clamp"));
+        entry->appendValue("prefix", false);
+
+        auto atlas = JsonValue::allocObject();
+        for (size_t i : page.sprites) {
+            const Sprite& s = _sprites[i];
+            auto bounds = JsonValue::allocArray();
+            bounds->appendValue((long)s.placed.x);
+            bounds->appendValue((long)s.placed.y);
+            bounds->appendValue((long)s.placed.right());
+            bounds->appendValue((long)s.placed.bottom());
+            atlas->appendChild(s.key, bounds);
+            textures->removeChild(s.key);
+        }
+        entry->appendChild("atlas", atlas);
+        textures->appendChild(base + "_atlas" + to_string(p), entry);
+
+        CULog("%s: %dx%d, %d textures", file.c_str(), page.width, page.height, (int)page.sprites.size());
+    }
+
+    auto writer = JsonWriter::alloc(_assets + atlas::packedName(directory));
+    if (writer == nullptr) {
+        CULogError("Cannot write %s", atlas::packedName(directory).c_str());
+        return false;
+    }
+    writer->writeJson(json);
+    writer->close();
+    return true;
+}
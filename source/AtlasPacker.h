@@ -0,0 +1,139 @@
+#pragma once
+
+#ifndef __ATLAS_PACKER_H__
+#define __ATLAS_PACKER_H__
+#include <cugl/cugl.h>
+#include "AtlasNames.h"
+
+using namespace std;
+using namespace cugl;
+
+/** An integer rectangle, in pixels, with the origin at the top left */
+struct PixelRect {
+    int x, y, w, h;
+
+    PixelRect(int x = 0, int y = 0, int w = 0, int h = 0) : x(x), y(y), w(w), h(h) { }
+
+    int right() const { return x + w; }
+    int bottom() const { return y + h; }
+
+    bool contains(const PixelRect& r) const {
+        return r.x >= x && r.y >= y && r.right() <= right() && r.bottom() <= bottom();
+    }
+
+    bool overlaps(const PixelRect& r) const {
+        return r.x < right() && r.right() > x && r.y < bottom() && r.bottom() > y;
+    }
+};
+
+/**
+ * MaxRects bin packer for a single page.
+ *
+ * The page keeps a list of maximal free rectangles. A new rectangle goes in
+ * the free rectangle that leaves the shortest leftover side, and every free
+ * rectangle it overlaps is split around it.
+ */
+class RectPacker {
+private:
+    /** Maximal free rectangles, none contained in another */
+    vector<PixelRect> _free;
+
+    /** Adds the parts of free rectangle f around used to pieces; false if they do not overlap */
+    static bool split(const PixelRect& f, const PixelRect& used, vector<PixelRect>& pieces);
+
+    /** Removes every free rectangle contained in another */
+    void prune();
+
+public:
+    /** Starts over with an empty page of the given size */
+    void reset(int width, int height);
+
+    /**
+     * Places a rectangle of the given size.
+     *
+     * @return the placed rectangle, or one with zero size if it does not fit
+     */
+    PixelRect insert(int width, int height);
+};
+
+/**
+ * Offline texture atlas builder.
+ *
+ * The packer reads an asset directory (such as json/game.json), packs its
+ * textures into power-of-two pages, and writes the pages as PNG files along
+ * with a copy of the directory in which the packed textures are replaced by
+ * atlas entries. Atlas entries are not prefixed, so every texture keeps its
+ * key and the game does not need to know whether it was packed.
+ *
+ * Textures are only packed if they can share a page: they must clamp in both
+ * directions and have no mipmaps. Textures with different filters go on
+ * different pages. Every sprite is surrounded by padding that repeats its
+ * edge pixels, so linear filtering does not bleed between sprites.
+ */
+class AtlasPacker {
+public:
+    /** Packing options */
+    struct Options {
+        /** Largest page width or height */
+        int maxSize = 2048;
+        /** Pixels repeated around each sprite */
+        int padding = 1;
+        /** Whether to crop transparent borders (this changes sprite sizes) */
+        bool trim = false;
+    };
+
+private:
+    /** A texture to pack */
+    struct Sprite {
+        string key;
+        SDL_Surface* image;
+        /** The part of the image that is kept */
+        PixelRect source;
+        /** Where the kept part went, not counting padding */
+        PixelRect placed;
+        int page;
+    };
+
+    /** A finished page */
+    struct Page {
+        string group;
+        int width;
+        int height;
+        vector<size_t> sprites;
+    };
+
+    Options _options;
+    string _assets;
+    vector<Sprite> _sprites;
+    vector<Page> _pages;
+
+    /** Returns whether a directory entry can go in an atlas */
+    bool isPackable(const shared_ptr<JsonValue>& entry) const;
+
+    /** Returns the key shared by entries that may be on the same page */
+    static string groupOf(const shared_ptr<JsonValue>& entry);
+
+    /** Packs the sprites with the given indices, adding pages as needed */
+    bool packGroup(const string& group, vector<size_t>& sprites);
+
+    /** Copies the sprites of a page into a new image */
+    SDL_Surface* render(const Page& page) const;
+
+public:
+    AtlasPacker(const string& assets, const Options& options) : _options(options), _assets(assets) { }
+    ~AtlasPacker();
+
+    /**
+     * Packs the textures of an asset directory and writes the result.
+     *
+     * For directory json/game.json, the pages are written to
+     * textures/atlas/game_N.png and the directory to json/game.packed.json.
+     *
+     * @param directory The asset directory, relative to the assets folder
+     *
+     * @return true if the atlas was written
+     */
+    bool pack(const string& directory);
+};
+
+#endif /** __ATLAS_PACKER_H__ */
@@ -0,0 +1,71 @@
+//
+//  AtlasTool.cpp
+//
+//  Entry point for the offline atlas packer. This is the ghosted-atlas target
+//  in build-linux, which builds the game sources with GHOSTED_ATLAS_TOOL
+//  defined in place of main.cpp. No window or GL context is created.
+//
+//      ghosted-atlas <assets dir> [--max N] [--padding N] [--trim] [directory ...]
+//
+//  Every directory (json/game.json by default) gets a packed copy next to it,
+//  which the game loads in its place. The atlas target in build-linux runs it
+//  on every directory the game loads whenever textures change.
+//
+#ifdef GHOSTED_ATLAS_TOOL
+
+#include "AtlasPacker.h"
+#include <SDL/SDL_image.h>
+
+using namespace std;
+using namespace cugl;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        CULogError("usage: %s <assets dir> [--max N] [--padding N] [--trim] [directory ...]", argv[0]);
+        return 1;
+    }
+
+    string assets = argv[1];
+    if (assets.back() != '/') assets += '/';
+
+    AtlasPacker::Options options;
+    vector<string> directories;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--max" && i + 1 < argc) {
+            options.maxSize = stoi(argv[++i]);
+        }
+        else if (arg == "--padding" && i + 1 < argc) {
+            options.padding = stoi(argv[++i]);
+        }
+        else if (arg == "--trim") {
+            options.trim = true;
+        }
+        else {
+            directories.push_back(arg);
+        }
+    }
+    if (directories.empty()) {
+        directories.push_back("json/game.json");
+    }
+    // pages are power-of-two sizes, so the limit must be one too
+    if (options.maxSize <= 0 || (options.maxSize & (options.maxSize - 1)) != 0) {
+        CULogError("--max must be a power of two, not %d", options.maxSize);
+        return 1;
+    }
+
+    IMG_Init(IMG_INIT_PNG);
+    int result = 0;
+    for (auto& directory : directories) {
+        AtlasPacker packer(assets, options);
+        if (!packer.pack(directory)) {
+            result = 1;
+            break;
+        }
+        CULog("wrote %s", atlas::packedName(directory).c_str());
+    }
+    IMG_Quit();
+    return result;
+}
+
+#endif /** GHOSTED_ATLAS_TOOL */
@@ -38,7 +38,7 @@ void AudioController::setTrapSound(shared_ptr<Trap> t) {
     else {_trapSound = "";};
 }
 
-void AudioController::update(float timestep) {
+void AudioController::update(float /*timestep*/) {
     if (AudioEngine::get()->getMusicQueue()->getState() == AudioEngine::State::PLAYING && _menuMusic.size() > 0) {
         if (_mute && AudioEngine::get()->getMusicQueue()->getVolume() > 0.0f) {
             AudioEngine::get()->getMusicQueue()->setVolume(0.0f);
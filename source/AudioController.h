@@ -25,7 +25,7 @@ private:
     bool _mute;
     
 public:
-    AudioController() : _menuMusic(""), _trapSound(""), _mute(false) {};
+    AudioController() : _trapSound(""), _menuMusic(""), _mute(false) {};
     ~AudioController() { dispose(); };
     
     bool init(std::shared_ptr<cugl::AssetManager>& assets);
@@ -0,0 +1,76 @@
+//
+//  BundleTool.cpp
+//
+//  Entry point for the offline asset bundler. This is the ghosted-bundle target
+//  in build-linux, which builds the game sources with GHOSTED_BUNDLE_TOOL
+//  defined in place of main.cpp. No window or GL context is created.
+//
+//      ghosted-bundle <assets dir> [--out FILE] [directory ...] [--file FILE ...]
+//
+//  Every directory the game loads is bundled by default, using the packed
+//  copy from the atlas tool where there is one, so run the atlas tool first.
+//  The bundle (assets.bundle by default) is written to the assets folder, and
+//  the game reads it in place of the loose files. Each entry records the file
+//  it was built from, and the game ignores the whole bundle once any of those
+//  files changes, so run it again after editing assets.
+//
+#ifdef GHOSTED_BUNDLE_TOOL
+
+#include "AssetBundler.h"
+#include "AtlasNames.h"
+#include <SDL/SDL_image.h>
+
+using namespace std;
+using namespace cugl;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        CULogError("usage: %s <assets dir> [--out FILE] [directory ...] [--file FILE ...]", argv[0]);
+        return 1;
+    }
+
+    string assets = argv[1];
+    if (assets.back() != '/') assets += '/';
+
+    string output = "assets.bundle";
+    vector<string> directories;
+    vector<string> files;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (arg == "--file" && i + 1 < argc) {
+            files.push_back(argv[++i]);
+        }
+        else {
+            directories.push_back(arg);
+        }
+    }
+    if (directories.empty()) {
+        directories = { "json/loading.json", "json/assets.json", "json/start.json", "json/join.json",
+                        "json/game.json", "json/lobby.json", "json/win.json", "json/info.json" };
+    }
+
+    IMG_Init(IMG_INIT_PNG);
+    AssetBundler bundler(assets);
+    bool success = bundler.open(output);
+    for (auto& directory : directories) {
+        string packed = atlas::packedName(directory);
+        success = success && bundler.addDirectory(filetool::file_exists(assets + packed) ? packed : directory);
+    }
+    for (auto& file : files) {
+        success = success && bundler.addFile(file);
+    }
+    success = bundler.close() && success;
+    IMG_Quit();
+
+    if (!success) {
+        CULogError("Cannot write %s", output.c_str());
+        return 1;
+    }
+    CULog("wrote %s", output.c_str());
+    return 0;
+}
+
+#endif /** GHOSTED_BUNDLE_TOOL */
@@ -19,10 +19,7 @@ void CollisionController::dispose() {
 *
 * @param  contact  The two bodies that collided
 */
-void CollisionController::beginContact(b2Contact* contact) {
-    b2Body* body1 = contact->GetFixtureA()->GetBody();
-    b2Body* body2 = contact->GetFixtureB()->GetBody();
-
+void CollisionController::beginContact(b2Contact* /*contact*/) {
     // Must handle ghost and vision cone tagging
 }
 
@@ -36,6 +33,5 @@ void CollisionController::beginContact(b2Contact* contact) {
 * @param  contact  The two bodies that collided
 * @param  contact  The collision manifold before contact
 */
-void CollisionController::beforeSolve(b2Contact* contact, const b2Manifold* oldManifold) {
-    float speed = 0;
+void CollisionController::beforeSolve(b2Contact* /*contact*/, const b2Manifold* /*oldManifold*/) {
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "CollisionGrid.h"
+
+using namespace std;
+using namespace cugl;
+
+bool CollisionGrid::cellRange(const Rect& rect, int& x0, int& y0, int& x1, int& y1) const {
+    if (_cols == 0 || _rows == 0) return false;
+    x0 = static_cast<int>(floorf((rect.getMinX() - _origin.x) / _cellSize));
+    y0 = static_cast<int>(floorf((rect.getMinY() - _origin.y) / _cellSize));
+    x1 = static_cast<int>(floorf((rect.getMaxX() - _origin.x) / _cellSize));
+    y1 = static_cast<int>(floorf((rect.getMaxY() - _origin.y) / _cellSize));
+    if (x1 < 0 || y1 < 0 || x0 >= _cols || y0 >= _rows) return false;
+
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, _cols - 1);
+    y1 = min(y1, _rows - 1);
+    return true;
+}
+
+void CollisionGrid::build(const Rect& bounds, float cellSize, const vector<Collider>& colliders) {
+    clear();
+    _colliders = colliders;
+    _origin = bounds.origin;
+    _cellSize = cellSize;
+    _cols = max(1, static_cast<int>(ceilf(bounds.size.width / cellSize)));
+    _rows = max(1, static_cast<int>(ceilf(bounds.size.height / cellSize)));
+    _stamp.assign(_colliders.size(), 0);
+
+    // count, then fill; two passes keep every cell in one contiguous array
+    unsigned cells = _cols * _rows;
+    _cellStart.assign(cells + 1, 0);
+    int x0, y0, x1, y1;
+    for (auto& c : _colliders) {
+        if (!cellRange(c.rect, x0, y0, x1, y1)) continue;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                ++_cellStart[y * _cols + x + 1];
+            }
+        }
+    }
+    for (unsigned i = 0; i < cells; ++i) {
+        _cellStart[i + 1] += _cellStart[i];
+    }
+
+    _cellItems.resize(_cellStart[cells]);
+    vector<unsigned> fill(_cellStart.begin(), _cellStart.end() - 1);
+    for (unsigned i = 0; i < _colliders.size(); ++i) {
+        if (!cellRange(_colliders[i].rect, x0, y0, x1, y1)) continue;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                _cellItems[fill[y * _cols + x]++] = i;
+            }
+        }
+    }
+}
+
+void CollisionGrid::clear() {
+    _colliders.clear();
+    _cellStart.clear();
+    _cellItems.clear();
+    _stamp.clear();
+    _cols = 0;
+    _rows = 0;
+    _query = 0;
+}
+
+void CollisionGrid::query(const Rect& rect, vector<unsigned>& out) const {
+    out.clear();
+    int x0, y0, x1, y1;
+    if (!cellRange(rect, x0, y0, x1, y1)) return;
+
+    if (++_query == 0) {
+        // the stamp wrapped around, forget every old query
+        fill(_stamp.begin(), _stamp.end(), 0);
+        _query = 1;
+    }
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            unsigned cell = y * _cols + x;
+            for (unsigned i = _cellStart[cell]; i < _cellStart[cell + 1]; ++i) {
+                unsigned index = _cellItems[i];
+                if (_stamp[index] == _query) continue;
+                _stamp[index] = _query;
+                if (rect.doesIntersect(_colliders[index].rect)) {
+                    out.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+bool CollisionGrid::overlaps(const Rect& rect, bool obstacles) const {
+    int x0, y0, x1, y1;
+    if (!cellRange(rect, x0, y0, x1, y1)) return false;
+
+    // testing a collider twice is cheaper than stamping it here
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            unsigned cell = y * _cols + x;
+            for (unsigned i = _cellStart[cell]; i < _cellStart[cell + 1]; ++i) {
+                const Collider& c = _colliders[_cellItems[i]];
+                if ((obstacles || !c.obstacle) && rect.doesIntersect(c.rect)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
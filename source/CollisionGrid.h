@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef __COLLISION_GRID_H__
+#define __COLLISION_GRID_H__
+#include <cugl/cugl.h>
+
+using namespace std;
+using namespace cugl;
+
+/** A static rectangle that players cannot move through */
+struct Collider {
+    Rect rect;
+    /** Furniture rather than a wall; only pals collide with these */
+    bool obstacle;
+
+    Collider(const Rect& rect, bool obstacle) : rect(rect), obstacle(obstacle) { }
+};
+
+/**
+ * Uniform grid over the static colliders of a map.
+ *
+ * The grid is built once, after the rooms are built, and never changes. Each
+ * cell lists the colliders overlapping it, stored back to back in one array,
+ * so a query for a player-sized rectangle only looks at the few colliders in
+ * the cells it touches no matter how large the map is.
+ */
+class CollisionGrid {
+private:
+    /** All colliders, in the order they were added */
+    vector<Collider> _colliders;
+
+    /** World-space origin of cell (0, 0) */
+    Vec2 _origin;
+
+    /** Width and height of a cell */
+    float _cellSize;
+
+    /** Number of cells in each direction */
+    int _cols;
+    int _rows;
+
+    /** Start of each cell's run in _cellItems; cell i is [_cellStart[i], _cellStart[i+1]) */
+    vector<unsigned> _cellStart;
+
+    /** Collider indices, grouped by cell */
+    vector<unsigned> _cellItems;
+
+    /** Query number each collider was last reported in, so a collider spanning cells is reported once */
+    mutable vector<unsigned> _stamp;
+    mutable unsigned _query;
+
+    /** Computes the (clamped) range of cells a rectangle covers; false if it is off the grid */
+    bool cellRange(const Rect& rect, int& x0, int& y0, int& x1, int& y1) const;
+
+public:
+    CollisionGrid() : _cellSize(1), _cols(0), _rows(0), _query(0) { }
+
+    /**
+     * Builds the grid.
+     *
+     * @param bounds    The area covered by the grid; colliders outside are ignored
+     * @param cellSize  The width and height of a cell
+     * @param colliders The colliders to index
+     */
+    void build(const Rect& bounds, float cellSize, const vector<Collider>& colliders);
+
+    /** Removes all colliders */
+    void clear();
+
+    /** Returns the collider with the given index */
+    const Collider& get(unsigned index) const { return _colliders[index]; }
+
+    /** Returns the number of colliders */
+    size_t size() const { return _colliders.size(); }
+
+    /**
+     * Finds the colliders overlapping a rectangle.
+     *
+     * @param rect  The rectangle to test
+     * @param out   Cleared, then filled with the indices of overlapping colliders
+     */
+    void query(const Rect& rect, vector<unsigned>& out) const;
+
+    /**
+     * Returns whether any collider overlaps a rectangle.
+     *
+     * @param rect      The rectangle to test
+     * @param obstacles Whether obstacles count, or only walls
+     */
+    bool overlaps(const Rect& rect, bool obstacles) const;
+};
+
+#endif /** __COLLISION_GRID_H__ */
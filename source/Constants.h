@@ -13,6 +13,10 @@ using namespace cugl;
 namespace constants {
     constexpr unsigned SCENE_WIDTH = 1024;
 
+    constexpr float TICK_RATE = 60.0f; // game rules tick; player speeds are per tick
+
+    constexpr unsigned MAX_TICKS_PER_FRAME = 8; // past this a slow device runs behind rather than spiral
+
     constexpr uint8_t NETWORK_TICKS = 2; // must be >1 for interpolation
 
     const Vec2 ROOM_CENTER (187.5, 187.5);
@@ -40,13 +44,45 @@ namespace constants {
     const int MAX_BATTERIES = 3;
 
 
-    // Make sure to change values in lightShader.frag if you change these here
     /**maximum possible rooms generated in a map**/
     constexpr uint8_t MAX_ROOMS = 16;
 
     /**maximum possible pals in a game**/
     constexpr uint8_t MAX_PALS = 3;
 
+    // Make sure to change values in lightShader.frag if you change these here
+    /** maximum lights sent to the light shader after culling to the view */
+    constexpr unsigned MAX_LIGHTS = 32;
+
+    /** the view is split into LIGHT_TILES x LIGHT_TILES tiles for light culling */
+    constexpr unsigned LIGHT_TILES = 4;
+
+    /** room for light indices across all tiles (a multiple of 4) */
+    constexpr unsigned MAX_LIGHT_INDICES = 128;
+
+    constexpr float ROOM_LIGHT_RADIUS = 432.0f;
+
+    constexpr float PAL_LIGHT_RADIUS = 200.0f;
+
+    /** half angles of the flashlight cone, in radians; it fades between the two */
+    constexpr float PAL_LIGHT_INNER = 0.7f;
+    constexpr float PAL_LIGHT_OUTER = 0.7071f;
+
+    /** spokes in a full circle of the light map mesh */
+    constexpr int LIGHT_MAP_SEGMENTS = 32;
+
+    /** fraction of a light's radius over which it fades out in the light map */
+    constexpr float LIGHT_MAP_FEATHER = 0.1f;
+
+    /** default light map downscale; 0 lights the dim pass per fragment (L cycles 0, 2, 4 on desktop) */
+    constexpr unsigned LIGHT_MAP_SCALE = 0;
+
+    /** seconds between refreshes of the profiler overlay text */
+    constexpr float PROFILER_REFRESH = 0.25f;
+
+    /** scale of the profiler overlay font */
+    constexpr float PROFILER_TEXT_SCALE = 0.4f;
+
     /** Game modes */
     enum class GameMode {
         None,
@@ -26,6 +26,8 @@ bool Battery::init(const Vec2& loc) {
  * Called when a battery on the floor collide
  */
 void Battery::pickUp() {
-    _node->setVisible(false);
+    if (_node != nullptr) {
+        _node->setVisible(false);
+    }
     destroy();
 }
\ No newline at end of file
@@ -28,7 +28,7 @@ void Player::dispose() {
  * @param node the Player animation node
  * @param shadow the Player shadow node
  */
-void Player::setNode(const std::shared_ptr<scene2::AnimationNode>& value, const std::shared_ptr<scene2::PolygonNode>& shadow) {
+void Player::setNode(const std::shared_ptr<scene2::AnimationNode>& value, const std::shared_ptr<scene2::PolygonNode>& /*shadow*/) {
     Player::setNode(value);
 }
 
@@ -65,6 +65,7 @@ void Player::setHitbox(const std::shared_ptr<scene2::PolygonNode>& value) {
  * @param timestep  Time elapsed since last called.
  */
 void Player::update(float timestep) {
+    _prevLoc = _loc;
     _loc += _velocity;
     GameEntity::update(timestep);
 
@@ -102,10 +102,25 @@ public:
 
     Vec2 predictVelocity(Vec2 Move);
 
+    /** Returns the current velocity */
+    Vec2 getVelocity() const {
+        return _velocity;
+    }
+
+    /** Sets the velocity, used when replaying inputs */
+    void setVelocity(Vec2 velocity) {
+        _velocity = velocity;
+    }
+
+    /** Returns whether the Player is free to move */
+    virtual bool canMove() const {
+        return true;
+    }
+
     /** Creates a Player with the default values */
     Player() : Player(8, 1) {};
 
-    Player(float speed, float scale) : GameEntity(), _direction(Vec2(0.0f, -1.0f)), _speed(speed), _idle(true) {};
+    Player(float speed, float /*scale*/) : GameEntity(), _idle(true), _direction(Vec2(0.0f, -1.0f)), _speed(speed) {};
 
     /** Releases all resources allocated with this Player */
     ~Player() { dispose(); }
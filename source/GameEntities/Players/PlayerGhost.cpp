@@ -37,7 +37,8 @@ void Ghost::update(float timestep) {
 }
 
 void Ghost::processDirection() {
-    unsigned int frame = _node->getFrame();
+    if (_node == nullptr) return;
+    int frame = _node->getFrame();
     if (_timer >= 2) {
         _timer = 0;
         _node->setFrame(frame);
@@ -78,7 +78,7 @@ public:
     }
 
     /** Creates a Ghost with the default values */
-    Ghost() : Player(9, 1), _tagTimer(0) {};
+    Ghost() : Player(9, 1), _tagTimer(0), _spookingTimer(0), _spooking(false) {};
 
     /** Releaes all resources allocated with this Ghost */
     ~Ghost() { }
@@ -34,7 +34,7 @@ void Pal::setNode(const std::shared_ptr<scene2::AnimationNode>& node, const std:
 
 void Pal::update(float timestep) {
     // Move the pal
-    if (_spooked || getHelping() || getUnspooking()) {
+    if (!canMove()) {
         _velocity = Vec2::ZERO;
     }
 
@@ -47,7 +47,8 @@ void Pal::update(float timestep) {
 }
 
 void Pal::processDirection() {
-    unsigned int frame = _node->getFrame();
+    if (_node == nullptr || _effectNode == nullptr) return;
+    int frame = _node->getFrame();
     unsigned int effectFrame = _effectNode->getFrame();
     if (_timer >= 2) {
         _timer = 0;
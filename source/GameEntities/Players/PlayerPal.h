@@ -136,6 +136,11 @@ public:
         return _helping > 0;
     }
 
+    /** Returns whether the pal is free to move, i.e. not spooked, helping or being unspooked */
+    virtual bool canMove() const override {
+        return !(_spooked || getHelping() || getUnspooking());
+    }
+
     /** Sets the pal as helping */
     void setHelping() {
         if (!getHelping()) {
@@ -18,6 +18,7 @@ void Trap::setNode(const shared_ptr<scene2::PolygonNode>& node, const std::share
 }
 
 void Trap::processState() {
+    if (_chandelierNode == nullptr || _smokeNode == nullptr) return;
     unsigned int frame = _chandelierNode->getFrame();
     unsigned int smokeFrame = _smokeNode->getFrame();
     if (_timer >= 2) {
@@ -49,6 +50,12 @@ void Trap::processState() {
 
 void Trap::update(float timestep) {
     GameEntity::update(timestep);
+    if (_node == nullptr) {
+        // headless: only the trap timers matter
+        if (getTriggered() && _triggering > 0) _triggering--;
+        else if (!getTriggered() && getArmed() && _arming > 0) _arming--;
+        return;
+    }
     if (getTriggered()) {
         if (_triggering > 0) {
             _triggering--;
@@ -14,6 +14,7 @@ using namespace cugl;
 */
 bool GameEntity::init(const Vec2& pos) {
     _loc = pos;
+    _prevLoc = pos;
     
     return true;
 }
@@ -48,7 +49,7 @@ void GameEntity::setNode(const std::shared_ptr<scene2::AnimationNode>& value) {
  * @param timestep  Time elapsed since last called.
  */
 
-void GameEntity::update(float timestep) {
+void GameEntity::update(float /*timestep*/) {
     //setPosition(0, 0);
     if (_node != nullptr) _node->setPosition(_loc);
 
@@ -19,6 +19,9 @@ protected:
 	/** Location of the entity */
 	Vec2 _loc;
 
+	/** Location of the entity before the last simulation tick */
+	Vec2 _prevLoc;
+
 	/** Radius of the entity in pixels */
 	int _radius;
 
@@ -39,6 +42,15 @@ public:
 		return _radius;
 	}
 
+	/**
+	Returns the position between the last two simulation ticks, for drawing
+
+	@param alpha 0 for the previous tick, 1 for the current one
+	*/
+	Vec2 getLerpLoc(float alpha) const {
+		return _prevLoc + (_loc - _prevLoc) * alpha;
+	}
+
 	/**
 	Sets the position of the entity
 	*/
@@ -9,15 +9,30 @@ using namespace cugl;
 bool GameMap::init(const shared_ptr<AssetManager>& assets) {
     _assets = assets;
     _teleCount = 4;
-    return true;
+    if (assets == nullptr) {
+        // without the asset manager (e.g. the headless host) every map shares one catalog
+        static shared_ptr<RoomParser> catalog = RoomParser::alloc(ROOM_DIRECTORY);
+        _parser = catalog;
+    }
+    else {
+        _parser = assets->get<RoomParser>(ROOM_CATALOG);
+        if (_parser == nullptr) {
+            CULogError("The room catalog is not loaded");
+        }
+    }
+    return _parser != nullptr;
 }
 
 #pragma mark Gameplay Handling
 
 /** Adds a trap to _traps, delete after traps properly implemented */
 void GameMap::addTrap(Vec2 pos) {
-    auto trap = Trap::alloc(_player->getLoc());
+    auto trap = Trap::alloc(pos);
     trap->setArmed();
+    _traps.push_back(trap);
+    _trapIndex.insert(trap);
+    if (litRoot == nullptr) return;
+
     auto trapNode = scene2::PolygonNode::allocWithTexture(_assets->get<Texture>("ghost_shadow_texture"));
     trapNode->setAnchor(Vec2::ANCHOR_CENTER);
     //trapNode->setScale(0.25f); // TEMP
@@ -43,30 +58,31 @@ void GameMap::addTrap(Vec2 pos) {
     trapNode->addChildWithName(trapRadiusNode, "radius");
 
     trap->setNode(trapNode, chandelierNode, smokeNode);
-    trap->setLoc(pos);
-    _traps.push_back(trap);
 }
 
 /** Method to update the GameMap model, called by GameScene */
 void GameMap::update(float timestep) {
+    indexPlayers();
+
     vector<shared_ptr<Trap>> newTraps;
     for (auto& t : _traps) {
         t->update(timestep);
         if (t->justTriggered()) {
-            for (auto& p : _players) {
+            _playerIndex.forEachInRadius(t->getLoc(), TRAP_RADIUS, [](const shared_ptr<Player>& p, float) {
                 if (p->getType() == constants::PlayerType::Pal) {
-                    if ((t->getLoc() - p->getLoc()).length() < TRAP_RADIUS) {
-                        auto pal = dynamic_pointer_cast<Pal>(p);
-                        if (!pal->getSpooked()) {
-                            pal->setSpookFlag();
-                        }
+                    auto pal = dynamic_pointer_cast<Pal>(p);
+                    if (!pal->getSpooked()) {
+                        pal->setSpookFlag();
                     }
                 }
-            }
+            });
         }
         if (!t->doneTriggering()) {
             newTraps.push_back(t);
         }
+        else {
+            _trapIndex.remove(t);
+        }
     }
     _traps = newTraps;
     for (auto& s : _slots) {
@@ -75,32 +91,37 @@ void GameMap::update(float timestep) {
 
 
     //pal battery interactions
+    bool pickedUp = false;
     for (auto& p : _players) {
         if (p->getType() == constants::PlayerType::Pal) {
             auto pal = dynamic_pointer_cast<Pal>(p);
             if (pal->getBatteries() < constants::MAX_BATTERIES) {
-                for (auto& b : _batteries) {
-                    Vec2 distance = b->getLoc() - p->getLoc();
-                    float minDistance = distance.length();
-                    if (minDistance < BATTERY_RADIUS && !b->isDestroyed()) {
-                        b->pickUp();
-                        int numBatteries = pal->getBatteries() + 1;
-                        pal->setBatteries(numBatteries);
-                    }
-                }
+                _batteryIndex.forEachInRadius(p->getLoc(), BATTERY_RADIUS, [&](const shared_ptr<Battery>& b, float) {
+                    if (b->isDestroyed()) return;
+                    b->pickUp();
+                    pal->setBatteries(pal->getBatteries() + 1);
+                    pickedUp = true;
+                });
             }
         }
     }
 
-    vector<shared_ptr<Battery>> newBatteries;
-    for (auto& b : _batteries) {
-        if (!b->isDestroyed()) {
-            newBatteries.push_back(b);
+    if (pickedUp) {
+        vector<shared_ptr<Battery>> newBatteries;
+        for (auto& b : _batteries) {
+            if (!b->isDestroyed()) {
+                newBatteries.push_back(b);
+            }
+            else {
+                _batteryIndex.remove(b);
+            }
         }
+        _batteries = newBatteries;
     }
-    _batteries = newBatteries;
 
-    _player->update(timestep);
+    if (_player != nullptr) {
+        _player->update(timestep);
+    }
 
     // If ghost is tagged, lower the tag timer
     /*
@@ -119,81 +140,81 @@ void GameMap::update(float timestep) {
 }
 
 /** Method to update player velocity and players */
-void GameMap::move(Vec2 move, Vec2 direction) {
-    Vec2 velocity = _player->predictVelocity(move);
-    Vec2 loc = _player->getLoc() + velocity + Vec2(-20, -10);
-    
-    Rect hitbox = Rect(loc, constants::PLAYER_HITBOX_DIMENSIONS);
-    
-    for (auto& room : getRooms()) {
-        if (_player->getType() == constants::PlayerType::Pal) {
-            //obstacle collision here
+bool GameMap::hitsWall(const Vec2& loc, bool obstacles) const {
+    Rect hitbox = Rect(loc + Vec2(-20, -10), constants::PLAYER_HITBOX_DIMENSIONS);
+    return _colliders.overlaps(hitbox, obstacles);
+}
+
+void GameMap::move(const shared_ptr<Player>& player, Vec2 move, Vec2 direction) {
+    Vec2 velocity = player->predictVelocity(move);
+    Vec2 loc = player->getLoc();
+    bool obstacles = player->getType() == constants::PlayerType::Pal;
+    if (hitsWall(loc + velocity, obstacles)) {
+        // resolve each axis on its own so the player slides along what it hit
+        Vec2 allowed = Vec2::ZERO;
+        if (!hitsWall(loc + Vec2(velocity.x, 0), obstacles)) {
+            allowed.x = velocity.x;
         }
-        for (auto& wall : room->getWalls()) {
-            if (hitbox.doesIntersect(wall)) {
-                _player->updateVelocity(Vec2::ZERO);
-                _player->setDir(move);
-                return;
-            }
+        if (!hitsWall(loc + Vec2(allowed.x, velocity.y), obstacles)) {
+            allowed.y = velocity.y;
         }
+        if (allowed.isZero()) {
+            player->setVelocity(Vec2::ZERO);
+            player->setIdle(true);
+            player->setDir(move);
+            return;
+        }
+        velocity = allowed;
     }
-    _player->updateVelocity(move);
-    if (_player->getType() == constants::PlayerType::Pal) {
+    player->setVelocity(velocity);
+    player->setIdle(velocity.isNearZero());
+    if (player->getType() == constants::PlayerType::Pal) {
         // if pal is helping, freeze the vision cone direction
-        if (direction != Vec2::ZERO && !dynamic_pointer_cast<Pal>(_player)->getHelping()) {
-            _player->setDir(direction);
+        if (direction != Vec2::ZERO && !dynamic_pointer_cast<Pal>(player)->getHelping()) {
+            player->setDir(direction);
         }
     }
     else {
         if (move != Vec2::ZERO) {
-            _player->setDir(move);
+            player->setDir(move);
         }
     }
 }
 
+void GameMap::predictMove(Vec2 move, Vec2 direction) {
+    this->move(move, direction);
+    if (!_player->canMove()) {
+        _player->setVelocity(Vec2::ZERO);
+    }
+    _player->setLoc(_player->getLoc() + _player->getVelocity());
+}
+
 /** Helper method to handle the "interact" input from the players */
-void GameMap::handleInteract() {
+void GameMap::handleInteract(const shared_ptr<Player>& player) {
     float range = 250.0f;
-    if (_player->getType() == constants::PlayerType::Pal && !dynamic_pointer_cast<Pal>(_player)->getSpooked()) {
-        shared_ptr<Pal> pal;
-        float minDistance = numeric_limits<float>::infinity();
-        for (auto& p : _players) {
-            if (p->getType() == constants::PlayerType::Pal && p != _player && dynamic_pointer_cast<Pal>(p)->getSpooked()) {
-                Vec2 distance = p->getLoc() - _player->getLoc();
-                if (distance.length() < minDistance) {
-                    pal = dynamic_pointer_cast<Pal>(p);
-                    minDistance = distance.length();
-                }
-            }
-        }
-        if (minDistance < range) {
-            dynamic_pointer_cast<Pal>(_player)->setHelping();
-            dynamic_pointer_cast<Pal>(pal)->setUnspookFlag();
+    indexPlayers();
+    if (player->getType() == constants::PlayerType::Pal && !dynamic_pointer_cast<Pal>(player)->getSpooked()) {
+        auto spooked = _playerIndex.nearest(player->getLoc(), range, [&](const shared_ptr<Player>& p) {
+            return p->getType() == constants::PlayerType::Pal && p != player && dynamic_pointer_cast<Pal>(p)->getSpooked();
+        });
+        if (spooked != nullptr) {
+            dynamic_pointer_cast<Pal>(player)->setHelping();
+            dynamic_pointer_cast<Pal>(spooked)->setUnspookFlag();
             return;
         }
 
-        pal = dynamic_pointer_cast<Pal>(_player);
-
-        shared_ptr<BatterySlot> slot;
-        minDistance = numeric_limits<float>::infinity();
-        for (auto& room : _rooms) {
-            if (room->getWinRoom()) continue;
-            auto s = room->getSlot();
-            if (s == nullptr) continue;
-            Vec2 distance = s->getLoc() - _player->getLoc();
-            if (distance.length() < minDistance) {
-                slot = s;
-                minDistance = distance.length();
-            }
-        }
-        
+        auto pal = dynamic_pointer_cast<Pal>(player);
+
         // Check if pal is in range of teleporter
         Vec2 tpPos = _endRank * constants::WALL_LENGTH + constants::TELEPORTER_POS;
-        Vec2 distance = tpPos - _player->getLoc();
-        if (distance.length() < range && pal->getBatteries() > 0) {
+        if (tpPos.distanceSquared(player->getLoc()) < range * range && pal->getBatteries() > 0) {
             _teleCount -= 1;
             pal->setBatteries(pal->getBatteries() - 1);
-        } else if (slot != nullptr && minDistance < SLOT_RADIUS) {
+            return;
+        }
+
+        auto slot = _slotIndex.nearest(player->getLoc(), SLOT_RADIUS);
+        if (slot != nullptr) {
             if (slot->getCharge() <= 0 && !slot->activated() && pal->getBatteries() > 0) {
                 slot->activate();
                 pal->setBatteries(pal->getBatteries() - 1);
@@ -201,41 +222,118 @@ void GameMap::handleInteract() {
         }
 
     }
-    else if (_player->getType() == constants::PlayerType::Ghost) {
-        shared_ptr<Trap> trap;
-        
-        float minDistance = numeric_limits<float>::infinity();
-        for (auto& t : _traps) {
-            if (!t->getTriggered()) {
-                Vec2 distance = t->getLoc() - _player->getLoc();
-                if (distance.length() < minDistance) {
-                    trap = t;
-                    minDistance = distance.length();
-                }
+    else if (player->getType() == constants::PlayerType::Ghost) {
+        auto trap = _trapIndex.nearest(player->getLoc(), TRAP_RADIUS, [](const shared_ptr<Trap>& t) {
+            return !t->getTriggered();
+        });
+        if (trap != nullptr) {
+            trap->setTriggered();
+            if (trap->justTriggered()) {
+                dynamic_pointer_cast<Ghost>(player)->setSpooking(true);
             }
         }
-        if (trap == nullptr) {
-            addTrap(_player->getLoc());
-        }
         else {
-            if (minDistance < TRAP_RADIUS) {
-                
-                trap->setTriggered();
-                if (trap->justTriggered()) {
-                    dynamic_pointer_cast<Ghost>(_player)->setSpooking(true);
-                }
-                
-            }
-            else {
-                addTrap(_player->getLoc());
-            }
+            addTrap(player->getLoc());
         }
         
     }
 }
 
+void GameMap::setTraps(const vector<Vec2>& trapPositions) {
+    unordered_set<Trap*> kept;
+    vector<shared_ptr<Trap>> newTraps;
+    vector<Vec2> newTrapPositions;
+    for (auto& pos : trapPositions) {
+        auto trap = _trapIndex.nearest(pos, TRAP_RADIUS, [&](const shared_ptr<Trap>& t) {
+            return kept.count(t.get()) == 0;
+        });
+        if (trap != nullptr) {
+            kept.insert(trap.get());
+            newTraps.push_back(trap);
+        }
+        else {
+            newTrapPositions.push_back(pos);
+        }
+    }
+    for (auto& trap : _traps) {
+        if (kept.count(trap.get()) == 0) {
+            _trapIndex.remove(trap);
+        }
+    }
+    _traps = newTraps;
+    for (auto& pos : newTrapPositions) {
+        addTrap(pos);
+    }
+}
+
+void GameMap::indexPlayers() {
+    _playerIndex.clear();
+    for (auto& p : _players) {
+        _playerIndex.insert(p);
+    }
+}
+
+constants::PlayerType GameMap::getWinner() const {
+    bool allPalsSpooked = true;
+    for (auto& p : _players) {
+        if (p->getType() == constants::PlayerType::Pal) {
+            allPalsSpooked = allPalsSpooked && dynamic_pointer_cast<Pal>(p)->getSpooked();
+        }
+    }
+    if (allPalsSpooked) {
+        return constants::PlayerType::Ghost;
+    }
+    if (_teleCount == 0) {
+        return constants::PlayerType::Pal;
+    }
+    return constants::PlayerType::Undefined;
+}
+
 #pragma mark -
 
+Vec2 GameMap::getPalSpawn(unsigned index) const {
+    static const Vec2 offsets[] = { Vec2(440, 420), Vec2(680, 420), Vec2(560, 360) };
+    return _startRank * constants::WALL_DIMENSIONS + offsets[index % 3];
+}
+
+Rect GameMap::getBounds() const {
+    if (_rooms.empty()) return Rect::ZERO;
+
+    Vec2 minRank = _rooms.front()->getRanking();
+    Vec2 maxRank = minRank;
+    for (auto& room : _rooms) {
+        Vec2 rank = room->getRanking();
+        minRank.x = min(minRank.x, rank.x);
+        minRank.y = min(minRank.y, rank.y);
+        maxRank.x = max(maxRank.x, rank.x);
+        maxRank.y = max(maxRank.y, rank.y);
+    }
+
+    // Walls extend one tile past the room origin on the south and west sides
+    Vec2 origin = minRank * constants::WALL_LENGTH - Vec2(constants::TILE_SIZE, constants::TILE_SIZE);
+    Vec2 extent = (maxRank - minRank + Vec2::ONE) * constants::WALL_LENGTH + Vec2(2 * constants::TILE_SIZE, 2 * constants::TILE_SIZE);
+    return Rect(origin, Size(extent.x, extent.y));
+}
+
+void GameMap::buildColliders() {
+    vector<Collider> colliders;
+    _slotIndex.clear();
+    for (auto& room : _rooms) {
+        // slots only have their final location once the room is built
+        if (!room->getWinRoom()) {
+            _slotIndex.insert(room->getSlot());
+        }
+        for (auto& wall : room->getWalls()) {
+            colliders.push_back(Collider(wall, false));
+        }
+        for (auto& obstacle : room->getObstacles()) {
+            colliders.push_back(Collider(obstacle, true));
+        }
+    }
+    // cells line up with the tiles, so a wall or obstacle covers whole cells
+    _colliders.build(getBounds(), constants::TILE_SIZE, colliders);
+}
+
 bool GameMap::assertValidMap() {
     // make sure there are no overlapping rooms
     set<Vec2> origins;
@@ -253,7 +351,6 @@ void GameMap::makeNodes() {
     // Rooms
     for (auto& room : _rooms) {
         auto node = scene2::OrderedNode::allocWithOrder(scene2::OrderedNode::Order::ASCEND);
-        auto origin = room->getOrigin();
         node->setContentSize(constants::ROOM_DIMENSIONS);
         node->doLayout();
         node->setName("room_" + to_string(room->getLayout()));
@@ -262,6 +359,7 @@ void GameMap::makeNodes() {
         room->setRoot(litRoot, dimRoot, topRoot);
         room->addObstacles();
     }
+    buildColliders();
 
     // Batteries
     for (auto& battery : _batteries) {
@@ -275,17 +373,26 @@ void GameMap::makeNodes() {
     }
 }
 
+void GameMap::makeModels() {
+    for (auto& room : _rooms) {
+        room->buildModel();
+    }
+    buildColliders();
+}
+
 bool GameMap::generateRandomMap() {
     reset();
 
-    shared_ptr<RoomParser> parser = make_shared<RoomParser>();
-    //_mapData = parser->getMapData(parser->pickMap());
-    _mapData = parser->getMapData("json/maps/map3.json");
+    //_mapData = _parser->getMapData(_parser->pickMap());
+    _mapData = _parser->getMapData(3);
+    if (_mapData == nullptr) {
+        CULogError("Unknown map");
+        return false;
+    }
 
     _startRank = _mapData->start;
     _endRank = _mapData->end;
 
-    int i = 0;
     int type = 0;
     for (auto& room : _mapData->rooms) {
         shared_ptr<GameRoom> r = GameRoom::alloc(_assets, room.doors, room.rank);
@@ -296,7 +403,7 @@ bool GameMap::generateRandomMap() {
         else if (room.rank == _startRank) {
             type = 2;
         }
-        r->pickLayout(parser, type);
+        if (!r->pickLayout(_parser, type)) return false;
 
         for (auto& coord : r->getBatterySpawns()) {
             // Adjust the coordinates of this room's battery spawns
@@ -318,6 +425,7 @@ bool GameMap::generateRandomMap() {
         Vec2 coord = _batteriesSpawnable.back();
         auto batteryModel = Battery::alloc(coord);
         _batteries.push_back(batteryModel);
+        _batteryIndex.insert(batteryModel);
         _batteriesSpawnable.pop_back();
     }
 
@@ -340,18 +448,24 @@ shared_ptr<MapNetworkdata> GameMap::makeNetworkMap() {
 
 /** Takes in the network metadata and updates the GameMap model */
 bool GameMap::readNetworkMap(shared_ptr<MapNetworkdata> networkData) {
-    _rooms.clear();
+    reset();
+    _slots.clear();
     _batteries.clear();
+    _batteryIndex.clear();
     _startRank = networkData->startRank;
     _endRank = networkData->endRank;
 
     for (auto& room : networkData->rooms) {
-        _rooms.push_back(GameRoom::alloc(_assets, room->doors, room->rank, room->layout));
+        auto r = GameRoom::alloc(_assets, room->doors, room->rank, room->layout);
+        if (!r->loadLayout(_parser)) return false;
+        addSlot(r->getSlot());
+        _rooms.push_back(r);
     }
     for (auto& coord : networkData->batteries) {
         auto batteryModel = Battery::alloc(coord);
         _batteries.push_back(batteryModel);
+        _batteryIndex.insert(batteryModel);
     }
 
-    return true;;
+    return true;
 }
@@ -9,6 +9,9 @@
 #include "GameEntities/BatteryCollectible.h"
 #include "GameEntities/Trap.h"
 #include "AudioController.h"
+#include "CollisionGrid.h"
+#include "SpatialIndex.h"
+#include <unordered_set>
 
 #define SLOT_RADIUS 500
 #define TRAP_RADIUS 120 // temp, should be 500px
@@ -83,6 +86,9 @@ private:
     /** The vector of batteries */
     vector<shared_ptr<Battery>> _batteries;
 
+    /** The catalog of room layouts and maps */
+    shared_ptr<RoomParser> _parser;
+
     /** The metadata represeting the map */
     shared_ptr<MapMetadata> _mapData;
     
@@ -92,8 +98,24 @@ private:
     /** The ranking of the end room */
     Vec2 _endRank;
 
+    /** Broadphase over the walls and obstacles of every room */
+    CollisionGrid _colliders;
+
+    /** Proximity indices for interactions; kept in step with the vectors above */
+    SpatialIndex<Trap> _trapIndex;
+    SpatialIndex<Battery> _batteryIndex;
+    SpatialIndex<BatterySlot> _slotIndex;
+    /** Rebuilt before each use, since players move every tick */
+    SpatialIndex<Player> _playerIndex;
+
     bool assertValidMap();
 
+    /** Indexes the walls, obstacles and slots of the rooms, once their models are built */
+    void buildColliders();
+
+    /** Reindexes the players at their current locations */
+    void indexPlayers();
+
 public:
 #pragma mark Constructors
     GameMap() : _teleCount(4) { }
@@ -107,6 +129,7 @@ public:
      */
     virtual void dispose() {
         _assets = nullptr;
+        _parser = nullptr;
         _player = nullptr;
         
         litRoot = nullptr;
@@ -118,6 +141,11 @@ public:
         _traps.clear();
         _slots.clear();
         _batteries.clear();
+        _colliders.clear();
+        _trapIndex.clear();
+        _batteryIndex.clear();
+        _slotIndex.clear();
+        _playerIndex.clear();
     };
 
     /**
@@ -137,37 +165,20 @@ public:
 #pragma mark State Access
     
     /** Returns the list of rooms */
-    vector<shared_ptr<GameRoom>> getRooms() { return _rooms; }
+    const vector<shared_ptr<GameRoom>>& getRooms() const { return _rooms; }
     
     /** Removes references for all rooms */
-    void reset() { _rooms.clear(); }
+    void reset() {
+        _rooms.clear();
+        _colliders.clear();
+        _slotIndex.clear();
+    }
     
     /** Returns the list of traps, delete after traps properly implemented */
-    vector<shared_ptr<Trap>> getTraps() { return _traps; }
-
-    /** Sets traps */
-    void setTraps(const vector<Vec2>& trapPositions) {
-        vector<shared_ptr<Trap>> newTraps;
-        vector<Vec2> newTrapPositions;
-        for (auto& pos : trapPositions) {
-            bool trapExists = false;
-            for (auto& trap : _traps) {
-                if (trap->getLoc().distance(pos) < TRAP_RADIUS && find(newTraps.begin(), newTraps.end(), trap) == newTraps.end()) {
-                    trapExists = true;
-                    newTraps.push_back(trap);
-                    break;
-                }
-            }
+    const vector<shared_ptr<Trap>>& getTraps() const { return _traps; }
 
-            if (!trapExists) {
-                newTrapPositions.push_back(pos);
-            }
-        }
-        _traps = newTraps;
-        for (auto& pos : newTrapPositions) {
-            addTrap(pos);
-        }
-    }
+    /** Sets traps, keeping the existing trap nearest each position */
+    void setTraps(const vector<Vec2>& trapPositions);
     
     /** @return the player model */
     shared_ptr<Player> getPlayer() { return _player; }
@@ -216,6 +227,17 @@ public:
     Vec2 getEndRank() {
         return _endRank;
     }
+
+    /** Returns where the pal with the given index (doe, seal, tanuki) spawns */
+    Vec2 getPalSpawn(unsigned index) const;
+
+    /** Returns where the ghost spawns */
+    Vec2 getGhostSpawn() const {
+        return Vec2(560, 560) + _endRank * constants::WALL_DIMENSIONS;
+    }
+
+    /** Returns the world-space rectangle covering every room, including the outer walls */
+    Rect getBounds() const;
     
     /** Sets the player model */
     void setPlayer(shared_ptr<Player>& player) { _player = player; }
@@ -236,10 +258,38 @@ public:
     void update(float timestep);
     
     /** Method to move and change the direction of players */
-    void move(Vec2 move, Vec2 direction);
+    void move(Vec2 move, Vec2 direction) { this->move(_player, move, direction); }
+
+    /** Moves and changes the direction of the given player */
+    void move(const shared_ptr<Player>& player, Vec2 move, Vec2 direction);
+
+    /**
+     * Returns whether the player hitbox at the given player location overlaps a wall
+     *
+     * @param obstacles whether obstacles block as well (they only block pals)
+     */
+    bool hitsWall(const Vec2& loc, bool obstacles = false) const;
+
+    /**
+     * Applies one frame of movement input to the player without animating it.
+     *
+     * This is the movement part of move and Player::update, used to replay
+     * inputs after a correction from the host.
+     */
+    void predictMove(Vec2 move, Vec2 direction);
     
     /** Method to handle the interactions */
-    void handleInteract();
+    void handleInteract() { handleInteract(_player); }
+
+    /** Handles the "interact" input from the given player */
+    void handleInteract(const shared_ptr<Player>& player);
+
+    /**
+     * Returns the side that has won, or Undefined if the game is still going.
+     *
+     * The ghost takes precedence if both conditions hold on the same frame.
+     */
+    constants::PlayerType getWinner() const;
 
     
 #pragma mark -
@@ -252,6 +302,9 @@ public:
 
     void makeNodes();
 
+    /** Builds the room models (walls, exit) without any scene nodes, for running headless */
+    void makeModels();
+
     /** Constructs metadata to send over the network for map generation */
     shared_ptr<MapNetworkdata> makeNetworkMap();
 
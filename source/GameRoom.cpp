@@ -33,6 +33,7 @@ void GameRoom::setNode(const shared_ptr<scene2::OrderedNode>& value) {
     _node = value;
     _node->setPosition(_origin);
     _node->setAnchor(Vec2::ANCHOR_BOTTOM_CENTER);
+    _node->setStatic(true);
 
     auto slotNodeOn = scene2::PolygonNode::allocWithTexture(_assets->get<Texture>("slot_full"));
     slotNodeOn->setPosition(Vec2(ROOM_DIMENSION / 2 + 80, ROOM_DIMENSION / 2));
@@ -57,26 +58,24 @@ void GameRoom::setRoot(const shared_ptr<scene2::OrderedNode>& lit, const shared_
     topRoot = top;
 };
 
-void GameRoom::pickLayout(const shared_ptr<RoomParser>& parser, int type) {
-    string roomCode = getDoorsStr();
-
-    string path;
-    if (type == 1) {
-        path = "json/layouts/end.json";
-        _layout = -1 * type;
-    }
-    else if (type == 2) {
-        path = "json/layouts/start.json";
+bool GameRoom::pickLayout(const shared_ptr<RoomParser>& parser, int type) {
+    if (type == 1 || type == 2) {
         _layout = -1 * type;
     }
     else {
-        vector<string> temp = parser->pickLayout(roomCode);
-        path = temp[1];
-        _layout = stoi(temp[0]);
+        _layout = parser->pickLayout(getDoorsStr());
     }
+    return loadLayout(parser);
+}
 
-    shared_ptr<LayoutMetadata> roomData = parser->getLayoutData(path);
-    _batterySpawns = roomData->spawns;
+bool GameRoom::loadLayout(const shared_ptr<RoomParser>& parser) {
+    _layoutData = parser->getLayoutData(_layout);
+    if (_layoutData == nullptr) {
+        CULogError("Unknown layout %d", _layout);
+        return false;
+    }
+    _batterySpawns = _layoutData->spawns;
+    return true;
 }
 
 
@@ -85,46 +84,46 @@ void GameRoom::addObstacles() {
     shared_ptr<Texture> litFloorTexture = _assets->get<Texture>("lit_floor1_texture");
     string roomCode = getDoorsStr();
     shared_ptr<Texture> doorTexture = _assets->get<Texture>(roomCode);
-    shared_ptr<scene2::PolygonNode> node = scene2::PolygonNode::allocWithTexture(doorTexture);
-    node->setPriority(constants::Priority::Room);
 
+    // the floors, doors and obstacles are siblings so that the ordered roots
+    // sort them against those of the other rooms and the players
     shared_ptr<scene2::PolygonNode> floorNode = scene2::PolygonNode::allocWithTexture(floorTexture);
     floorNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-    floorNode->setPosition(floorNode->getPosition());
+    floorNode->setPosition(getOrigin());
     floorNode->setPriority(constants::Priority::Background);
-    node->addChild(floorNode);
+    dimRoot->addChild(floorNode);
+
+    shared_ptr<scene2::PolygonNode> node = scene2::PolygonNode::allocWithTexture(doorTexture);
     node->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
     node->setPosition(getOrigin());
+    node->setPriority(constants::Priority::Room);
     dimRoot->addChild(node);
+
+    shared_ptr<scene2::SceneNode> obsDimGroup = scene2::SceneNode::alloc();
+    obsDimGroup->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
+    obsDimGroup->setPosition(getOrigin());
+    obsDimGroup->setPriority(constants::Priority::RoomEntity);
+    obsDimGroup->setStatic(true);
+    dimRoot->addChild(obsDimGroup);
     
     //scene graph for lit versions of entities, or entities only visible under light
     shared_ptr<scene2::PolygonNode> litFloorNode = scene2::PolygonNode::allocWithTexture(litFloorTexture);
     litFloorNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-    litFloorNode->setPosition(litFloorNode->getPosition());
     litFloorNode->setPriority(constants::Priority::Background);
+    _node->addChild(litFloorNode);
 
     shared_ptr<scene2::PolygonNode> litDoorNode = scene2::PolygonNode::allocWithTexture(doorTexture);
-    litDoorNode->addChild(litFloorNode);
     litDoorNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-    _node->addChild(litDoorNode);
     litDoorNode->setPriority(constants::Priority::Room);
+    _node->addChild(litDoorNode);
 
-    shared_ptr<RoomParser> parser = make_shared<RoomParser>();
-    string path;
-    // Start room
-    if (_layout == -2) {
-        path = "json/layouts/start.json";
-    }
-    else if (_layout == -1) {
-        path = "json/layouts/end.json";
-        _winRoom = true;
-    }
-    else {
-        path = "json/layouts/" + to_string(_layout) + ".json";
-    }
+    shared_ptr<scene2::SceneNode> obsGroup = scene2::SceneNode::alloc();
+    obsGroup->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
+    obsGroup->setPriority(constants::Priority::RoomEntity);
+    obsGroup->setStatic(true);
+    _node->addChild(obsGroup);
 
-    shared_ptr<LayoutMetadata> roomData = parser->getLayoutData(path);
-    for (auto& obs : roomData->obstacles) {
+    for (auto& obs : _layoutData->obstacles) {
         // Get texture with name
         shared_ptr<Texture> obsTexture = _assets->get<Texture>(obs.name);
         shared_ptr<scene2::PolygonNode> obsNode = scene2::PolygonNode::allocWithTexture(obsTexture);
@@ -136,10 +135,8 @@ void GameRoom::addObstacles() {
         Vec2 position = Vec2((obs.position.x * constants::TILE_SIZE + 80), (obs.position.y * constants::TILE_SIZE));
         obsNode->setPosition(position);
         obsNode->setPriority(constants::Priority::RoomEntity);
-        // Do something with hitboxes
-        Vec2 hitbox = obs.hitbox;
         // Add to scene graph
-        _node->addChild(obsNode);
+        obsGroup->addChild(obsNode);
 
         // Now to the same for the dim version
         // Get texture with name
@@ -152,7 +149,7 @@ void GameRoom::addObstacles() {
         obsDimNode->setPosition(position);
         obsDimNode->setPriority(constants::Priority::RoomEntity);
         // Add to scene graph
-        node->addChild(obsDimNode);
+        obsDimGroup->addChild(obsDimNode);
     }
 
     if (_layout == -1) { // end room
@@ -174,204 +171,95 @@ void GameRoom::addObstacles() {
         }
     }
 
+    // the obstacles never change, so draw each group as a few meshes at the
+    // obstacle priority; the battery slot and teleporters are toggled and stay live
+    obsDimGroup->bake(true);
+    obsGroup->bake(true);
+
     addWalls();
 };
 
-void GameRoom::addWalls() {
+void GameRoom::buildModel() {
+    if (_layout == -1) {
+        _winRoom = true;
+    }
+    _slotModel->setLoc(_origin + Vec2(ROOM_DIMENSION / 2 + 80, ROOM_DIMENSION / 2));
+
+    // obstacle sprites are centered on a tile corner, offset past the west wall like in addObstacles
+    _obstacles.clear();
+    for (auto& obs : _layoutData->obstacles) {
+        Vec2 center = Vec2(obs.position.x * constants::TILE_SIZE + 80, obs.position.y * constants::TILE_SIZE);
+        Vec2 size = obs.hitbox * constants::TILE_SIZE;
+        _obstacles.push_back(Rect(_origin + center - size / 2, Size(size.x, size.y)));
+    }
+
+    float width = constants::ROOM_DIMENSIONS.width;
+    float height = constants::ROOM_DIMENSIONS.height;
+    _wallNodes.clear();
+
+    // a side with a door gets two walls on either side of the opening
     int dir = 0;
     for (auto door : getDoors()) {
         switch (dir) {
         case constants::DoorDirection::North:
-            {
-                if (door) {
-                    auto wallDimensions = Size(480, 80);
-                    Vec2 wallPos = Vec2(0, constants::ROOM_DIMENSIONS.height).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-
-                    Vec2 wallPos2 = Vec2((constants::ROOM_DIMENSIONS.width / 2 + 160), constants::ROOM_DIMENSIONS.height).add(_origin);
-                    auto wallRect2 = Rect(wallPos2, wallDimensions);
-                    auto wallNode2 = scene2::PolygonNode::alloc(wallRect2);
-                    wallNode2->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode2->setColor(Color4f::BLUE);
-
-                    wallNode2->setPosition(wallPos2);
-                    wallNode2->setPriority(constants::Priority::Room);
-                    wallNode2->setVisible(false);
-                    topRoot->addChild(wallNode2);
-                    _wallNodes.push_back(wallRect2);
-                    break;
-
-                }
-                else {
-                    auto wallDimensions = Size(1120, 80);
-                    Vec2 wallPos = Vec2(0, constants::ROOM_DIMENSIONS.height).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-                    break;
-                }
+            if (door) {
+                _wallNodes.push_back(Rect(Vec2(0, height).add(_origin), Size(480, 80)));
+                _wallNodes.push_back(Rect(Vec2(width / 2 + 160, height).add(_origin), Size(480, 80)));
+            }
+            else {
+                _wallNodes.push_back(Rect(Vec2(0, height).add(_origin), Size(1120, 80)));
             }
+            break;
         case constants::DoorDirection::East:
-            {
-                if (door) {
-                    auto wallDimensions = Size(80, 480);
-                    Vec2 wallPos = Vec2(constants::ROOM_DIMENSIONS.width + 80, -80).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-
-                    Vec2 wallPos2 = Vec2(constants::ROOM_DIMENSIONS.width + 80, constants::ROOM_DIMENSIONS.height / 2 + 80).add(_origin);
-                    auto wallRect2 = Rect(wallPos2, wallDimensions);
-                    auto wallNode2 = scene2::PolygonNode::alloc(wallRect2);
-                    wallNode2->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode2->setColor(Color4f::BLUE);
-
-                    wallNode2->setPosition(wallPos2);
-                    wallNode2->setPriority(constants::Priority::Room);
-                    wallNode2->setVisible(false);
-                    topRoot->addChild(wallNode2);
-                    _wallNodes.push_back(wallRect2);
-                    break;
-
-                }
-                else {
-                    //rightmost wall
-                    auto wallDimensions = Size(80, 1120);
-                    Vec2 wallPos = Vec2(constants::ROOM_DIMENSIONS.width + 80, 0).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-                    break;
-                }
-
+            if (door) {
+                _wallNodes.push_back(Rect(Vec2(width + 80, -80).add(_origin), Size(80, 480)));
+                _wallNodes.push_back(Rect(Vec2(width + 80, height / 2 + 80).add(_origin), Size(80, 480)));
             }
+            else {
+                //rightmost wall
+                _wallNodes.push_back(Rect(Vec2(width + 80, 0).add(_origin), Size(80, 1120)));
+            }
+            break;
         case constants::DoorDirection::South:
-            {
-                if (door) {
-                    auto wallDimensions = Size(480, 80);
-                    Vec2 wallPos = Vec2(0, -80).add(_origin);
-                    Vec2 wallRectPos = Vec2(160, -80).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-
-                    Vec2 wallPos2 = Vec2((constants::ROOM_DIMENSIONS.width / 2 + 160), -80).add(_origin);
-                    Vec2 wallRectPos2 = Vec2(constants::ROOM_DIMENSIONS.width / 2 + 80, 0).add(_origin);
-                    auto wallRect2 = Rect(wallPos2, wallDimensions);
-                    auto wallNode2 = scene2::PolygonNode::alloc(wallRect2);
-                    wallNode2->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode2->setColor(Color4f::BLUE);
-
-                    wallNode2->setPosition(wallPos2);
-                    wallNode2->setPriority(constants::Priority::Room);
-                    wallNode2->setVisible(false);
-                    topRoot->addChild(wallNode2);
-                    _wallNodes.push_back(wallRect2);
-                    break;
-                }
-                else {
-                    //bottommost wall
-                    auto wallDimensions = Size(1120, 80);
-                    Vec2 wallPos = Vec2(0, -80).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-                    break;
-
-                }
+            if (door) {
+                _wallNodes.push_back(Rect(Vec2(0, -80).add(_origin), Size(480, 80)));
+                _wallNodes.push_back(Rect(Vec2(width / 2 + 160, -80).add(_origin), Size(480, 80)));
+            }
+            else {
+                //bottommost wall
+                _wallNodes.push_back(Rect(Vec2(0, -80).add(_origin), Size(1120, 80)));
             }
+            break;
         case constants::DoorDirection::West:
-            {
-                if (door) {
-                    auto wallDimensions = Size(80, 480);
-                    Vec2 wallPos = Vec2(0, -80).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-
-                    Vec2 wallPos2 = Vec2(0, constants::ROOM_DIMENSIONS.height / 2 + 80).add(_origin);
-                    auto wallRect2 = Rect(wallPos2, wallDimensions);
-                    auto wallNode2 = scene2::PolygonNode::alloc(wallRect2);
-                    wallNode2->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode2->setColor(Color4f::BLUE);
-
-                    wallNode2->setPosition(wallPos2);
-                    wallNode2->setPriority(constants::Priority::Room);
-                    wallNode2->setVisible(false);
-                    topRoot->addChild(wallNode2);
-                    _wallNodes.push_back(wallRect2);
-                    break;
-                }
-                else {
-                    //leftmost wall
-                    auto wallDimensions = Size(80, 1120);
-                    Vec2 wallPos = Vec2(0, 0).add(_origin);
-                    auto wallRect = Rect(wallPos, wallDimensions);
-                    auto wallNode = scene2::PolygonNode::alloc(wallRect);
-                    wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
-                    wallNode->setColor(Color4f::BLUE);
-
-                    wallNode->setPosition(wallPos);
-                    wallNode->setPriority(constants::Priority::Room);
-                    wallNode->setVisible(false);
-                    topRoot->addChild(wallNode);
-                    _wallNodes.push_back(wallRect);
-                    break;
-                }
+            if (door) {
+                _wallNodes.push_back(Rect(Vec2(0, -80).add(_origin), Size(80, 480)));
+                _wallNodes.push_back(Rect(Vec2(0, height / 2 + 80).add(_origin), Size(80, 480)));
             }
+            else {
+                //leftmost wall
+                _wallNodes.push_back(Rect(Vec2(0, 0).add(_origin), Size(80, 1120)));
+            }
+            break;
         }
         ++dir;
     }
+}
 
+void GameRoom::addWalls() {
+    buildModel();
+
+    // hidden outlines of the walls, for debugging collisions; show the group to see them
+    auto wallGroup = scene2::SceneNode::alloc();
+    wallGroup->setPriority(constants::Priority::Room);
+    wallGroup->setVisible(false);
+    for (auto& wallRect : _wallNodes) {
+        auto wallNode = scene2::PolygonNode::alloc(wallRect);
+        wallNode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
+        wallNode->setColor(Color4f::BLUE);
+
+        wallNode->setPosition(wallRect.origin);
+        wallNode->setPriority(constants::Priority::Room);
+        wallGroup->addChild(wallNode);
+    }
+    topRoot->addChild(wallGroup);
 }
@@ -38,6 +38,9 @@ private:
     shared_ptr<BatterySlot> _slotModel;
     shared_ptr<scene2::PolygonNode> _cableNode;
     vector<Rect> _wallNodes;
+
+    /** World-space hitboxes of the layout's obstacles */
+    vector<Rect> _obstacles;
     
     /** The origin of the room. Distance from (0,0) of the map to room's bottom left corner */
     Vec2 _origin;
@@ -48,6 +51,9 @@ private:
     /** Which layout this room is using. -1 if end room, -2 if start room */
     int _layout;
 
+    /** The obstacles and battery spawns of the layout, shared with the parser's catalog */
+    shared_ptr<LayoutMetadata> _layoutData;
+
     bool _winRoom;
     
     /** Possible locations within the room where batteries can spawn */
@@ -92,7 +98,17 @@ public:
     Vec2 getRanking() { return _ranking; }
 
     // Gets the walls of the room
-    vector<Rect> getWalls() { return _wallNodes; }
+    const vector<Rect>& getWalls() const { return _wallNodes; }
+
+    // Gets the hitboxes of the obstacles in the room
+    const vector<Rect>& getObstacles() const { return _obstacles; }
+
+    /**
+     * Computes the parts of the room the game rules need (walls, obstacle
+     * hitboxes, exit flag) without creating any scene nodes. addObstacles
+     * calls this as well.
+     */
+    void buildModel();
 
     // Gets the scene node
     shared_ptr<scene2::OrderedNode> getNode() { return _node; };
@@ -141,8 +157,11 @@ public:
     /** Populates the room with obstacles */
     void addObstacles();
 
-    /** Picks which layout should be used for this room */
-    void pickLayout(const shared_ptr<RoomParser>& parser, int type);
+    /** Picks which layout should be used for this room, returning false if none fits */
+    bool pickLayout(const shared_ptr<RoomParser>& parser, int type);
+
+    /** Looks up the metadata of this room's layout, which must be set before building the room */
+    bool loadLayout(const shared_ptr<RoomParser>& parser);
     
     /** Is this room the exit room? */
     void setWinRoom(bool exit) { _winRoom = exit; };
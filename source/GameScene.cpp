@@ -162,8 +162,6 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
     // shared_ptr<Texture> doorTexture =_assets->get<Texture>("dim_door_texture");
     //shared_ptr<Texture> litDoorTexture = _assets->get<Texture>("lit_door_texture"); // TODO put this in for loop
 
-    shared_ptr<RoomParser> parser = make_shared<RoomParser>();
-
     shared_ptr<Texture> slotTexture =_assets->get<Texture>("slot_empty");
 
     // Player models
@@ -172,8 +170,7 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
     _assets->get<Texture>("pal_tanuki_texture")->setName("pal_sprite_tanuki");
     _assets->get<Texture>("ghost_texture")->setName("ghost_sprite");
 
-    Vec2 spawnOffset = _gameMap->getStartRank() * constants::WALL_DIMENSIONS;
-
+    unsigned palIndex = 0;
     for (auto& s : { "doe", "seal", "tanuki" }) {
         auto palNode = scene2::AnimationNode::alloc(_assets->get<Texture>("pal_" + string(s) + "_texture"), 6, 24);
         auto hitboxNode = scene2::PolygonNode::alloc(Rect(Vec2 (0, 0), constants::PLAYER_HITBOX_DIMENSIONS));
@@ -184,17 +181,7 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
         auto palSmokeNode = scene2::AnimationNode::alloc(_assets->get<Texture>("pal_effect_texture"), 2, 19);
         
 
-        Vec2 spawn = spawnOffset;
-        if (string(s) == "doe") {
-            spawn += Vec2(440, 420);
-        }
-        else if (string(s) == "seal") {
-            spawn += Vec2(680, 420);
-        }
-        else {
-            spawn += Vec2(560, 360);
-        }
-        auto palModel = Pal::alloc(spawn);
+        auto palModel = Pal::alloc(_gameMap->getPalSpawn(palIndex++));
         palModel->setNode(palNode, palShadowNode, palSmokeNode);
         palModel->setHitbox(hitboxNode);
         hitboxNode->setVisible(true);
@@ -213,7 +200,7 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
     hitboxNode->setColor(Color4f::BLUE);
     hitboxNode->setVisible(false);
 
-    auto ghostModel = Ghost::alloc(Vec2(560, 560)+(_gameMap->getEndRank()*constants::WALL_DIMENSIONS));
+    auto ghostModel = Ghost::alloc(_gameMap->getGhostSpawn());
     ghostModel->setNode(ghostNode, ghostShadowNode);
     ghostModel->setHitbox(hitboxNode);
     ghostModel->setTimer(0);
@@ -318,22 +305,48 @@ void GameScene::addObstacle(const shared_ptr<physics2::Obstacle>& obj, const sha
     }
 }
 
+/**
+ * Advances the game rules by one simulation tick.
+ *
+ * @param step  The length of a simulation tick in seconds
+ */
+void GameScene::fixedUpdate(float step) {
+    CU_PROFILE_ZONE("GameScene::fixedUpdate");
+    // Process movement input and update player states
+    _gameMap->move(_input->getMove(), _input->getDirection());
+    _gameMap->update(step);
+    _network->getData()->recordInput(_input->getMove(), _input->getDirection(), step);
+
+    if (_input->takeInteraction()) {
+        _gameMap->handleInteract();
+    }
+
+    constants::PlayerType winner = _gameMap->getWinner();
+    if (winner != constants::PlayerType::Undefined) {
+        _network->getData()->setWinner(winner);
+    }
+}
+
 /**
  * The method called to update the game mode.
  *
  * This method contains any gameplay code that is not an OpenGL call.
  *
  * @param timestep  The amount of time (in seconds) since the last frame
+ * @param alpha     How far the frame is between the last tick and the next
  */
-void GameScene::update(float timestep) {
+void GameScene::update(float /*timestep*/, float alpha) {
+    CU_PROFILE_ZONE("GameScene::update");
     Size dimen = computeActiveSize();
     Vec2 center(dimen.width / 2, dimen.height / 2);
+
+    // cycle the light map for frame time comparisons
+    if (_input->getLightMapToggle()) {
+        _lightMapScale = _lightMapScale == 0 ? 2 : (_lightMapScale == 2 ? 4 : 0);
+    }
     
     auto player = _gameMap->getPlayer();
 
-    // Process movement input and update player states
-    _gameMap->move(_input->getMove(), _input->getDirection());
-    _gameMap->update(timestep);
     for (auto& p : _players) {
         if (p != nullptr) {
             updateVision(p);
@@ -392,11 +405,6 @@ void GameScene::update(float timestep) {
     }
     */
 
-    if (_input->getInteraction()) {
-        _gameMap->handleInteract();
-    }
-
-
     // Checks if the ghost should be revealed, commented out because no
     // tagging yet
     /**
@@ -421,28 +429,16 @@ void GameScene::update(float timestep) {
         if (shadow != nullptr) shadow->setPriority(node->getPriority() - 0.02f);
     }
 
-    // Update camera
-    _litRoot->setPosition(center - player->getLoc());
-    _dimRoot->setPosition(center - player->getLoc());
-    _topRoot->setPosition(center - player->getLoc());
-    
-
-
-    // Pal wins
-    if (_gameMap->getTeleCount() == 0) {
-        _network->getData()->setWinner(constants::PlayerType::Pal);
+    // Draw the local player between ticks, remote players are already interpolated
+    Vec2 loc = player->getLerpLoc(alpha);
+    if (player->getNode() != nullptr) {
+        player->getNode()->setPosition(loc);
     }
 
-    // Ghost wins
-    bool allPalsSpooked = true;
-    for (auto& p : _players) {
-        if (p->getType() == constants::PlayerType::Pal) {
-            allPalsSpooked = allPalsSpooked && dynamic_pointer_cast<Pal>(p)->getSpooked();
-        }
-    }
-    if (allPalsSpooked) {
-        _network->getData()->setWinner(constants::PlayerType::Ghost);
-    }
+    // Update camera
+    _litRoot->setPosition(center - loc);
+    _dimRoot->setPosition(center - loc);
+    _topRoot->setPosition(center - loc);
 
     if (_network->getData()->getWinner() != constants::PlayerType::Undefined) {
         _mode = constants::GameMode::Win;
@@ -464,80 +460,104 @@ void GameScene::updateVision(const std::shared_ptr<Player>& player) {
 }
 
 void GameScene::draw(const std::shared_ptr<SpriteBatch>& batch, const std::shared_ptr<SpriteBatch>& shaderBatch) {
+    // Only the part of the map under the camera is drawn
+    batch->setCulling(true);
+    shaderBatch->setCulling(true);
+
     if (_gameMap->getPlayer()->getType() == constants::PlayerType::Pal) {
-        float roomLights[constants::MAX_ROOMS * 3];
-        int i = 0;
-        for (auto& room : _gameMap->getRooms()) {
-            auto s = room->getSlot();
-            if (s != nullptr) {
-                Vec2 slotPos = room->getSlot()->getLoc();
-                roomLights[i] = _dimRoot->getPosition().x + slotPos.x;
-                roomLights[i + 1] = _dimRoot->getPosition().y + slotPos.y;
-                roomLights[i + 2] = room->getLight() ? 1 : 0; // set to 1 if room's light is on, 0 if not
+        {
+            CU_PROFILE_ZONE("GameScene::lights");
+            _lights.clear();
+            for (auto& room : _gameMap->getRooms()) {
+                auto s = room->getSlot();
+                if (s != nullptr && room->getLight()) {
+                    _lights.addPoint(_dimRoot->getPosition() + s->getLoc(), constants::ROOM_LIGHT_RADIUS);
+                }
+            }
+            for (auto& player : _players) {
+                if (player != nullptr && player->getType() == constants::PlayerType::Pal) {
+                    Vec2 pos = _topRoot->getPosition() + player->getNode()->getPosition();
+                    _lights.addCone(pos, constants::PAL_LIGHT_RADIUS, player->getDir(),
+                                    constants::PAL_LIGHT_INNER, constants::PAL_LIGHT_OUTER);
+                }
             }
-            i += 3;
-        };
-        //just to fill rest of values if the number of rooms < MAX_ROOMS
-        for (int j = i; j < (constants::MAX_ROOMS * 3); ++j) {
-            roomLights[j] = 0;
-        }
 
-        float palLights[constants::MAX_PALS * 4];
-        i = 0;
-        for (auto& player : _players) {
-            if (player != nullptr && player->getType() == constants::PlayerType::Pal) {
-                palLights[i] = _topRoot->getPosition().x + player->getNode()->getPosition().x;
-                palLights[i + 1] = _topRoot->getPosition().y + player->getNode()->getPosition().y;
-                palLights[i + 2] = 1; // set to 1 if pal is active, 0 if not
-
-                // because vision cone is broken
-                Vec2 dir = player->getDir();
-                float angle = atan2(dir.y, dir.x);
-                angle = fmod(angle - M_PI_2, 2 * M_PI);
-                if (angle < 0) angle += 2 * M_PI;
-                palLights[i + 3] = (angle - M_PI / 2);
-
-                i += 4;
+            batch->setPerspective(_camera->getCombined());
+            _lights.build(batch->getCullRect());
+
+            if (_lightMapScale > 0) {
+                // draw the lights once, at reduced resolution
+                Size size = Application::get()->getDisplaySize() / _lightMapScale;
+                int width = max(1, (int)size.width);
+                int height = max(1, (int)size.height);
+                if (_lightMap == nullptr || _lightMap->getWidth() != width || _lightMap->getHeight() != height) {
+                    _lightMap = RenderTarget::alloc(width, height);
+                    _lightMap->setClearColor(Color4::CLEAR);
+                    _lightMap->getTexture()->setMinFilter(GL_LINEAR);
+                    _lightMap->getTexture()->setMagFilter(GL_LINEAR);
+                }
+                _lights.buildMask(_lightMesh);
+                _lightMap->begin();
+                batch->begin(_camera->getCombined());
+                batch->setTexture(nullptr);
+                batch->setBlendFunc(GL_ONE, GL_ONE);
+                batch->setBlendEquation(GL_FUNC_ADD);
+                batch->fill(_lightMesh, Mat4::IDENTITY, false);
+                batch->end();
+                _lightMap->end();
             }
         }
-        // fill rest of values if the number of pals < MAX_PALS
-        for (int j = i; j < (constants::MAX_PALS * 4); ++j) {
-            palLights[j] = 0;
-        }
-        batch->begin(_camera->getCombined());
-        batch->setBlendFunc(_srcFactor, _dstFactor);
-        batch->setBlendEquation(_blendEquation);
-        _litRoot->render(batch, _root->getNodeToWorldTransform(), _color);
-        batch->end();
 
-        shaderBatch->begin(_camera->getCombined());
-        GLint uPlayers = shaderBatch->getShader()->getUniformLocation("uPlayers");
-        shaderBatch->getShader()->setUniform4fv(uPlayers, constants::MAX_PALS, palLights);
+        {
+            CU_PROFILE_ZONE("GameScene::lit");
+            batch->begin(_camera->getCombined());
+            batch->setBlendFunc(_srcFactor, _dstFactor);
+            batch->setBlendEquation(_blendEquation);
+            _litRoot->render(batch, _root->getNodeToWorldTransform(), _color);
+            batch->end();
+        }
 
-        GLint uRoomLights = shaderBatch->getShader()->getUniformLocation("uRoomLights");
-        shaderBatch->getShader()->setUniform3fv(uRoomLights, constants::MAX_ROOMS, roomLights);
+        {
+            CU_PROFILE_ZONE("GameScene::dim");
+            shaderBatch->begin(_camera->getCombined());
+            auto shader = shaderBatch->getShader();
+            if (_lightMapScale > 0) {
+                // past the sprite batch texture slots, leaving them active
+                _lightMap->getTexture()->bindAt(SPRITE_TEXTURE_SLOTS, false);
+                shader->setUniform1i(shader->getUniformLocation("uLightMask"), SPRITE_TEXTURE_SLOTS);
+                shader->setUniform1i(shader->getUniformLocation("uLightMode"), 1);
+            }
+            else {
+                shader->setUniform1i(shader->getUniformLocation("uLightMode"), 0);
+                _lights.upload(shader);
+            }
 
-        shaderBatch->setBlendFunc(_srcFactor, _dstFactor);
+            shaderBatch->setBlendFunc(_srcFactor, _dstFactor);
 
-        shaderBatch->setBlendEquation(_blendEquation);
-        _dimRoot->render(shaderBatch, _root->getNodeToWorldTransform(), _color);
+            shaderBatch->setBlendEquation(_blendEquation);
+            _dimRoot->render(shaderBatch, _root->getNodeToWorldTransform(), _color);
 
-        shaderBatch->end();
+            shaderBatch->end();
+        }
 
-        batch->begin(_camera->getCombined());
-        batch->setBlendFunc(_srcFactor, _dstFactor);
-        batch->setBlendEquation(_blendEquation);
-        _topRoot->render(batch, _root->getNodeToWorldTransform(), _color);
+        {
+            CU_PROFILE_ZONE("GameScene::top");
+            batch->begin(_camera->getCombined());
+            batch->setBlendFunc(_srcFactor, _dstFactor);
+            batch->setBlendEquation(_blendEquation);
+            _topRoot->render(batch, _root->getNodeToWorldTransform(), _color);
 //        _gameUI->render(batch, _root->getNodeToWorldTransform(), _color);
         
-        batch->begin(_camera->getCombined());
-        batch->setBlendFunc(_srcFactor, _dstFactor);
-        batch->setBlendEquation(_blendEquation);
-        _root->render(batch, _root->getNodeToWorldTransform(), _color);
+            batch->begin(_camera->getCombined());
+            batch->setBlendFunc(_srcFactor, _dstFactor);
+            batch->setBlendEquation(_blendEquation);
+            _root->render(batch, _root->getNodeToWorldTransform(), _color);
 //        getModeRoot()->draw(batch, _root->getNodeToWorldTransform(), _color);
-        batch->end();
+            batch->end();
+        }
     }
     else {
+        CU_PROFILE_ZONE("GameScene::scene");
         batch->begin(_camera->getCombined());
         batch->setBlendFunc(_srcFactor, _dstFactor);
         batch->setBlendEquation(_blendEquation);
@@ -548,6 +568,9 @@ void GameScene::draw(const std::shared_ptr<SpriteBatch>& batch, const std::share
 //        _gameUI->render(batch, _root->getNodeToWorldTransform(), _color);
         batch->end();
     }
+
+    batch->setCulling(false);
+    shaderBatch->setCulling(false);
 }
 
 /**
@@ -7,6 +7,7 @@
 #include "GameMode.h"
 #include "Constants.h"
 #include "GameMap.h"
+#include "LightGrid.h"
 #include "GameEntities/Players/PlayerPal.h"
 #include "GameEntities/Players/PlayerGhost.h"
 #include "InputController.h"
@@ -45,6 +46,15 @@ protected:
     /** Reference to the debug root of the scene graph */
     shared_ptr<scene2::SceneNode> _debugNode;
 
+    /** Room and flashlight lights for the dim pass, rebuilt every frame */
+    LightGrid _lights;
+    /** Light map for the dim pass (null until the light map is first used) */
+    shared_ptr<RenderTarget> _lightMap;
+    /** Light map mesh, rebuilt every frame */
+    Mesh<SpriteVertex3> _lightMesh;
+    /** Light map downscale, or 0 to light every fragment from the tile lists */
+    unsigned _lightMapScale;
+
     /**offset for flashlight position**/
     //Vec2 _flashlightOffset = Vec2(0, -50);
     
@@ -94,7 +104,7 @@ public:
      * This constructor does not allocate any objects or start the game.
      * This allows us to use the object without a heap pointer.
      */
-    GameScene() : GameMode(constants::GameMode::Game), _scale(1), _debug(false) {}
+    GameScene() : GameMode(constants::GameMode::Game), _lightMapScale(constants::LIGHT_MAP_SCALE), _scale(1), _debug(false) {}
 
     /**
      * Disposes of all (non-static) resources allocated to this mode.
@@ -155,6 +165,8 @@ public:
      */
     void setInput(shared_ptr<InputController> input) {
         _input = input;
+        // drop any press made before the game started
+        if (_input != nullptr) _input->takeInteraction();
     }
 
     /**
@@ -180,14 +192,29 @@ public:
 
 #pragma mark -
 #pragma mark Gameplay Handling
+    /**
+     * Advances the game rules by one simulation tick.
+     *
+     * GhostedApp calls this at a fixed rate (constants::TICK_RATE) regardless
+     * of the frame rate, zero or more times per frame.
+     *
+     * @param step  The length of a simulation tick in seconds
+     */
+    void fixedUpdate(float step);
+
     /**
      * The method called to update the game mode.
      *
      * This method contains any gameplay code that is not an OpenGL call.
+     * It runs once per frame after the ticks for that frame.
      *
      * @param timestep  The amount of time (in seconds) since the last frame
+     * @param alpha     How far the frame is between the last tick and the next
      */
-    void update(float timestep) override;
+    void update(float timestep, float alpha);
+
+    /** Updates the game mode, drawing the local player at the last tick */
+    void update(float timestep) override { update(timestep, 1); }
     
     /**
      * Sets the cone position based on player direction
@@ -200,6 +227,19 @@ public:
     virtual void reset();
 
     void draw(const std::shared_ptr<SpriteBatch>& batch, const std::shared_ptr<SpriteBatch>& shaderBatch);
+
+    /**
+     * Sets how the dim pass is lit.
+     *
+     * With 0, the light shader tests the lights of its tile for every
+     * fragment. With 2 or 4, the lights are first drawn into a light map at
+     * half or quarter resolution, and the shader samples it instead. That
+     * trades lighting precision for fill rate on mobile GPUs.
+     */
+    void setLightMapScale(unsigned scale) { _lightMapScale = scale; }
+
+    /** Returns the light map downscale, or 0 if there is no light map */
+    unsigned getLightMapScale() const { return _lightMapScale; }
 };
 #pragma mark -
 #endif /* __GAME_SCENE_H__ */
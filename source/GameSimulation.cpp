@@ -0,0 +1,49 @@
+#include "GameSimulation.h"
+
+using namespace std;
+using namespace cugl;
+
+#pragma mark Constructors
+bool GameSimulation::init(const shared_ptr<GameMap>& map) {
+    if (map == nullptr) return false;
+    _map = map;
+    _map->makeModels();
+
+    for (unsigned i = 0; i < constants::MAX_PALS; ++i) {
+        _players.push_back(Pal::alloc(_map->getPalSpawn(i)));
+    }
+    auto ghost = Ghost::alloc(_map->getGhostSpawn());
+    ghost->setTimer(0);
+    _players.push_back(ghost);
+
+    _map->setPlayers(_players);
+    _winner = constants::PlayerType::Undefined;
+    _ticks = 0;
+    return true;
+}
+
+#pragma mark -
+#pragma mark Gameplay Handling
+void GameSimulation::step(const vector<PlayerInput>& inputs, float timestep) {
+    if (isOver()) return;
+
+    for (unsigned i = 0; i < _players.size() && i < inputs.size(); ++i) {
+        _map->move(_players[i], inputs[i].move, inputs[i].direction);
+        if (inputs[i].interact) {
+            _map->handleInteract(_players[i]);
+        }
+    }
+
+    _map->update(timestep);
+
+    // GameMap only updates the local player; here every player is simulated
+    for (auto& p : _players) {
+        if (p->getType() == constants::PlayerType::Pal) {
+            dynamic_pointer_cast<Pal>(p)->updateSpooked();
+        }
+        p->update(timestep);
+    }
+
+    _winner = _map->getWinner();
+    ++_ticks;
+}
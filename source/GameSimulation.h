@@ -0,0 +1,102 @@
+#pragma once
+
+#ifndef __GAME_SIMULATION_H__
+#define __GAME_SIMULATION_H__
+#include <cugl/cugl.h>
+#include "GameMap.h"
+
+using namespace std;
+using namespace cugl;
+
+/** One tick of input from one player */
+struct PlayerInput {
+    /** The movement input, in the same form InputController reports it */
+    Vec2 move;
+    /** The facing input (ignored by the ghost) */
+    Vec2 direction;
+    /** Whether the interact button was pressed this tick */
+    bool interact;
+
+    PlayerInput() : interact(false) { }
+};
+
+/**
+ * The game rules of one match, without any scene graph, audio or network.
+ *
+ * This owns a GameMap and its players and advances them by whole ticks.
+ * Every player is simulated (there is no local player), so the host is the
+ * only authority. GameScene draws the same models; this class is for
+ * running matches where nothing is drawn, e.g. a dedicated host.
+ */
+class GameSimulation {
+private:
+    /** The map, with rooms built as models only */
+    shared_ptr<GameMap> _map;
+
+    /** The players, in the same order as GameScene (pals, then the ghost) */
+    vector<shared_ptr<Player>> _players;
+
+    /** The side that has won, or Undefined if the match is still going */
+    constants::PlayerType _winner;
+
+    /** Number of ticks simulated so far */
+    unsigned _ticks;
+
+public:
+#pragma mark Constructors
+    GameSimulation() : _winner(constants::PlayerType::Undefined), _ticks(0) { }
+
+    ~GameSimulation() { dispose(); }
+
+    /**
+     * Initializes a match on the given map.
+     *
+     * The map should already be generated (or read from the network) and
+     * must not have scene nodes.
+     */
+    bool init(const shared_ptr<GameMap>& map);
+
+    /** Disposes of all (non-static) resources allocated to this match */
+    void dispose() {
+        _players.clear();
+        _map = nullptr;
+    }
+
+    static shared_ptr<GameSimulation> alloc(const shared_ptr<GameMap>& map) {
+        shared_ptr<GameSimulation> result = make_shared<GameSimulation>();
+        return (result->init(map) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark State Access
+    /** Returns the map */
+    const shared_ptr<GameMap>& getMap() const { return _map; }
+
+    /** Returns the players, indexed by player id */
+    const vector<shared_ptr<Player>>& getPlayers() const { return _players; }
+
+    /** Returns the side that has won, or Undefined if the match is still going */
+    constants::PlayerType getWinner() const { return _winner; }
+
+    /** Returns whether the match is over */
+    bool isOver() const { return _winner != constants::PlayerType::Undefined; }
+
+    /** Returns the number of ticks simulated so far */
+    unsigned getTicks() const { return _ticks; }
+
+#pragma mark -
+#pragma mark Gameplay Handling
+    /**
+     * Advances the match by one tick.
+     *
+     * Player velocities are per tick, so this should be called at the same
+     * fixed rate as the game (see constants::TICK_RATE). Does nothing once
+     * the match is over.
+     *
+     * @param inputs    One input per player, indexed by player id
+     * @param timestep  The length of a tick in seconds
+     */
+    void step(const vector<PlayerInput>& inputs, float timestep);
+};
+
+#endif /** __GAME_SIMULATION_H__ */
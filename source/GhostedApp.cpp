@@ -29,7 +29,7 @@
 //
 // Include the class header, which includes all of the CUGL classes
 #include "GhostedApp.h"
-
+#include "AtlasNames.h"
 
 
 // This keeps us from having to write cugl:: all the time
@@ -42,6 +42,24 @@ const std::string _fsource =
 #include "../assets/shaders/lightShader.frag"
 ;
 
+/** The precompiled bundle made by the bundle tool, relative to the assets folder */
+#define ASSET_BUNDLE "assets.bundle"
+
+/**
+ * Returns the packed version of an asset directory if the atlas tool has
+ * made one, and the directory itself otherwise.
+ */
+static std::string packedDirectory(const std::shared_ptr<AssetManager>& assets, const std::string& directory) {
+    std::string packed = atlas::packedName(directory);
+    if (assets->getBundle() != nullptr && assets->getBundle()->contains(packed)) {
+        return packed;
+    }
+    if (filetool::file_exists(Application::get()->getAssetDirectory() + packed)) {
+        return packed;
+    }
+    return directory;
+}
+
 /**
  * The method called after OpenGL is initialized, but before running the application.
  *
@@ -53,9 +71,11 @@ const std::string _fsource =
  * causing the application to run.
  */
 void GhostedApp::onStartup() {
-    Size size = getDisplaySize();
     // Create an asset manager to load all assets
     _assets = AssetManager::alloc();
+    if (filetool::file_exists(getAssetDirectory() + ASSET_BUNDLE)) {
+        _assets->setBundle(AssetBundle::allocWithAsset(ASSET_BUNDLE));
+    }
     _mode = constants::GameMode::Loading;
     _mute = false;
     
@@ -69,6 +89,12 @@ void GhostedApp::onStartup() {
     setClearColor(Color4::RED);
     
     _resetPressed = false;
+    _statFrames = 0;
+    _showProfiler = false;
+    _traceCount = 0;
+#ifdef CU_PROFILE
+    Profiler::start();
+#endif
 
     // Activate mouse or touch screen input as appropriate
     // We have to do this BEFORE the scene, because the scene has a button
@@ -106,6 +132,8 @@ void GhostedApp::onShutdown() {
     _input = nullptr;
     _collision = nullptr;
     _audio = nullptr;
+    _profilerOverlay = nullptr;
+    Profiler::stop();
     
     _loadKeys = false;
     
@@ -264,7 +292,15 @@ void GhostedApp::update(float timestep) {
         case constants::GameMode::Lobby:
             _networkData->setStatus(constants::MatchStatus::Waiting);
             _lobby.setNetwork(_network);
-            _lobby.init(_assets);
+            if (!_lobby.init(_assets)) {
+                // the lobby connects last, so there is no match to leave
+                CULogError("Could not set up the lobby, returning to the start screen");
+                _lobby.dispose();
+                _networkData->setStatus(constants::MatchStatus::None);
+                _start.init(_assets);
+                _start.setMute(_mute);
+                mode = constants::GameMode::Start;
+            }
 //            _lobby.setMute(_mute);
             break;
         case constants::GameMode::Game:
@@ -286,11 +322,15 @@ void GhostedApp::update(float timestep) {
     }
 
         _mode = mode;
+        _accumulator = 0;
     }
     
     if (_input != nullptr) {
         _input->update(timestep);
     }
+#ifdef CU_PROFILE
+    updateProfiler(timestep);
+#endif
     
     switch (_mode) {
     case constants::GameMode::None:
@@ -316,14 +356,24 @@ void GhostedApp::update(float timestep) {
     case constants::GameMode::Lobby:
 //        _mute = _lobby.getMute();
         _network->update(timestep);
+        for (unsigned i = takeTicks(timestep); i > 0; --i) {
+            _network->step();
+        }
         _lobby.update(timestep);
         break;
     case constants::GameMode::Game:
         _network->update(timestep);
-        _gameplay.update(timestep);
+        for (unsigned i = takeTicks(timestep); i > 0 && _gameplay.getMode() == constants::GameMode::Game; --i) {
+            _gameplay.fixedUpdate(1 / constants::TICK_RATE);
+            _network->step();
+        }
+        _gameplay.update(timestep, getTickAlpha());
         break;
     case constants::GameMode::Win:
         _network->update(timestep);
+        for (unsigned i = takeTicks(timestep); i > 0; --i) {
+            _network->step();
+        }
         _win.update(timestep);
         break;
     case constants::GameMode::Info:
@@ -335,6 +385,21 @@ void GhostedApp::update(float timestep) {
     }
 }
 
+unsigned GhostedApp::takeTicks(float timestep) {
+    const float tick = 1 / constants::TICK_RATE;
+    _accumulator += timestep;
+    unsigned ticks = 0;
+    while (_accumulator >= tick && ticks < constants::MAX_TICKS_PER_FRAME) {
+        _accumulator -= tick;
+        ++ticks;
+    }
+    // after a long stall, drop the backlog instead of catching up over many frames
+    if (_accumulator >= tick) {
+        _accumulator = fmod(_accumulator, tick);
+    }
+    return ticks;
+}
+
 /**
  * The method called to draw the application to the screen.
  *
@@ -346,6 +411,8 @@ void GhostedApp::update(float timestep) {
  */
 void GhostedApp::draw() {
     switch (_mode) {
+    case constants::GameMode::None:
+        break;
     case constants::GameMode::Loading:
         _loading.render(_batch);
         break;
@@ -371,6 +438,67 @@ void GhostedApp::draw() {
         _gameplay.draw(_batch, _shaderBatch);
         break;
     }
+#ifdef GHOSTED_RENDER_STATS
+    reportRenderStats();
+#endif
+    if (_showProfiler && _profilerOverlay != nullptr) {
+        _profilerOverlay->render(_batch);
+    }
+}
+
+/**
+ * Logs the average vertex upload and buffer stall per frame every few seconds.
+ *
+ * The sprite batches count these across all of their passes, so the numbers
+ * cover the lit, dim and top passes of the game scene together.
+ */
+void GhostedApp::reportRenderStats() {
+    if (++_statFrames < 5 * getFPS()) return;
+    Uint64 bytes = _batch->getBytesUploaded() + _shaderBatch->getBytesUploaded();
+    Uint64 stall = _batch->getStallTime() + _shaderBatch->getStallTime();
+    CULog("render: %.1f KB uploaded, %.1f us stalled per frame",
+          bytes / 1024.0f / _statFrames, (float)stall / _statFrames);
+    _batch->resetStreamStats();
+    _shaderBatch->resetStreamStats();
+    _statFrames = 0;
+}
+
+/**
+ * Handles the profiler keys and refreshes the overlay.
+ *
+ * The backquote key shows the overlay, and the backslash key starts a trace
+ * capture or writes the current one to the save directory.
+ */
+void GhostedApp::updateProfiler(float timestep) {
+    Profiler* profiler = Profiler::get();
+    Keyboard* keys = Input::get<Keyboard>();
+    if (profiler == nullptr || keys == nullptr) return;
+
+    if (keys->keyPressed(KeyCode::BACKQUOTE)) {
+        _showProfiler = !_showProfiler;
+    }
+    if (keys->keyPressed(KeyCode::BACKSLASH)) {
+        if (profiler->isCapturing()) {
+            string path = getSaveDirectory() + "trace" + to_string(_traceCount++) + ".json";
+            if (profiler->stopCapture(path)) {
+                CULog("wrote %s", path.c_str());
+            }
+        }
+        else {
+            profiler->startCapture();
+        }
+    }
+
+    // the font is loaded with the other assets
+    if (_showProfiler && _profilerOverlay == nullptr) {
+        _profilerOverlay = ProfilerOverlay::alloc(_assets->get<Font>("gyparody"));
+    }
+    if (_showProfiler && _profilerOverlay != nullptr) {
+        unsigned scale = _gameplay.getLightMapScale();
+        _profilerOverlay->setNote(!_gameplay.isActive() ? "" :
+                                  scale == 0 ? "light map off" : "light map 1/" + to_string(scale));
+        _profilerOverlay->update(timestep);
+    }
 }
 
 /**
@@ -388,19 +516,22 @@ void GhostedApp::buildScene() {
     _assets->attach<Sound>(SoundLoader::alloc()->getHook());
     _assets->attach<scene2::SceneNode>(Scene2Loader::alloc()->getHook());
     _assets->attach<JsonValue>(JsonLoader::alloc()->getHook());
+    _assets->attach<RoomParser>(GenericLoader<RoomParser>::alloc()->getHook());
 
     _loading.init(_assets);
     
     AudioEngine::start(24);
     
     // Queue up the other assets
-    _assets->loadDirectoryAsync("json/assets.json", nullptr);
-    _assets->loadDirectoryAsync("json/start.json", nullptr);
-    _assets->loadDirectoryAsync("json/join.json", nullptr);
-    _assets->loadDirectoryAsync("json/game.json", nullptr);
-    _assets->loadDirectoryAsync("json/lobby.json", nullptr);
-    _assets->loadDirectoryAsync("json/win.json", nullptr);
-    _assets->loadDirectoryAsync("json/info.json", nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/assets.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/start.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/join.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/game.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/lobby.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/win.json"), nullptr);
+    _assets->loadDirectoryAsync(packedDirectory(_assets, "json/info.json"), nullptr);
+    // the room layouts and maps are read once here, not every time a map is generated
+    _assets->loadAsync<RoomParser>(ROOM_CATALOG, ROOM_DIRECTORY, nullptr);
 }
 
 /**
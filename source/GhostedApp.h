@@ -44,6 +44,7 @@
 #include "GameScene.h"
 #include "WinScene.h"
 #include "InfoScene.h"
+#include "ProfilerOverlay.h"
 
 /**
  * Class for the Ghosted application by Star Soup Games.
@@ -93,6 +94,43 @@ protected:
     
     bool _loadKeys;
     bool _resetPressed;
+
+    /** Time not yet simulated, always less than one tick after update */
+    float _accumulator;
+
+    /**
+     * Returns how many fixed simulation ticks are due this frame.
+     *
+     * Adds the frame time to the accumulator and takes whole ticks out of it,
+     * so the game and network run at constants::TICK_RATE whatever the
+     * frame rate is.
+     */
+    unsigned takeTicks(float timestep);
+
+    /** Returns how far the current frame is between two ticks, in [0, 1) */
+    float getTickAlpha() const { return _accumulator * constants::TICK_RATE; }
+
+    /** Frames drawn since the render stats were last reported */
+    unsigned _statFrames;
+
+    /**
+     * Logs the average vertex upload and buffer stall per frame every few
+     * seconds. Only called when built with GHOSTED_RENDER_STATS.
+     */
+    void reportRenderStats();
+
+    /** The profiler overlay, created when it is first shown */
+    shared_ptr<ProfilerOverlay> _profilerOverlay;
+    /** Whether the profiler overlay is shown */
+    bool _showProfiler;
+    /** The number of trace captures written */
+    unsigned _traceCount;
+
+    /**
+     * Handles the profiler keys and refreshes the overlay. Only called when
+     * built with CU_PROFILE.
+     */
+    void updateProfiler(float timestep);
     
     /** 
      * Internal helper to build the scene graph.
@@ -115,7 +153,7 @@ public:
      * of initialization from the constructor allows main.cpp to perform
      * advanced configuration of the application before it starts.
      */
-    GhostedApp() : cugl::Application(), _mode(constants::GameMode::None), _status(constants::MatchStatus::None) {}
+    GhostedApp() : cugl::Application(), _mode(constants::GameMode::None), _status(constants::MatchStatus::None), _accumulator(0) {}
     
     /**
      * Disposes of this application, releasing all resources.
@@ -0,0 +1,137 @@
+//
+//  HeadlessHost.cpp
+//
+//  Entry point for the dedicated host. This is the ghosted-headless target in
+//  build-linux, which builds the game sources with GHOSTED_HEADLESS defined in
+//  place of main.cpp. No window or GL context is created. Nothing here touches
+//  SDL video, audio or the scene graph; the only assets read are the JSON
+//  layouts, so run it from (or point it at) the assets directory.
+//
+//      ghosted-headless [assets dir] [matches] [max ticks] [--realtime]
+//
+//  Every match is stepped once per tick, round-robin, at the fixed tick rate.
+//  Without --realtime the ticks run back to back, which is useful for
+//  measuring how many matches one process can host.
+//
+#ifdef GHOSTED_HEADLESS
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include "GameSimulation.h"
+
+using namespace std;
+using namespace cugl;
+
+/** Ticks between bot changes of direction */
+constexpr unsigned BOT_WANDER_TICKS = 60;
+
+/** Stand-in for a connected player: wanders and presses interact now and then */
+struct Bot {
+    mt19937 rng;
+    Vec2 heading;
+
+    Bot(unsigned seed) : rng(seed) { }
+
+    PlayerInput next(const shared_ptr<Player>& player, unsigned tick) {
+        uniform_real_distribution<float> angle(0, 2 * M_PI);
+        if (tick % BOT_WANDER_TICKS == 0 || player->getVelocity().isNearZero()) {
+            float a = angle(rng);
+            heading = Vec2(cosf(a), sinf(a));
+        }
+
+        PlayerInput input;
+        input.move = heading;
+        input.direction = heading;
+        unsigned odds = player->getType() == constants::PlayerType::Ghost ? 120 : 30;
+        input.interact = uniform_int_distribution<unsigned>(0, odds - 1)(rng) == 0;
+        return input;
+    }
+};
+
+/** One hosted match and the bots playing it */
+struct Match {
+    shared_ptr<GameSimulation> sim;
+    vector<Bot> bots;
+    vector<PlayerInput> inputs;
+};
+
+int main(int argc, char* argv[]) {
+    string assets = argc > 1 ? argv[1] : ".";
+    unsigned count = argc > 2 ? stoi(argv[2]) : 16;
+    unsigned maxTicks = argc > 3 ? stoi(argv[3]) : 60 * 60 * 5;
+    bool realtime = argc > 4 && string(argv[4]) == "--realtime";
+
+    error_code err;
+    filesystem::current_path(assets, err);
+    if (err) {
+        CULogError("Cannot open assets directory %s", assets.c_str());
+        return 1;
+    }
+
+    shared_ptr<AssetManager> none;
+    vector<Match> matches;
+    for (unsigned i = 0; i < count; ++i) {
+        auto map = GameMap::alloc(none);
+        if (map == nullptr || !map->generateRandomMap()) {
+            CULogError("Could not generate a map for match %u", i);
+            return 1;
+        }
+
+        Match match;
+        match.sim = GameSimulation::alloc(map);
+        for (unsigned p = 0; p < match.sim->getPlayers().size(); ++p) {
+            match.bots.emplace_back(i * constants::MAX_PALS + p + 1);
+        }
+        match.inputs.resize(match.bots.size());
+        matches.push_back(move(match));
+    }
+
+    const float timestep = 1.0f / constants::TICK_RATE;
+    const auto tickLength = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(timestep));
+    auto start = chrono::steady_clock::now();
+    auto nextTick = start;
+
+    unsigned running = count;
+    unsigned long steps = 0;
+    for (unsigned tick = 0; running > 0 && tick < maxTicks; ++tick) {
+        running = 0;
+        for (auto& match : matches) {
+            if (match.sim->isOver()) continue;
+            auto& players = match.sim->getPlayers();
+            for (unsigned p = 0; p < players.size(); ++p) {
+                match.inputs[p] = match.bots[p].next(players[p], tick);
+            }
+            match.sim->step(match.inputs, timestep);
+            ++steps;
+            if (!match.sim->isOver()) ++running;
+        }
+
+        if (realtime) {
+            nextTick += tickLength;
+            this_thread::sleep_until(nextTick);
+        }
+    }
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    unsigned pals = 0, ghosts = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        auto& sim = matches[i].sim;
+        const char* result = "unfinished";
+        if (sim->getWinner() == constants::PlayerType::Pal) {
+            result = "pals";
+            ++pals;
+        }
+        else if (sim->getWinner() == constants::PlayerType::Ghost) {
+            result = "ghost";
+            ++ghosts;
+        }
+        CULog("match %u: %s after %u ticks", i, result, sim->getTicks());
+    }
+    CULog("%u matches, %u pal wins, %u ghost wins, %u unfinished", count, pals, ghosts, count - pals - ghosts);
+    CULog("%lu match ticks in %.2fs (%.0f ticks/s)", steps, elapsed, elapsed > 0 ? steps / elapsed : 0.0);
+    return 0;
+}
+
+#endif /** GHOSTED_HEADLESS */
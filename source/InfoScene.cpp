@@ -10,7 +10,7 @@ bool InfoScene::init(const shared_ptr<AssetManager>& assets, constants::GameMode
     if (_back == nullptr) {
         return false;
     }
-    _back->addListener([=](const string& name, bool down) {
+    _back->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = prev;
         }
@@ -20,7 +20,7 @@ bool InfoScene::init(const shared_ptr<AssetManager>& assets, constants::GameMode
     if (_pal == nullptr) {
         return false;
     }
-    _pal->addListener([=](const string& name, bool down) {
+    _pal->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             assets->get<scene2::SceneNode>("info_ghostgameplay")->setVisible(false);
             assets->get<scene2::SceneNode>("info_palsgameplay")->setVisible(true);
@@ -31,7 +31,7 @@ bool InfoScene::init(const shared_ptr<AssetManager>& assets, constants::GameMode
     if (_ghost == nullptr) {
         return false;
     }
-    _ghost->addListener([=](const string& name, bool down) {
+    _ghost->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             assets->get<scene2::SceneNode>("info_ghostgameplay")->setVisible(true);
             assets->get<scene2::SceneNode>("info_palsgameplay")->setVisible(false);
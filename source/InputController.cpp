@@ -35,6 +35,7 @@ _keyInteract(false),
 _spaceReleased(true),
 _resetPressed(false),
 _escapePressed(false),
+_lightMapPressed(false),
 _ljoystick(false),
 _rjoystick(false)
 {}
@@ -97,7 +98,7 @@ bool InputController::init(const Rect bounds) {
  * the OS, we may see multiple updates of the same touch in a single animation
  * frame, so we need to accumulate all of the data together.
  */
-void InputController::update(float dt) {
+void InputController::update(float /*dt*/) {
 #ifndef CU_TOUCH_SCREEN
     // DESKTOP CONTROLS
     Keyboard* keys = Input::get<Keyboard>();
@@ -122,6 +123,7 @@ void InputController::update(float dt) {
     
     _resetPressed = keys->keyDown(KeyCode::R);
     _escapePressed = keys->keyDown(KeyCode::ESCAPE);
+    _lightMapPressed = keys->keyPressed(KeyCode::L);
     
     _movement = Vec2::ZERO;
     _direction = Vec2::ZERO;
@@ -156,7 +158,7 @@ void InputController::update(float dt) {
     }
     
     //INTERACTIONS (BATTERIES/TRAPS)
-    _interact = false;
+    // _interact stays set until taken, so a press between simulation ticks is not lost
     if (_keyInteract && _spaceReleased) {
         _interact = true;
         _spaceReleased = false;
@@ -164,7 +166,6 @@ void InputController::update(float dt) {
     }
 #else
     //INTERACTIONS (BATTERIES/TRAPS)
-    _interact = false;
     if (_keyInteract) {
         _interact = true;
         _keyInteract = false;
@@ -243,12 +244,12 @@ void InputController::readLeft(const cugl::Vec2 pos) {
     Vec2 diff =  _ltouch.position-pos;
     
     
-    if (std::fabsf(diff.y) > JSTICK_DEADZONE/3 || std::fabsf(diff.x) > JSTICK_DEADZONE) {
+    if (std::fabs(diff.y) > JSTICK_DEADZONE/3 || std::fabs(diff.x) > JSTICK_DEADZONE) {
         _ljoystick = true;
         
         // return as movement vector (x,y) normalize in move in PLAYER
         if (_movement != Vec2::ZERO) {
-            if (std::fabsf(diff.length()) > 25) {
+            if (std::fabs(diff.length()) > 25) {
                 _ljoycenter = this->touch2Screen(_ltouch.position);
                 _movement = Vec2(pos.x-_ltouch.position.x, _ltouch.position.y-pos.y);
             } else {
@@ -274,7 +275,7 @@ void InputController::readLeft(const cugl::Vec2 pos) {
  * @param  stop     the end position of the candidate swipe
  * @param  current  the current timestamp of the gesture
  */
-void InputController::readRight(const Vec2 start, const Vec2 stop, Timestamp current) {
+void InputController::readRight(const Vec2 /*start*/, const Vec2 stop, Timestamp /*current*/) {
     // Look for swipes up that are "long enough"
     Vec2 diff = _rtouch.position-stop;
 //
@@ -288,12 +289,12 @@ void InputController::readRight(const Vec2 start, const Vec2 stop, Timestamp cur
     _rjoycenter = this->touch2Screen(_rtouch.position);
     _rjoycenter.y += JSTICK_OFFSET;
     
-    if (std::fabsf(diff.y) > JSTICK_DEADZONE || std::fabsf(diff.x) > JSTICK_DEADZONE) {
+    if (std::fabs(diff.y) > JSTICK_DEADZONE || std::fabs(diff.x) > JSTICK_DEADZONE) {
         _rjoystick = true;
         
         // return as movement vector (x,y) normalize in move in PLAYER
         if (_direction != Vec2::ZERO) {
-            if (std::fabsf(diff.length()) > 25) {
+            if (std::fabs(diff.length()) > 25) {
                 _direction = Vec2(stop.x-_rtouch.position.x, _rtouch.position.y-stop.y);
             }
         } else {
@@ -313,7 +314,7 @@ void InputController::readRight(const Vec2 start, const Vec2 stop, Timestamp cur
  * @param event The associated event
  * @param focus    Whether the listener currently has focus
  */
-void InputController::touchBeganCB(const TouchEvent& event, bool focus) {
+void InputController::touchBeganCB(const TouchEvent& event, bool /*focus*/) {
     //CULog("Touch began %lld", event.touch);
     Vec2 pos = event.position;
     Zone zone = getZone(pos);
@@ -359,7 +360,7 @@ void InputController::touchBeganCB(const TouchEvent& event, bool focus) {
  * @param event The associated event
  * @param focus    Whether the listener currently has focus
  */
-void InputController::touchEndedCB(const TouchEvent& event, bool focus) {
+void InputController::touchEndedCB(const TouchEvent& event, bool /*focus*/) {
     // Reset all keys that might have been set
     if (_ltouch.touchids.find(event.touch) != _ltouch.touchids.end()) {
         _ltouch.touchids.clear();
@@ -384,7 +385,7 @@ void InputController::touchEndedCB(const TouchEvent& event, bool focus) {
  * @param previous The previous position of the touch
  * @param focus    Whether the listener currently has focus
  */
-void InputController::touchesMovedCB(const TouchEvent& event, const Vec2& previous, bool focus) {
+void InputController::touchesMovedCB(const TouchEvent& event, const Vec2& previous, bool /*focus*/) {
     Vec2 pos = event.position;
     if (_ltouch.touchids.find(event.touch) != _ltouch.touchids.end()) {
         readLeft(pos);
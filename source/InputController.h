@@ -30,6 +30,9 @@ private:
     
     bool _escapePressed;
     
+    /** Whether the light map key was pressed this frame (DESKTOP ONLY) */
+    bool _lightMapPressed;
+    
 protected:
     // The screen is divided into four zones: Left, Bottom, Right and Main/
     // These are all shown in the diagram below.
@@ -138,6 +141,18 @@ public:
     bool getInteraction() const {
         return _interact;
     }
+
+    /**
+     * Returns whether interact was pressed since the last call, and clears it.
+     *
+     * Presses are held until taken, so the game sees each press exactly once
+     * no matter how many simulation ticks run in a frame.
+     */
+    bool takeInteraction() {
+        bool result = _interact;
+        _interact = false;
+        return result;
+    }
     
     bool getReset() const {
         return _resetPressed;
@@ -147,6 +162,11 @@ public:
         return _escapePressed;
     }
     
+    /** Returns whether the light map mode should change (DESKTOP ONLY) */
+    bool getLightMapToggle() const {
+        return _lightMapPressed;
+    }
+    
     bool withJoystick() { return _rjoystick || _ljoystick; };
     
     cugl::Vec2 getRJoystick() const {
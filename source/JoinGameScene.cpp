@@ -21,7 +21,7 @@ bool JoinGameScene::init(const shared_ptr<AssetManager>& assets) {
     if (_next == nullptr) {
         return false;
     }
-    _next->addListener([=](const string& name, bool down) {
+    _next->addListener([=](const string& /*name*/, bool down) {
         if (!down && _roomID != "") {
             _mode = constants::GameMode::Lobby;
         }
@@ -31,7 +31,7 @@ bool JoinGameScene::init(const shared_ptr<AssetManager>& assets) {
     if (_back == nullptr) {
         return false;
     }
-    _back->addListener([=](const string& name, bool down) {
+    _back->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::Start;
         }
@@ -42,7 +42,7 @@ bool JoinGameScene::init(const shared_ptr<AssetManager>& assets) {
         return false;
     }
     _roomID = "";
-    _field->addExitListener([=](const string& name, const string& value) {
+    _field->addExitListener([=](const string& /*name*/, const string& value) {
         if (utils::isNumeric(value)) {
             _roomID = value;
         }
@@ -0,0 +1,146 @@
+//
+//  JsonBench.cpp
+//
+//  Entry point for the JSON benchmark. This is the ghosted-jsonbench target in
+//  build-linux, which builds the game sources with GHOSTED_JSON_BENCH defined
+//  in place of main.cpp. No window or GL context is created.
+//
+//      ghosted-jsonbench <assets dir> [--iterations N]
+//
+//  Every file under json/ is read once, then parsed and walked repeatedly with
+//  both JsonValue (cJSON) and JsonDocument. The walk looks up every member of
+//  every object by key, the way RoomParser and the scene loaders do.
+//
+#ifdef GHOSTED_JSON_BENCH
+
+#include <cugl/cugl.h>
+
+using namespace std;
+using namespace cugl;
+
+/** Adds every JSON file under the given directory, recursively */
+static void findJson(const string& directory, vector<string>& files) {
+    for (auto& file : filetool::dir_contents(directory)) {
+        if (filetool::is_dir(file)) {
+            findJson(file, files);
+        }
+        else if (file.size() > 5 && file.compare(file.size() - 5, 5, ".json") == 0) {
+            files.push_back(file);
+        }
+    }
+}
+
+/** Returns the contents of a file, or the empty string if it cannot be read */
+static string readText(const string& file) {
+    string text;
+    SDL_RWops* source = SDL_RWFromFile(file.c_str(), "rb");
+    if (source == nullptr) return text;
+    Sint64 size = SDL_RWsize(source);
+    if (size > 0) {
+        text.resize((size_t)size);
+        text.resize(SDL_RWread(source, &text[0], 1, (size_t)size));
+    }
+    SDL_RWclose(source);
+    return text;
+}
+
+/** Looks up every object member by key, returning the number of nodes visited */
+static size_t walk(const shared_ptr<JsonValue>& value) {
+    size_t count = 1;
+    for (int i = 0; i < (int)value->size(); ++i) {
+        auto child = value->get(i);
+        if (value->isObject()) {
+            child = value->get(child->key());
+        }
+        count += walk(child);
+    }
+    return count;
+}
+
+/** Looks up every object member by key, returning the number of nodes visited */
+static size_t walk(const JsonDocument::Node& node) {
+    size_t count = 1;
+    for (size_t i = 0; i < node.size(); ++i) {
+        auto child = node.get(i);
+        if (node.isObject()) {
+            child = node.get(child.key());
+        }
+        count += walk(child);
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        CULogError("usage: %s <assets dir> [--iterations N]", argv[0]);
+        return 1;
+    }
+
+    string assets = argv[1];
+    if (assets.back() != '/') assets += '/';
+
+    int iterations = 100;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = max(1, stoi(argv[++i]));
+        }
+    }
+
+    vector<string> files;
+    findJson(assets + "json", files);
+    vector<string> texts;
+    size_t bytes = 0;
+    for (auto& file : files) {
+        texts.push_back(readText(file));
+        bytes += texts.back().size();
+    }
+    if (texts.empty()) {
+        CULogError("No JSON files under %sjson", assets.c_str());
+        return 1;
+    }
+
+    // Each DOM gets its own passes, so that neither evicts the other from the cache
+    Uint64 valueParse = 0, valueWalk = 0, docParse = 0, docWalk = 0;
+    size_t valueNodes = 0, docNodes = 0, docMemory = 0;
+    for (int n = 0; n < iterations; ++n) {
+        for (auto& text : texts) {
+            Timestamp start;
+            auto value = JsonValue::allocWithJson(text);
+            Timestamp parsed;
+            size_t nodes = value == nullptr ? 0 : walk(value);
+            Timestamp walked;
+            valueParse += Timestamp::ellapsedMicros(start, parsed);
+            valueWalk += Timestamp::ellapsedMicros(parsed, walked);
+            if (n == 0) valueNodes += nodes;
+        }
+    }
+    for (int n = 0; n < iterations; ++n) {
+        for (auto& text : texts) {
+            Timestamp start;
+            auto doc = JsonDocument::alloc(text);
+            Timestamp parsed;
+            size_t nodes = doc == nullptr ? 0 : walk(doc->root());
+            Timestamp walked;
+            docParse += Timestamp::ellapsedMicros(start, parsed);
+            docWalk += Timestamp::ellapsedMicros(parsed, walked);
+            if (n == 0) {
+                docNodes += nodes;
+                docMemory += doc == nullptr ? 0 : doc->memoryUsage();
+            }
+        }
+    }
+
+    CULog("%zu files, %zu bytes, %d iterations", files.size(), bytes, iterations);
+    CULog("JsonValue:    %zu nodes, parse %.1f us, walk %.1f us per pass",
+          valueNodes, (double)valueParse / iterations, (double)valueWalk / iterations);
+    CULog("JsonDocument: %zu nodes, parse %.1f us, walk %.1f us per pass, %zu bytes",
+          docNodes, (double)docParse / iterations, (double)docWalk / iterations, docMemory);
+    if (valueNodes != docNodes) {
+        CULogError("The DOMs disagree on the number of nodes");
+        return 1;
+    }
+    return 0;
+}
+
+#endif /** GHOSTED_JSON_BENCH */
@@ -0,0 +1,130 @@
+#include "LightGrid.h"
+
+using namespace std;
+using namespace cugl;
+
+void LightGrid::addPoint(const Vec2& pos, float radius) {
+    // every direction passes a cone whose cosines are below -1
+    _lights.push_back({ pos, radius, Vec2::ZERO, -2.0f, -1.0f });
+}
+
+void LightGrid::addCone(const Vec2& pos, float radius, const Vec2& dir, float inner, float outer) {
+    Vec2 unit = dir.isZero() ? Vec2::UNIT_X : dir.getNormalization();
+    _lights.push_back({ pos, radius, unit, cosf(outer), cosf(inner) });
+}
+
+/** Returns whether a circle reaches a rectangle */
+static bool reaches(const Rect& rect, const Vec2& center, float radius) {
+    float dx = center.x - clampf(center.x, rect.getMinX(), rect.getMaxX());
+    float dy = center.y - clampf(center.y, rect.getMinY(), rect.getMaxY());
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+void LightGrid::build(const Rect& view) {
+    _view = view;
+    _shape.clear();
+    _cone.clear();
+    _index.clear();
+    _tiles.assign(2 * constants::LIGHT_TILES * constants::LIGHT_TILES, 0);
+
+    bool dropped = false;
+    for (auto& light : _lights) {
+        if (!reaches(view, light.pos, light.radius)) continue;
+        if (_shape.size() / 4 == constants::MAX_LIGHTS) {
+            dropped = true;
+            break;
+        }
+        _shape.insert(_shape.end(), { light.pos.x, light.pos.y, light.radius * light.radius, 0.0f });
+        _cone.insert(_cone.end(), { light.dir.x, light.dir.y, light.cosOuter, light.cosInner });
+    }
+    if (dropped && !_lightsFull) {
+        CUWarn("More than %u lights in view", constants::MAX_LIGHTS);
+    }
+    _lightsFull = dropped;
+
+    GLint visible = (GLint)getVisibleCount();
+    float width = view.size.width / constants::LIGHT_TILES;
+    float height = view.size.height / constants::LIGHT_TILES;
+    bool full = false;
+    for (unsigned ty = 0; ty < constants::LIGHT_TILES; ++ty) {
+        for (unsigned tx = 0; tx < constants::LIGHT_TILES; ++tx) {
+            Rect tile(view.origin.x + tx * width, view.origin.y + ty * height, width, height);
+            unsigned t = ty * constants::LIGHT_TILES + tx;
+            _tiles[2 * t] = (GLint)_index.size();
+            for (GLint i = 0; i < visible; ++i) {
+                Vec2 pos(_shape[4 * i], _shape[4 * i + 1]);
+                if (!reaches(tile, pos, sqrtf(_shape[4 * i + 2]))) continue;
+                if (_index.size() == constants::MAX_LIGHT_INDICES) {
+                    full = true;
+                    break;
+                }
+                _index.push_back(i);
+            }
+            _tiles[2 * t + 1] = (GLint)_index.size() - _tiles[2 * t];
+        }
+    }
+    if (full && !_indexFull) {
+        CUWarn("More than %u tile lights in view", constants::MAX_LIGHT_INDICES);
+    }
+    _indexFull = full;
+
+    // the shader reads indices four at a time
+    while (_index.size() % 4 != 0) {
+        _index.push_back(0);
+    }
+}
+
+void LightGrid::upload(const shared_ptr<Shader>& shader) const {
+    GLsizei visible = (GLsizei)getVisibleCount();
+    shader->setUniform4fv(shader->getUniformLocation("uLights"), visible, _shape.data());
+    shader->setUniform4fv(shader->getUniformLocation("uLightCones"), visible, _cone.data());
+    shader->setUniform4iv(shader->getUniformLocation("uLightIndex"), (GLsizei)_index.size() / 4, _index.data());
+    shader->setUniform2iv(shader->getUniformLocation("uTiles"), (GLsizei)_tiles.size() / 2, _tiles.data());
+    shader->setUniform2f(shader->getUniformLocation("uTileOrigin"), _view.origin.x, _view.origin.y);
+    shader->setUniform2f(shader->getUniformLocation("uTileSize"),
+                         _view.size.width / constants::LIGHT_TILES, _view.size.height / constants::LIGHT_TILES);
+}
+
+/** Adds a vertex with the given position and brightness */
+static void addVertex(Mesh<SpriteVertex3>& mesh, const Vec2& pos, float light) {
+    SpriteVertex3 vert;
+    vert.position = Vec3(pos.x, pos.y, 0);
+    vert.color = Vec4(light, light, light, light);
+    mesh.vertices.push_back(vert);
+}
+
+void LightGrid::buildMask(Mesh<SpriteVertex3>& mesh) const {
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.command = GL_TRIANGLES;
+
+    for (auto& light : _lights) {
+        if (!reaches(_view, light.pos, light.radius)) continue;
+
+        // a round light is a full turn whose edges are fully lit
+        bool round = light.cosOuter < -1;
+        float outer = round ? M_PI : acosf(light.cosOuter);
+        float inner = round ? M_PI : acosf(light.cosInner);
+        float facing = atan2f(light.dir.y, light.dir.x);
+        int steps = round ? constants::LIGHT_MAP_SEGMENTS
+                          : max(2, (int)ceilf(constants::LIGHT_MAP_SEGMENTS * outer / M_PI));
+        float soft = light.radius * (1 - constants::LIGHT_MAP_FEATHER);
+
+        // center, then a lit and a dark vertex along each spoke
+        GLuint center = (GLuint)mesh.vertices.size();
+        addVertex(mesh, light.pos, 1);
+        for (int i = 0; i <= steps; ++i) {
+            float offset = -outer + 2 * outer * i / steps;
+            float edge = 1 - clampf((fabsf(offset) - inner) / max(outer - inner, 0.001f), 0, 1);
+            if (!round && (i == 0 || i == steps)) edge = 0;
+            Vec2 spoke(cosf(facing + offset), sinf(facing + offset));
+            addVertex(mesh, light.pos + spoke * soft, edge);
+            addVertex(mesh, light.pos + spoke * light.radius, 0);
+        }
+        for (int i = 0; i < steps; ++i) {
+            GLuint a = center + 1 + 2 * i;
+            GLuint b = a + 2;
+            mesh.indices.insert(mesh.indices.end(), { center, a, b, a, a + 1, b + 1, a, b + 1, b });
+        }
+    }
+}
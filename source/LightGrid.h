@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef __LIGHT_GRID_H__
+#define __LIGHT_GRID_H__
+#include <cugl/cugl.h>
+#include "Constants.h"
+
+using namespace std;
+using namespace cugl;
+
+/**
+ * Screen tiled light lists for the light shader.
+ *
+ * Lights are gathered every frame, culled against the view, and binned into
+ * a LIGHT_TILES x LIGHT_TILES grid over it. The shader finds the tile of a
+ * fragment and only tests the lights listed for that tile, so the cost of a
+ * fragment depends on the lights near it rather than on the size of the map.
+ *
+ * Cones are sent as a direction and the cosines of their inner and outer
+ * half angles, so the shader compares a dot product instead of taking an
+ * arctangent. A round light is a cone that accepts every direction.
+ */
+class LightGrid {
+private:
+    struct Light {
+        Vec2 pos;
+        float radius;
+        Vec2 dir;
+        float cosOuter;
+        float cosInner;
+    };
+
+    /** Every light added since the last clear */
+    vector<Light> _lights;
+
+    /** The lights that reach the view, packed as uniforms */
+    vector<float> _shape;
+    vector<float> _cone;
+
+    /** Light indices grouped by tile, and (start, count) of each tile */
+    vector<GLint> _index;
+    vector<GLint> _tiles;
+
+    /** The area covered by the tiles */
+    Rect _view;
+
+    /** Whether the last build dropped lights or tile entries (so we warn once) */
+    bool _lightsFull = false;
+    bool _indexFull = false;
+
+public:
+    /** Removes every light */
+    void clear() { _lights.clear(); }
+
+    /** Adds a light that shines in every direction */
+    void addPoint(const Vec2& pos, float radius);
+
+    /**
+     * Adds a light that shines in a cone.
+     *
+     * @param dir       The direction of the cone (need not be normalized)
+     * @param inner     The half angle, in radians, that is fully lit
+     * @param outer     The half angle, in radians, past which nothing is lit
+     */
+    void addCone(const Vec2& pos, float radius, const Vec2& dir, float inner, float outer);
+
+    /**
+     * Culls the lights against the view and bins them into tiles.
+     *
+     * Lights past constants::MAX_LIGHTS, and tile entries past
+     * constants::MAX_LIGHT_INDICES, are dropped. We warn when a cap is
+     * first exceeded, not on every frame that it stays exceeded.
+     *
+     * @param view  The visible area, in drawing coordinates
+     */
+    void build(const Rect& view);
+
+    /** Sends the result of the last build to the bound light shader */
+    void upload(const shared_ptr<Shader>& shader) const;
+
+    /**
+     * Builds a mesh of the lights that reach the view, for a light map.
+     *
+     * Each light is a fan whose vertex alpha is 1 where it is fully lit and
+     * falls to 0 over the last constants::LIGHT_MAP_FEATHER of its radius
+     * and between the inner and outer angles of a cone. The mesh is meant to
+     * be drawn untextured with additive blending.
+     *
+     * @param mesh  The mesh to fill (any previous contents are removed)
+     */
+    void buildMask(Mesh<SpriteVertex3>& mesh) const;
+
+    /** Returns the number of lights that reached the view in the last build */
+    size_t getVisibleCount() const { return _shape.size() / 4; }
+};
+
+#endif /** __LIGHT_GRID_H__ */
@@ -47,7 +47,7 @@ bool LoadingScene::init(const std::shared_ptr<AssetManager>& assets) {
     _bar = std::dynamic_pointer_cast<scene2::ProgressBar>(assets->get<scene2::SceneNode>("load_bar"));
     _brand = assets->get<scene2::SceneNode>("load_name");
     _button = std::dynamic_pointer_cast<scene2::Button>(assets->get<scene2::SceneNode>("load_play"));
-    _button->addListener([=](const std::string& name, bool down) {
+    _button->addListener([=](const std::string& /*name*/, bool down) {
         this->_active = down;
         });
     Application::get()->setClearColor(Color4(192, 192, 192, 255));
@@ -79,7 +79,7 @@ void LoadingScene::dispose() {
  *
  * @param timestep  The amount of time (in seconds) since the last frame
  */
-void LoadingScene::update(float progress) {
+void LoadingScene::update(float /*progress*/) {
     if (_progress < 1) {
         _progress = _assets->progress();
         if (_progress >= 1) {
@@ -15,13 +15,15 @@ using namespace cugl;
  * @return true if the controller is initialized properly, false otherwise.
  */
 bool LobbyScene::init(const shared_ptr<AssetManager>& assets) {
-    GameMode::init(assets, constants::GameMode::Lobby, "lobby");
+    if (!GameMode::init(assets, constants::GameMode::Lobby, "lobby")) {
+        return false;
+    }
     
     _start = dynamic_pointer_cast<scene2::Button>(_assets->get<scene2::SceneNode>("lobby_startgame"));
     if (_start == nullptr) {
         return false;
     }
-    _start->addListener([=](const string& name, bool down) {
+    _start->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::Game;
         }
@@ -31,7 +33,7 @@ bool LobbyScene::init(const shared_ptr<AssetManager>& assets) {
     if (_escape == nullptr) {
         return false;
     }
-    _escape->addListener([=](const string& name, bool down) {
+    _escape->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::Start;
         }
@@ -40,15 +42,19 @@ bool LobbyScene::init(const shared_ptr<AssetManager>& assets) {
     _numPlayers = 0;
 
     _gameMap = GameMap::alloc(_assets);
+    if (_gameMap == nullptr) {
+        return false;
+    }
 
     _host = _roomID == "";
     if (_host) {
+        if (!_gameMap->generateRandomMap()) {
+            return false;
+        }
         _network->connect();
-        _gameMap->generateRandomMap();
     }
     else {
         _network->connect(_roomID);
-        _gameMap->generateRandomMap();
 
         Size dimen = Application::get()->getDisplaySize();
         dimen *= constants::SCENE_WIDTH / dimen.width;
@@ -70,7 +76,7 @@ bool LobbyScene::init(const shared_ptr<AssetManager>& assets) {
  *
  * @param timestep  The amount of time (in seconds) since the last frame
  */
-void LobbyScene::update(float timestep) {
+void LobbyScene::update(float /*timestep*/) {
     Size dimen = Application::get()->getDisplaySize();
     dimen *= constants::SCENE_WIDTH / dimen.width;
 
@@ -109,10 +115,11 @@ void LobbyScene::update(float timestep) {
     if (_network != nullptr) {
         auto networkData = _network->getData();
         if (networkData != nullptr) {
-            if (_network->isConnected() && networkData->getStatus() == constants::MatchStatus::InProgress) {
+            networkData->setGameMap(_gameMap);
+            // clients wait for the host's map layout before starting
+            if (_network->isConnected() && networkData->getStatus() == constants::MatchStatus::InProgress && networkData->hasMapLayout()) {
                 _mode = constants::GameMode::Game;
             }
-            networkData->setGameMap(_gameMap);
         }
 
         switch (_network->getStatus()) {
@@ -148,8 +155,10 @@ void LobbyScene::dispose() {
     _start = nullptr;
     _escape = nullptr;
 
-    _root->removeChildByName("roomIDText");
-    _root->removeChildByName("numPlayers");
+    if (_root != nullptr) {
+        _root->removeChildByName("roomIDText");
+        _root->removeChildByName("numPlayers");
+    }
     GameMode::dispose();
 }
 
@@ -163,10 +172,10 @@ void LobbyScene::setActive(bool value) {
     if (value) {
     }
     else {
-        if (_start->isActive()) {
+        if (_start != nullptr && _start->isActive()) {
             _start->deactivate();
         }
-        if (_escape->isActive()) {
+        if (_escape != nullptr && _escape->isActive()) {
             _escape->deactivate();
         }
     }
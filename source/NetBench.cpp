@@ -0,0 +1,410 @@
+//
+//  NetBench.cpp
+//
+//  Entry point for the network serialization benchmark. This is the
+//  ghosted-netbench target in build-linux, which builds the game sources with
+//  GHOSTED_NET_BENCH defined in place of main.cpp. No window or GL context is
+//  created.
+//
+//      ghosted-netbench [assets dir] [--frames N]
+//
+//  A host and a client exchange in-progress state on a generated map every
+//  frame, once through NetworkData and once through a copy of the old
+//  encode/split wire code it replaced. Heap allocations are counted by
+//  replacing the global operator new.
+//
+//  Before measuring, it checks that a client rejects a map layout with a
+//  forged battery count, and exits with an error if not. This runs as the
+//  netbench test in build-linux.
+//
+#ifdef GHOSTED_NET_BENCH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <new>
+#include "GameSimulation.h"
+#include "NetworkData.h"
+
+using namespace std;
+using namespace cugl;
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+/** Number of heap allocations made so far */
+static atomic<size_t> allocations(0);
+/** Largest single allocation allowed, so a runaway decode fails fast */
+static atomic<size_t> allocationLimit(SIZE_MAX);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (size > allocationLimit.load(memory_order_relaxed)) throw bad_alloc();
+    void* result = malloc(size == 0 ? 1 : size);
+    if (result == nullptr) throw bad_alloc();
+    return result;
+}
+
+// GCC checks inlined calls of these against the new they pair with, and
+// mistakes the free below for a mismatch
+NOINLINE void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+NOINLINE void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+/**
+ * The wire code NetworkData used before the Writer and Reader cursors.
+ *
+ * Every field is encoded into a fresh vector and every message is decoded
+ * by splitting it into more vectors. Kept here only to measure against.
+ */
+namespace Legacy {
+    vector<vector<uint8_t>> split(const vector<uint8_t>& bytes, const vector<unsigned>& sizes) {
+        size_t index = 0;
+        for (auto& size : sizes) index += size;
+        vector<vector<uint8_t>> result;
+        if (bytes.size() < index) return result;
+        index = 0;
+        for (auto& size : sizes) {
+            result.push_back(vector<uint8_t>(bytes.begin() + index, bytes.begin() + index + size));
+            index += size;
+        }
+        if (index != bytes.size()) {
+            result.push_back(vector<uint8_t>(bytes.begin() + index, bytes.end()));
+        }
+        return result;
+    }
+
+    void encodeByte(uint8_t b, vector<uint8_t>& out) { out.push_back(b); }
+    void encodeBool(bool b, vector<uint8_t>& out) { out.push_back(b); }
+
+    void encodeInt(int i, vector<uint8_t>& out) {
+        int temp = marshall(i);
+        unsigned char bytes[4];
+        bytes[0] = (temp >> 24) & 0xFF;
+        bytes[1] = (temp >> 16) & 0xFF;
+        bytes[2] = (temp >> 8) & 0xFF;
+        bytes[3] = temp & 0xFF;
+        out.insert(out.end(), begin(bytes), end(bytes));
+    }
+
+    void encodeFloat(float f, vector<uint8_t>& out) { encodeInt(static_cast<int>(f * FLOAT_PRECISION), out); }
+
+    void encodeVector(const Vec2& v, vector<uint8_t>& out) {
+        encodeFloat(v.x, out);
+        encodeFloat(v.y, out);
+    }
+
+    void encodeBoolList(const vector<bool>& list, vector<uint8_t>& out) {
+        encodeInt((int)list.size(), out);
+        for (auto element : list) encodeBool(element, out);
+    }
+
+    void encodeVec2List(const vector<Vec2>& list, vector<uint8_t>& out) {
+        encodeInt((int)list.size(), out);
+        for (auto& element : list) encodeVector(element, out);
+    }
+
+    uint8_t decodeByte(const vector<uint8_t>& bytes) { return bytes[0]; }
+    bool decodeBool(const vector<uint8_t>& bytes) { return (bool)bytes[0]; }
+
+    int decodeInt(const vector<uint8_t>& bytes) {
+        int32_t i = (bytes[0] << 24) + (bytes[1] << 16) + (bytes[2] << 8) + bytes[3];
+        return marshall(i);
+    }
+
+    float decodeFloat(const vector<uint8_t>& bytes) { return static_cast<float>(decodeInt(bytes)) / FLOAT_PRECISION; }
+
+    Vec2 decodeVector(const vector<uint8_t>& bytes) {
+        auto splitBytes = split(bytes, { 4, 4 });
+        return Vec2(decodeFloat(splitBytes[0]), decodeFloat(splitBytes[1]));
+    }
+
+    vector<bool> decodeBoolList(const vector<uint8_t>& bytes) {
+        vector<vector<uint8_t>> subdividedList;
+        for (unsigned i = 0; i < bytes.size(); i += 1) {
+            subdividedList.push_back(vector<uint8_t>(bytes.begin() + i, bytes.begin() + i + 1));
+        }
+        vector<bool> result;
+        for (auto& encodedBool : subdividedList) result.push_back(decodeBool(encodedBool));
+        return result;
+    }
+
+    vector<Vec2> decodeVec2List(const vector<uint8_t>& bytes) {
+        vector<vector<uint8_t>> subdividedList;
+        for (unsigned i = 0; i + 8 <= bytes.size(); i += 8) {
+            subdividedList.push_back(vector<uint8_t>(bytes.begin() + i, bytes.begin() + i + 8));
+        }
+        vector<Vec2> result;
+        for (auto& encodedVec2 : subdividedList) result.push_back(decodeVector(encodedVec2));
+        return result;
+    }
+
+    /** The old in-progress message: metadata, player block and map block */
+    vector<uint8_t> serialize(int id, int hostID, const vector<shared_ptr<Player>>& players, const shared_ptr<GameMap>& map) {
+        vector<uint8_t> result;
+
+        vector<uint8_t> metadata;
+        encodeByte(constants::MatchStatus::InProgress, metadata);
+        encodeInt(id, metadata);
+        result.insert(result.end(), metadata.begin(), metadata.end());
+
+        vector<uint8_t> playerData;
+        auto player = players[id];
+        if (player->getType() == constants::PlayerType::Pal) {
+            encodeInt(dynamic_pointer_cast<Pal>(player)->getBatteries(), playerData);
+        }
+        else {
+            encodeInt(dynamic_pointer_cast<Ghost>(player)->getTraps(), playerData);
+        }
+        encodeVector(player->getLoc(), playerData);
+        encodeVector(player->getDir(), playerData);
+        for (auto& target : players) {
+            if (target->getType() == constants::PlayerType::Pal) {
+                encodeBool(dynamic_pointer_cast<Pal>(target)->getSpooked(), playerData);
+            }
+            else {
+                encodeBool(dynamic_pointer_cast<Ghost>(target)->getTagged(), playerData);
+            }
+        }
+        result.insert(result.end(), playerData.begin(), playerData.end());
+
+        vector<uint8_t> mapData;
+        if (id == hostID) {
+            vector<Vec2> trapPositions;
+            vector<bool> trapTriggered;
+            for (auto& trap : map->getTraps()) {
+                trapPositions.push_back(trap->getLoc());
+                trapTriggered.push_back(trap->getTriggered());
+            }
+            encodeVec2List(trapPositions, mapData);
+            encodeBoolList(trapTriggered, mapData);
+        }
+        vector<bool> roomsLit;
+        for (auto& room : map->getRooms()) {
+            roomsLit.push_back(room->getLight());
+        }
+        encodeBoolList(roomsLit, mapData);
+        if (id != hostID) encodeInt(map->getTeleCount(), mapData);
+        result.insert(result.end(), mapData.begin(), mapData.end());
+
+        return result;
+    }
+
+    /** Decodes an old in-progress message, applying the traps to the map */
+    void unserialize(int hostID, const vector<uint8_t>& msg, const shared_ptr<GameMap>& map, vector<Vec2>& locations) {
+        auto splitMsg = split(msg, { 5 });
+        if (splitMsg.size() < 2) return;
+        auto splitMetadata = split(splitMsg[0], { 1, 4 });
+        decodeByte(splitMetadata[0]);
+        int id = decodeInt(splitMetadata[1]);
+
+        splitMsg = split(splitMsg[1], { 24 });
+        if (splitMsg.size() < 2) return;
+        auto splitPlayer = split(splitMsg[0], { 4, 8, 8, 4 });
+        decodeInt(splitPlayer[0]);
+        locations[id] = decodeVector(splitPlayer[1]);
+        decodeVector(splitPlayer[2]);
+        for (auto& flag : split(splitPlayer[3], { 1, 1, 1, 1 })) decodeBool(flag);
+
+        if (id == hostID) {
+            splitMsg = split(splitMsg[1], { 4 });
+            unsigned numTraps = decodeInt(splitMsg[0]);
+            splitMsg = split(splitMsg[1], { numTraps * 8 });
+            map->setTraps(decodeVec2List(splitMsg[0]));
+            splitMsg = split(splitMsg[1], { 4, numTraps });
+            decodeBoolList(splitMsg[1]);
+            splitMsg = split(splitMsg[2], { 4 });
+        }
+        else {
+            splitMsg = split(splitMsg[1], { 4 });
+        }
+        unsigned numRooms = decodeInt(splitMsg[0]);
+        splitMsg = split(splitMsg[1], { numRooms });
+        decodeBoolList(splitMsg[0]);
+        if (splitMsg.size() > 1) decodeInt(split(splitMsg[1], { 4 })[0]);
+    }
+}
+
+/** Totals for one serialization path */
+struct Result {
+    size_t allocations = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+
+    void report(const char* name, unsigned frames) const {
+        CULog("%s %.1f allocations, %.1f bytes, %.2f us per frame", name,
+              (double)allocations / frames, (double)bytes / frames, seconds * 1e6 / frames);
+    }
+};
+
+/** Moves every player a little, so each frame has fresh state to send */
+static void movePlayers(const vector<shared_ptr<Player>>& players, const vector<Vec2>& starts, unsigned frame) {
+    for (unsigned i = 0; i < players.size(); ++i) {
+        float angle = 0.05f * frame + i;
+        players[i]->setLoc(starts[i] + Vec2(cosf(angle), sinf(angle)) * 40.0f);
+        players[i]->setDir(Vec2(cosf(angle), sinf(angle)));
+    }
+}
+
+/**
+ * Returns true if a client applies a real layout and rejects a forged one.
+ *
+ * The forged layout claims 0x20000001 batteries, which wraps to 8 bytes
+ * if the count is multiplied in 32 bits. Allocations are capped while it
+ * is decoded, so a missing bound fails at once instead of exhausting memory.
+ */
+static bool checkLayoutBounds(const shared_ptr<GameMap>& map) {
+    shared_ptr<AssetManager> none;
+    NetworkData host, client;
+    host.setID(0);
+    client.setID(1);
+    host.setStatus(constants::MatchStatus::Waiting);
+    client.setStatus(constants::MatchStatus::Waiting);
+    host.setGameMap(map);
+    client.setGameMap(GameMap::alloc(none));
+
+    client.unserializeData(host.serializeData());
+    if (!client.hasMapLayout()) {
+        CULogError("Client did not apply the host layout");
+        return false;
+    }
+
+    vector<uint8_t> forged;
+    NetworkUtils::Writer out(forged);
+    out.writeByte(constants::MatchStatus::Waiting);
+    out.writeInt(0);
+    for (int i = 0; i < 4; ++i) out.writeInt(i);
+    out.writeBool(true);
+    out.writeVector(Vec2::ZERO);
+    out.writeVector(Vec2::ZERO);
+    out.writeInt(0x20000001);
+    out.writeVector(Vec2::ZERO);
+
+    NetworkData victim;
+    victim.setID(1);
+    victim.setStatus(constants::MatchStatus::Waiting);
+    victim.setGameMap(GameMap::alloc(none));
+    bool rejected = true;
+    allocationLimit.store(1 << 20, memory_order_relaxed);
+    try {
+        victim.unserializeData(forged);
+    }
+    catch (const bad_alloc&) {
+        rejected = false;
+    }
+    allocationLimit.store(SIZE_MAX, memory_order_relaxed);
+    if (!rejected || victim.hasMapLayout()) {
+        CULogError("Forged battery count was accepted");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    string assets = ".";
+    unsigned frames = 6000;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = stoi(argv[++i]);
+        }
+        else {
+            assets = arg;
+        }
+    }
+
+    error_code err;
+    filesystem::current_path(assets, err);
+    if (err) {
+        CULogError("Cannot open assets directory %s", assets.c_str());
+        return 1;
+    }
+
+    shared_ptr<AssetManager> none;
+    auto map = GameMap::alloc(none);
+    if (map == nullptr || !map->generateRandomMap()) {
+        CULogError("Could not generate a map");
+        return 1;
+    }
+    if (!checkLayoutBounds(map)) {
+        return 1;
+    }
+
+    auto sim = GameSimulation::alloc(map);
+    auto& players = sim->getPlayers();
+    if (players.size() != NUM_PLAYERS) {
+        CULogError("Expected %u players, got %zu", NUM_PLAYERS, players.size());
+        return 1;
+    }
+    vector<Vec2> starts;
+    for (auto& p : players) starts.push_back(p->getLoc());
+
+    // The ghost has laid a few traps, so the host map block is not empty
+    map->setTraps({ starts[0] + Vec2(60, 0), starts[1] + Vec2(0, 60), starts[2] - Vec2(60, 0) });
+
+    // Host and client views of the same match
+    const int hostID = 0;
+    const int clientID = 1;
+    NetworkData host, client;
+    host.setID(hostID);
+    client.setID(clientID);
+    for (NetworkData* data : { &host, &client }) {
+        data->setPlayers(players);
+        data->setGameMap(map);
+        data->setStatus(constants::MatchStatus::InProgress);
+    }
+
+    // Both paths warm up first, so reserved buffers are not counted
+    const unsigned warmup = 60;
+    const float timestep = 1.0f / constants::TICK_RATE;
+    Result current, legacy;
+
+    for (unsigned frame = 0; frame < warmup + frames; ++frame) {
+        movePlayers(players, starts, frame);
+        bool measured = frame >= warmup;
+
+        auto start = chrono::steady_clock::now();
+        size_t before = allocations.load(memory_order_relaxed);
+        const vector<uint8_t>& hostMsg = host.serializeData();
+        size_t bytes = hostMsg.size();
+        client.unserializeData(hostMsg);
+        const vector<uint8_t>& clientMsg = client.serializeData();
+        bytes += clientMsg.size();
+        host.unserializeData(clientMsg);
+        client.interpolatePlayerData(timestep);
+        if (measured) {
+            current.allocations += allocations.load(memory_order_relaxed) - before;
+            current.bytes += bytes;
+            current.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        vector<Vec2> locations(NUM_PLAYERS);
+        start = chrono::steady_clock::now();
+        before = allocations.load(memory_order_relaxed);
+        auto oldHostMsg = Legacy::serialize(hostID, hostID, players, map);
+        Legacy::unserialize(hostID, oldHostMsg, map, locations);
+        auto oldClientMsg = Legacy::serialize(clientID, hostID, players, map);
+        Legacy::unserialize(hostID, oldClientMsg, map, locations);
+        if (measured) {
+            legacy.allocations += allocations.load(memory_order_relaxed) - before;
+            legacy.bytes += oldHostMsg.size() + oldClientMsg.size();
+            legacy.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    CULog("%u frames, %zu rooms, %zu traps, host and client each send once per frame",
+          frames, map->getRooms().size(), map->getTraps().size());
+    legacy.report("encode/split:  ", frames);
+    current.report("Writer/Reader: ", frames);
+    return 0;
+}
+
+#endif /** GHOSTED_NET_BENCH */
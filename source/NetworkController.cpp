@@ -71,6 +71,7 @@ void NetworkController::updateStatus() {
 }
 
 void NetworkController::update(float timestep) {
+    CU_PROFILE_ZONE("NetworkController::update");
     if (_connection == nullptr) return;
 
     // receive data
@@ -81,6 +82,12 @@ void NetworkController::update(float timestep) {
     // update status
     updateStatus();
 
+    // resend the map layout whenever someone joins, since they have not seen it yet
+    if (_host && _data != nullptr && _connection->getNumPlayers() != _numPlayers) {
+        _numPlayers = _connection->getNumPlayers();
+        if (_numPlayers > 1) _data->requestMapLayout();
+    }
+
     // handle dropped player
     if (_connection->getNumPlayers() < _connection->getTotalPlayers()) {
         // CULog("Player exited the game.");
@@ -89,9 +96,14 @@ void NetworkController::update(float timestep) {
     // interpolate player data
     if (_data != nullptr) {
         if (_connected) {
-            _data->interpolatePlayerData();
+            _data->interpolatePlayerData(timestep);
         }
     }
+}
+
+void NetworkController::step() {
+    CU_PROFILE_ZONE("NetworkController::step");
+    if (_connection == nullptr) return;
 
     // send data
     if (_connected && ++_tick >= constants::NETWORK_TICKS) {
@@ -105,7 +117,14 @@ bool NetworkController::sendData() {
         // CULog("No data attached.");
         return false;
     }
-    _connection->send(_data->serializeData());
+    const vector<uint8_t>& msg = _data->serializeData();
+    if (_data->getMessageType() == StateMessage) {
+        // a lost state message is superseded by the next one, so never wait on a resend
+        _connection->send(msg, CUNetworkConnection::Reliability::UnreliableSequenced, STATE_CHANNEL + _data->getID());
+    }
+    else {
+        _connection->send(msg, CUNetworkConnection::Reliability::ReliableOrdered, EVENT_CHANNEL);
+    }
     return true;
 }
 
@@ -7,7 +7,7 @@
 #include "NetworkData.h"
 
 /** Constants for connection config */
-constexpr char* SERVER_ADDRESS = "34.86.11.83";
+constexpr const char* SERVER_ADDRESS = "34.86.11.83";
 constexpr uint16_t SERVER_PORT = 61111;
 constexpr uint32_t MAX_PLAYERS = 4;
 constexpr uint8_t API_VERSION = 0;
@@ -18,7 +18,7 @@ using namespace cugl;
 /** Handles networking */
 class NetworkController {
 private:
-    /** Tick */
+    /** Simulation ticks since we last sent our data */
     unsigned _tick;
 
     /** Network data */
@@ -39,6 +39,9 @@ private:
     /** Connection room id */
     string _roomID;
 
+    /** Number of connected players when the map layout was last sent */
+    uint8_t _numPlayers;
+
     /** Update connection status */
     void updateStatus();
 
@@ -49,7 +52,7 @@ private:
     bool receiveData(const vector<uint8_t>& msg);
 
 public:
-    NetworkController() : _tick(0), _status(CUNetworkConnection::NetStatus::Disconnected), _connected(false), _host(true), _roomID("") { };
+    NetworkController() : _tick(0), _status(CUNetworkConnection::NetStatus::Disconnected), _connected(false), _host(true), _roomID(""), _numPlayers(0) { };
 
     ~NetworkController() { dispose(); };
 
@@ -110,8 +113,16 @@ public:
         }
     }
 
+    /** Receives messages and interpolates remote players, once per frame */
     void update(float timestep);
 
+    /**
+     * Advances one simulation tick, sending our data every
+     * constants::NETWORK_TICKS ticks so the send rate does not depend on the
+     * frame rate.
+     */
+    void step();
+
     void dispose() {
         disconnect();
         _data = nullptr;
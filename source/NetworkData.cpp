@@ -17,38 +17,28 @@ shared_ptr<PlayerData> NetworkData::getPlayer(int id) {
     return nullptr;
 };
 
-vector<uint8_t> NetworkData::convertMetadata() {
-    vector<uint8_t> result;
+bool NetworkData::convertMetadata(Writer& out) {
     if (_id < 0) {
         CULog("ID is not defined.");
-        return result;
+        return false;
     }
 
     // match status
-    encodeByte(_status, result);
+    out.writeByte(_status);
 
     // player id
-    encodeInt(_id, result);
+    out.writeInt(_id);
 
-    return result;
+    return true;
 }
 
-shared_ptr<NetworkMetadata> NetworkData::interpretMetadata(const vector<uint8_t>& metadata) {
-    CUAssertLog(metadata.size() == 5, "interpretMetadata: Byte vector size is not equal to data type size.");
-    vector<vector<uint8_t>> splitMetadata = split(metadata, { 1, 4 });
-    int status = decodeByte(splitMetadata[0]);
-    int id = decodeInt(splitMetadata[1]);
-    return make_shared<NetworkMetadata>(status, id);
+NetworkMetadata NetworkData::interpretMetadata(Reader& in) {
+    uint8_t status = in.readByte();
+    int id = in.readInt();
+    return NetworkMetadata(status, id);
 }
 
-vector<uint8_t> NetworkData::convertLobbyData() {
-    vector<uint8_t> result;
-
-    if (_id < 0) {
-        CULog("ID is not defined.");
-        return result;
-    }
-
+void NetworkData::convertLobbyData(Writer& out) {
     if (_id == _hostID) {
         if (_lobbyData == nullptr) {
             vector<int> playerOrder({ 3, 0, 1, 2 });
@@ -57,140 +47,202 @@ vector<uint8_t> NetworkData::convertLobbyData() {
         }
 
         for (int i : _lobbyData->playerOrder) {
-            encodeInt(i, result);
+            out.writeInt(i);
         }
     }
-
-    return result;
 }
 
-void NetworkData::interpretLobbyData(const int id, const vector<uint8_t>& msg) {
-    vector<vector<uint8_t>> splitMsg = split(msg, { 16 });
-    if (splitMsg.empty()) return;
+void NetworkData::interpretLobbyData(const int id, Reader& in) {
+    if (!in.has<LobbyLayout>()) return;
     if (id == _hostID && _lobbyData == nullptr) {
-        vector<vector<uint8_t>> splitPlayerOrder = split(splitMsg[0], { 4, 4, 4, 4 });
         vector<int> playerOrder(4);
         for (int i = 0; i < 4; ++i) {
-            playerOrder[i] = decodeInt(splitPlayerOrder[i]);
+            playerOrder[i] = in.readInt();
         }
         _lobbyData = make_shared<LobbyData>(playerOrder);
     }
-}
-
-vector<uint8_t> NetworkData::convertMapLayoutData() {
-    vector<uint8_t> result;
-
-    if (_id < 0) {
-        CULog("ID is not defined.");
-        return result;
+    else {
+        in.skip(LobbyLayout::size);
     }
+}
 
+void NetworkData::convertMapLayoutData(Writer& out) {
     if (_id == _hostID) {
-        if (_mapData == nullptr || _mapData->map == nullptr) {
-            return result;
-        }
+        // the layout is large, so it is only sent when someone may not have it yet
+        bool send = _mapData != nullptr && _mapData->map != nullptr && _mapData->layoutPending;
+        out.writeBool(send);
+        if (!send) return;
+        _mapData->layoutPending = false;
 
         auto data = _mapData->map->makeNetworkMap();
-        encodeVector(data->startRank, result); // Vec2
-        encodeVector(data->endRank, result); // Vec2
+        out.writeVector(data->startRank); // Vec2
+        out.writeVector(data->endRank); // Vec2
 
-        /*
-        encodeVec2List(data->batteries, result); // vector<Vec2>
+        out.writeInt((int)data->batteries.size()); // vector<Vec2>
+        for (auto& battery : data->batteries) {
+            out.writeVector(battery);
+        }
 
-        encodeInt((int)data->rooms.size(), result); // int
+        out.writeInt((int)data->rooms.size()); // int
         for (auto& roomData : data->rooms) {
-            encodeInt(roomData->layout, result); // int
-            encodeVector(roomData->rank, result); // Vec2
-            encodeBoolList(roomData->doors, result); // vector<bool>
+            out.writeInt(roomData->layout); // int
+            out.writeVector(roomData->rank); // Vec2
+            out.writeInt((int)roomData->doors.size()); // vector<bool>
+            for (bool door : roomData->doors) {
+                out.writeBool(door);
+            }
         }
-        */
     }
-
-    return result;
 }
 
-void NetworkData::interpretMapLayoutData(const int id, const vector<uint8_t>& msg) {
-    if (msg.empty()) return;
-
-    if (_mapData == nullptr || _mapData->map == nullptr) return;
+bool NetworkData::interpretMapLayoutData(const int id, Reader& in) {
+    if (in.remaining() == 0) return true;
 
-    vector<vector<uint8_t>> splitMsg;
     if (id == _hostID) {
-        /*
-        if (_mapData->generated) return;
+        if (!in.readBool()) return true;
+        if (_mapData != nullptr && _mapData->generated) return true;
 
-        splitMsg = split(msg, { 8, 8 });
-        auto startRank = decodeVector(splitMsg[0]);
-        auto endRank = decodeVector(splitMsg[1]);
+        auto startRank = in.readVector();
+        auto endRank = in.readVector();
 
-        splitMsg = split(splitMsg[2], { 4 });
-        unsigned batteriesLength = decodeInt(splitMsg[0]);
+        // bound the count before allocating, so a huge count cannot wrap the size check
+        unsigned batteriesLength = in.readInt();
+        if (batteriesLength > in.remaining() / WireSize<Vec2>::value) {
+            in.fail();
+            return false;
+        }
         vector<Vec2> batteries;
-        if (batteriesLength > 0) {
-            splitMsg = split(splitMsg[1], { batteriesLength * 8 });
-            if (splitMsg.)
-            batteries = decodeVec2List(batteriesLength, splitMsg[0]);
+        for (unsigned i = 0; i < batteriesLength; i++) {
+            batteries.push_back(in.readVector());
         }
 
-        splitMsg = split(splitMsg[1], { 4 });
-        unsigned roomsLength = decodeInt(splitMsg[0]);
+        unsigned roomsLength = in.readInt();
+        if (roomsLength > constants::MAX_ROOMS) {
+            in.fail();
+            return false;
+        }
         vector<shared_ptr<RoomNetworkdata>> rooms;
-        for (unsigned i = 0; i < roomsLength; i++) {
-            splitMsg = split(splitMsg[1], { 4, 8 });
-            auto layout = decodeInt(splitMsg[0]);
-            auto rank = decodeVector(splitMsg[1]);
-
-            splitMsg = split(splitMsg[2], { 4 });
-            unsigned doorsLength = decodeInt(splitMsg[0]);
+        for (unsigned i = 0; i < roomsLength && in.ok(); i++) {
+            auto layout = in.readInt();
+            auto rank = in.readVector();
+
+            unsigned doorsLength = in.readInt();
+            if (in.remaining() < doorsLength) {
+                in.fail();
+                return false;
+            }
             vector<bool> doors;
-            if (doorsLength > 0) {
-                splitMsg = split(splitMsg[1], { batteriesLength * 1 });
-                doors = decodeBoolList(doorsLength, splitMsg[0]);
+            for (unsigned j = 0; j < doorsLength; j++) {
+                doors.push_back(in.readBool());
             }
 
             rooms.push_back(make_shared<RoomNetworkdata>(doors, rank, layout));
         }
+        if (!in.ok()) return false;
 
         auto data = make_shared<MapNetworkdata>(rooms, batteries, startRank, endRank);
-        _mapData->map->readNetworkMap(data);
-        */
+        if (_mapData == nullptr || _mapData->map == nullptr) {
+            // no map to fill in yet, keep the layout until one is attached
+            _receivedLayout = data;
+            return true;
+        }
+        _mapData->generated = _mapData->map->readNetworkMap(data);
     }
+    return true;
 }
 
-vector<uint8_t> NetworkData::convertPlayerData() {
-    vector<uint8_t> result;
-    if (_id < 0) {
-        CULog("Player id is not defined.");
-        return result;
+/** Encodes a facing direction as an angle, reserving 0 for no direction */
+static uint8_t encodeDirection(const Vec2& dir) {
+    if (dir.isNearZero()) return 0;
+    const uint32_t steps = (1u << DIRECTION_BITS) - 1;
+    float t = atan2f(dir.y, dir.x) / (2 * M_PI);
+    if (t < 0) t += 1;
+    return 1 + (static_cast<uint32_t>(t * steps + 0.5f) % steps);
+}
+
+static Vec2 decodeDirection(uint8_t q) {
+    if (q == 0) return Vec2::ZERO;
+    const uint32_t steps = (1u << DIRECTION_BITS) - 1;
+    float angle = 2 * M_PI * (q - 1) / steps;
+    return Vec2(cosf(angle), sinf(angle));
+}
+
+unsigned NetworkData::getPositionQuantization(Rect& bounds) {
+    if (_mapData != nullptr && _mapData->map != nullptr) {
+        bounds = _mapData->map->getBounds();
+    }
+    else {
+        bounds = Rect::ZERO;
+    }
+    if (bounds.size.width <= 0 || bounds.size.height <= 0) {
+        // no map yet, fall back to the largest square layout
+        float side = sqrtf(constants::MAX_ROOMS) * constants::WALL_LENGTH;
+        bounds = Rect(0, 0, side, side);
     }
+    float extent = max(bounds.size.width, bounds.size.height);
+    return bitsFor(static_cast<uint32_t>(ceilf(extent / POSITION_PRECISION)));
+}
 
+const PlayerSnapshot* NetworkData::findBaseline() {
+    // newest snapshot first, so the delta stays as small as possible
+    for (unsigned age = 1; age <= ACK_MASK_BITS + 1 && age < SNAPSHOT_HISTORY; age++) {
+        uint8_t seq = _seq - age;
+        const PlayerSnapshot& candidate = _sent[seq % SNAPSHOT_HISTORY];
+        if (!candidate.valid || candidate.seq != seq) return nullptr;
+
+        bool acked = true;
+        for (auto& p : _players) {
+            if (p == nullptr || p->id == _id) continue;
+            auto& rep = p->replicationData;
+            // players we have not heard from recently do not hold back the baseline
+            if (rep->lastHeard < 0 || _tick - rep->lastHeard > PEER_TIMEOUT_TICKS) continue;
+            if (!rep->hasAcked(seq)) {
+                acked = false;
+                break;
+            }
+        }
+        if (acked) return &candidate;
+    }
+    return nullptr;
+}
+
+void NetworkData::convertPlayerData(Writer& out) {
     shared_ptr<PlayerData> playerData = getPlayer();
 
     if (playerData == nullptr || playerData->player == nullptr) {
         CULog("Player is null.");
-        return result;
+        return;
     }
 
-    auto player = playerData->player;
+    auto& player = playerData->player;
+
+    PlayerSnapshot snapshot;
+    snapshot.valid = true;
+    snapshot.seq = _seq;
 
     // number of batteries/traps
+    int count;
     if (player->getType() == constants::PlayerType::Pal) {
-        auto pal = dynamic_pointer_cast<Pal>(player);
-        encodeInt(pal->getBatteries(), result);
+        count = dynamic_pointer_cast<Pal>(player)->getBatteries();
     }
     else {
-        auto ghost = dynamic_pointer_cast<Ghost>(player);
-        encodeInt(ghost->getTraps(), result);
+        count = dynamic_pointer_cast<Ghost>(player)->getTraps();
     }
+    snapshot.count = clamp(count, 0, (1 << COUNT_BITS) - 1);
 
     // player location
-    encodeVector(player->getLoc(), result);
+    Rect bounds;
+    unsigned locationBits = getPositionQuantization(bounds);
+    Vec2 loc = player->getLoc();
+    snapshot.x = quantize(loc.x, bounds.getMinX(), bounds.getMaxX(), locationBits);
+    snapshot.y = quantize(loc.y, bounds.getMinY(), bounds.getMaxY(), locationBits);
 
     // player direction
-    encodeVector(player->getDir(), result);
+    snapshot.direction = encodeDirection(player->getDir());
 
-    for (auto& p : _players) {
-        auto targetPlayer = p->player;
+    for (unsigned i = 0; i < _players.size(); i++) {
+        auto& targetPlayer = _players[i]->player;
+        bool flag;
 
         // player spooked / tagged
         if (_id == _hostID) {
@@ -198,10 +250,10 @@ vector<uint8_t> NetworkData::convertPlayerData() {
             if (targetPlayer->getType() == constants::PlayerType::Pal) {
                 auto pal = dynamic_pointer_cast<Pal>(targetPlayer);
                 pal->updateSpooked();
-                encodeBool(pal->getSpooked(), result);
+                flag = pal->getSpooked();
             }
             else {
-                encodeBool(dynamic_pointer_cast<Ghost>(targetPlayer)->getTagged(), result);
+                flag = dynamic_pointer_cast<Ghost>(targetPlayer)->getTagged();
             }
         }
         else {
@@ -209,30 +261,102 @@ vector<uint8_t> NetworkData::convertPlayerData() {
             if (player->getType() == constants::PlayerType::Pal) {
                 if (targetPlayer->getType() == constants::PlayerType::Pal) {
                     // pal unspook pal
-                    encodeBool(dynamic_pointer_cast<Pal>(targetPlayer)->getUnspookFlag(), result);
+                    flag = dynamic_pointer_cast<Pal>(targetPlayer)->getUnspookFlag();
                 }
                 else {
                     // pal tag ghost
-                    encodeBool(dynamic_pointer_cast<Ghost>(targetPlayer)->getTagged(), result);
+                    flag = dynamic_pointer_cast<Ghost>(targetPlayer)->getTagged();
                 }
             }
             else {
                 if (targetPlayer->getType() == constants::PlayerType::Pal) {
                     // ghost spook pal
-                    encodeBool(dynamic_pointer_cast<Pal>(targetPlayer)->getSpookFlag(), result);
+                    flag = dynamic_pointer_cast<Pal>(targetPlayer)->getSpookFlag();
                 }
                 else {
                     // ghost kiss ghost ???
-                    encodeBool(false, result);
+                    flag = false;
                 }
             }
         }
+        if (flag) snapshot.flags |= 1 << i;
     }
 
-    return result;
+    const PlayerSnapshot* baseline = findBaseline();
+    uint8_t fields = baseline == nullptr ? (uint8_t)FieldAll : snapshot.diff(*baseline);
+
+    // length prefix, filled in once the block is packed
+    size_t start = out.size();
+    out.writeByte(0);
+
+    BitWriter bits(out);
+    bits.write(snapshot.seq, SEQ_BITS);
+    bits.write(static_cast<uint32_t>(_clock * 1000), TIME_BITS);
+    bits.writeBool(baseline != nullptr);
+    if (baseline != nullptr) bits.write(baseline->seq, SEQ_BITS);
+
+    // acknowledge the latest snapshot received from every other player
+    for (auto& p : _players) {
+        if (p->id == _id) continue;
+        auto& received = p->replicationData->received;
+        int last = p->replicationData->lastReceived;
+        bits.writeBool(last >= 0);
+        if (last < 0) continue;
+
+        uint8_t mask = 0;
+        for (unsigned age = 1; age <= ACK_MASK_BITS; age++) {
+            uint8_t seq = last - age;
+            auto& s = received[seq % SNAPSHOT_HISTORY];
+            if (s.valid && s.seq == seq) mask |= 1 << (age - 1);
+        }
+        bits.write(last, SEQ_BITS);
+        bits.write(mask, ACK_MASK_BITS);
+    }
+
+    bits.write(fields, FIELD_BITS);
+    if (fields & FieldCount) bits.write(snapshot.count, COUNT_BITS);
+    if (fields & FieldLocation) {
+        bits.write(snapshot.x, locationBits);
+        bits.write(snapshot.y, locationBits);
+    }
+    if (fields & FieldDirection) bits.write(snapshot.direction, DIRECTION_BITS);
+    if (fields & FieldFlags) bits.write(snapshot.flags, NUM_PLAYERS);
+
+    // latest local input, so the host can tell which inputs a correction applies to
+    bits.write(static_cast<uint8_t>(_inputSeq - 1), INPUT_BITS);
+    if (_id == _hostID) {
+        // acknowledge every other player's latest input, with a correction if we hold them elsewhere
+        for (auto& p : _players) {
+            if (p->id == _id) continue;
+            auto& rep = p->replicationData;
+            bits.writeBool(rep->lastInput >= 0);
+            if (rep->lastInput < 0) continue;
+            bits.write(rep->lastInput, INPUT_BITS);
+
+            // spooked pals stay where they were when we spooked them
+            auto pal = dynamic_pointer_cast<Pal>(p->player);
+            bool frozen = pal != nullptr && pal->getSpooked();
+            if (frozen && !rep->frozen) rep->frozenLocation = rep->reportedLocation;
+            rep->frozen = frozen;
+
+            bool correct = frozen && rep->reportedLocation.distance(rep->frozenLocation) > CORRECTION_THRESHOLD;
+            bits.writeBool(correct);
+            if (correct) {
+                bits.write(quantize(rep->frozenLocation.x, bounds.getMinX(), bounds.getMaxX(), locationBits), locationBits);
+                bits.write(quantize(rep->frozenLocation.y, bounds.getMinY(), bounds.getMaxY(), locationBits), locationBits);
+            }
+        }
+    }
+    bits.flush();
+
+    out.setByte(start, static_cast<uint8_t>(out.size() - start - 1));
+
+    _sent[_seq % SNAPSHOT_HISTORY] = snapshot;
+    ++_seq;
 }
 
-void NetworkData::interpretPlayerData(const int id, const vector<uint8_t>& playerData) {
+void NetworkData::interpretPlayerData(const int id, Reader& in) {
+    Reader block = in.sub(in.readByte());
     shared_ptr<PlayerData> otherPlayerData = getPlayer(id);
 
     if (otherPlayerData == nullptr || otherPlayerData->player == nullptr) {
@@ -240,200 +364,298 @@ void NetworkData::interpretPlayerData(const int id, const vector<uint8_t>& playe
         return;
     }
 
-    vector<vector<uint8_t>> splitPlayerData = split(playerData, { 4, 8, 8, 4 });
-    if (splitPlayerData.empty()) return;
+    auto& otherPlayer = otherPlayerData->player;
+    auto& rep = otherPlayerData->replicationData;
+    rep->lastHeard = _tick;
 
-    auto otherPlayer = otherPlayerData->player;
+    BitReader bits(block);
+    uint8_t seq = bits.read(SEQ_BITS);
+    uint16_t stamp = bits.read(TIME_BITS);
+    bool hasBaseline = bits.readBool();
+    uint8_t baseSeq = hasBaseline ? bits.read(SEQ_BITS) : 0;
+
+    // acknowledgements, one per player other than the sender
+    for (auto& p : _players) {
+        if (p->id == id) continue;
+        if (!bits.readBool()) continue;
+        uint8_t ack = bits.read(SEQ_BITS);
+        uint8_t mask = bits.read(ACK_MASK_BITS);
+        if (p->id == _id && (rep->acked < 0 || (int8_t)(ack - (uint8_t)rep->acked) > 0)) {
+            rep->acked = ack;
+            rep->ackMask = mask;
+        }
+    }
+
+    uint8_t fields = bits.read(FIELD_BITS);
+    PlayerSnapshot snapshot;
+    if (hasBaseline) {
+        auto& base = rep->received[baseSeq % SNAPSHOT_HISTORY];
+        // we never received the baseline, wait for a later one
+        if (!base.valid || base.seq != baseSeq) return;
+        snapshot = base;
+    }
+    else if (fields != FieldAll) {
+        return;
+    }
+
+    Rect bounds;
+    unsigned locationBits = getPositionQuantization(bounds);
+    if (fields & FieldCount) snapshot.count = bits.read(COUNT_BITS);
+    if (fields & FieldLocation) {
+        snapshot.x = bits.read(locationBits);
+        snapshot.y = bits.read(locationBits);
+    }
+    if (fields & FieldDirection) snapshot.direction = bits.read(DIRECTION_BITS);
+    if (fields & FieldFlags) snapshot.flags = bits.read(NUM_PLAYERS);
+
+    uint8_t input = bits.read(INPUT_BITS);
+    bool corrected = false;
+    uint8_t correctedInput = 0;
+    Vec2 correctedLocation;
+    if (id == _hostID) {
+        for (auto& p : _players) {
+            if (p->id == id) continue;
+            if (!bits.readBool()) continue;
+            uint8_t ack = bits.read(INPUT_BITS);
+            if (!bits.readBool()) continue;
+            uint32_t x = bits.read(locationBits);
+            uint32_t y = bits.read(locationBits);
+            if (p->id == _id) {
+                corrected = true;
+                correctedInput = ack;
+                correctedLocation = Vec2(dequantize(x, bounds.getMinX(), bounds.getMaxX(), locationBits),
+                    dequantize(y, bounds.getMinY(), bounds.getMaxY(), locationBits));
+            }
+        }
+    }
+    if (!bits.ok()) return;
+
+    // ignore snapshots older than the one we already applied
+    if (rep->lastReceived >= 0 && (int8_t)(seq - (uint8_t)rep->lastReceived) <= 0) return;
+    snapshot.valid = true;
+    snapshot.seq = seq;
+    rep->received[seq % SNAPSHOT_HISTORY] = snapshot;
+    rep->lastReceived = seq;
 
     // number of batteries/traps
     if (otherPlayer->getType() == constants::PlayerType::Pal) {
-        auto pal = dynamic_pointer_cast<Pal>(otherPlayer);
-        pal->setBatteries(decodeInt(splitPlayerData[0]));
+        dynamic_pointer_cast<Pal>(otherPlayer)->setBatteries(snapshot.count);
     }
     else {
-        auto ghost = dynamic_pointer_cast<Ghost>(otherPlayer);
-        ghost->setTraps(decodeInt(splitPlayerData[0]));
+        dynamic_pointer_cast<Ghost>(otherPlayer)->setTraps(snapshot.count);
     }
 
     // location and direction
-    Vec2 location = decodeVector(splitPlayerData[1]);
-    Vec2 direction = decodeVector(splitPlayerData[2]);
+    Vec2 location(dequantize(snapshot.x, bounds.getMinX(), bounds.getMaxX(), locationBits),
+        dequantize(snapshot.y, bounds.getMinY(), bounds.getMaxY(), locationBits));
+    Vec2 direction = decodeDirection(snapshot.direction);
 
-    otherPlayer->setDir(direction);
-    otherPlayerData->interpolationData->ticksSinceReceived = 0;
-    otherPlayerData->interpolationData->oldPosition = otherPlayer->getLoc();
-    otherPlayerData->interpolationData->newPosition = location;
-    otherPlayer->setIdle((location - otherPlayer->getLoc()).length() < 1.f);
+    bufferPlayerData(otherPlayerData, stamp, location, direction);
+    rep->lastInput = input;
+    rep->reportedLocation = location;
 
     // more complicated player data
-    splitPlayerData = split(splitPlayerData[3], { 1, 1, 1, 1 });
     for (unsigned i = 0; i < _players.size(); i++) {
-        auto p = _players[i];
-        auto targetPlayer = p->player;
+        auto& p = _players[i];
+        auto& targetPlayer = p->player;
 
-        bool data = decodeBool(splitPlayerData[i]);
+        bool data = (snapshot.flags >> i) & 1;
         // this piece of code only works if ghost is host
         if (id == _hostID) {
             // receive master data from host
             if (targetPlayer->getType() == constants::PlayerType::Pal) {
-                auto pal = dynamic_pointer_cast<Pal>(targetPlayer);
-                pal->setSpooked(data);
+                dynamic_pointer_cast<Pal>(targetPlayer)->setSpooked(data);
             }
             else {
-                auto ghost = dynamic_pointer_cast<Ghost>(targetPlayer);
-                ghost->setTagged(data);
+                dynamic_pointer_cast<Ghost>(targetPlayer)->setTagged(data);
             }
         }
-        else if (p != getPlayer()) {
+        else if (p->id != _id) {
             // receive data and update player state
             if (data) {
                 if (otherPlayer->getType() == constants::PlayerType::Pal) {
                     if (targetPlayer->getType() == constants::PlayerType::Pal) {
-                        auto pal = dynamic_pointer_cast<Pal>(targetPlayer);
                         // pal unspook pal
                         dynamic_pointer_cast<Pal>(otherPlayer)->setHelping();
-                        pal->setUnspookFlag();
+                        dynamic_pointer_cast<Pal>(targetPlayer)->setUnspookFlag();
                     }
                 }
             }
         }
     }
+
+    // apply host state before replaying, so the replay sees e.g. that we are spooked
+    if (corrected) reconcile(correctedInput, correctedLocation);
 }
 
-vector<uint8_t> NetworkData::convertMapData() {
-    vector<uint8_t> result;
-    if (_id < 0) {
-        CULog("Player id is not defined.");
-        return result;
+void NetworkData::reconcile(uint8_t input, const Vec2& location) {
+    auto playerData = getPlayer();
+    if (playerData == nullptr || playerData->player == nullptr) return;
+    if (_mapData == nullptr || _mapData->map == nullptr) return;
+
+    InputRecord& record = _inputs[input % INPUT_HISTORY];
+    if (!record.valid || record.seq != input) return;
+    if (record.location.distance(location) <= CORRECTION_THRESHOLD) return;
+
+    auto& player = playerData->player;
+    Vec2 current = player->getLoc();
+    Vec2 direction = player->getDir();
+
+    // the host only corrects players it holds in place, so restart from rest
+    player->setLoc(location);
+    player->setVelocity(Vec2::ZERO);
+    record.location = location;
+    record.velocity = Vec2::ZERO;
+    for (uint8_t seq = input + 1; seq != _inputSeq; ++seq) {
+        InputRecord& r = _inputs[seq % INPUT_HISTORY];
+        if (!r.valid || r.seq != seq) break;
+        _mapData->map->predictMove(r.move, r.direction);
+        r.location = player->getLoc();
+        r.velocity = player->getVelocity();
+    }
+    player->setDir(direction);
+
+    // ease small corrections in over the next frames instead of snapping
+    Vec2 predicted = player->getLoc();
+    if (predicted.distance(current) < CORRECTION_SNAP_DISTANCE) {
+        player->setLoc(current);
+        _correction = predicted - current;
+    }
+    else {
+        _correction = Vec2::ZERO;
     }
+}
+
+void NetworkData::recordInput(const Vec2& move, const Vec2& direction, float timestep) {
+    auto playerData = getPlayer();
+    if (playerData == nullptr || playerData->player == nullptr) return;
+    auto& player = playerData->player;
+
+    if (!_correction.isZero()) {
+        Vec2 step = _correction * min(timestep * CORRECTION_RATE, 1.f);
+        if (_correction.lengthSquared() < 0.01f) step = _correction;
+        player->setLoc(player->getLoc() + step);
+        _correction -= step;
+    }
+
+    InputRecord& record = _inputs[_inputSeq % INPUT_HISTORY];
+    record.valid = true;
+    record.seq = _inputSeq;
+    record.move = move;
+    record.direction = direction;
+    record.location = player->getLoc();
+    record.velocity = player->getVelocity();
+    ++_inputSeq;
+}
 
+void NetworkData::convertMapData(Writer& out) {
     if (_mapData == nullptr || _mapData->map == nullptr) {
         CULog("Game map is not defined.");
-        return result;
+        return;
     };
 
     if (_id == _hostID) {
         // traps
-        vector<Vec2> trapPositions;
-        vector<bool> trapTriggered;
-        for (auto& trap : _mapData->map->getTraps()) {
-            trapPositions.push_back(trap->getLoc());
-            trapTriggered.push_back(trap->getTriggered());
-        };
-        encodeVec2List(trapPositions, result);
-        encodeBoolList(trapTriggered, result);
+        auto& traps = _mapData->map->getTraps();
+        out.writeInt((int)traps.size());
+        for (auto& trap : traps) {
+            out.writeVector(trap->getLoc());
+        }
+        out.writeInt((int)traps.size());
+        for (auto& trap : traps) {
+            out.writeBool(trap->getTriggered());
+        }
 
         // room lights status
-        vector<bool> roomsLit;
-        for (auto& room : _mapData->map->getRooms()) {
-            roomsLit.push_back(room->getLight());
+        auto& rooms = _mapData->map->getRooms();
+        out.writeInt((int)rooms.size());
+        for (auto& room : rooms) {
+            out.writeBool(room->getLight());
         }
-        encodeBoolList(roomsLit, result);
     }
     else {
         // room lights activated
-        vector<bool> roomsLit;
-        for (auto& room : _mapData->map->getRooms()) {
-            if (room->getSlot() == nullptr) roomsLit.push_back(false);
-            else roomsLit.push_back(room->getSlot()->activated());
+        auto& rooms = _mapData->map->getRooms();
+        out.writeInt((int)rooms.size());
+        for (auto& room : rooms) {
+            out.writeBool(room->getSlot() != nullptr && room->getSlot()->activated());
         }
-        encodeBoolList(roomsLit, result);
 
         // teleporter battery count
-        encodeInt(_mapData->map->getTeleCount(), result);
+        out.writeInt(_mapData->map->getTeleCount());
     }
-
-    return result;
 }
 
-void NetworkData::interpretMapData(const int id, const vector<uint8_t>& msg) {
-    if (msg.empty()) return;
+bool NetworkData::interpretMapData(const int id, Reader& in) {
+    if (in.remaining() == 0) return true;
 
-    if (_mapData == nullptr || _mapData->map == nullptr) return;
+    if (_mapData == nullptr || _mapData->map == nullptr) return true;
 
     // this only works if ghost is host
     if (id == _hostID) {
         // host data
-        vector<vector<uint8_t>> splitMsg = split(msg, { 4 });
-        if (splitMsg.empty()) return;
-
-        unsigned numTraps = decodeInt(splitMsg[0]);
-        vector<Vec2> trapPositions;
-        if (numTraps > 0) {
-            splitMsg = split(splitMsg[1], { numTraps * 8 });
-            trapPositions = decodeVec2List(numTraps, splitMsg[0]);
+        // counts are untrusted, so bound them by the bytes left rather than multiplying
+        unsigned numTraps = in.readInt();
+        if (numTraps > in.remaining() / NetworkUtils::WireSize<Vec2>::value) {
+            in.fail();
+            return false;
         }
-        _mapData->map->setTraps(trapPositions);
-
-        splitMsg = split(splitMsg[1], { 4 });
-        if (splitMsg.empty()) return;
+        _trapPositions.clear();
+        for (unsigned i = 0; i < numTraps; i++) {
+            _trapPositions.push_back(in.readVector());
+        }
+        _mapData->map->setTraps(_trapPositions);
 
-        CUAssertLog(numTraps == decodeInt(splitMsg[0]), "Expected different number of traps");
-        numTraps = decodeInt(splitMsg[0]);
-        vector<bool> trapTriggered;
-        if (numTraps > 0) {
-            splitMsg = split(splitMsg[1], { numTraps * 1 });
-            trapTriggered = decodeBoolList(numTraps, splitMsg[0]);
+        unsigned numTriggered = in.readInt();
+        if (numTriggered != numTraps) {
+            in.fail();
+            return false;
         }
-        for (unsigned i = 0; i < numTraps; i++) {
-            auto trap = _mapData->map->getTraps()[i];
-            if (trapTriggered[i] && !trap->getTriggered()) {
+        auto& traps = _mapData->map->getTraps();
+        for (unsigned i = 0; i < numTriggered && in.ok(); i++) {
+            bool triggered = in.readBool();
+            if (i >= traps.size()) continue;
+            auto& trap = traps[i];
+            if (triggered && !trap->getTriggered()) {
                 trap->setTriggered();
             }
         }
 
-        splitMsg = split(splitMsg[1], { 4 });
-        if (splitMsg.empty()) return;
-
-        unsigned numRooms = decodeInt(splitMsg[0]);
-        vector<bool> roomsLit;
-        if (numRooms > 0) {
-            splitMsg = split(splitMsg[1], { numRooms * 1 });
-            roomsLit = decodeBoolList(numRooms, splitMsg[0]);
-        }
-        for (unsigned i = 0; i < numRooms && i < _mapData->map->getRooms().size(); i++) {
-            auto room = _mapData->map->getRooms()[i];
-            if (roomsLit[i] && !room->getLight() && room->getSlot() != nullptr) {
+        auto& rooms = _mapData->map->getRooms();
+        unsigned numRooms = in.readInt();
+        for (unsigned i = 0; i < numRooms && in.ok(); i++) {
+            bool lit = in.readBool();
+            if (i >= rooms.size()) continue;
+            auto& room = rooms[i];
+            if (lit && !room->getLight() && room->getSlot() != nullptr) {
                 room->getSlot()->setCharge();
             };
         }
     }
     else if (_id == _hostID) {
         // host receiving data
-        vector<vector<uint8_t>> splitMsg = split(msg, { 4 });
-        if (splitMsg.empty()) return;
-
-        unsigned numRooms = decodeInt(splitMsg[0]);
-        vector<bool> roomsLit;
-        if (numRooms > 0) {
-            splitMsg = split(splitMsg[1], { numRooms * 1 });
-            roomsLit = decodeBoolList(numRooms, splitMsg[0]);
-        }
-        for (unsigned i = 0; i < numRooms && i < _mapData->map->getRooms().size(); i++) {
-            auto room = _mapData->map->getRooms()[i];
-            if (roomsLit[i] && !room->getLight() && room->getSlot() != nullptr) {
+        auto& rooms = _mapData->map->getRooms();
+        unsigned numRooms = in.readInt();
+        for (unsigned i = 0; i < numRooms && in.ok(); i++) {
+            bool lit = in.readBool();
+            if (i >= rooms.size()) continue;
+            auto& room = rooms[i];
+            if (lit && !room->getLight() && room->getSlot() != nullptr) {
                 room->getSlot()->setCharge();
             };
         }
 
-        splitMsg = split(splitMsg[1], { 4 });
-        if (splitMsg.empty()) return;
-
-        int receivedTeleCount = decodeInt(splitMsg[0]);
+        int receivedTeleCount = in.readInt();
+        if (!in.ok()) return false;
         int currentTeleCount = _mapData->map->getTeleCount();
         if (currentTeleCount > receivedTeleCount) {
             _mapData->map->setTeleCount(receivedTeleCount);
         }
     }
+    return in.ok();
 }
 
-vector<uint8_t> NetworkData::convertWinData() {
-    vector<uint8_t> result;
-    if (_id < 0) {
-        CULog("ID is not defined.");
-        return result;
-    }
-
+void NetworkData::convertWinData(Writer& out) {
     uint8_t winner = 0;
 
     if (_id == _hostID) {
@@ -450,16 +672,14 @@ vector<uint8_t> NetworkData::convertWinData() {
             }
         }
     }
-    encodeByte(winner, result);
-
-    return result;
+    out.writeByte(winner);
 }
 
-void NetworkData::interpretWinData(const int id, const vector<uint8_t>& msg) {
-    vector<vector<uint8_t>> splitMsg = split(msg, { 1 });
-    if (splitMsg.empty()) return;
+void NetworkData::interpretWinData(const int id, Reader& in) {
+    if (!in.has<WinLayout>()) return;
+    uint8_t winner = in.readByte();
     if (id == _hostID) {
-        switch (decodeByte(splitMsg[0])) {
+        switch (winner) {
         case 0:
             break;
         case 1:
@@ -472,99 +692,150 @@ void NetworkData::interpretWinData(const int id, const vector<uint8_t>& msg) {
     }
 }
 
-vector<uint8_t> NetworkData::serializeData() {
-    vector<uint8_t> result;
+const vector<uint8_t>& NetworkData::serializeData() {
+    Writer out(_buffer);
+    ++_tick;
 
-    vector<uint8_t> metadata = convertMetadata();
-    result.insert(result.end(), metadata.begin(), metadata.end()); // 5
+    if (!convertMetadata(out)) return _buffer; // 5
 
     switch (_status) {
-    case constants::MatchStatus::Waiting: {
-        vector<uint8_t> lobbyData = convertLobbyData();
-        result.insert(result.end(), lobbyData.begin(), lobbyData.end()); // 16
-
-        vector<uint8_t> mapLayoutData = convertMapLayoutData();
-        result.insert(result.end(), mapLayoutData.begin(), mapLayoutData.end()); // struct
+    case constants::MatchStatus::Waiting:
+        convertLobbyData(out); // 16
+        convertMapLayoutData(out); // struct
         break;
-    }
-    case constants::MatchStatus::InProgress: {
-        vector<uint8_t> playerData = convertPlayerData(); // 24
-        result.insert(result.end(), playerData.begin(), playerData.end());
-
-        vector<uint8_t> mapData = convertMapData(); // variable
-        result.insert(result.end(), mapData.begin(), mapData.end());
+    case constants::MatchStatus::InProgress:
+        convertPlayerData(out); // variable
+        convertMapData(out); // variable
         break;
-    }
     case constants::MatchStatus::Paused:
         break;
     case constants::MatchStatus::Ended:
-        vector<uint8_t> winData = convertWinData(); // 1
-        result.insert(result.end(), winData.begin(), winData.end());
+        convertWinData(out); // 1
         break;
     }
 
-    return result;
+    return _buffer;
 }
 
 void NetworkData::unserializeData(const vector<uint8_t>& msg) {
-    vector<vector<uint8_t>> splitMsg = split(msg, { 5 });
-    if (splitMsg.empty()) return;
+    Reader in(msg);
+    if (!in.has<MetadataLayout>()) {
+        CULogError("Message is too small. Message size: %d. Expected size: %d.", (int)msg.size(), MetadataLayout::size);
+        return;
+    }
 
-    shared_ptr<NetworkMetadata> metadata = interpretMetadata(splitMsg[0]);
-    auto status = metadata->status;
+    NetworkMetadata metadata = interpretMetadata(in);
+    auto status = metadata.status;
     if (status != _status) {
-        if (metadata->id == _hostID) _status = metadata->status; // sync with host status
+        if (metadata.id == _hostID) _status = metadata.status; // sync with host status
         else return;
     }
 
     switch (_status) {
     case constants::MatchStatus::None:
         break;
-    case constants::MatchStatus::Waiting: {
-        if (splitMsg.size() <= 1) break;
-        splitMsg = split(splitMsg[1], { 16 });
-        if (splitMsg.empty()) break;
-        interpretLobbyData(metadata->id, splitMsg[0]);
-        if (splitMsg.size() < 2) break;
-        interpretMapLayoutData(metadata->id, splitMsg[1]);
+    case constants::MatchStatus::Waiting:
+        if (!in.has<LobbyLayout>()) break;
+        interpretLobbyData(metadata.id, in);
+        if (!interpretMapLayoutData(metadata.id, in)) {
+            CULogError("Malformed map layout from player %d.", metadata.id);
+        }
         break;
-    }
-    case constants::MatchStatus::InProgress: {
-        if (splitMsg.size() <= 1) break;
-        splitMsg = split(splitMsg[1], { 24 });
-        if (splitMsg.empty()) break;
-        interpretPlayerData(metadata->id, splitMsg[0]);
-        if (splitMsg.size() < 2) break;
-        interpretMapData(metadata->id, splitMsg[1]);
+    case constants::MatchStatus::InProgress:
+        if (in.remaining() == 0) break;
+        interpretPlayerData(metadata.id, in);
+        if (!interpretMapData(metadata.id, in)) {
+            CULogError("Malformed map data from player %d.", metadata.id);
+        }
         break;
-    }
     case constants::MatchStatus::Paused:
         break;
     case constants::MatchStatus::Ended:
-        if (splitMsg.size() <= 1) break;
-        interpretWinData(metadata->id, splitMsg[1]);
+        interpretWinData(metadata.id, in);
         break;
     }
 }
 
-void NetworkData::interpolatePlayerData() {
-    vector<shared_ptr<PlayerData>> otherPlayers;
-    for (auto& p : _players) {
-        if (p != nullptr && p->id >= 0 && p->id != _id) {
-            otherPlayers.push_back(p);
-        }
+void NetworkData::bufferPlayerData(const shared_ptr<PlayerData>& playerData, uint16_t stamp, const Vec2& position, const Vec2& direction) {
+    auto& data = playerData->interpolationData;
+
+    // unwrap the sender clock; snapshots arrive in order, so it only moves forward
+    float elapsed = 0;
+    if (data->count == 0) {
+        data->remoteTime = stamp / 1000.f;
+        data->offset = _clock - data->remoteTime;
+    }
+    else {
+        elapsed = static_cast<uint16_t>(stamp - data->lastStamp) / 1000.f;
+        data->remoteTime += elapsed;
+    }
+    data->lastStamp = stamp;
+
+    // the fastest transit seen is the clock offset, anything slower is jitter
+    float sample = _clock - data->remoteTime;
+    data->offset = min(sample, data->offset + elapsed * OFFSET_RELAXATION);
+    data->jitter += (sample - data->offset - data->jitter) * JITTER_SMOOTHING;
+    if (data->count > 0) {
+        data->interval += (elapsed - data->interval) * JITTER_SMOOTHING;
     }
 
-    for (auto& p : otherPlayers) {
-        float progress = min((float)p->interpolationData->ticksSinceReceived / constants::NETWORK_TICKS, 1.f);
-        Vec2 interpolatedPosition = p->interpolationData->oldPosition * (1 - progress) + p->interpolationData->newPosition * progress;
+    data->push(TimedSnapshot(data->remoteTime, position, direction));
+}
+
+void NetworkData::interpolatePlayerData(float timestep) {
+    _clock += timestep;
 
-        p->player->setLoc(interpolatedPosition);
-        p->player->update();
-        if (progress >= 1.f) {
-            p->player->setIdle(true);
+    for (auto& p : _players) {
+        if (p == nullptr || p->id < 0 || p->id == _id || p->player == nullptr) continue;
+        auto& data = p->interpolationData;
+        if (data->count == 0) continue;
+
+        float target = clamp(data->interval + data->jitter * JITTER_DELAY_SCALE, MIN_PLAYOUT_DELAY, MAX_PLAYOUT_DELAY);
+        data->delay += (target - data->delay) * min(timestep * DELAY_ADAPT_RATE, 1.f);
+
+        // render time on the sender clock
+        float time = _clock - data->offset - data->delay;
+
+        const TimedSnapshot& oldest = data->at(0);
+        const TimedSnapshot& newest = data->at(data->count - 1);
+        Vec2 position;
+        Vec2 direction;
+        bool idle;
+        if (time <= oldest.time) {
+            position = oldest.position;
+            direction = oldest.direction;
+            idle = true;
+        }
+        else if (time >= newest.time) {
+            // late, dead reckon along the last direction at the last observed speed
+            position = newest.position;
+            direction = newest.direction;
+            idle = true;
+            if (data->count > 1 && !newest.direction.isNearZero()) {
+                const TimedSnapshot& previous = data->at(data->count - 2);
+                float dt = newest.time - previous.time;
+                float ahead = min(time - newest.time, MAX_EXTRAPOLATION);
+                if (dt > 0) {
+                    float speed = (newest.position - previous.position).length() / dt;
+                    position += newest.direction.getNormalization() * speed * ahead;
+                    idle = speed * dt < 1.f;
+                }
+            }
+        }
+        else {
+            unsigned i = 1;
+            while (data->at(i).time < time) ++i;
+            const TimedSnapshot& from = data->at(i - 1);
+            const TimedSnapshot& to = data->at(i);
+            float progress = to.time > from.time ? (time - from.time) / (to.time - from.time) : 1.f;
+            position = from.position * (1 - progress) + to.position * progress;
+            direction = to.direction;
+            idle = (to.position - from.position).length() < 1.f;
         }
 
-        ++p->interpolationData->ticksSinceReceived;
+        p->player->setDir(direction);
+        p->player->setLoc(position);
+        p->player->setIdle(idle);
+        p->player->update();
     }
-}
\ No newline at end of file
+}
@@ -12,6 +12,171 @@
 
 using namespace std;
 
+/**
+ * Typical size of a serialized message, used to preallocate the send buffer.
+ * Messages may be larger (e.g. the full map layout), the connection splits them.
+ */
+constexpr unsigned MAX_MESSAGE_SIZE = 255;
+
+/** Number of players in a match */
+constexpr unsigned NUM_PLAYERS = 4;
+
+/** Kinds of messages, which determine how they are delivered */
+enum MessageType : uint8_t {
+    EventMessage = 0, // lobby, map layout and win; must arrive in order
+    StateMessage = 1 // player and map state; only the newest one matters
+};
+
+/** Channel for reliable, ordered event messages */
+constexpr uint8_t EVENT_CHANNEL = 0;
+
+/** First channel for state messages; sequencing is per channel, so each sender gets its own */
+constexpr uint8_t STATE_CHANNEL = 2;
+
+/** Wire layouts of the fixed-size message blocks */
+using MetadataLayout = NetworkUtils::Layout<uint8_t, int>; // status, player id
+using LobbyLayout = NetworkUtils::Layout<int, int, int, int>; // player order
+using WinLayout = NetworkUtils::Layout<uint8_t>; // winner
+
+static_assert(MetadataLayout::size == 5, "Metadata layout changed size.");
+
+/**
+ * The player block is variable length: a length byte followed by a bit-packed
+ * delta against a snapshot the receivers have acknowledged.
+ */
+constexpr unsigned SEQ_BITS = 8; // player snapshot sequence numbers
+constexpr unsigned ACK_MASK_BITS = 8; // sequence numbers received before the latest one
+constexpr unsigned COUNT_BITS = 4; // batteries or traps
+constexpr unsigned DIRECTION_BITS = 8; // facing angle, 0 for no direction
+constexpr unsigned FIELD_BITS = 4; // changed field mask
+
+/** Bits of the millisecond timestamp on each player snapshot */
+constexpr unsigned TIME_BITS = 16;
+
+/** Number of received positions buffered per player for interpolation */
+constexpr unsigned INTERPOLATION_BUFFER = 16;
+
+/** Bounds on the playout delay remote players are rendered behind, in seconds */
+constexpr float MIN_PLAYOUT_DELAY = 0.03f;
+constexpr float MAX_PLAYOUT_DELAY = 0.3f;
+
+/** Playout delay as a multiple of the measured jitter, on top of the send interval */
+constexpr float JITTER_DELAY_SCALE = 2.5f;
+
+/** Smoothing factor for the jitter and send interval estimates */
+constexpr float JITTER_SMOOTHING = 0.1f;
+
+/** How fast the playout delay moves toward its target, per second */
+constexpr float DELAY_ADAPT_RATE = 2.0f;
+
+/** How fast the clock offset estimate is allowed to drift upward, in seconds per second */
+constexpr float OFFSET_RELAXATION = 0.01f;
+
+/** Longest a remote player is extrapolated past its last snapshot, in seconds */
+constexpr float MAX_EXTRAPOLATION = 0.25f;
+
+/** Bits of the input sequence number on each player snapshot */
+constexpr unsigned INPUT_BITS = 8;
+
+/** Number of local inputs kept for replay, must divide 1 << INPUT_BITS */
+constexpr unsigned INPUT_HISTORY = 128;
+
+/** Distance between the host and the client position before the host corrects a client, in pixels */
+constexpr float CORRECTION_THRESHOLD = 4.0f;
+
+/** Corrections larger than this are applied at once instead of smoothed, in pixels */
+constexpr float CORRECTION_SNAP_DISTANCE = 160.0f;
+
+/** Fraction of the remaining correction applied per second */
+constexpr float CORRECTION_RATE = 10.0f;
+
+/** Number of sent and received snapshots kept as delta baselines */
+constexpr unsigned SNAPSHOT_HISTORY = 32;
+
+/** Serialization ticks without hearing from a player before we stop waiting on its acks */
+constexpr unsigned PEER_TIMEOUT_TICKS = 60;
+
+/** Resolution of replicated positions, in pixels */
+constexpr float POSITION_PRECISION = 0.5f;
+
+/** Fields of a player snapshot that are sent only when they change */
+enum PlayerField : uint8_t {
+    FieldCount = 1 << 0,
+    FieldLocation = 1 << 1,
+    FieldDirection = 1 << 2,
+    FieldFlags = 1 << 3,
+    FieldAll = 0xF
+};
+
+/** A frame of local input, with the state it produced, kept until the host acknowledges it */
+struct InputRecord {
+    bool valid;
+    uint8_t seq;
+    Vec2 move;
+    Vec2 direction;
+    Vec2 location; // player location after this input
+    Vec2 velocity; // player velocity after this input
+
+    InputRecord() : valid(false), seq(0) { }
+};
+
+/** Quantized player state, as replicated over the network */
+struct PlayerSnapshot {
+    bool valid;
+    uint8_t seq;
+    uint8_t count; // batteries or traps
+    uint32_t x; // quantized location
+    uint32_t y;
+    uint8_t direction; // quantized facing angle, 0 for no direction
+    uint8_t flags; // spooked/tagged or interaction flags, one bit per player
+
+    PlayerSnapshot() : valid(false), seq(0), count(0), x(0), y(0), direction(0), flags(0) { }
+
+    /** @return mask of the fields that differ from the baseline */
+    uint8_t diff(const PlayerSnapshot& base) const {
+        uint8_t mask = 0;
+        if (count != base.count) mask |= FieldCount;
+        if (x != base.x || y != base.y) mask |= FieldLocation;
+        if (direction != base.direction) mask |= FieldDirection;
+        if (flags != base.flags) mask |= FieldFlags;
+        return mask;
+    }
+};
+
+/** Delta replication state for one player */
+struct ReplicationData {
+    /** Snapshots received from this player, indexed by sequence number */
+    array<PlayerSnapshot, SNAPSHOT_HISTORY> received;
+    /** Latest sequence number received from this player, -1 if none */
+    int lastReceived;
+    /** Latest of our sequence numbers this player acknowledged, -1 if none */
+    int acked;
+    /** Which of the ACK_MASK_BITS sequence numbers before acked this player also received */
+    uint8_t ackMask;
+    /** Serialization tick at which we last heard from this player, -1 if never */
+    int lastHeard;
+
+    /** Latest input sequence number this player reported, -1 if none */
+    int lastInput;
+    /** Location this player reported with that input */
+    Vec2 reportedLocation;
+    /** Whether the host holds this player in place, e.g. because it is spooked */
+    bool frozen;
+    /** Where the host holds this player */
+    Vec2 frozenLocation;
+
+    ReplicationData() : lastReceived(-1), acked(-1), ackMask(0), lastHeard(-1),
+        lastInput(-1), frozen(false) { }
+
+    /** @return whether this player acknowledged our snapshot with the given sequence number */
+    bool hasAcked(uint8_t seq) const {
+        if (acked < 0) return false;
+        uint8_t age = (uint8_t)acked - seq;
+        if (age == 0) return true;
+        return age <= ACK_MASK_BITS && (ackMask & (1 << (age - 1)));
+    }
+};
+
 /** Metadata */
 struct NetworkMetadata {
     uint8_t status;
@@ -32,16 +197,53 @@ struct LobbyData {
     }
 };
 
+/** A received player position, stamped with the sender's clock */
+struct TimedSnapshot {
+    float time; // sender time, in seconds
+    Vec2 position;
+    Vec2 direction;
+
+    TimedSnapshot() : time(0), position(Vec2::ZERO), direction(Vec2::ZERO) { }
+    TimedSnapshot(float time, Vec2 position, Vec2 direction) : time(time), position(position), direction(direction) { }
+};
+
 /** Data used for player interpolation */
 struct InterpolationData {
-    unsigned ticksSinceReceived;
-    Vec2 oldPosition;
-    Vec2 newPosition;
+    /** Received positions in a ring, oldest at head */
+    array<TimedSnapshot, INTERPOLATION_BUFFER> snapshots;
+    unsigned head;
+    unsigned count;
+
+    /** Last received timestamp, used to unwrap the sender clock */
+    uint16_t lastStamp;
+    /** Unwrapped sender clock at the last received snapshot, in seconds */
+    float remoteTime;
+
+    /** Estimated local minus sender clock, tracking the fastest transit seen */
+    float offset;
+    /** Smoothed transit time above the fastest one, in seconds */
+    float jitter;
+    /** Smoothed time between snapshots, in seconds */
+    float interval;
+    /** Current playout delay, in seconds */
+    float delay;
+
+    InterpolationData() : head(0), count(0), lastStamp(0), remoteTime(0), offset(0), jitter(0),
+        interval(0), delay(MAX_PLAYOUT_DELAY) { }
+
+    /** @return the i-th oldest snapshot */
+    const TimedSnapshot& at(unsigned i) const {
+        return snapshots[(head + i) % INTERPOLATION_BUFFER];
+    }
 
-    InterpolationData(Vec2 pos) {
-        this->ticksSinceReceived = 0;
-        this->oldPosition = pos;
-        this->newPosition = pos;
+    /** Adds a snapshot, overwriting the oldest one if the ring is full */
+    void push(const TimedSnapshot& snapshot) {
+        if (count == INTERPOLATION_BUFFER) {
+            head = (head + 1) % INTERPOLATION_BUFFER;
+            --count;
+        }
+        snapshots[(head + count) % INTERPOLATION_BUFFER] = snapshot;
+        ++count;
     }
 };
 
@@ -50,23 +252,27 @@ struct PlayerData {
     int id; // Player id
     shared_ptr<Player> player; // NetworkData does not own this player
     shared_ptr<InterpolationData> interpolationData;
+    shared_ptr<ReplicationData> replicationData;
 
     PlayerData(int id, shared_ptr<Player>& player) {
         this->id = id;
         this->player = player;
-        this->interpolationData = make_shared<InterpolationData>(player->getLoc());
+        this->interpolationData = make_shared<InterpolationData>();
+        this->replicationData = make_shared<ReplicationData>();
     }
-    ~PlayerData() { player = nullptr; interpolationData = nullptr; };
+    ~PlayerData() { player = nullptr; interpolationData = nullptr; replicationData = nullptr; };
 };
 
 /** Map data */
 struct MapData {
     shared_ptr<GameMap> map;
-    bool generated;
+    bool generated; // the layout was received from the host
+    bool layoutPending; // the layout needs to be sent to the other players
 
     MapData(shared_ptr<GameMap>& map) {
         this->map = map;
         this->generated = false;
+        this->layoutPending = true;
     }
     ~MapData() { map = nullptr; };
 };
@@ -107,32 +313,79 @@ private:
     /** Win data */
     shared_ptr<WinData> _winData;
 
-    /** Convert metadata */
-    vector<uint8_t> convertMetadata();
-    shared_ptr<NetworkMetadata> interpretMetadata(const vector<uint8_t>& metadata);
+    /** Send buffer, reused across ticks so serialization does not allocate */
+    vector<uint8_t> _buffer;
+
+    /** Map layout received from the host before a game map was attached */
+    shared_ptr<MapNetworkdata> _receivedLayout;
+
+    /** Scratch list of received trap positions, reused across ticks */
+    vector<Vec2> _trapPositions;
+
+    /** Number of messages serialized so far */
+    unsigned _tick;
+
+    /** Local clock, in seconds, advanced by interpolatePlayerData */
+    float _clock;
+
+    /** Records a received position for interpolation */
+    void bufferPlayerData(const shared_ptr<PlayerData>& playerData, uint16_t stamp, const Vec2& position, const Vec2& direction);
+
+    /** Sequence number of the next player snapshot we send */
+    uint8_t _seq;
+
+    /** Player snapshots we sent, indexed by sequence number */
+    array<PlayerSnapshot, SNAPSHOT_HISTORY> _sent;
+
+    /** Local inputs, indexed by sequence number */
+    array<InputRecord, INPUT_HISTORY> _inputs;
+
+    /** Sequence number of the next local input */
+    uint8_t _inputSeq;
+
+    /** Correction still to be applied to the local player */
+    Vec2 _correction;
+
+    /**
+     * Rewinds the local player to where the host has it at the given input
+     * and replays the inputs since, through the same movement code.
+     */
+    void reconcile(uint8_t input, const Vec2& location);
+
+    /** Computes the quantization range and bit width for positions on the current map */
+    unsigned getPositionQuantization(Rect& bounds);
+
+    /** @return the newest sent snapshot every active player has acknowledged, or nullptr */
+    const PlayerSnapshot* findBaseline();
+
+    /** Convert and interpret metadata */
+    bool convertMetadata(NetworkUtils::Writer& out);
+    NetworkMetadata interpretMetadata(NetworkUtils::Reader& in);
 
     /** Convert and interpret lobby data */
-    vector<uint8_t> convertLobbyData();
-    void interpretLobbyData(const int id, const vector<uint8_t>& lobbyData);
+    void convertLobbyData(NetworkUtils::Writer& out);
+    void interpretLobbyData(const int id, NetworkUtils::Reader& in);
 
-    /** Convert and interpret map layout data */
-    vector<uint8_t> convertMapLayoutData();
-    void interpretMapLayoutData(const int id, const vector<uint8_t>& mapLayoutData);
+    /** Convert and interpret map layout data (false if the data is malformed) */
+    void convertMapLayoutData(NetworkUtils::Writer& out);
+    bool interpretMapLayoutData(const int id, NetworkUtils::Reader& in);
 
     /** Convert and interpret player data */
-    vector<uint8_t> convertPlayerData();
-    void interpretPlayerData(const int id, const vector<uint8_t>& playerData);
+    void convertPlayerData(NetworkUtils::Writer& out);
+    void interpretPlayerData(const int id, NetworkUtils::Reader& in);
 
-    /** Convert and interpret map data */
-    vector<uint8_t> convertMapData();
-    void interpretMapData(const int id, const vector<uint8_t>& mapData);
+    /** Convert and interpret map data (false if the data is malformed) */
+    void convertMapData(NetworkUtils::Writer& out);
+    bool interpretMapData(const int id, NetworkUtils::Reader& in);
 
     /** Convert and interpret win data */
-    vector<uint8_t> convertWinData();
-    void interpretWinData(const int id, const vector<uint8_t>& winData);
+    void convertWinData(NetworkUtils::Writer& out);
+    void interpretWinData(const int id, NetworkUtils::Reader& in);
 
 public:
-    NetworkData() : _id(-1), _name("Player"), _hostID(0), _status(constants::MatchStatus::None) { };
+    NetworkData() : _id(-1), _name("Player"), _hostID(0), _status(constants::MatchStatus::None), _tick(0), _clock(0), _seq(0), _inputSeq(0) {
+        _buffer.reserve(MAX_MESSAGE_SIZE);
+    };
 
     ~NetworkData() { dispose(); };
 
@@ -141,6 +394,7 @@ public:
         _players.clear();
         _winData = nullptr;
         _mapData = nullptr;
+        _receivedLayout = nullptr;
     }
 
     /** @return main player */
@@ -170,9 +424,9 @@ public:
 
     /** Set players as player data vector */
     void setPlayers(vector<shared_ptr<Player>> players) {
-        CUAssertLog(players.size() == 4, "Players vector is not size 4.");
-        _players = vector<shared_ptr<PlayerData>>(4, nullptr);
-        for (int i = 0; i < 4; ++i) {
+        CUAssertLog(players.size() == NUM_PLAYERS, "Players vector is not size 4.");
+        _players = vector<shared_ptr<PlayerData>>(NUM_PLAYERS, nullptr);
+        for (unsigned i = 0; i < NUM_PLAYERS; ++i) {
             if (players[i] != nullptr) {
                 if (_lobbyData != nullptr) {
                     _players[i] = make_shared<PlayerData>(i, players[_lobbyData->playerOrder[i]]);
@@ -190,9 +444,25 @@ public:
         return _mapData->map;
     }
 
-    /** Set game map */
+    /** Set game map, applying the host's layout if it already arrived */
     void setGameMap(shared_ptr<GameMap> gameMap) {
+        if (_mapData != nullptr && _mapData->map == gameMap) return;
         _mapData = make_shared<MapData>(gameMap);
+        if (_receivedLayout != nullptr && gameMap != nullptr) {
+            _mapData->generated = gameMap->readNetworkMap(_receivedLayout);
+            _receivedLayout = nullptr;
+        }
+    }
+
+    /** Sends the full map layout again with the next lobby message, e.g. when a player joins */
+    void requestMapLayout() {
+        if (_mapData != nullptr) _mapData->layoutPending = true;
+    }
+
+    /** @return whether the game map holds the match layout, generated locally by the host or received from it */
+    bool hasMapLayout() {
+        if (_id == _hostID) return _mapData != nullptr && _mapData->map != nullptr;
+        return _mapData != nullptr && _mapData->generated;
     }
 
     /** @return match status */
@@ -205,6 +475,11 @@ public:
         _status = status;
     }
 
+    /** @return the kind of message serializeData produces for the current match status */
+    MessageType getMessageType() {
+        return _status == constants::MatchStatus::InProgress ? StateMessage : EventMessage;
+    }
+
     /** @return winner */
     constants::PlayerType getWinner() {
         if (_winData == nullptr) return constants::PlayerType::Undefined;
@@ -217,13 +492,34 @@ public:
         _winData->winner = winner;
     }
 
-    /** Serialize game data */
-    vector<uint8_t> serializeData();
+    /**
+     * Serialize game data
+     *
+     * The returned buffer is owned by this object and is overwritten by the
+     * next call.
+     */
+    const vector<uint8_t>& serializeData();
 
     /** Unserialize game data */
     void unserializeData(const vector<uint8_t>& msg);
 
-    /** Interpolate player data using interpolation data */
-    void interpolatePlayerData();
+    /**
+     * Records the local input applied this frame, and eases in any pending
+     * correction from the host.
+     *
+     * Call once per frame, after the local player has moved.
+     */
+    void recordInput(const Vec2& move, const Vec2& direction, float timestep);
+
+    /**
+     * Interpolate player data using interpolation data
+     *
+     * Remote players are drawn a playout delay behind the newest snapshot,
+     * which adapts to the measured jitter. If snapshots are late, players are
+     * extrapolated along their last direction for a bounded amount of time.
+     *
+     * @param timestep  The amount of time (in seconds) since the last frame
+     */
+    void interpolatePlayerData(float timestep);
 };
 #endif /** __NETWORK_DATA_H__ */
\ No newline at end of file
@@ -11,179 +11,246 @@ constexpr float FLOAT_PRECISION = 100.0f;
 using namespace cugl;
 using namespace std;
 
-/** Functions to convert data types to byte vectors */
+/** Functions to convert data types to and from bytes */
 namespace NetworkUtils {
-    /** Split byte vector at certain points */
-    inline vector<vector<uint8_t>> split(const vector<uint8_t>& bytes, const vector<unsigned>& sizes) {
-        bool raiseError = false;
-        int index = 0;
-        for (auto& size : sizes) {
-            index += size;
-            if (bytes.size() < index) {
-                raiseError = true;
-            }
+    /** Number of bytes a value of type T occupies on the wire */
+    template <typename T> struct WireSize;
+    template <> struct WireSize<uint8_t> { static constexpr unsigned value = 1; };
+    template <> struct WireSize<bool> { static constexpr unsigned value = 1; };
+    template <> struct WireSize<int> { static constexpr unsigned value = 4; };
+    template <> struct WireSize<float> { static constexpr unsigned value = 4; };
+    template <> struct WireSize<Vec2> { static constexpr unsigned value = 8; };
+
+    /** Compile-time layout of a fixed-size block, listed in wire order */
+    template <typename... Fields>
+    struct Layout {
+        static constexpr unsigned size = (WireSize<Fields>::value + ... + 0);
+    };
+
+    /**
+     * Cursor-based writer that appends to a caller-owned byte buffer.
+     *
+     * The buffer is cleared (not freed) on construction, so reusing the same
+     * buffer every tick does not allocate once it has reached its peak size.
+     */
+    class Writer {
+    private:
+        vector<uint8_t>& _out;
+
+    public:
+        Writer(vector<uint8_t>& out) : _out(out) { _out.clear(); }
+
+        /** @return number of bytes written so far */
+        size_t size() const { return _out.size(); }
+
+        /** Overwrites a byte that was already written, e.g. a length prefix */
+        void setByte(size_t pos, uint8_t b) {
+            CUAssertLog(pos < _out.size(), "setByte: Position is past the end of the buffer.");
+            _out[pos] = b;
         }
-        vector<vector<uint8_t>> result;
-        if (raiseError) {
-            CULogError("Byte vector is too small. Byte vector size: %d. Expected size: %d.", bytes.size(), index);
-            return result;
+
+        // byte (1 byte)
+        void writeByte(uint8_t b) {
+            _out.push_back(b);
         }
-        index = 0;
-        for (auto& size : sizes) {
-            result.push_back(vector(bytes.begin() + index, bytes.begin() + index + size));
-            index += size;
+
+        // bool (1 byte)
+        void writeBool(bool b) {
+            _out.push_back(b);
         }
-        if (index != bytes.size()) {
-            result.push_back(vector(bytes.begin() + index, bytes.begin() + bytes.size()));
+
+        // int (4 bytes)
+        // adapted from https://os.mbed.com/forum/helloworld/topic/2053/?page=1#comment-54126
+        void writeInt(int i) {
+            int temp = marshall(i);
+            _out.push_back((temp >> 24) & 0xFF);
+            _out.push_back((temp >> 16) & 0xFF);
+            _out.push_back((temp >> 8) & 0xFF);
+            _out.push_back(temp & 0xFF);
         }
-        return result;
-    }
 
-    // byte (1 byte)
-    inline void encodeByte(uint8_t b, vector<uint8_t>& out) {
-        out.push_back(b);
-    }
+        // float (4 bytes)
+        void writeFloat(float f) {
+            writeInt(static_cast<int>(f * FLOAT_PRECISION));
+        }
 
-    inline uint8_t decodeByte(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() == 1, "decodeByte: Byte vector size is not equal to data type size.");
-        return bytes[0];
-    }
+        // Vec2 (8 bytes)
+        void writeVector(const Vec2& v) {
+            writeFloat(v.x);
+            writeFloat(v.y);
+        }
+    };
 
-    // bool (1 byte)
-    inline void encodeBool(bool b, vector<uint8_t>& out) {
-        out.push_back(b);
-    }
+    /**
+     * Cursor-based reader that decodes in place from a byte range.
+     *
+     * Reading past the end of the range does not assert. It returns zero
+     * values and marks the reader as failed, so callers can decode a whole
+     * block and check {@link #ok} once at the end.
+     */
+    class Reader {
+    private:
+        const uint8_t* _data;
+        size_t _size;
+        size_t _pos;
+        bool _ok;
 
-    inline bool decodeBool(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() == 1, "decodeBool: Byte vector size is not equal to data type size.");
-        return (bool)bytes[0];
-    }
+        /** Reserves n bytes at the cursor, returning nullptr on overrun */
+        const uint8_t* take(size_t n) {
+            if (!_ok || _pos + n > _size) {
+                _ok = false;
+                return nullptr;
+            }
+            const uint8_t* result = _data + _pos;
+            _pos += n;
+            return result;
+        }
 
-    // int (4 bytes)
-    // adapted from https://os.mbed.com/forum/helloworld/topic/2053/?page=1#comment-54126
-    inline void encodeInt(int i, vector<uint8_t>& out) {
-        int temp = marshall(i);
-        unsigned char bytes[4];
-        bytes[0] = (temp >> 24) & 0xFF;
-        bytes[1] = (temp >> 16) & 0xFF;
-        bytes[2] = (temp >> 8) & 0xFF;
-        bytes[3] = temp & 0xFF;
-        out.insert(out.end(), begin(bytes), end(bytes));
-    }
+    public:
+        Reader(const uint8_t* data, size_t size) : _data(data), _size(size), _pos(0), _ok(true) { }
 
-    inline int decodeInt(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() == sizeof(int), "decodeInt: Byte vector size is not equal to data type size.");
-        int32_t i = (bytes[0] << 24) + (bytes[1] << 16) + (bytes[2] << 8) + bytes[3];
-        return marshall(i);
-    }
+        Reader(const vector<uint8_t>& bytes) : Reader(bytes.data(), bytes.size()) { }
 
-    // float (4 bytes)
-    inline void encodeFloat(float f, vector<uint8_t>& out) {
-        encodeInt(static_cast<int>(f * FLOAT_PRECISION), out);
-    }
+        /** @return whether every read so far was in range */
+        bool ok() const { return _ok; }
 
-    inline float decodeFloat(const vector<uint8_t>& bytes) {
-        return static_cast<float>(decodeInt(bytes)) / FLOAT_PRECISION;
-    }
+        /** Marks the reader as failed, for data that is in range but malformed */
+        void fail() { _ok = false; }
 
-    // Vec2 (8 bytes)
-    inline void encodeVector(const Vec2& v, vector<uint8_t>& out) {
-        encodeFloat(v.x, out);
-        encodeFloat(v.y, out);
-    }
+        /** @return number of unread bytes */
+        size_t remaining() const { return _ok ? _size - _pos : 0; }
 
-    inline Vec2 decodeVector(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() == 2 * sizeof(float), "decodeVector: Byte vector size is not equal to data type size.");
-        vector<vector<uint8_t>> splitBytes = split(bytes, { 4, 4 });
-        return Vec2(decodeFloat(splitBytes[0]), decodeFloat(splitBytes[1]));
-    }
+        /** @return whether a block with layout L can be read at the cursor */
+        template <typename L>
+        bool has() const { return remaining() >= L::size; }
+
+        /** Skips n bytes */
+        void skip(size_t n) { take(n); }
 
-    // int vector (variable bytes)
-    inline void encodeIntList(const vector<int>& list, vector<uint8_t>& out) {
-        encodeInt((int)list.size(), out);
-        for (auto element : list) {
-            encodeInt(element, out);
+        /** Splits off the next n bytes as their own reader and skips past them */
+        Reader sub(size_t n) {
+            const uint8_t* b = take(n);
+            Reader result(b, b == nullptr ? 0 : n);
+            result._ok = b != nullptr;
+            return result;
         }
-    }
 
-    inline vector<int> decodeIntList(int length, const vector<uint8_t>& bytes) { // needs to be defined before decodeList(bytes)
-        CUAssertLog(bytes.size() == length * sizeof(int), "decodeIntList2: Byte vector size is not equal to data type size.");
-        vector<vector<uint8_t>> subdividedList;
-        for (unsigned i = 0; i < bytes.size(); i+=4) {
-            subdividedList.push_back(vector(bytes.begin() + i, bytes.begin() + i + 4));
+        // byte (1 byte)
+        uint8_t readByte() {
+            const uint8_t* b = take(1);
+            return b == nullptr ? 0 : b[0];
         }
-        vector<int> result;
-        for (auto& encodedInt : subdividedList) {
-            result.push_back(decodeInt(encodedInt));
+
+        // bool (1 byte)
+        bool readBool() {
+            return readByte() != 0;
         }
-        return result;
-    }
 
-    inline vector<int> decodeIntList(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() > sizeof(int), "decodeIntList1: Byte vector size is not equal to data type size.");
-        vector<uint8_t> encodedLength(bytes.begin(), bytes.begin() + 4);
-        int length = decodeInt(encodedLength);
-        return decodeIntList(length, vector(bytes.begin() + 4, bytes.begin() + bytes.size()));
-    }
+        // int (4 bytes)
+        int readInt() {
+            const uint8_t* b = take(4);
+            if (b == nullptr) return 0;
+            int32_t i = (b[0] << 24) + (b[1] << 16) + (b[2] << 8) + b[3];
+            return marshall(i);
+        }
 
-    // bool vector (variable bytes)
-    inline void encodeBoolList(const vector<bool>& list, vector<uint8_t>& out) {
-        encodeInt((int)list.size(), out);
-        for (auto element : list) {
-            encodeBool(element, out);
+        // float (4 bytes)
+        float readFloat() {
+            return static_cast<float>(readInt()) / FLOAT_PRECISION;
         }
-    }
 
-    inline vector<bool> decodeBoolList(int length, const vector<uint8_t>& bytes) { // needs to be defined before decodeList(bytes)
-        CUAssertLog(bytes.size() == length, "decodeBoolList2: Byte vector size is not equal to data type size.");
-        vector<vector<uint8_t>> subdividedList;
-        for (unsigned i = 0; i < bytes.size(); i += 1) {
-            subdividedList.push_back(vector(bytes.begin() + i, bytes.begin() + i + 1));
+        // Vec2 (8 bytes)
+        Vec2 readVector() {
+            float x = readFloat();
+            float y = readFloat();
+            return Vec2(x, y);
         }
-        vector<bool> result;
-        for (auto& encodedBool : subdividedList) {
-            result.push_back(decodeBool(encodedBool));
+    };
+
+    /** Packs values of arbitrary bit width, most significant bit first */
+    class BitWriter {
+    private:
+        Writer& _out;
+        uint32_t _acc;
+        unsigned _bits;
+
+    public:
+        BitWriter(Writer& out) : _out(out), _acc(0), _bits(0) { }
+
+        /** Writes the low `bits` bits of value (at most 24 bits per call) */
+        void write(uint32_t value, unsigned bits) {
+            CUAssertLog(bits <= 24, "BitWriter: Too many bits in one write.");
+            _acc = (_acc << bits) | (value & ((1u << bits) - 1));
+            _bits += bits;
+            while (_bits >= 8) {
+                _bits -= 8;
+                _out.writeByte((_acc >> _bits) & 0xFF);
+            }
         }
-        return result;
-    }
 
-    inline vector<bool> decodeBoolList(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() > sizeof(int), "decodeBoolList1: Byte vector size is not equal to data type size.");
-        vector<uint8_t> encodedLength(bytes.begin(), bytes.begin() + 4);
-        int length = decodeInt(encodedLength);
-        return decodeBoolList(length, vector(bytes.begin() + 4, bytes.begin() + bytes.size()));
-    }
+        void writeBool(bool b) {
+            write(b ? 1 : 0, 1);
+        }
 
-    // Vec2 vector (variable bytes)
-    inline void encodeVec2List(const vector<Vec2>& list, vector<uint8_t>& out) {
-        encodeInt((int)list.size(), out);
-        for (auto& element : list) {
-            encodeVector(element, out);
+        /** Writes any remaining bits, padding the last byte with zeros */
+        void flush() {
+            if (_bits > 0) {
+                _out.writeByte((_acc << (8 - _bits)) & 0xFF);
+            }
+            _acc = 0;
+            _bits = 0;
         }
-    }
+    };
+
+    /** Unpacks values written by a BitWriter */
+    class BitReader {
+    private:
+        Reader& _in;
+        uint32_t _acc;
+        unsigned _bits;
+
+    public:
+        BitReader(Reader& in) : _in(in), _acc(0), _bits(0) { }
 
-    inline vector<Vec2> decodeVec2List(int length, const vector<uint8_t>& bytes) { // needs to be defined before decodeList(bytes)
-        CUAssertLog(bytes.size() == length * 2 * sizeof(float), "decodeVec2List2: Byte vector size is not equal to data type size.");
-        vector<vector<uint8_t>> subdividedList;
-        for (unsigned i = 0; i < bytes.size(); i += 8) {
-            subdividedList.push_back(vector(bytes.begin() + i, bytes.begin() + i + 8));
+        /** Reads a value of the given bit width (at most 24 bits per call) */
+        uint32_t read(unsigned bits) {
+            while (_bits < bits) {
+                _acc = (_acc << 8) | _in.readByte();
+                _bits += 8;
+            }
+            _bits -= bits;
+            return (_acc >> _bits) & ((1u << bits) - 1);
         }
-        vector<Vec2> result;
-        for (auto& encodedVec2 : subdividedList) {
-            result.push_back(decodeVector(encodedVec2));
+
+        bool readBool() {
+            return read(1) != 0;
         }
-        return result;
-    }
 
-    inline vector<Vec2> decodeVec2List(const vector<uint8_t>& bytes) {
-        CUAssertLog(bytes.size() > sizeof(int), "decodeVec2List1: Byte vector size is not equal to data type size.");
-        auto splitBytes = split(bytes, { 4 });
-        int length = decodeInt(splitBytes[0]);
-        vector<Vec2> result;
-        if (length == 0) {
-            return result;
+        /** @return whether every read so far was in range */
+        bool ok() const { return _in.ok(); }
+    };
+
+    /** @return the number of bits needed to store values in [0, maxValue] */
+    inline unsigned bitsFor(uint32_t maxValue) {
+        unsigned bits = 1;
+        while (bits < 24 && (maxValue >> bits) != 0) {
+            ++bits;
         }
-        return decodeVec2List(length, splitBytes[1]);
+        return bits;
+    }
+
+    /** Maps v in [min, max] onto an integer with the given number of bits */
+    inline uint32_t quantize(float v, float min, float max, unsigned bits) {
+        uint32_t steps = (1u << bits) - 1;
+        float t = (max > min) ? (v - min) / (max - min) : 0;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+        return static_cast<uint32_t>(t * steps + 0.5f);
+    }
+
+    /** Inverse of quantize */
+    inline float dequantize(uint32_t q, float min, float max, unsigned bits) {
+        uint32_t steps = (1u << bits) - 1;
+        return min + (max - min) * (static_cast<float>(q) / steps);
     }
 };
-#endif /** __NETWORK_UTILS_H__ */
\ No newline at end of file
+#endif /** __NETWORK_UTILS_H__ */
@@ -0,0 +1,87 @@
+#include "ProfilerOverlay.h"
+
+using namespace std;
+using namespace cugl;
+
+bool ProfilerOverlay::init(const shared_ptr<Font>& font) {
+    if (font == nullptr) return false;
+    Size size = Application::get()->getDisplaySize();
+    _camera = OrthographicCamera::alloc(size);
+    _root = scene2::SceneNode::alloc();
+    _root->setScale(constants::PROFILER_TEXT_SCALE);
+    _root->setPosition(Vec2(8, size.height - 8));
+    _font = font;
+    _elapsed = constants::PROFILER_REFRESH;
+    return true;
+}
+
+void ProfilerOverlay::update(float timestep) {
+    _elapsed += timestep;
+    if (_elapsed < constants::PROFILER_REFRESH) return;
+    _elapsed = 0;
+    rebuild();
+}
+
+/** Returns printf style text */
+static string format(const char* pattern, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, pattern);
+    vsnprintf(buffer, sizeof(buffer), pattern, args);
+    va_end(args);
+    return buffer;
+}
+
+void ProfilerOverlay::rebuild() {
+    Profiler* profiler = Profiler::get();
+    if (profiler == nullptr) return;
+
+    vector<string> text;
+    text.push_back(format("frame %.2f ms (last %.2f)%s", profiler->getAverageFrameTime() / 1000,
+                          profiler->getFrameTime() / 1000, profiler->isCapturing() ? "  [capturing]" : ""));
+    text.push_back(format("draws %.0f  verts %.0f  states %.0f  allocs %.0f",
+                          profiler->getAverageCount(Profiler::Counter::DRAW_CALLS),
+                          profiler->getAverageCount(Profiler::Counter::VERTICES),
+                          profiler->getAverageCount(Profiler::Counter::STATE_CHANGES),
+                          profiler->getAverageCount(Profiler::Counter::ALLOCATIONS)));
+    if (!_note.empty()) {
+        text.push_back(_note);
+    }
+    for (auto& stat : profiler->getStats()) {
+        if (!stat.gpu && strcmp(stat.name, "frame") == 0) continue;
+        text.push_back(format("%s%s %.2f ms", stat.gpu ? "gpu " : "", stat.name, stat.average / 1000));
+    }
+    if (profiler->getDroppedZones() > 0) {
+        text.push_back(format("dropped %llu zones", (unsigned long long)profiler->getDroppedZones()));
+    }
+
+    // reuse the labels, growing the list as zones appear
+    float y = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (i == _lines.size()) {
+            auto label = scene2::Label::alloc(text[i], _font);
+            label->setAnchor(Vec2::ANCHOR_TOP_LEFT);
+            label->setForeground(Color4::WHITE);
+            label->setBackground(Color4(0, 0, 0, 160));
+            _root->addChild(label);
+            _lines.push_back(label);
+        }
+        else {
+            _lines[i]->setText(text[i], true);
+        }
+        _lines[i]->setPosition(Vec2(0, y));
+        _lines[i]->setVisible(true);
+        y -= _font->getHeight();
+    }
+    for (size_t i = text.size(); i < _lines.size(); ++i) {
+        _lines[i]->setVisible(false);
+    }
+}
+
+void ProfilerOverlay::render(const shared_ptr<SpriteBatch>& batch) {
+    batch->begin(_camera->getCombined());
+    batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    batch->setBlendEquation(GL_FUNC_ADD);
+    _root->render(batch);
+    batch->end();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef __PROFILER_OVERLAY_H__
+#define __PROFILER_OVERLAY_H__
+#include <cugl/cugl.h>
+#include "Constants.h"
+
+using namespace std;
+using namespace cugl;
+
+/**
+ * On-screen table of the profiler timings and counters.
+ *
+ * The table shows the running averages kept by cugl::Profiler, one line
+ * per zone. The text is only rebuilt a few times a second, so the overlay
+ * adds little to the frame it measures.
+ */
+class ProfilerOverlay {
+private:
+    /** The camera for the overlay, in screen coordinates */
+    shared_ptr<OrthographicCamera> _camera;
+    /** The parent of the lines, which scales the font down */
+    shared_ptr<scene2::SceneNode> _root;
+    /** The font of the lines */
+    shared_ptr<Font> _font;
+    /** One label per line of the table */
+    vector<shared_ptr<scene2::Label>> _lines;
+    /** Seconds since the text was rebuilt */
+    float _elapsed;
+    /** Extra line from the application, shown under the counters */
+    string _note;
+
+    /** Rebuilds the text from the profiler */
+    void rebuild();
+
+public:
+    /** Creates the overlay for the current display, with the given font */
+    bool init(const shared_ptr<Font>& font);
+
+    static shared_ptr<ProfilerOverlay> alloc(const shared_ptr<Font>& font) {
+        auto result = make_shared<ProfilerOverlay>();
+        return result->init(font) ? result : nullptr;
+    }
+
+    /** Sets an extra line to show under the counters (empty for none) */
+    void setNote(const string& note) { _note = note; }
+
+    /** Rebuilds the text when it is due */
+    void update(float timestep);
+
+    /** Draws the table in the top left corner of the screen */
+    void render(const shared_ptr<SpriteBatch>& batch);
+};
+
+#endif /** __PROFILER_OVERLAY_H__ */
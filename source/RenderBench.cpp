@@ -0,0 +1,138 @@
+//
+//  RenderBench.cpp
+//
+//  Entry point for the sprite batch benchmark. This is the ghosted-renderbench
+//  target in build-linux, which builds the game sources with
+//  GHOSTED_RENDER_BENCH defined in place of main.cpp. It opens a window, since
+//  it measures the GL uploads.
+//
+//      ghosted-renderbench [--frames N]
+//
+//  Every frame draws a few passes of quads with a flush every few hundred
+//  quads, like the lit, dim and top passes of the game scene. The first half
+//  of the run reloads one buffer per flush with glBufferData, the way
+//  SpriteBatch used to, and the second half streams through the fenced ring.
+//  Upload bytes and stall time per frame are logged for both.
+//
+#ifdef GHOSTED_RENDER_BENCH
+
+#include <cugl/cugl.h>
+
+using namespace std;
+using namespace cugl;
+
+/** Number of passes per frame */
+constexpr unsigned BENCH_PASSES = 3;
+/** Number of quads per pass */
+constexpr unsigned BENCH_QUADS = 6000;
+/** Number of quads between flushes, standing in for shader and target changes */
+constexpr unsigned BENCH_FLUSH = 500;
+/** Number of frames drawn before measuring, so that buffers have grown */
+constexpr unsigned BENCH_WARMUP = 60;
+
+/** Per-frame totals for one upload path */
+struct StreamStats {
+    unsigned frames = 0;
+    Uint64 bytes = 0;
+    Uint64 stall = 0;
+    Uint64 worst = 0;
+
+    void add(Uint64 frameBytes, Uint64 frameStall) {
+        ++frames;
+        bytes += frameBytes;
+        stall += frameStall;
+        worst = max(worst, frameStall);
+    }
+
+    void report(const char* name) const {
+        if (frames == 0) return;
+        CULog("%s %.1f KB uploaded, %.1f us stalled per frame (worst %llu us)", name,
+              bytes / 1024.0 / frames, (double)stall / frames, (unsigned long long)worst);
+    }
+};
+
+/** An application that draws synthetic passes and measures the uploads */
+class RenderBench : public Application {
+private:
+    shared_ptr<OrthographicCamera> _camera;
+    shared_ptr<SpriteBatch> _batch;
+
+    /** Number of frames measured per path */
+    unsigned _frames;
+    /** Number of frames drawn so far */
+    unsigned _frame;
+    /** Totals for glBufferData and the buffer ring */
+    StreamStats _reload, _ring;
+
+public:
+    RenderBench(unsigned frames) : _frames(frames), _frame(0) { }
+
+    void onStartup() override {
+        _camera = OrthographicCamera::alloc(getDisplaySize());
+        _batch = SpriteBatch::alloc();
+        setClearColor(Color4::BLACK);
+        Application::onStartup();
+    }
+
+    void onShutdown() override {
+        _batch = nullptr;
+        _camera = nullptr;
+        Application::onShutdown();
+    }
+
+    void draw() override {
+        // Each path warms up before it is measured
+        unsigned phase = _frame / (BENCH_WARMUP + _frames);
+        unsigned step = _frame % (BENCH_WARMUP + _frames);
+        if (phase > 1) {
+            _reload.report("glBufferData:");
+            _ring.report("buffer ring: ");
+            quit();
+            return;
+        }
+        _batch->setStreaming(phase == 1);
+
+        Size size = getDisplaySize();
+        for (unsigned pass = 0; pass < BENCH_PASSES; ++pass) {
+            _batch->begin(_camera->getCombined());
+            for (unsigned i = 0; i < BENCH_QUADS; ++i) {
+                float x = (float)((i * 37 + _frame * 3) % (int)size.width);
+                float y = (float)((i * 91 + pass * 17) % (int)size.height);
+                _batch->setColor(Color4f((i % 7) / 7.0f, (pass + 1) / 4.0f, (i % 3) / 3.0f, 0.5f));
+                _batch->fill(Rect(x, y, 8, 8), Vec2::ZERO);
+                if ((i + 1) % BENCH_FLUSH == 0) _batch->flush();
+            }
+            _batch->end();
+        }
+
+        if (step >= BENCH_WARMUP) {
+            (phase == 0 ? _reload : _ring).add(_batch->getBytesUploaded(), _batch->getStallTime());
+        }
+        _batch->resetStreamStats();
+        ++_frame;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    unsigned frames = 600;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(argv[i]) == "--frames") frames = stoi(argv[++i]);
+    }
+
+    RenderBench app(frames);
+    app.setName("Ghosted Render Bench");
+    app.setOrganization("Star Soup Games");
+    app.setSize(1024, 576);
+    // uncapped, so the stalls are not hidden by the frame limiter
+    app.setFPS(1000.0f);
+
+    if (!app.init()) {
+        return 1;
+    }
+    app.onStartup();
+    while (app.step());
+    app.onShutdown();
+    return 0;
+}
+
+#endif /** GHOSTED_RENDER_BENCH */
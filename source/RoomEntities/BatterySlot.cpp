@@ -10,14 +10,12 @@ void BatterySlot::setNode(const shared_ptr<scene2::PolygonNode>& nodeOn, const s
 void BatterySlot::update(float timestep) {
     RoomEntity::update(timestep);
     if (_charge > 0) {
-        _nodeOn->setVisible(true);
-        _nodeOff->setVisible(false);
         _charge -= timestep;
         _activate = false;
     }
-    else {
-        _nodeOff->setVisible(true);
-        _nodeOn->setVisible(false);
+    if (_nodeOn != nullptr && _nodeOff != nullptr) {
+        _nodeOn->setVisible(_charge > 0);
+        _nodeOff->setVisible(_charge <= 0);
     }
 }
 
@@ -10,6 +10,6 @@ bool RoomEntity::init(const cugl::Vec2& loc) {
     return true;
 }
 
-void RoomEntity::update(float timestep) {}
+void RoomEntity::update(float /*timestep*/) {}
 
 void RoomEntity::reset() {}
@@ -1,95 +1,127 @@
 #include "RoomParser.h"
-#include "GameRoom.h"
 #include <random>
 
 using namespace cugl;
 
 template <typename T>
 
-/** Returns the index to a random element of a list of floats */
-int RoomParser::getRandIndex(vector<T> lst) {
+/** Returns the index to a random element of a list, or -1 if the list is empty */
+int RoomParser::getRandIndex(const vector<T>& lst) {
+    if (lst.empty()) return -1;
     // https://cpppatterns.com/patterns/choose-random-element.html
-    std::random_device random_device;
-    std::mt19937 engine{ random_device() };
+    static std::mt19937 engine{ std::random_device()() };
     std::uniform_int_distribution<int> dist(0, lst.size() - 1);
     //int random_element = lst[dist(engine)];
     return dist(engine);
 }
 
+/** Reads every layout and map under the given json directory */
+bool RoomParser::preload(const string& directory) {
+    string root = directory.empty() || directory.back() == '/' ? directory : directory + "/";
 
-/** Takes in a door configuration and returns the path to an obstacle layout,
- *  as well as the string that represents which layout was chosen.
- */
-vector<string> RoomParser::pickLayout(string code) {
-    vector<string> output;
-    shared_ptr<JsonReader> reader = JsonReader::alloc("json/layouts/layouts.json");
-    shared_ptr<JsonValue> value = reader->readJson();
-    vector<int> layouts = value->get(code)->asIntArray();
-    string result = to_string(layouts[getRandIndex(layouts)]);
-    output.push_back(result);
-    output.push_back("json/layouts/" + result + ".json");
-    return output;
-}
-
-/** Returns the path to a random map layout */
-string RoomParser::pickMap() {
-    shared_ptr<JsonReader> reader = JsonReader::alloc("json/maps/mapcount.json");
-    shared_ptr<JsonValue> value = reader->readJson();
-    vector<int> layouts = value->get("maps")->asIntArray();
+    auto codes = JsonDocument::allocWithFile(root + "layouts/layouts.json");
+    if (codes == nullptr) return false;
+    bool success = readLayout(root + "layouts/end.json", -1) && readLayout(root + "layouts/start.json", -2);
+    for (size_t i = 0; i < codes->root().size(); ++i) {
+        auto code = codes->root().get(i);
+        vector<int>& layouts = _codes[string(code.key())];
+        for (size_t j = 0; j < code.size(); ++j) {
+            int layout = code.get(j).asInt();
+            layouts.push_back(layout);
+            if (_layouts.find(layout) == _layouts.end()) {
+                success = readLayout(root + "layouts/" + to_string(layout) + ".json", layout) && success;
+            }
+        }
+    }
 
-    return "json/maps/map" + to_string(layouts[getRandIndex(layouts)]) + ".json";
+    auto maps = JsonDocument::allocWithFile(root + "maps/mapcount.json");
+    if (maps == nullptr) return false;
+    auto ids = maps->root().get("maps");
+    for (size_t i = 0; i < ids.size(); ++i) {
+        int map = ids.get(i).asInt();
+        _mapIds.push_back(map);
+        success = readMap(root + "maps/map" + to_string(map) + ".json", map) && success;
+    }
+    return success;
 }
 
-/** Takes in a json file and returns the layout metadata */
-shared_ptr<LayoutMetadata> RoomParser::getLayoutData(string file) {
+/** Parses the layout file and adds it under the given id */
+bool RoomParser::readLayout(const string& file, int layout) {
     vector<ObsMetadata> obstaclesData = {};
     vector<Vec2> spawnData = {};
 
-    shared_ptr<JsonReader> reader = JsonReader::alloc(file);
-    shared_ptr<JsonValue> value = reader->readJson();
-    shared_ptr<JsonValue> obstacles = value->get("obstacles");
-    for (auto& obs : obstacles->_children) {
-        string name = obs->get("name")->asString();
-        bool flip = obs->get("flip")->asBool();
-        vector<float> pos = obs->get("position")->asFloatArray();
-        vector<float> dims = obs->get("hitbox")->asFloatArray();
-        Vec2 position = Vec2(pos[0], pos[1]);
-        Vec2 hitbox = Vec2(dims[0], dims[1]);
+    auto doc = JsonDocument::allocWithFile(file);
+    if (doc == nullptr) return false;
+    auto obstacles = doc->root().get("obstacles");
+    for (size_t i = 0; i < obstacles.size(); ++i) {
+        auto obs = obstacles.get(i);
+        string name = string(obs.get("name").asString());
+        bool flip = obs.getBool("flip");
+        auto pos = obs.get("position");
+        auto dims = obs.get("hitbox");
+        Vec2 position = Vec2(pos.get(0).asFloat(), pos.get(1).asFloat());
+        Vec2 hitbox = Vec2(dims.get(0).asFloat(), dims.get(1).asFloat());
         obstaclesData.push_back(ObsMetadata(name, flip, position, hitbox));
     }
-    shared_ptr<JsonValue> spawns = value->get("spawns");
-    for (auto& spawn : spawns->_children) {
-        vector<float> pos = spawn->get("position")->asFloatArray();
-        Vec2 position = Vec2(pos[0], pos[1]);
-        spawnData.push_back(position);
+    auto spawns = doc->root().get("spawns");
+    for (size_t i = 0; i < spawns.size(); ++i) {
+        auto pos = spawns.get(i).get("position");
+        spawnData.push_back(Vec2(pos.get(0).asFloat(), pos.get(1).asFloat()));
     }
-    return make_shared<LayoutMetadata>(obstaclesData, spawnData);
+    _layouts[layout] = make_shared<LayoutMetadata>(obstaclesData, spawnData);
+    return true;
 }
 
-/** Takes in a json file and returns the corresponding map.
- *  Also picks a start room and end room combination.
- */
-shared_ptr<MapMetadata> RoomParser::getMapData(string file) {
+/** Parses the map file and adds it under the given id */
+bool RoomParser::readMap(const string& file, int map) {
     vector<RoomMetadata> rooms = {};
 
-    shared_ptr<JsonReader> reader = JsonReader::alloc(file);
-    shared_ptr<JsonValue> value = reader->readJson();
-
-    // Start with rooms
-    shared_ptr<JsonValue> roomData = value->get("rooms");
-    for (auto& room : roomData->_children) {
-        vector<bool> doors = room->get("doors")->asBoolArray();
-        vector<float> temp = room->get("rank")->asFloatArray();
-        Vec2 rank = Vec2(temp[0], temp[1]);
+    auto doc = JsonDocument::allocWithFile(file);
+    if (doc == nullptr) return false;
+    auto roomData = doc->root().get("rooms");
+    for (size_t i = 0; i < roomData.size(); ++i) {
+        auto room = roomData.get(i);
+        auto doorData = room.get("doors");
+        vector<bool> doors;
+        for (size_t j = 0; j < doorData.size(); ++j) {
+            doors.push_back(doorData.get(j).asBool());
+        }
+        auto temp = room.get("rank");
+        Vec2 rank = Vec2(temp.get(0).asFloat(), temp.get(1).asFloat());
         rooms.push_back(RoomMetadata(doors, rank));
     }
-    // Then pick a spawn
+    // The start and end rooms are fixed for now rather than picked from "spawns"
+    _maps[map] = make_shared<MapMetadata>(rooms, Vec2(1, 3), Vec2(3, 1), doc->root().getInt("batteries"));
+    return true;
+}
+
+/** Takes in a door configuration and returns a random layout id that fits it, or NO_PICK if none does */
+int RoomParser::pickLayout(const string& code) {
+    auto it = _codes.find(code);
+    if (it == _codes.end() || it->second.empty()) {
+        CULogError("No layout for doors %s", code.c_str());
+        return NO_PICK;
+    }
+    return it->second[getRandIndex(it->second)];
+}
 
-    vector<shared_ptr<JsonValue>> spawnData = value->get("spawns")->_children;
-    shared_ptr<JsonValue> randSpawn = spawnData[getRandIndex(spawnData)];
-    Vec2 start = Vec2(randSpawn->get("start")->asIntArray()[0], randSpawn->get("start")->asIntArray()[1]);
-    Vec2 end = Vec2(randSpawn->get("end")->asIntArray()[0], randSpawn->get("end")->asIntArray()[1]);
-    //return make_shared<MapMetadata>(rooms, start, end, value->get("batteries")->asInt());
-    return make_shared<MapMetadata>(rooms, Vec2(1, 3), Vec2(3, 1), value->get("batteries")->asInt());
+/** Returns the id of a random map, or NO_PICK if there are no maps */
+int RoomParser::pickMap() {
+    if (_mapIds.empty()) {
+        CULogError("No maps in the room catalog");
+        return NO_PICK;
+    }
+    return _mapIds[getRandIndex(_mapIds)];
+}
 
-}
\ No newline at end of file
+/** Returns the layout with the given id, or nullptr if there is none */
+shared_ptr<LayoutMetadata> RoomParser::getLayoutData(int layout) const {
+    auto it = _layouts.find(layout);
+    return it == _layouts.end() ? nullptr : it->second;
+}
+
+/** Returns the map with the given id, or nullptr if there is none */
+shared_ptr<MapMetadata> RoomParser::getMapData(int map) const {
+    auto it = _maps.find(map);
+    return it == _maps.end() ? nullptr : it->second;
+}
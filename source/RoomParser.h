@@ -4,10 +4,20 @@
 using namespace std;
 using namespace cugl;
 
+/** The asset key of the room catalog */
+#define ROOM_CATALOG "rooms"
+/** The directory holding layouts/ and maps/ */
+#define ROOM_DIRECTORY "json"
+/** The id returned by pickLayout and pickMap when there is nothing to pick */
+#define NO_PICK INT_MIN
+
 /**
 * This class represents the room parser. It's responsible for
 * taking in json representations of rooms and creating room objects
 * as per the json's specifications
+*
+* The layouts and maps are read once, when the parser is loaded as an asset,
+* so generating a map does no file I/O or JSON parsing.
 */
 
 
@@ -67,49 +77,69 @@ struct MapMetadata {
     }
 };
 
-class RoomParser {
+class RoomParser : public Asset {
  
 private:
+    /** The layout ids that fit each door configuration, keyed by door code */
+    unordered_map<string, vector<int>> _codes;
+
+    /** Every layout, keyed by layout id. -1 is the end room and -2 the start room */
+    unordered_map<int, shared_ptr<LayoutMetadata>> _layouts;
+
+    /** The ids of the random maps */
+    vector<int> _mapIds;
+
+    /** Every map, keyed by map id */
+    unordered_map<int, shared_ptr<MapMetadata>> _maps;
+
     template <typename T>
 
-    /** Returns the index to a random element of a list of floats */
-    int getRandIndex(vector<T> lst);
+    /** Returns the index to a random element of a list, or -1 if the list is empty */
+    int getRandIndex(const vector<T>& lst);
 
-public:
-    shared_ptr<AssetManager> _assets;
-    shared_ptr<scene2::OrderedNode> _node;
+    /** Parses the layout file and adds it under the given id */
+    bool readLayout(const string& file, int layout);
+
+    /** Parses the map file and adds it under the given id */
+    bool readMap(const string& file, int map);
 
+public:
     /** Creates a new Parser with the default values */
     RoomParser() {};
 
     /** Releases all resources allocated with this Parser */
     ~RoomParser() { dispose(); };
 
-    /** Initializes a new Parser */
-    bool init() {
-        return true;
-    };
+    /** 
+     * Reads every layout and map under the given json directory (the parent of
+     * layouts/ and maps/). This is the only place the catalog touches a file,
+     * so it is safe to call on a loader thread.
+     */
+    bool preload(const string& directory) override;
+    using Asset::preload;
 
     void dispose() {
-        _assets = nullptr;
-        _node = nullptr;
+        _codes.clear();
+        _layouts.clear();
+        _mapIds.clear();
+        _maps.clear();
     }
 
-    /** Takes in a door configuration and returns the path to an obstacle layout,
-     *  as well as the string that represents which layout was chosen. 
-     */
-    vector<string> pickLayout(string code);
-
-    /** Returns the path to a random map layout */
-    string pickMap();
+    /** Returns a parser with the catalog under the given json directory */
+    static shared_ptr<RoomParser> alloc(const string& directory) {
+        shared_ptr<RoomParser> result = make_shared<RoomParser>();
+        return (result->init(directory) ? result : nullptr);
+    }
 
-    /** Takes in a json file and returns the room layout */
-    shared_ptr<LayoutMetadata>getLayoutData(string file);
+    /** Takes in a door configuration and returns a random layout id that fits it, or NO_PICK if none does */
+    int pickLayout(const string& code);
 
-    /** Takes in a json file and returns the corresponding map.
-     *  Also picks a start room and end room combination.
-     */
-    shared_ptr<MapMetadata> getMapData(string file);
+    /** Returns the id of a random map, or NO_PICK if there are no maps */
+    int pickMap();
 
+    /** Returns the layout with the given id, or nullptr if there is none */
+    shared_ptr<LayoutMetadata> getLayoutData(int layout) const;
 
+    /** Returns the map with the given id, or nullptr if there is none */
+    shared_ptr<MapMetadata> getMapData(int map) const;
 };
@@ -0,0 +1,144 @@
+#pragma once
+
+#ifndef __SPATIAL_INDEX_H__
+#define __SPATIAL_INDEX_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+#include "Constants.h"
+
+using namespace std;
+using namespace cugl;
+
+/**
+ * Spatial hash over entities, for "what is near this point" queries.
+ *
+ * Items are bucketed by the cell their location falls in. Cells are only
+ * created when something is in them, so the index needs no bounds. Queries
+ * visit the cells a circle overlaps and compare squared distances, so no
+ * square roots are taken.
+ *
+ * T is any entity with getLoc(). The index keeps the location an item was
+ * inserted at, so an entity that moves must be moved in the index too (or
+ * the index rebuilt, which is cheap for a handful of players).
+ */
+template <typename T>
+class SpatialIndex {
+private:
+    struct Entry {
+        shared_ptr<T> item;
+        Vec2 loc;
+    };
+
+    /** Width and height of a cell */
+    float _cellSize;
+
+    /** Occupied cells, keyed by packed cell coordinates */
+    unordered_map<uint64_t, vector<Entry>> _cells;
+
+    /** Number of items in the index */
+    size_t _size;
+
+    int cellCoord(float v) const {
+        return static_cast<int>(floorf(v / _cellSize));
+    }
+
+    static uint64_t key(int x, int y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    uint64_t keyFor(const Vec2& loc) const {
+        return key(cellCoord(loc.x), cellCoord(loc.y));
+    }
+
+public:
+    SpatialIndex(float cellSize = 4 * constants::TILE_SIZE) : _cellSize(cellSize), _size(0) { }
+
+    /** Returns the number of items in the index */
+    size_t size() const { return _size; }
+
+    /** Removes every item; cell storage is kept for reuse */
+    void clear() {
+        for (auto& cell : _cells) {
+            cell.second.clear();
+        }
+        _size = 0;
+    }
+
+    /** Adds an item at its current location */
+    void insert(const shared_ptr<T>& item) {
+        if (item == nullptr) return;
+        Vec2 loc = item->getLoc();
+        _cells[keyFor(loc)].push_back({ item, loc });
+        ++_size;
+    }
+
+    /** Removes an item, returning false if it was not in the index */
+    bool remove(const shared_ptr<T>& item) {
+        if (item == nullptr) return false;
+        auto it = _cells.find(keyFor(item->getLoc()));
+        if (it == _cells.end()) return false;
+        auto& entries = it->second;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].item == item) {
+                entries[i] = entries.back();
+                entries.pop_back();
+                --_size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Calls f(item, distanceSquared) for every item strictly closer than
+     * radius to center, in no particular order.
+     */
+    template <typename F>
+    void forEachInRadius(const Vec2& center, float radius, F f) const {
+        if (_size == 0) return;
+        float radius2 = radius * radius;
+        int x0 = cellCoord(center.x - radius);
+        int x1 = cellCoord(center.x + radius);
+        int y0 = cellCoord(center.y - radius);
+        int y1 = cellCoord(center.y + radius);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                auto it = _cells.find(key(x, y));
+                if (it == _cells.end()) continue;
+                for (auto& e : it->second) {
+                    float d2 = e.loc.distanceSquared(center);
+                    if (d2 < radius2) {
+                        f(e.item, d2);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the closest item strictly within radius of center that passes
+     * the filter, or nullptr if there is none.
+     *
+     * @param distance2 If not null, set to the squared distance of the result
+     */
+    template <typename Pred>
+    shared_ptr<T> nearest(const Vec2& center, float radius, Pred filter, float* distance2 = nullptr) const {
+        shared_ptr<T> result;
+        float best = numeric_limits<float>::infinity();
+        forEachInRadius(center, radius, [&](const shared_ptr<T>& item, float d2) {
+            if (d2 < best && filter(item)) {
+                best = d2;
+                result = item;
+            }
+        });
+        if (distance2 != nullptr) *distance2 = best;
+        return result;
+    }
+
+    /** Returns the closest item strictly within radius of center, or nullptr */
+    shared_ptr<T> nearest(const Vec2& center, float radius) const {
+        return nearest(center, radius, [](const shared_ptr<T>&) { return true; });
+    }
+};
+
+#endif /** __SPATIAL_INDEX_H__ */
@@ -21,7 +21,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
     if (_create == nullptr) {
         return false;
     }
-    _create->addListener([=](const string& name, bool down) {
+    _create->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::CreateGame;
         }
@@ -31,7 +31,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
     if (_join == nullptr) {
         return false;
     }
-    _join->addListener([=](const string& name, bool down) {
+    _join->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::JoinGame;
         }
@@ -42,7 +42,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
         return false;
     }
     
-    _muteButton->addListener([=](const string& name, bool down) {
+    _muteButton->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mute = !_mute;
         }
@@ -53,7 +53,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
         return false;
     }
     
-    _unmuteButton->addListener([=](const string& name, bool down) {
+    _unmuteButton->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mute = !_mute;
         }
@@ -64,7 +64,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
         return false;
     }
 
-    _info->addListener([=](const string& name, bool down) {
+    _info->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::Info;
         }
@@ -98,7 +98,7 @@ bool StartScene::init(const shared_ptr<AssetManager>& assets) {
     return true;
 }
 
-void StartScene::update(float timestep) {
+void StartScene::update(float /*timestep*/) {
     if (_mute == false) {
         _unmuteButton->setVisible(false);
         if (_unmuteButton->isActive()) {
@@ -21,7 +21,7 @@ namespace utils {
         CULog("%d", i);
     }
     inline void Log(const string& label, const vector<int>& v) {
-        for (int i = 0; i < v.size(); ++i) {
+        for (int i = 0; i < (int)v.size(); ++i) {
             CULog((label + "[%d]: &d").c_str(), i, v[i]);
         }
     }
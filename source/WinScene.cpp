@@ -28,7 +28,7 @@ bool WinScene::init(const shared_ptr<AssetManager>& assets) {
         return false;
     }
     
-    _quit->addListener([=](const string& name, bool down) {
+    _quit->addListener([=](const string& /*name*/, bool down) {
         if (!down) {
             _mode = constants::GameMode::Start;
         }
@@ -46,7 +46,7 @@ bool WinScene::init(const shared_ptr<AssetManager>& assets) {
  *
  * @param timestep  The amount of time (in seconds) since the last frame
  */
-void WinScene::update(float timestep) {
+void WinScene::update(float /*timestep*/) {
     Size dimen = Application::get()->getDisplaySize();
     dimen *= constants::SCENE_WIDTH / dimen.width;
     _quit->setVisible(_quit->isActive());
@@ -27,8 +27,18 @@
 //  Author: Walker White
 //  Version: 7/1/16
 
+// The headless host (HeadlessHost.cpp), the atlas packer (AtlasTool.cpp), the
+// asset bundler (BundleTool.cpp) and the JSON, network and render benchmarks
+// (JsonBench.cpp, NetBench.cpp, RenderBench.cpp) provide their own entry points
+#if !defined(GHOSTED_HEADLESS) && !defined(GHOSTED_ATLAS_TOOL) && !defined(GHOSTED_BUNDLE_TOOL) && \
+    !defined(GHOSTED_JSON_BENCH) && !defined(GHOSTED_NET_BENCH) && !defined(GHOSTED_RENDER_BENCH)
+
 // Include your application class
 #include "GhostedApp.h"
+#ifdef CU_PROFILE
+#include <cstdlib>
+#include <new>
+#endif
 
 // This keeps us from having to write cugl:: all the time
 using namespace cugl;
@@ -37,6 +47,38 @@ using namespace cugl;
 #define GAME_WIDTH 1024
 #define GAME_HEIGHT 576
 
+#ifdef CU_PROFILE
+/**
+ * Allocates memory, counting the allocation for the profiler.
+ *
+ * CUGL leaves this hook to the application, so that the tools and benchmarks
+ * (which have no main.cpp) are free to replace operator new themselves. The
+ * array and nothrow forms are defined in terms of this one.
+ *
+ * @param size  The number of bytes to allocate
+ *
+ * @return the allocated memory
+ */
+void* operator new(std::size_t size) {
+    Profiler::count(Profiler::Counter::ALLOCATIONS, 1);
+    void* result = std::malloc(size == 0 ? 1 : size);
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+/** Releases memory allocated by operator new */
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+/** Releases memory allocated by operator new */
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
 /**
  * The main entry point of any CUGL application.
  *
@@ -60,7 +102,7 @@ int main(int argc, char * argv[]) {
 
     // Set the window properties (Only applies to OS X/Windows Desktop)
     app.setSize(GAME_WIDTH, GAME_HEIGHT);
-    app.setFPS(60.0f);
+    app.setFPS(constants::TICK_RATE);
     app.setHighDPI(true);
     
     /// DO NOT MODIFY ANYTHING BELOW THIS LINE
@@ -76,3 +118,5 @@ int main(int argc, char * argv[]) {
     exit(0);    // Necessary to quit on mobile devices
     return 0;   // This line is never reached
 }
+
+#endif /** No tool or benchmark entry point */